@@ -51,6 +51,7 @@
 #include <gtkmm/accelmap.h>
 #include <gtkmm/stock.h>
 
+#include "pbd/arena.h"
 #include "pbd/error.h"
 #include "pbd/basename.h"
 #include "pbd/compose.h"
@@ -121,6 +122,8 @@
 
 #include "timecode/time.h"
 
+#include "canvas/tiled_container.h"
+
 typedef uint64_t microseconds_t;
 
 #include "about.h"
@@ -746,6 +749,8 @@ ARDOUR_UI::~ARDOUR_UI ()
 
 	stop_video_server();
 
+	ArdourCanvas::TiledContainer::set_render_threads (0);
+
 	if (getenv ("ARDOUR_RUNNING_UNDER_VALGRIND")) {
 		// don't bother at 'real' exit. the OS cleans up for us.
 		delete big_clock; big_clock = 0;
@@ -766,12 +771,8 @@ ARDOUR_UI::~ARDOUR_UI ()
 	}
 
 #ifndef NDEBUG
-	/* Small trick to flush main-thread event pool.
-	 * Other thread-pools are destroyed at pthread_exit(),
-	 * but tmain thread termination is too late to trigger Pool::~Pool()
-	 */
-	SessionEvent* ev = new SessionEvent (SessionEvent::SetTransportSpeed, SessionEvent::Clear, SessionEvent::Immediate, 0, 0); // get the pool reference, values don't matter since the event is never queued.
-	delete ev->event_pool();
+	/* show how well the per-thread event and request reservations fit */
+	cerr << PBD::Arena::report ();
 #endif
 }
 
@@ -30,6 +30,7 @@
 #include "ardour/rc_configuration.h"
 #include "ardour/session.h"
 
+#include "canvas/tiled_container.h"
 #include "canvas/wave_view.h"
 
 #include "audio_clock.h"
@@ -493,6 +494,11 @@ ARDOUR_UI::parameter_changed (std::string p)
 	} else if (p == "waveform-cache-size") {
 		/* GUI option has units of megabytes; image cache uses units of bytes */
 		ArdourCanvas::WaveView::set_image_cache_size (UIConfiguration::instance().get_waveform_cache_size() * 1048576);
+	} else if (p == "canvas-tile-cache-size") {
+		/* GUI option has units of megabytes; tile cache uses units of bytes */
+		ArdourCanvas::TiledContainer::set_cache_size (UIConfiguration::instance().get_canvas_tile_cache_size() * 1048576);
+	} else if (p == "canvas-render-threads") {
+		ArdourCanvas::TiledContainer::set_render_threads (UIConfiguration::instance().get_canvas_render_threads());
 	} else if (p == "use-wm-visibility") {
 		VisibilityTracker::set_use_window_manager_visibility (UIConfiguration::instance().get_use_wm_visibility());
 	} else if (p == "action-table-columns") {
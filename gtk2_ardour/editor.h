@@ -1335,15 +1335,6 @@ class Editor : public PublicEditor, public PBD::ScopedConnectionList, public ARD
 
 	/* PT import */
 	void external_pt_dialog ();
-	typedef struct ptflookup {
-		uint16_t index1;
-		uint16_t index2;
-		PBD::ID  id;
-
-		bool operator ==(const struct ptflookup& other) {
-			return (this->index1 == other.index1);
-		}
-	} ptflookup_t;
 
 	/* import & embed */
 
@@ -1370,6 +1361,16 @@ class Editor : public PublicEditor, public PBD::ScopedConnectionList, public ARD
 	                     bool                                  replace,
 	                     boost::shared_ptr<ARDOUR::PluginInfo> instrument = boost::shared_ptr<ARDOUR::PluginInfo>());
 
+	void run_import (std::vector<std::string>              paths,
+	                 Editing::ImportDisposition            disposition,
+	                 Editing::ImportMode                   mode,
+	                 ARDOUR::SrcQuality                    quality,
+	                 framepos_t                            pos,
+	                 int                                   target_regions,
+	                 int                                   target_tracks,
+	                 boost::shared_ptr<ARDOUR::Track>&     track,
+	                 bool                                  replace);
+
 	int embed_sndfiles (std::vector<std::string>              paths,
 	                    bool                                  multiple_files,
 	                    bool&                                 check_sample_rate,
@@ -553,6 +553,45 @@ Editor::import_sndfiles (vector<string>            paths,
                          boost::shared_ptr<Track>& track,
                          bool                      replace,
                          ARDOUR::PluginInfoPtr     instrument)
+{
+	run_import (paths, disposition, mode, quality, pos, target_regions, target_tracks, track, replace);
+
+	int result = -1;
+
+	if (!import_status.cancel && !import_status.sources.empty()) {
+		result = add_sources (
+			import_status.paths,
+			import_status.sources,
+			import_status.pos,
+			disposition,
+			import_status.mode,
+			import_status.target_regions,
+			import_status.target_tracks,
+			track, false, instrument
+			);
+
+		/* update position from results */
+
+		pos = import_status.pos;
+	}
+
+	return result;
+}
+
+/** Copy @param paths into the session in the import thread, while the GUI
+ *  keeps running. The new sources are left in import_status.sources, in the
+ *  order of @param paths and each file's channels one after the other.
+ */
+void
+Editor::run_import (vector<string>            paths,
+                    ImportDisposition         disposition,
+                    ImportMode                mode,
+                    SrcQuality                quality,
+                    framepos_t                pos,
+                    int                       target_regions,
+                    int                       target_tracks,
+                    boost::shared_ptr<Track>& track,
+                    bool                      replace)
 {
 	import_status.paths = paths;
 	import_status.done = false;
@@ -588,27 +627,6 @@ Editor::import_sndfiles (vector<string>            paths,
 	while (!import_status.done) {
 		gtk_main_iteration ();
 	}
-
-	int result = -1;
-
-	if (!import_status.cancel && !import_status.sources.empty()) {
-		result = add_sources (
-			import_status.paths,
-			import_status.sources,
-			import_status.pos,
-			disposition,
-			import_status.mode,
-			import_status.target_regions,
-			import_status.target_tracks,
-			track, false, instrument
-			);
-
-		/* update position from results */
-
-		pos = import_status.pos;
-	}
-
-	return result;
 }
 
 int
@@ -34,6 +34,7 @@
 #include "canvas/pixbuf.h"
 #include "canvas/scroll_group.h"
 #include "canvas/text.h"
+#include "canvas/tiled_container.h"
 #include "canvas/debug.h"
 
 #include "ardour_ui.h"
@@ -116,7 +117,10 @@ Editor::initialize_canvas ()
 	time_line_group = new ArdourCanvas::Container (h_scroll_group);
 	CANVAS_DEBUG_NAME (time_line_group, "time line group");
 
-	_trackview_group = new ArdourCanvas::Container (hv_scroll_group);
+	/* regions and everything else that lives in the tracks is drawn
+	 * into cached tiles, so that scrolling mostly just composites them.
+	 */
+	_trackview_group = new ArdourCanvas::TiledContainer (hv_scroll_group);
 	CANVAS_DEBUG_NAME (_trackview_group, "Canvas TrackViews");
 
 	// used as rubberband rect
@@ -987,8 +991,12 @@ Editor::color_handler()
 
 	NoteBase::set_colors ();
 
-	/* redraw the whole thing */
+	/* redraw the whole thing, including tiles of items which did not
+	   change but render using the colours we have just changed (notes,
+	   for instance)
+	*/
 	_track_canvas->set_background_color (UIConfiguration::instance().color ("arrange base"));
+	_track_canvas->drop_tiles ();
 	_track_canvas->queue_draw ();
 
 /*
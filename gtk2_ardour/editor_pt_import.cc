@@ -120,14 +120,18 @@ Editor::do_ptimport (std::string ptpath,
 	boost::shared_ptr<ARDOUR::Track> track;
 	ARDOUR::PluginInfoPtr instrument;
 	vector<string> to_import;
+	vector<uint32_t> channels;
+	map<string, size_t> to_import_index;
+	vector<pair<uint16_t, size_t> > wavfiles;
 	string fullpath;
 	bool ok = false;
 	bool onefailed = false;
 	PTFFormat ptf;
 	framepos_t pos = -1;
 
-	vector<ptflookup_t> ptfwavpair;
-	vector<ptflookup_t> ptfregpair;
+	/* imported sources by PT wav index, and created regions by PT region index */
+	map<uint16_t, boost::shared_ptr<Source> > ptfwavs;
+	map<uint16_t, PBD::ID> ptfregions;
 
 	if (ptf.load(ptpath, _session->frame_rate()) == -1) {
 		MessageDialog msg (_("Doesn't seem to be a valid PT session file"));
@@ -142,36 +146,98 @@ Editor::do_ptimport (std::string ptpath,
 			return;
 		}
 	}
+
+	/* check the headers of all files first, so that those which cannot be
+	   read are left out rather than failing the whole import, then import
+	   the rest in one go, which copies them in parallel.
+	*/
+
+	for (vector<PTFFormat::wav_t>::iterator a = ptf.audiofiles.begin(); a != ptf.audiofiles.end(); ++a) {
+		SoundFileInfo info;
+		string errmsg;
+
+		fullpath = Glib::build_filename (Glib::path_get_dirname(ptpath), "Audio Files");
+		fullpath = Glib::build_filename (fullpath, a->filename);
+
+		map<string, size_t>::const_iterator f = to_import_index.find (fullpath);
+		if (f != to_import_index.end()) {
+			wavfiles.push_back (make_pair (a->index, f->second));
+			continue;
+		}
+
+		if (!AudioFileSource::get_soundfile_info (fullpath, info, errmsg) || info.channels == 0) {
+			onefailed = true;
+			continue;
+		}
+
+		to_import_index[fullpath] = to_import.size();
+		wavfiles.push_back (make_pair (a->index, to_import.size()));
+		to_import.push_back (fullpath);
+		channels.push_back (info.channels);
+	}
+
 	current_interthread_info = &import_status;
 	import_status.current = 1;
-	import_status.total = ptf.audiofiles.size ();
+	import_status.total = to_import.size ();
 	import_status.all_done = false;
 
 	ImportProgressWindow ipw (&import_status, _("Import"), _("Cancel Import"));
 
 	SourceList just_one;
+	gint64 const import_start = g_get_monotonic_time ();
+
+	if (!to_import.empty ()) {
+		ipw.show ();
+		run_import (to_import, Editing::ImportDistinctFiles, Editing::ImportAsRegion, quality, pos, 1, -1, track, false);
+	}
+
+	/* sources are added in the order of the files, each file's channels
+	   one after the other. As when the files were imported one by one,
+	   make a whole-file region of each file's channels, and use the last
+	   channel of each for the PT regions.
+	*/
+
 	SourceList imported;
+	size_t n_channels = 0;
 
-	for (vector<PTFFormat::wav_t>::iterator a = ptf.audiofiles.begin(); a != ptf.audiofiles.end(); ++a) {
-		ptflookup_t p;
+	for (size_t n = 0; n < to_import.size(); ++n) {
+		n_channels += channels[n];
+	}
 
-		fullpath = Glib::build_filename (Glib::path_get_dirname(ptpath), "Audio Files");
-		fullpath = Glib::build_filename (fullpath, a->filename);
-		to_import.clear ();
-		to_import.push_back (fullpath);
-		ipw.show ();
-		ok = import_sndfiles (to_import, Editing::ImportDistinctFiles, Editing::ImportAsRegion, quality, pos, 1, -1, track, false, instrument);
-		if (!import_status.sources.empty()) {
-			p.index1 = a->index;
-			p.id = import_status.sources.back()->id();
-
-			ptfwavpair.push_back(p);
-			imported.push_back(import_status.sources.back());
-		} else {
-			onefailed = true;
+	if (to_import.empty ()) {
+		/* nothing was imported */
+	} else if (import_status.cancel) {
+		onefailed = true;
+	} else if (import_status.sources.size() != n_channels) {
+		/* a file had a different number of channels than its header
+		   said, so which sources belong to which file is unknown.
+		*/
+		error << string_compose (_("PT import: expected %1 channels from %2 audio files, got %3"),
+		                         n_channels, to_import.size(), import_status.sources.size())
+		      << endmsg;
+		onefailed = true;
+	} else {
+		SourceList::const_iterator s = import_status.sources.begin();
+
+		for (size_t n = 0; n < to_import.size(); ++n) {
+			SourceList file_sources (s, s + channels[n]);
+			s += channels[n];
+
+			add_sources (vector<string> (1, to_import[n]), file_sources, pos, Editing::ImportDistinctFiles, Editing::ImportAsRegion, 1, -1, track, false, instrument);
+			imported.push_back (file_sources.back ());
+		}
+
+		ok = !imported.empty ();
+	}
+
+	for (vector<pair<uint16_t, size_t> >::const_iterator w = wavfiles.begin(); w != wavfiles.end(); ++w) {
+		if (w->second < imported.size()) {
+			ptfwavs.insert (make_pair (w->first, imported[w->second]));
 		}
 	}
 
+	gint64 const import_end = g_get_monotonic_time ();
+
 	if (onefailed) {
 		MessageDialog msg (_("Failed to load one or more of the audio files, but continuing to attempt import."));
 		msg.run ();
@@ -180,6 +246,8 @@ Editor::do_ptimport (std::string ptpath,
 		msg.run ();
 	}
 
+	gint64 const create_start = g_get_monotonic_time ();
+
 	// Create a dummy midi track first to get a midi Source
 	list<boost::shared_ptr<MidiTrack> > mt (
 		_session->new_midi_track (ChanCount (DataType::MIDI, 1),
@@ -196,36 +264,26 @@ Editor::do_ptimport (std::string ptpath,
 
 	for (vector<PTFFormat::region_t>::iterator a = ptf.regions.begin();
 			a != ptf.regions.end(); ++a) {
-		for (vector<ptflookup_t>::iterator p = ptfwavpair.begin();
-				p != ptfwavpair.end(); ++p) {
-			if ((p->index1 == a->wave.index) && (strcmp(a->wave.filename.c_str(), "") != 0)) {
-				for (SourceList::iterator x = imported.begin();
-						x != imported.end(); ++x) {
-					if ((*x)->id() == p->id) {
-						// Matched an uncreated ptf region to ardour region
-						ptflookup_t rp;
-						PropertyList plist;
-
-						plist.add (ARDOUR::Properties::start, a->sampleoffset);
-						plist.add (ARDOUR::Properties::position, 0);
-						plist.add (ARDOUR::Properties::length, a->length);
-						plist.add (ARDOUR::Properties::name, a->name);
-						plist.add (ARDOUR::Properties::layer, 0);
-						plist.add (ARDOUR::Properties::whole_file, false);
-						plist.add (ARDOUR::Properties::external, true);
-
-						just_one.clear();
-						just_one.push_back(*x);
-
-						boost::shared_ptr<Region> r = RegionFactory::create (just_one, plist);
-						regions.push_back(r);
-
-						rp.id = regions.back()->id();
-						rp.index1 = a->index;
-						ptfregpair.push_back(rp);
-					}
-				}
-			}
+		map<uint16_t, boost::shared_ptr<Source> >::const_iterator w = ptfwavs.find (a->wave.index);
+		if ((w != ptfwavs.end()) && (strcmp(a->wave.filename.c_str(), "") != 0)) {
+			// Matched an uncreated ptf region to ardour region
+			PropertyList plist;
+
+			plist.add (ARDOUR::Properties::start, a->sampleoffset);
+			plist.add (ARDOUR::Properties::position, 0);
+			plist.add (ARDOUR::Properties::length, a->length);
+			plist.add (ARDOUR::Properties::name, a->name);
+			plist.add (ARDOUR::Properties::layer, 0);
+			plist.add (ARDOUR::Properties::whole_file, false);
+			plist.add (ARDOUR::Properties::external, true);
+
+			just_one.clear();
+			just_one.push_back(w->second);
+
+			boost::shared_ptr<Region> r = RegionFactory::create (just_one, plist);
+			regions.push_back(r);
+
+			ptfregions.insert (make_pair (a->index, regions.back()->id()));
 		}
 		if (strcmp(a->wave.filename.c_str(), "") == 0) {
 			/* Empty wave - assume MIDI region */
@@ -267,67 +325,68 @@ Editor::do_ptimport (std::string ptpath,
 
 	boost::shared_ptr<AudioTrack> existing_track;
 	uint16_t nth = 0;
-	vector<ptflookup_t> usedtracks;
-	ptflookup_t utr;
+	/* ardour track, by PT track index */
+	map<uint16_t, uint16_t> usedtracks;
 
 	for (vector<PTFFormat::track_t>::iterator a = ptf.tracks.begin();
 			a != ptf.tracks.end(); ++a) {
-		for (vector<ptflookup_t>::iterator p = ptfregpair.begin();
-				p != ptfregpair.end(); ++p) {
-
-			if (p->index1 == a->reg.index)  {
-				// Matched a ptf active region to an ardour region
-				utr.index1 = a->index;
-				utr.index2 = nth;
-				utr.id = p->id;
-				boost::shared_ptr<Region> r = RegionFactory::region_by_id (p->id);
-				vector<ptflookup_t>::iterator lookuptr = usedtracks.begin();
-				vector<ptflookup_t>::iterator found;
-				if ((found = std::find(lookuptr, usedtracks.end(), utr)) != usedtracks.end()) {
-					DEBUG_TRACE (DEBUG::FileUtils, string_compose ("\twav(%1) reg(%2) ptf_tr(%3) ard_tr(%4)\n", a->reg.wave.filename.c_str(), a->reg.index, found->index1, found->index2));
-					existing_track =  get_nth_selected_audio_track(found->index2);
-					// Put on existing track
-					boost::shared_ptr<Playlist> playlist = existing_track->playlist();
-					boost::shared_ptr<Region> copy (RegionFactory::create (r, true));
-					playlist->clear_changes ();
-					playlist->add_region (copy, a->reg.startpos);
-					//_session->add_command (new StatefulDiffCommand (playlist));
-				} else {
-					// Put on a new track
-					DEBUG_TRACE (DEBUG::FileUtils, string_compose ("\twav(%1) reg(%2) new_tr(%3)\n", a->reg.wave.filename.c_str(), a->reg.index, nth));
-					list<boost::shared_ptr<AudioTrack> > at (_session->new_audio_track (1, 2, 0, 1, string(), PresentationInfo::max_order, Normal));
-					if (at.empty()) {
-						return;
-					}
-					existing_track = at.back();
-					std::string trackname;
-					try {
-						trackname = Glib::convert_with_fallback (a->name, "UTF-8", "UTF-8", "_");
-					} catch (Glib::ConvertError& err) {
-						trackname = string_compose ("Invalid %1", a->index);
-					}
-					// TODO legalize track name (no slashes, no colons)
+		map<uint16_t, PBD::ID>::const_iterator p = ptfregions.find (a->reg.index);
+
+		if (p != ptfregions.end())  {
+			// Matched a ptf active region to an ardour region
+			boost::shared_ptr<Region> r = RegionFactory::region_by_id (p->second);
+			map<uint16_t, uint16_t>::const_iterator found;
+			if ((found = usedtracks.find (a->index)) != usedtracks.end()) {
+				DEBUG_TRACE (DEBUG::FileUtils, string_compose ("\twav(%1) reg(%2) ptf_tr(%3) ard_tr(%4)\n", a->reg.wave.filename.c_str(), a->reg.index, found->first, found->second));
+				existing_track =  get_nth_selected_audio_track(found->second);
+				// Put on existing track
+				boost::shared_ptr<Playlist> playlist = existing_track->playlist();
+				boost::shared_ptr<Region> copy (RegionFactory::create (r, true));
+				playlist->clear_changes ();
+				playlist->add_region (copy, a->reg.startpos);
+				//_session->add_command (new StatefulDiffCommand (playlist));
+			} else {
+				// Put on a new track
+				DEBUG_TRACE (DEBUG::FileUtils, string_compose ("\twav(%1) reg(%2) new_tr(%3)\n", a->reg.wave.filename.c_str(), a->reg.index, nth));
+				list<boost::shared_ptr<AudioTrack> > at (_session->new_audio_track (1, 2, 0, 1, string(), PresentationInfo::max_order, Normal));
+				if (at.empty()) {
+					return;
+				}
+				existing_track = at.back();
+				std::string trackname;
+				try {
+					trackname = Glib::convert_with_fallback (a->name, "UTF-8", "UTF-8", "_");
+				} catch (Glib::ConvertError& err) {
+					trackname = string_compose ("Invalid %1", a->index);
+				}
+				// TODO legalize track name (no slashes, no colons)
 #if 0 // TODO --  "find_route_name" is currently private
-					/* generate a unique name by adding a number if needed */
-					uint32_t id = 0;
-					if (!_session->find_route_name (trackname.c_str (), id, trackname, false)) {
-						fatal << _("PTImport: UINT_MAX routes? impossible!") << endmsg;
-						abort(); /*NOTREACHED*/
-					}
-#endif
-					existing_track->set_name (trackname);
-					boost::shared_ptr<Playlist> playlist = existing_track->playlist();
-					boost::shared_ptr<Region> copy (RegionFactory::create (r, true));
-					playlist->clear_changes ();
-					playlist->add_region (copy, a->reg.startpos);
-					//_session->add_command (new StatefulDiffCommand (playlist));
-					nth++;
+				/* generate a unique name by adding a number if needed */
+				uint32_t id = 0;
+				if (!_session->find_route_name (trackname.c_str (), id, trackname, false)) {
+					fatal << _("PTImport: UINT_MAX routes? impossible!") << endmsg;
+					abort(); /*NOTREACHED*/
 				}
-				usedtracks.push_back(utr);
+#endif
+				existing_track->set_name (trackname);
+				boost::shared_ptr<Playlist> playlist = existing_track->playlist();
+				boost::shared_ptr<Region> copy (RegionFactory::create (r, true));
+				playlist->clear_changes ();
+				playlist->add_region (copy, a->reg.startpos);
+				//_session->add_command (new StatefulDiffCommand (playlist));
+				usedtracks.insert (make_pair (a->index, nth));
+				nth++;
 			}
 		}
 	}
 
+	info << string_compose (_("PT import of %1: decoding %2 ms, parsing %3 ms, copying %4 audio files %5 ms, creating regions and tracks %6 ms"),
+	                        Glib::path_get_basename (ptpath),
+	                        ptf.decodetime / 1000, ptf.parsetime / 1000,
+	                        to_import.size(), (import_end - import_start) / 1000,
+	                        (g_get_monotonic_time () - create_start) / 1000)
+	     << endmsg;
+
 	import_status.sources.clear();
 
 	if (ok) {
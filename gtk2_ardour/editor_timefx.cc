@@ -299,11 +299,8 @@ void
 Editor::do_timefx ()
 {
 	boost::shared_ptr<Playlist> playlist;
-	boost::shared_ptr<Region>   new_region;
 	set<boost::shared_ptr<Playlist> > playlists_affected;
 
-	uint32_t const N = current_timefx->regions.size ();
-
 	for (RegionList::iterator i = current_timefx->regions.begin(); i != current_timefx->regions.end(); ++i) {
 		boost::shared_ptr<Playlist> playlist = (*i)->playlist();
 
@@ -312,6 +309,11 @@ Editor::do_timefx ()
 		}
 	}
 
+	/* one filter per region; their processing is spread over all cores */
+
+	vector<Filter*> filters;
+	vector<boost::shared_ptr<Region> > regions;
+
 	for (RegionList::iterator i = current_timefx->regions.begin(); i != current_timefx->regions.end(); ++i) {
 
 		boost::shared_ptr<AudioRegion> region = boost::dynamic_pointer_cast<AudioRegion> (*i);
@@ -320,13 +322,6 @@ Editor::do_timefx ()
 			continue;
 		}
 
-		if (current_timefx->request.cancel) {
-			/* we were cancelled */
-			/* XXX what to do about playlists already affected ? */
-			current_timefx->status = 1;
-			return;
-		}
-
 		Filter* fx;
 
 		if (current_timefx->pitching) {
@@ -339,31 +334,48 @@ Editor::do_timefx ()
 #endif
 		}
 
-		current_timefx->descend (1.0 / N);
+		filters.push_back (fx);
+		regions.push_back (region);
+	}
+
+	int const ret = Filter::run_parallel (filters, regions, current_timefx);
 
-		if (fx->run (region, current_timefx)) {
-			current_timefx->status = -1;
-			current_timefx->request.done = true;
-			delete fx;
-			return;
+	if (current_timefx->request.cancel) {
+		/* we were cancelled. If that happened after every filter had
+		   finished, run_parallel() kept their results, so drop them here.
+		*/
+		if (!ret) {
+			for (vector<Filter*>::iterator f = filters.begin(); f != filters.end(); ++f) {
+				(*f)->drop_results ();
+			}
 		}
+		current_timefx->status = 1;
+	} else if (ret) {
+		current_timefx->status = -1;
+	} else {
+		for (size_t n = 0; n < filters.size(); ++n) {
+			if (filters[n]->results.empty()) {
+				continue;
+			}
 
-		if (!fx->results.empty()) {
-			new_region = fx->results.front();
+			boost::shared_ptr<Region> new_region = filters[n]->results.front();
 
-			playlist->replace_region (region, new_region, region->position());
+			playlist = regions[n]->playlist();
+			playlist->replace_region (regions[n], new_region, regions[n]->position());
 			playlists_affected.insert (playlist);
 		}
 
-		current_timefx->ascend ();
-		delete fx;
+		for (set<boost::shared_ptr<Playlist> >::iterator p = playlists_affected.begin(); p != playlists_affected.end(); ++p) {
+			_session->add_command (new StatefulDiffCommand (*p));
+		}
+
+		current_timefx->status = 0;
 	}
 
-	for (set<boost::shared_ptr<Playlist> >::iterator p = playlists_affected.begin(); p != playlists_affected.end(); ++p) {
-		_session->add_command (new StatefulDiffCommand (*p));
+	for (vector<Filter*>::iterator f = filters.begin(); f != filters.end(); ++f) {
+		delete *f;
 	}
 
-	current_timefx->status = 0;
 	current_timefx->request.done = true;
 }
 
@@ -344,7 +344,7 @@ MidiGhostRegion::add_note (NoteBase* n)
 
 	if (mv) {
 
-		if (!n->item()->visible()) {
+		if (!n->visible()) {
 			event->item->hide();
 		} else {
 			uint8_t const note_num = n->note()->note();
@@ -77,6 +77,12 @@ Hit::hide ()
 	_polygon->hide ();
 }
 
+bool
+Hit::visible () const
+{
+	return _polygon->visible ();
+}
+
 Points
 Hit::points(Distance height)
 {
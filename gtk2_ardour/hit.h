@@ -42,6 +42,7 @@ public:
 
 	void show ();
 	void hide ();
+	bool visible () const;
 
 	ArdourCanvas::Coord x0 () const;
 	ArdourCanvas::Coord y0 () const;
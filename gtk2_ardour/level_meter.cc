@@ -21,6 +21,7 @@
 
 #include "ardour/meter.h"
 #include "ardour/logmeter.h"
+#include "ardour/session.h"
 
 #include <gtkmm2ext/utils.h>
 #include "pbd/fastlog.h"
@@ -124,6 +125,32 @@ static float vu_standard() {
 	}
 }
 
+/** @return a copy of @param s's meter snapshot, shared by all meters in
+ *  the GUI and refreshed at most every few milliseconds, so that a mixer
+ *  full of meters takes one pass over the engine's data per redraw.
+ */
+static MeterSnapshot::Reader const *
+meter_snapshot (Session* s)
+{
+	static MeterSnapshot::Reader reader;
+
+	if (!s) {
+		return 0;
+	}
+
+	reader.update (s->meter_snapshot (), 5000);
+	return &reader;
+}
+
+static float
+meter_level (PeakMeter* meter, MeterSnapshot::Reader const * snapshot, uint32_t n, MeterType type)
+{
+	if (snapshot && meter->snapshot_slot () != MeterSnapshot::no_slot) {
+		return snapshot->level (meter->snapshot_slot (), n, type);
+	}
+	return meter->meter_level (n, type);
+}
+
 float
 LevelMeterBase::update_meters ()
 {
@@ -135,10 +162,11 @@ LevelMeterBase::update_meters ()
 	}
 
 	uint32_t nmidi = _meter->input_streams().n_midi();
+	MeterSnapshot::Reader const * snapshot = meter_snapshot (_session);
 
 	for (n = 0, i = meters.begin(); i != meters.end(); ++i, ++n) {
 		if ((*i).packed) {
-			const float mpeak = _meter->meter_level(n, MeterMaxPeak);
+			const float mpeak = meter_level (_meter, snapshot, n, MeterMaxPeak);
 			if (mpeak > (*i).max_peak) {
 				(*i).max_peak = mpeak;
 				(*i).meter->set_highlight(mpeak >= UIConfiguration::instance().get_meter_peak());
@@ -148,9 +176,9 @@ LevelMeterBase::update_meters ()
 			}
 
 			if (n < nmidi) {
-				(*i).meter->set (_meter->meter_level (n, MeterPeak));
+				(*i).meter->set (meter_level (_meter, snapshot, n, MeterPeak));
 			} else {
-				const float peak = _meter->meter_level (n, _meter_type);
+				const float peak = meter_level (_meter, snapshot, n, _meter_type);
 				if (_meter_type == MeterPeak) {
 					(*i).meter->set (log_meter (peak));
 				} else if (_meter_type == MeterPeak0dB) {
@@ -164,13 +192,13 @@ LevelMeterBase::update_meters ()
 				} else if (_meter_type == MeterVU) {
 					(*i).meter->set (meter_deflect_vu (peak + vu_standard() + meter_lineup(0)));
 				} else if (_meter_type == MeterK12) {
-					(*i).meter->set (meter_deflect_k (peak, 12), meter_deflect_k(_meter->meter_level(n, MeterPeak), 12));
+					(*i).meter->set (meter_deflect_k (peak, 12), meter_deflect_k(meter_level (_meter, snapshot, n, MeterPeak), 12));
 				} else if (_meter_type == MeterK14) {
-					(*i).meter->set (meter_deflect_k (peak, 14), meter_deflect_k(_meter->meter_level(n, MeterPeak), 14));
+					(*i).meter->set (meter_deflect_k (peak, 14), meter_deflect_k(meter_level (_meter, snapshot, n, MeterPeak), 14));
 				} else if (_meter_type == MeterK20) {
-					(*i).meter->set (meter_deflect_k (peak, 20), meter_deflect_k(_meter->meter_level(n, MeterPeak), 20));
+					(*i).meter->set (meter_deflect_k (peak, 20), meter_deflect_k(meter_level (_meter, snapshot, n, MeterPeak), 20));
 				} else { // RMS
-					(*i).meter->set (log_meter (peak), log_meter(_meter->meter_level(n, MeterPeak)));
+					(*i).meter->set (log_meter (peak), log_meter(meter_level (_meter, snapshot, n, MeterPeak)));
 				}
 			}
 		}
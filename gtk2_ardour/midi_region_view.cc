@@ -46,6 +46,7 @@
 #include "evoral/midi_util.h"
 
 #include "canvas/debug.h"
+#include "canvas/note_set.h"
 #include "canvas/text.h"
 
 #include "automation_region_view.h"
@@ -105,6 +106,7 @@ MidiRegionView::MidiRegionView (ArdourCanvas::Container*      parent,
 	, _region_relative_time_converter_double(r->session().tempo_map(), r->position())
 	, _active_notes(0)
 	, _note_group (new ArdourCanvas::Container (group))
+	, _note_set (new ArdourCanvas::NoteSet (_note_group))
 	, _note_diff_command (0)
 	, _ghost_note(0)
 	, _step_edit_cursor (0)
@@ -151,6 +153,7 @@ MidiRegionView::MidiRegionView (ArdourCanvas::Container*      parent,
 	, _region_relative_time_converter_double(r->session().tempo_map(), r->position())
 	, _active_notes(0)
 	, _note_group (new ArdourCanvas::Container (group))
+	, _note_set (new ArdourCanvas::NoteSet (_note_group))
 	, _note_diff_command (0)
 	, _ghost_note(0)
 	, _step_edit_cursor (0)
@@ -204,6 +207,7 @@ MidiRegionView::MidiRegionView (const MidiRegionView& other)
 	, _region_relative_time_converter_double(other.region_relative_time_converter_double())
 	, _active_notes(0)
 	, _note_group (new ArdourCanvas::Container (get_canvas_group()))
+	, _note_set (new ArdourCanvas::NoteSet (_note_group))
 	, _note_diff_command (0)
 	, _ghost_note(0)
 	, _step_edit_cursor (0)
@@ -235,6 +239,7 @@ MidiRegionView::MidiRegionView (const MidiRegionView& other, boost::shared_ptr<M
 	, _region_relative_time_converter_double(other.region_relative_time_converter_double())
 	, _active_notes(0)
 	, _note_group (new ArdourCanvas::Container (get_canvas_group()))
+	, _note_set (new ArdourCanvas::NoteSet (_note_group))
 	, _note_diff_command (0)
 	, _ghost_note(0)
 	, _step_edit_cursor (0)
@@ -262,6 +267,9 @@ MidiRegionView::init (bool wfd)
 {
 	PublicEditor::DropDownKeys.connect (sigc::mem_fun (*this, &MidiRegionView::drop_down_keys));
 
+	CANVAS_DEBUG_NAME (_note_set, string_compose ("note set for %1", get_item_name()));
+	_note_set->Event.connect (sigc::mem_fun (*this, &MidiRegionView::note_set_event));
+
 	if (wfd) {
 		Glib::Threads::Mutex::Lock lm(midi_region()->midi_source(0)->mutex());
 		midi_region()->midi_source(0)->load_model(lm);
@@ -977,7 +985,13 @@ MidiRegionView::clear_events ()
 	}
 
 
+	/* keep the note set, it is re-used for the next model */
+	_unrealize_connection.disconnect ();
+	_realized_notes.clear ();
+	_note_group->remove (_note_set);
 	_note_group->clear (true);
+	_note_set->clear ();
+	_note_group->add_front (_note_set);
 	_events.clear();
 	_patch_changes.clear();
 	_sys_exes.clear();
@@ -1199,6 +1213,7 @@ MidiRegionView::redisplay_model()
 
 	bool empty_when_starting = _events.empty();
 	_optimization_iterator = _events.begin();
+	_note_set->begin_batch ();
 	MidiModel::Notes missing_notes;
 	Note* sus = NULL;
 	Hit*  hit = NULL;
@@ -1246,7 +1261,7 @@ MidiRegionView::redisplay_model()
 				i = _events.erase (i);
 
 			} else {
-				bool visible = cne->item()->visible();
+				bool visible = cne->visible();
 
 				if ((sus = dynamic_cast<Note*>(cne))) {
 
@@ -1295,6 +1310,8 @@ MidiRegionView::redisplay_model()
 		}
 	}
 
+	_note_set->end_batch ();
+
 	display_sysexes();
 	display_patch_changes ();
 
@@ -1447,6 +1464,8 @@ MidiRegionView::~MidiRegionView ()
 	_entered_note = 0;
 	clear_events ();
 
+	_unrealize_connection.disconnect ();
+
 	delete _note_group;
 	delete _note_diff_command;
 	delete _step_edit_cursor;
@@ -1831,7 +1850,8 @@ MidiRegionView::add_note(const boost::shared_ptr<NoteType> note, bool visible)
 
 	if (midi_view()->note_mode() == Sustained) {
 
-		Note* ev_rect = new Note (*this, _note_group, note); // XXX may leak
+		/* drawn by the note set until it is selected or entered */
+		Note* ev_rect = new Note (*this, _note_set, note); // XXX may leak
 
 		update_sustained (ev_rect);
 
@@ -2145,6 +2165,8 @@ MidiRegionView::note_deleted (NoteBase* cne)
 		_entered_note = 0;
 	}
 
+	_realized_notes.erase (cne);
+
 	if (_selection.empty()) {
 		return;
 	}
@@ -2520,6 +2542,7 @@ MidiRegionView::remove_from_selection (NoteBase* ev)
 
 	ev->set_selected (false);
 	ev->hide_velocity ();
+	queue_unrealize_notes ();
 
 	if (_selection.empty()) {
 		PublicEditor& editor (trackview.editor());
@@ -2533,6 +2556,7 @@ MidiRegionView::add_to_selection (NoteBase* ev)
 	const bool selection_was_empty = _selection.empty();
 
 	if (_selection.insert (ev).second) {
+		realize_note (ev);
 		ev->set_selected (true);
 		start_playing_midi_note ((ev)->note());
 		if (selection_was_empty && _entered) {
@@ -3570,6 +3594,8 @@ MidiRegionView::note_left (NoteBase*)
 {
 	_entered_note = 0;
 
+	queue_unrealize_notes ();
+
 	for (Selection::iterator i = _selection.begin(); i != _selection.end(); ++i) {
 		(*i)->hide_velocity ();
 	}
@@ -3577,6 +3603,90 @@ MidiRegionView::note_left (NoteBase*)
 	hide_verbose_cursor ();
 }
 
+/** Events delivered to the note set mean the pointer is over a note
+ *  that does not have its own canvas item yet; give it one, and have the
+ *  canvas re-pick so that the note itself receives this and further events.
+ */
+bool
+MidiRegionView::note_set_event (GdkEvent* ev)
+{
+	double x;
+	double y;
+
+	switch (ev->type) {
+	case GDK_ENTER_NOTIFY:
+		x = ev->crossing.x;
+		y = ev->crossing.y;
+		break;
+	case GDK_MOTION_NOTIFY:
+		x = ev->motion.x;
+		y = ev->motion.y;
+		break;
+	default:
+		return false;
+	}
+
+	if (!trackview.editor().internal_editing()) {
+		return false;
+	}
+
+	ArdourCanvas::NoteSet::Handle h = _note_set->note_at (_note_set->canvas()->canvas_to_window (ArdourCanvas::Duple (x, y)));
+
+	if (h == ArdourCanvas::NoteSet::invalid_handle) {
+		return false;
+	}
+
+	NoteBase* note = static_cast<NoteBase*> (_note_set->data (h));
+
+	if (note) {
+		realize_note (note);
+		_note_set->canvas()->re_enter ();
+	}
+
+	return false;
+}
+
+void
+MidiRegionView::realize_note (NoteBase* note)
+{
+	if (!note->realized ()) {
+		note->realize ();
+		_realized_notes.insert (note);
+	}
+}
+
+void
+MidiRegionView::queue_unrealize_notes ()
+{
+	/* notes may be left/deselected from within their own event handler,
+	 * so their canvas items are only dropped once we are idle.
+	 */
+	if (!_realized_notes.empty() && !_unrealize_connection.connected()) {
+		_unrealize_connection = Glib::signal_idle().connect (sigc::mem_fun (*this, &MidiRegionView::unrealize_notes));
+	}
+}
+
+bool
+MidiRegionView::unrealize_notes ()
+{
+	if (_mouse_state != None || trackview.editor().drags()->active()) {
+		/* try again later */
+		return true;
+	}
+
+	for (std::set<NoteBase*>::iterator i = _realized_notes.begin(); i != _realized_notes.end(); ) {
+		NoteBase* note = *i;
+		if (note->selected() || note == _entered_note || note == _channel_selection_scoped_note) {
+			++i;
+			continue;
+		}
+		note->unrealize ();
+		_realized_notes.erase (i++);
+	}
+
+	return false;
+}
+
 void
 MidiRegionView::patch_entered (PatchChange* p)
 {
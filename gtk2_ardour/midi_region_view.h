@@ -41,6 +41,10 @@ namespace ARDOUR {
 	class Filter;
 };
 
+namespace ArdourCanvas {
+	class NoteSet;
+};
+
 namespace MIDI {
 	namespace Name {
 		struct PatchPrimaryKey;
@@ -200,6 +204,9 @@ public:
 	void   select_range(framepos_t start, framepos_t end);
 	void   invert_selection ();
 
+	/** Give @param note its own canvas item, until it is next unrealized */
+	void   realize_note (NoteBase* note);
+
 	Evoral::Beats earliest_in_selection ();
 	void move_selection(double dx, double dy, double cumulative_dy);
 	void note_dropped (NoteBase* ev, double d_qn, int8_t d_note, bool copy);
@@ -385,6 +392,16 @@ private:
 
 	bool canvas_group_event(GdkEvent* ev);
 	bool note_canvas_event(GdkEvent* ev);
+	bool note_set_event (GdkEvent* ev);
+
+	/** Notes which currently have their own canvas item rather than
+	 * being drawn by _note_set.
+	 */
+	std::set<NoteBase*> _realized_notes;
+	sigc::connection    _unrealize_connection;
+
+	void queue_unrealize_notes ();
+	bool unrealize_notes ();
 
 	void midi_channel_mode_changed ();
 	PBD::ScopedConnection _channel_mode_changed_connection;
@@ -431,6 +448,7 @@ private:
 	SysExes                              _sys_exes;
 	Note**                               _active_notes;
 	ArdourCanvas::Container*             _note_group;
+	ArdourCanvas::NoteSet*               _note_set;
 	ARDOUR::MidiModel::NoteDiffCommand*  _note_diff_command;
 	NoteBase*                            _ghost_note;
 	double                               _last_ghost_x;
@@ -270,7 +270,7 @@ MidiTimeAxisView::set_route (boost::shared_ptr<Route> rt)
 	_midi_controls_box.set_border_width (2);
 
 	MIDI::Name::MidiPatchManager::instance().PatchesChanged.connect (*this, invalidator (*this),
-			boost::bind (&MidiTimeAxisView::setup_midnam_patches, this),
+			boost::bind (&MidiTimeAxisView::patches_changed, this),
 			gui_context());
 
 	setup_midnam_patches ();
@@ -354,6 +354,23 @@ MidiTimeAxisView::check_step_edit ()
 	_step_editor->check_step_edit ();
 }
 
+void
+MidiTimeAxisView::patches_changed ()
+{
+	setup_midnam_patches ();
+
+	/* the model of this track may only just have been found by the
+	 * background scan of the .midnam files; keep its device mode.
+	 */
+	const std::string mode = gui_property (X_("midnam-custom-device-mode"));
+
+	model_changed (gui_property (X_("midnam-model-name")));
+
+	if (!mode.empty ()) {
+		custom_device_mode_changed (mode);
+	}
+}
+
 void
 MidiTimeAxisView::setup_midnam_patches ()
 {
@@ -361,18 +378,18 @@ MidiTimeAxisView::setup_midnam_patches ()
 	PatchManager& patch_manager = PatchManager::instance();
 
 	_midnam_model_selector.clear_items ();
-	for (PatchManager::DeviceNamesByMaker::const_iterator m = patch_manager.devices_by_manufacturer().begin();
-			m != patch_manager.devices_by_manufacturer().end(); ++m) {
+	const PatchManager::DeviceNamesByMaker devices = patch_manager.devices_by_manufacturer();
+	for (PatchManager::DeviceNamesByMaker::const_iterator m = devices.begin(); m != devices.end(); ++m) {
 		Menu*                   menu  = Gtk::manage(new Menu);
 		Menu_Helpers::MenuList& items = menu->items();
 
 		// Build manufacturer submenu
-		for (MIDI::Name::MIDINameDocument::MasterDeviceNamesList::const_iterator n = m->second.begin();
+		for (MIDI::Name::MasterDeviceNames::Models::const_iterator n = m->second.begin();
 				n != m->second.end(); ++n) {
 			Menu_Helpers::MenuElem elem = Gtk::Menu_Helpers::MenuElem(
-					n->first.c_str(),
+					n->c_str(),
 					sigc::bind(sigc::mem_fun(*this, &MidiTimeAxisView::model_changed),
-						n->first.c_str()));
+						n->c_str()));
 
 			items.push_back(elem);
 		}
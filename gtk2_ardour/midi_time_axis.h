@@ -120,6 +120,7 @@ private:
 	sigc::signal<void, std::string, std::string>  _midi_patch_settings_changed;
 
 	void setup_midnam_patches ();
+	void patches_changed ();
 	void update_patch_selector ();
 	void drop_instrument_ref ();
 	PBD::ScopedConnectionList midnam_connection;
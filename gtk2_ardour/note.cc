@@ -33,114 +33,247 @@ Note::Note (
 	MidiRegionView& region, Item* parent, const boost::shared_ptr<NoteType> note, bool with_events)
 	: NoteBase (region, with_events, note)
 	, _rectangle (new ArdourCanvas::Rectangle (parent))
+	, _set (0)
+	, _handle (NoteSet::invalid_handle)
+	, _fill_color (0)
+	, _outline_color (0)
+	, _outline_what (Rectangle::ALL)
+	, _visible (true)
+	, _ignore_events (false)
 {
 	CANVAS_DEBUG_NAME (_rectangle, "note");
 	set_item (_rectangle);
 }
 
+Note::Note (MidiRegionView& region, NoteSet* set, const boost::shared_ptr<NoteType> note)
+	: NoteBase (region, true, note)
+	, _rectangle (0)
+	, _set (set)
+	, _fill_color (0)
+	, _outline_color (0)
+	, _outline_what (Rectangle::ALL)
+	, _visible (true)
+	, _ignore_events (false)
+{
+	_handle = _set->add (Rect (), _fill_color, _outline_color, this);
+}
+
 Note::~Note ()
 {
 	delete _rectangle;
+
+	if (_set && _handle != NoteSet::invalid_handle) {
+		_set->remove (_handle);
+	}
+}
+
+/** Give this note its own canvas item (stacked above the note set) so
+ *  that it can receive events, be dragged, trimmed etc.
+ */
+void
+Note::realize ()
+{
+	if (_rectangle || !_set) {
+		return;
+	}
+
+	_rectangle = new ArdourCanvas::Rectangle (_set->parent(), _set->get (_handle));
+	CANVAS_DEBUG_NAME (_rectangle, "note");
+
+	_rectangle->set_fill_color (_fill_color);
+	_rectangle->set_outline_color (_outline_color);
+	_rectangle->set_outline_what (_outline_what);
+	_rectangle->set_ignore_events (_ignore_events);
+
+	if (!_visible) {
+		_rectangle->hide ();
+	}
+
+	_set->remove (_handle);
+	_handle = NoteSet::invalid_handle;
+
+	set_item (_rectangle);
+}
+
+/** Drop this note's canvas item and hand drawing back to the note set */
+void
+Note::unrealize ()
+{
+	if (!_rectangle || !_set) {
+		return;
+	}
+
+	_handle = _set->add (_rectangle->get(), _fill_color, _outline_color, this);
+	_set->set_outline_what (_handle, _outline_what);
+	_set->set_visible (_handle, _visible);
+
+	delete _rectangle;
+	_rectangle = 0;
+	_item = 0;
+}
+
+Rect
+Note::rect () const
+{
+	if (_rectangle) {
+		return _rectangle->get ();
+	}
+	return _set->get (_handle);
 }
 
 void
 Note::move_event (double dx, double dy)
 {
-	_rectangle->set (_rectangle->get().translate (Duple (dx, dy)));
+	set (rect().translate (Duple (dx, dy)));
 }
 
 Coord
 Note::x0 () const
 {
-	return _rectangle->x0 ();
+	return rect().x0;
 }
 
 Coord
 Note::x1 () const
 {
-	return _rectangle->x1 ();
+	return rect().x1;
 }
 
 Coord
 Note::y0 () const
 {
-	return _rectangle->y0 ();
+	return rect().y0;
 }
 
 Coord
 Note::y1 () const
 {
-	return _rectangle->y1 ();
+	return rect().y1;
 }
 
 void
 Note::set_outline_color (uint32_t color)
 {
-	_rectangle->set_outline_color (color);
+	_outline_color = color;
+
+	if (_rectangle) {
+		_rectangle->set_outline_color (color);
+	} else {
+		_set->set_outline_color (_handle, color);
+	}
 }
 
 void
 Note::set_fill_color (uint32_t color)
 {
-	_rectangle->set_fill_color (color);
+	_fill_color = color;
+
+	if (_rectangle) {
+		_rectangle->set_fill_color (color);
+	} else {
+		_set->set_fill_color (_handle, color);
+	}
 }
 
 void
 Note::show ()
 {
-	_rectangle->show ();
+	_visible = true;
+
+	if (_rectangle) {
+		_rectangle->show ();
+	} else {
+		_set->set_visible (_handle, true);
+	}
 }
 
 void
 Note::hide ()
 {
-	_rectangle->hide ();
+	_visible = false;
+
+	if (_rectangle) {
+		_rectangle->hide ();
+	} else {
+		_set->set_visible (_handle, false);
+	}
+}
+
+bool
+Note::visible () const
+{
+	if (_rectangle) {
+		return _rectangle->visible ();
+	}
+	return _visible && _set->visible ();
 }
 
 void
 Note::set (ArdourCanvas::Rect rect)
 {
-	_rectangle->set (rect);
+	if (_rectangle) {
+		_rectangle->set (rect);
+	} else {
+		_set->set (_handle, rect);
+	}
 }
 
 void
 Note::set_x0 (Coord x0)
 {
-	_rectangle->set_x0 (x0);
+	Rect r (rect ());
+	r.x0 = x0;
+	set (r);
 }
 
 void
 Note::set_y0 (Coord y0)
 {
-	_rectangle->set_y0 (y0);
+	Rect r (rect ());
+	r.y0 = y0;
+	set (r);
 }
 
 void
 Note::set_x1 (Coord x1)
 {
-	_rectangle->set_x1 (x1);
+	Rect r (rect ());
+	r.x1 = x1;
+	set (r);
 }
 
 void
 Note::set_y1 (Coord y1)
 {
-	_rectangle->set_y1 (y1);
+	Rect r (rect ());
+	r.y1 = y1;
+	set (r);
 }
 
 void
 Note::set_outline_what (ArdourCanvas::Rectangle::What what)
 {
-	_rectangle->set_outline_what (what);
+	_outline_what = what;
+
+	if (_rectangle) {
+		_rectangle->set_outline_what (what);
+	} else {
+		_set->set_outline_what (_handle, what);
+	}
 }
 
 void
 Note::set_outline_all ()
 {
-	_rectangle->set_outline_all ();
+	set_outline_what (Rectangle::ALL);
 }
 
 void
 Note::set_ignore_events (bool ignore)
 {
-	_rectangle->set_ignore_events (ignore);
+	_ignore_events = ignore;
+
+	if (_rectangle) {
+		_rectangle->set_ignore_events (ignore);
+	}
 }
@@ -22,6 +22,9 @@
 #define __gtk_ardour_note_h__
 
 #include <iostream>
+
+#include "canvas/note_set.h"
+
 #include "note_base.h"
 #include "midi_util.h"
 
@@ -39,8 +42,19 @@ public:
 	      const boost::shared_ptr<NoteType> note = boost::shared_ptr<NoteType>(),
 	      bool with_events = true);
 
+	/** Construct a note that is drawn by @param set rather than by its
+	 * own canvas item, until realize() is called.
+	 */
+	Note (MidiRegionView&                   region,
+	      ArdourCanvas::NoteSet*            set,
+	      const boost::shared_ptr<NoteType> note);
+
 	~Note ();
 
+	void realize ();
+	void unrealize ();
+	bool realized () const { return _rectangle != 0; }
+
 	ArdourCanvas::Coord x0 () const;
 	ArdourCanvas::Coord y0 () const;
 	ArdourCanvas::Coord x1 () const;
@@ -60,13 +74,25 @@ public:
 
 	void show ();
 	void hide ();
+	bool visible () const;
 
 	void set_ignore_events (bool);
 
 	void move_event (double dx, double dy);
 
 private:
-	ArdourCanvas::Rectangle* _rectangle;
+	ArdourCanvas::Rectangle*       _rectangle;
+	ArdourCanvas::NoteSet*         _set;
+	ArdourCanvas::NoteSet::Handle  _handle;
+
+	/* state that has to survive a realize()/unrealize() round trip */
+	uint32_t                        _fill_color;
+	uint32_t                        _outline_color;
+	ArdourCanvas::Rectangle::What   _outline_what;
+	bool                            _visible;
+	bool                            _ignore_events;
+
+	ArdourCanvas::Rect rect () const;
 };
 
 #endif /* __gtk_ardour_note_h__ */
@@ -114,6 +114,8 @@ NoteBase::validate ()
 void
 NoteBase::show_velocity()
 {
+	_region.realize_note (this);
+
 	if (!_text) {
 		_text = new Text (_item->parent ());
 		_text->set_ignore_events (true);
@@ -150,8 +152,10 @@ NoteBase::on_channel_selection_change(uint16_t selection)
 		set_selected(_selected);
 	}
 	// this forces the item to update..... maybe slow...
-	_item->hide();
-	_item->show();
+	if (_item) {
+		_item->hide();
+		_item->show();
+	}
 }
 
 void
@@ -63,6 +63,14 @@ class NoteBase : public sigc::trackable
 
 	virtual void show() = 0;
 	virtual void hide() = 0;
+	virtual bool visible() const = 0;
+
+	/** Notes may be drawn in bulk by their region view until they need
+	 * their own canvas item (e.g. to receive events or be edited).
+	 */
+	virtual void realize () {}
+	virtual void unrealize () {}
+	virtual bool realized () const { return true; }
 
 	bool valid() const { return _valid; }
 	void invalidate ();
@@ -3323,6 +3323,16 @@ RCOptionEditor::RCOptionEditor ()
 	Gtkmm2ext::UI::instance()->set_tip (bo->tip_widget(),
 					    _("<b>When enabled</b> plugins will be reset at transport stop. When disabled plugins will be left unchanged at transport stop.\n\nThis mostly affects plugins with a \"tail\" like Reverbs."));
 
+	bo = new BoolOption (
+		"skip-silent-plugins",
+		_("Do not run plugins whose input is silent"),
+		sigc::mem_fun (*_rc_config, &RCConfiguration::get_skip_silent_plugins),
+		sigc::mem_fun (*_rc_config, &RCConfiguration::set_skip_silent_plugins)
+		);
+	add_option (_("Plugins"), bo);
+	Gtkmm2ext::UI::instance()->set_tip (bo->tip_widget(),
+					    _("<b>When enabled</b> a plugin is not run once its input has been silent for longer than its tail (as reported by the plugin or set by the user). Plugins which do not report a tail, and plugins with MIDI input, are always run."));
+
 	bo = new BoolOption (
 		"new-plugins-active",
 			_("Make new plugins active"),
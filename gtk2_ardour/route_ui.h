@@ -235,6 +235,9 @@ class RouteUI : public virtual Selectable, public virtual ARDOUR::SessionHandleP
 	void toggle_denormal_protection();
 	virtual void denormal_protection_changed ();
 
+	Gtk::CheckMenuItem *pipeline_menu_item;
+	void toggle_pipelined ();
+
 	void disconnect_input ();
 	void disconnect_output ();
 
@@ -20,6 +20,8 @@
 
 #include <gtkmm/stock.h>
 
+#include "pbd/compose.h"
+
 #include "ardour/session.h"
 
 #include "session_archive_dialog.h"
@@ -187,12 +189,20 @@ SessionArchiveDialog::update_progress_gui (float p)
 	set_response_sensitive (RESPONSE_CANCEL, false);
 	progress_bar.show ();
 	if (p < 0) {
-		progress_bar.set_text (_("Archiving Session"));
+		progress_task = _("Archiving Session");
+		progress_bar.set_text (progress_task);
 		return;
 	}
 	if (p > 1.0) {
-		progress_bar.set_text (_("Encoding Audio"));
+		progress_task = _("Encoding Audio");
+		progress_bar.set_text (progress_task);
 		return;
 	}
 	progress_bar.set_fraction (p);
 }
+
+void
+SessionArchiveDialog::set_rate (double bytes_per_second)
+{
+	progress_bar.set_text (string_compose (_("%1 (%2 MB/s)"), progress_task, (int) (bytes_per_second / 1e6)));
+}
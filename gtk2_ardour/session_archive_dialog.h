@@ -53,9 +53,11 @@ private:
 	Gtk::CheckButton       only_used_checkbox;
 
 	Gtk::ProgressBar progress_bar;
+	std::string      progress_task;
 
 	void name_entry_changed ();
 	void update_progress_gui (float);
+	void set_rate (double);
 };
 
 #endif /* __ardour_gtk_tempo_dialog_h__ */
@@ -84,6 +84,8 @@ UI_CONFIG_VARIABLE (bool, no_new_session_dialog, "no-new-session-dialog", false)
 UI_CONFIG_VARIABLE (bool, buggy_gradients, "buggy-gradients", false)
 UI_CONFIG_VARIABLE (bool, cairo_image_surface, "cairo-image-surface", false)
 UI_CONFIG_VARIABLE (uint64_t, waveform_cache_size, "waveform-cache-size", 100) /* units of megagbytes */
+UI_CONFIG_VARIABLE (uint64_t, canvas_tile_cache_size, "canvas-tile-cache-size", 64) /* units of megabytes, 0 disables tiling */
+UI_CONFIG_VARIABLE (uint32_t, canvas_render_threads, "canvas-render-threads", 0)
 UI_CONFIG_VARIABLE (int32_t, recent_session_sort, "recent-session-sort", 0)
 UI_CONFIG_VARIABLE (bool, save_export_analysis_image, "save-export-analysis-image", false)
 UI_CONFIG_VARIABLE (std::string, xjadeo_binary, "xjadeo-binary", "")
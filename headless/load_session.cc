@@ -2,13 +2,23 @@
 #include <cstdlib>
 #include <getopt.h>
 
+#include <glibmm/timer.h>
+
+#include "pbd/compose.h"
 #include "pbd/failed_constructor.h"
 #include "pbd/error.h"
 #include "pbd/debug.h"
+#include "pbd/timing.h"
+#include "pbd/xml++.h"
 
 #include "ardour/ardour.h"
+#include "ardour/audio_backend.h"
+#include "ardour/audio_source_cache.h"
 #include "ardour/audioengine.h"
+#include "ardour/processor.h"
+#include "ardour/route.h"
 #include "ardour/session.h"
+#include "ardour/worker.h"
 
 #include "misc.h"
 
@@ -25,6 +35,37 @@ static const char* localedir = LOCALEDIR;
 
 TestReceiver test_receiver;
 
+string session_name = "";
+string backend_client_name = "ardour";
+string backend_session_uuid;
+bool just_version = false;
+bool use_vst = true;
+bool try_hw_optimization = true;
+bool no_connect_ports = false;
+bool benchmark = false;
+double roll_seconds = -1;
+string report_file;
+
+/** Select the Dummy backend's "Benchmark" driver, which runs process
+ * cycles back to back and generates the same input on every run.
+ */
+static bool
+use_benchmark_backend (AudioEngine* engine)
+{
+	vector<const AudioBackendInfo*> backends = engine->available_backends ();
+
+	for (vector<const AudioBackendInfo*>::const_iterator i = backends.begin(); i != backends.end(); ++i) {
+		if ((*i)->name.find ("Dummy") == string::npos) {
+			continue;
+		}
+		boost::shared_ptr<AudioBackend> b = engine->set_backend ((*i)->name, "", "");
+		if (b && b->name () == "Dummy") {
+			return b->set_driver ("Benchmark") == 0;
+		}
+	}
+	return false;
+}
+
 /** @param dir Session directory.
  *  @param state Session state file, without .ardour suffix.
  */
@@ -40,13 +81,23 @@ load_session (string dir, string state)
 
 	AudioEngine* engine = AudioEngine::create ();
 
-	if (!engine->set_default_backend ()) {
+	if (benchmark) {
+		if (!use_benchmark_backend (engine)) {
+			std::cerr << "Cannot use the Dummy backend for benchmarking\n";
+			::exit (1);
+		}
+	} else if (!engine->set_default_backend ()) {
 		std::cerr << "Cannot create Audio/MIDI engine\n";
 		::exit (1);
 	}
 
 	init_post_engine ();
 
+	/* benchmark cycles do not wait for the clock, so they must wait
+	 * for the disk instead, or sessions playing from disk underrun.
+	 */
+	engine->set_wait_for_butler (benchmark);
+
 	if (engine->start () != 0) {
 		std::cerr << "Cannot start Audio/MIDI engine\n";
 		::exit (1);
@@ -57,13 +108,143 @@ load_session (string dir, string state)
 	return session;
 }
 
-string session_name = "";
-string backend_client_name = "ardour";
-string backend_session_uuid;
-bool just_version = false;
-bool use_vst = true;
-bool try_hw_optimization = true;
-bool no_connect_ports = false;
+static XMLNode*
+timing_node (string const & name, PBD::TimingHistogram const & t)
+{
+	XMLNode* node = new XMLNode (name);
+
+	node->add_property ("count", string_compose ("%1", t.count ()));
+	node->add_property ("min", string_compose ("%1", t.minimum ()));
+	node->add_property ("max", string_compose ("%1", t.maximum ()));
+	node->add_property ("avg", string_compose ("%1", t.average ()));
+	node->add_property ("p50", string_compose ("%1", t.percentile (.5)));
+	node->add_property ("p99", string_compose ("%1", t.percentile (.99)));
+
+	for (int i = 0; i < PBD::TimingHistogram::n_bins; ++i) {
+		if (t.bin (i) == 0) {
+			continue;
+		}
+		XMLNode* bin = new XMLNode ("Bin");
+		bin->add_property ("from", string_compose ("%1", PBD::TimingHistogram::bin_start (i)));
+		bin->add_property ("count", string_compose ("%1", t.bin (i)));
+		node->add_child_nocopy (*bin);
+	}
+
+	return node;
+}
+
+/** Write the timing statistics collected while rolling: all times in nsecs */
+static bool
+write_report (Session* s, string const & path)
+{
+	AudioEngine* engine = AudioEngine::instance ();
+	XMLNode* root = new XMLNode ("DSPReport");
+
+	root->add_property ("session", s->name ());
+	root->add_property ("backend", engine->current_backend_name ());
+	root->add_property ("sample-rate", string_compose ("%1", engine->sample_rate ()));
+	root->add_property ("period-size", string_compose ("%1", engine->samples_per_cycle ()));
+	root->add_property ("period-usecs", string_compose ("%1", engine->usecs_per_cycle ()));
+	root->add_property ("process-threads", string_compose ("%1", engine->process_thread_count ()));
+
+	root->add_child_nocopy (*timing_node ("Cycles", engine->cycle_timing ()));
+
+	AudioSourceCache::Stats const cs (AudioSourceCache::instance ().stats ());
+	XMLNode* cache = root->add_child ("SourceCache");
+	cache->add_property ("hits", string_compose ("%1", cs.hits));
+	cache->add_property ("misses", string_compose ("%1", cs.misses));
+	cache->add_property ("evictions", string_compose ("%1", cs.evictions));
+	cache->add_property ("bytes", string_compose ("%1", cs.bytes));
+
+	Worker::PoolStats const ws (Worker::pool_stats ());
+	XMLNode* workers = root->add_child ("WorkerPool");
+	workers->add_property ("threads", string_compose ("%1", ws.threads));
+	workers->add_property ("workers", string_compose ("%1", ws.workers));
+	workers->add_property ("executed", string_compose ("%1", ws.executed));
+	workers->add_property ("max-pending-requests", string_compose ("%1", ws.max_pending_requests));
+
+	boost::shared_ptr<RouteList> rl = s->get_routes ();
+	for (RouteList::iterator i = rl->begin(); i != rl->end(); ++i) {
+		XMLNode* node = timing_node ("Route", (*i)->process_timing ());
+		node->add_property ("name", (*i)->name ());
+		node->add_property ("id", (*i)->id ().to_s ());
+		for (uint32_t n = 0; ; ++n) {
+			boost::shared_ptr<Processor> p = (*i)->nth_processor (n);
+			if (!p) {
+				break;
+			}
+			XMLNode* pnode = timing_node ("Processor", p->dsp_timing ());
+			pnode->add_property ("name", p->name ());
+			node->add_child_nocopy (*pnode);
+		}
+		root->add_child_nocopy (*node);
+	}
+
+	XMLTree tree;
+	tree.set_root (root);
+	return tree.write (path);
+}
+
+/** Roll for @param seconds of session time, optionally collecting DSP timing statistics.
+ *  @return false if the transport did not start, or stopped moving, for 10 seconds.
+ */
+static bool
+roll (Session* s, double seconds, bool profile)
+{
+	AudioEngine* engine = AudioEngine::instance ();
+
+	framepos_t const start = s->transport_frame ();
+	framepos_t const end = start + seconds * s->frame_rate ();
+	bool rolled = false;
+	bool ok = true;
+
+	gint64 const timeout = 10 * G_USEC_PER_SEC;
+	gint64 last_progress = g_get_monotonic_time ();
+	framepos_t last_frame = start;
+
+	engine->reset_cycle_timing ();
+	AudioSourceCache::instance ().reset_stats ();
+	boost::shared_ptr<RouteList> rl = s->get_routes ();
+	for (RouteList::iterator i = rl->begin(); i != rl->end(); ++i) {
+		(*i)->reset_dsp_timing ();
+	}
+	engine->set_profiling (profile);
+
+	s->request_transport_speed (1.0);
+
+	while (s->transport_frame () < end) {
+		/* the transport may stop at the session end */
+		if (s->transport_rolling ()) {
+			rolled = true;
+		} else if (rolled) {
+			break;
+		}
+
+		framepos_t const now = s->transport_frame ();
+		if (now != last_frame) {
+			last_frame = now;
+			last_progress = g_get_monotonic_time ();
+		} else if (g_get_monotonic_time () - last_progress > timeout) {
+			cerr << (rolled ? "Transport stopped moving" : "Transport did not start") << " within 10 seconds\n";
+			ok = false;
+			break;
+		}
+
+		Glib::usleep (10000);
+	}
+
+	s->request_transport_speed (0.0);
+	engine->set_profiling (false);
+
+	cout << "Rolled " << (s->transport_frame () - start) / (double) s->frame_rate () << " seconds\n";
+	cout << "Source cache: " << AudioSourceCache::instance ().summary ();
+	cout << "Worker pool: " << Worker::pool_report ();
+	if (profile) {
+		cout << "Cycles: " << engine->cycle_timing ().summary ();
+	}
+
+	return ok;
+}
 
 void
 print_help ()
@@ -78,6 +259,9 @@ print_help ()
 	     << "  -D, --debug <options>       Set debug flags. Use \"-D list\" to see available options\n"
 	     << "  -O, --no-hw-optimizations   Disable h/w specific optimizations\n"
 	     << "  -P, --no-connect-ports      Do not connect any ports at startup\n"
+	     << "  -b, --benchmark             Use the Dummy backend, processing as fast as possible\n"
+	     << "  -R, --roll <seconds>        Roll for the given time (session time), then exit\n"
+	     << "  -r, --report <file>         Write DSP timing statistics (XML) to file, needs --roll\n"
 #ifdef WINDOWS_VST_SUPPORT
 	     << "  -V, --novst                 Do not use VST support\n"
 #endif
@@ -86,7 +270,7 @@ print_help ()
 
 int main (int argc, char* argv[])
 {
-	const char *optstring = "vhBdD:c:VOU:P";
+	const char *optstring = "vhBdD:c:VOU:PbR:r:";
 
 	const struct option longopts[] = {
 		{ "version", 0, 0, 'v' },
@@ -99,6 +283,9 @@ int main (int argc, char* argv[])
 		{ "no-hw-optimizations", 0, 0, 'O' },
 		{ "uuid", 1, 0, 'U' },
 		{ "no-connect-ports", 0, 0, 'P' },
+		{ "benchmark", 0, 0, 'b' },
+		{ "roll", 1, 0, 'R' },
+		{ "report", 1, 0, 'r' },
 		{ 0, 0, 0, 0 }
 	};
 
@@ -161,6 +348,18 @@ int main (int argc, char* argv[])
 			backend_session_uuid = optarg;
                         break;
 
+		case 'b':
+			benchmark = true;
+			break;
+
+		case 'R':
+			roll_seconds = atof (optarg);
+			break;
+
+		case 'r':
+			report_file = optarg;
+			break;
+
 		default:
 			print_help ();
 			::exit (1);
@@ -172,6 +371,11 @@ int main (int argc, char* argv[])
 		::exit (1);
 	}
 
+	if (!report_file.empty () && roll_seconds < 0) {
+		cerr << "--report needs --roll\n";
+		::exit (1);
+	}
+
 	if (!ARDOUR::init (false, true, localedir)) {
 		cerr << "Ardour failed to initialize\n" << endl;
 		::exit (1);
@@ -195,9 +399,17 @@ int main (int argc, char* argv[])
 		exit (EXIT_FAILURE);
 	}
 
-	s->request_transport_speed (1.0);
+	int ret = 0;
 
-	sleep (-1);
+	if (roll_seconds < 0) {
+		s->request_transport_speed (1.0);
+		sleep (-1);
+	} else if (!roll (s, roll_seconds, !report_file.empty ())) {
+		ret = EXIT_FAILURE;
+	} else if (!report_file.empty () && !write_report (s, report_file)) {
+		cerr << "Cannot write report to " << report_file << "\n";
+		ret = EXIT_FAILURE;
+	}
 
 	AudioEngine::instance()->remove_session ();
 	delete s;
@@ -205,5 +417,5 @@ int main (int argc, char* argv[])
 
 	AudioEngine::destroy ();
 
-	return 0;
+	return ret;
 }
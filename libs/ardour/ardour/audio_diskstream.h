@@ -31,7 +31,7 @@
 #include <boost/utility.hpp>
 
 #include "pbd/fastlog.h"
-#include "pbd/ringbufferNPT.h"
+#include "pbd/spsc_ringbuffer.h"
 #include "pbd/stateful.h"
 #include "pbd/rcu.h"
 
@@ -187,17 +187,17 @@ class LIBARDOUR_API AudioDiskstream : public Diskstream
 		/** A ringbuffer for data to be played back, written to in the
 		    butler thread, read from in the process thread.
 		*/
-		PBD::RingBufferNPT<Sample> *playback_buf;
-		PBD::RingBufferNPT<Sample> *capture_buf;
+		PBD::SPSCRingBuffer<Sample> *playback_buf;
+		PBD::SPSCRingBuffer<Sample> *capture_buf;
 
 		Sample* scrub_buffer;
 		Sample* scrub_forward_buffer;
 		Sample* scrub_reverse_buffer;
 
-		PBD::RingBufferNPT<Sample>::rw_vector playback_vector;
-		PBD::RingBufferNPT<Sample>::rw_vector capture_vector;
+		PBD::SPSCRingBuffer<Sample>::rw_vector playback_vector;
+		PBD::SPSCRingBuffer<Sample>::rw_vector capture_vector;
 
-		PBD::RingBufferNPT<CaptureTransition> * capture_transition_buf;
+		PBD::SPSCRingBuffer<CaptureTransition> * capture_transition_buf;
 		// the following are used in the butler thread only
 		framecnt_t                     curr_capture_cnt;
 
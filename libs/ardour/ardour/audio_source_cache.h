@@ -0,0 +1,122 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_audio_source_cache_h__
+#define __ardour_audio_source_cache_h__
+
+#include <list>
+#include <map>
+#include <string>
+
+#include <glibmm/threads.h>
+
+#include "pbd/id.h"
+#include "pbd/signals.h"
+
+#include "ardour/libardour_visibility.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+class AudioSource;
+
+/** A cache of decoded audio, shared by all immutable audio sources.
+ *
+ * Audio is cached in blocks of block_frames, keyed by source and block
+ * index, so that regions (or playlists, through nested sources) which
+ * use the same part of the same source only read and decode it once.
+ * The least recently used blocks are evicted when the cache grows beyond
+ * the "audio-source-cache-megabytes" configuration variable; 0 disables it.
+ *
+ * The cache is used by AudioSource::read(), which may be called from any
+ * number of (butler) threads at once.
+ */
+class LIBARDOUR_API AudioSourceCache
+{
+public:
+	static AudioSourceCache& instance ();
+
+	static const framecnt_t block_frames = 16384;
+
+	struct Stats {
+		Stats () : hits (0), misses (0), evictions (0), blocks (0), bytes (0) {}
+		uint64_t hits;      ///< blocks found in the cache
+		uint64_t misses;    ///< blocks read from their source
+		uint64_t evictions; ///< blocks dropped to make room
+		uint32_t blocks;    ///< blocks currently cached
+		size_t   bytes;     ///< size of the blocks currently cached
+	};
+
+	/** Read @param cnt frames from @param start of @param src into @param dst,
+	 * through the cache.
+	 * @return the number of frames read
+	 */
+	framecnt_t read (AudioSource const & src, Sample* dst, framepos_t start, framecnt_t cnt);
+
+	/** Drop all cached blocks of the source with ID @param id */
+	void drop (PBD::ID const & id);
+
+	void clear ();
+
+	Stats stats () const;
+	void reset_stats ();
+
+	/** @return the statistics as one line of text */
+	std::string summary () const;
+
+private:
+	AudioSourceCache ();
+	~AudioSourceCache ();
+
+	static AudioSourceCache* _instance;
+
+	typedef std::pair<PBD::ID, framepos_t> Key;
+
+	struct Block {
+		Block (Key const & k, framecnt_t len) : key (k), length (len), data (new Sample[len]) {}
+		~Block () { delete [] data; }
+
+		Key        key;
+		framecnt_t length;
+		Sample*    data;
+		std::list<Block*>::iterator lru;
+	};
+
+	typedef std::map<Key, Block*> Blocks;
+
+	mutable Glib::Threads::Mutex _lock;
+	Blocks                       _blocks;
+	std::list<Block*>            _lru; ///< most recently used first
+	size_t                       _bytes;
+	uint64_t                     _generation; ///< bumped whenever blocks are dropped
+	Stats                        _stats;
+	PBD::ScopedConnection        _config_connection;
+
+	static size_t max_bytes ();
+
+	bool lookup (Key const &, Sample* dst, framecnt_t offset, framecnt_t cnt, uint64_t& generation);
+	void insert (Block*, uint64_t generation);
+	void trim (size_t bytes);
+	void erase (Blocks::iterator);
+	void parameter_changed (std::string const &);
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_audio_source_cache_h__ */
@@ -71,6 +71,7 @@ class LIBARDOUR_API AUPlugin : public ARDOUR::Plugin
 	uint32_t parameter_count () const;
 	float default_value (uint32_t port);
 	framecnt_t signal_latency() const;
+	framecnt_t plugin_tail () const;
 	void set_parameter (uint32_t which, float val);
 	float get_parameter (uint32_t which) const;
 
@@ -172,6 +173,7 @@ class LIBARDOUR_API AUPlugin : public ARDOUR::Plugin
 	std::vector<std::pair<int,int> > io_configs;
 	framecnt_t _last_nframes;
 	mutable volatile guint _current_latency;
+	volatile gint _tail;
 	bool _requires_fixed_size_buffers;
 	AudioBufferList* buffers;
 	bool _has_midi_input;
@@ -35,6 +35,7 @@
 
 #include "pbd/signals.h"
 #include "pbd/stacktrace.h"
+#include "pbd/timing.h"
 
 #include "ardour/ardour.h"
 #include "ardour/data_type.h"
@@ -140,6 +141,26 @@ class LIBARDOUR_API AudioEngine : public PortManager, public SessionHandlePtr
 
 	framecnt_t processed_frames() const { return _processed_frames; }
 
+	/** Collect DSP timing statistics: the time each process cycle takes,
+	 * and each route's share of it (see Route::process_timing()).
+	 */
+	void set_profiling (bool yn) { _profiling = yn; }
+	bool profiling () const { return _profiling; }
+
+	/** Time taken by each process cycle (collected while profiling).
+	 * Reset while the engine is not processing, or accept a cycle's
+	 * worth of inaccuracy.
+	 */
+	PBD::TimingHistogram const & cycle_timing () const { return _cycle_timing; }
+	void reset_cycle_timing () { _cycle_timing.reset (); }
+
+	/** Wait for the session's butler to finish its disk i/o before every
+	 * cycle (outside of the cycle's timing), as a freewheeling export
+	 * does. For benchmarks, which run cycles faster than realtime and
+	 * would otherwise underrun when playing from disk.
+	 */
+	void set_wait_for_butler (bool yn) { _wait_for_butler = yn; }
+
 	void set_session (Session *);
 	void remove_session (); // not a replacement for SessionHandle::session_going_away()
 	Session* session() const { return _session; }
@@ -269,6 +290,9 @@ class LIBARDOUR_API AudioEngine : public PortManager, public SessionHandlePtr
 	framecnt_t                 last_monitor_check;
 	/// the number of frames processed since start() was called
 	framecnt_t                _processed_frames;
+	bool                      _profiling;
+	bool                      _wait_for_butler;
+	PBD::TimingHistogram      _cycle_timing;
 	Glib::Threads::Thread*     m_meter_thread;
 	ProcessThread*            _main_thread;
 	MTDM*                     _mtdm;
@@ -104,6 +104,11 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	/** @return true if the each source sample s must be clamped to -1 < s < 1 */
 	virtual bool clamped_at_unity () const = 0;
 
+	/** @return true if the audio of this source can not change, so that
+	 * reads from it may be served by the AudioSourceCache.
+	 */
+	virtual bool cacheable () const { return false; }
+
 	static void allocate_working_buffers (framecnt_t framerate);
 
   protected:
@@ -148,6 +153,8 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 				     framecnt_t frames_per_peak);
 
   private:
+	friend class AudioSourceCache;
+
 	bool _peaks_built;
 	/** This mutex is used to protect both the _peaks_built
 	 *  variable and also the emission (and handling) of the
@@ -20,10 +20,13 @@
 #define __ardour_automation_watch_h__
 
 #include <set>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 #include <glibmm/threads.h>
 #include <sigc++/signal.h>
 
+#include "pbd/rcu.h"
+#include "pbd/ringbuffer.h"
 #include "pbd/signals.h"
 
 #include "ardour/session_handle.h"
@@ -43,21 +46,48 @@ class LIBARDOUR_API AutomationWatch : public sigc::trackable, public ARDOUR::Ses
     void set_session (ARDOUR::Session*);
 
     gint timer ();
+    void merge_captured ();
+
+    static void capture (ARDOUR::framepos_t when, bool rolling);
 
   private:
     typedef std::set<boost::shared_ptr<ARDOUR::AutomationControl> > AutomationWatches;
 
+    struct CapturedValue {
+        ARDOUR::framepos_t when;
+        double             value;
+    };
+
+    /** values of a watched control, captured by the process thread */
+    struct Capture {
+        Capture (boost::shared_ptr<ARDOUR::AutomationControl>);
+        void push (ARDOUR::framepos_t, double);
+
+        boost::shared_ptr<ARDOUR::AutomationControl> control;
+        RingBuffer<CapturedValue> values;
+        ARDOUR::framepos_t last_when;   ///< time of the last captured value (process thread)
+        double             last_value;  ///< the last captured value (process thread)
+        ARDOUR::framepos_t last_cycle;  ///< time of the last cycle, or -1 (process thread)
+        ARDOUR::framepos_t merged_when; ///< time of the last value added to the list, or -1
+    };
+
+    typedef std::vector<boost::shared_ptr<Capture> > Captures;
+
     AutomationWatch ();
     ~AutomationWatch();
 
     static AutomationWatch* _instance;
     Glib::Threads::Thread*  _thread;
-    framepos_t              _last_time;
     bool                    _run_thread;
     AutomationWatches        automation_watches;
     Glib::Threads::Mutex     automation_watch_lock;
     PBD::ScopedConnection    transport_connection;
+    SerializedRCUManager<Captures> _captures;
+    ARDOUR::framecnt_t       _capture_interval;
+    bool                     _capture_rolling;
 
+    void capture_values (ARDOUR::framepos_t when, bool rolling);
+    void merge_captured (Capture&);
     void transport_state_change ();
     void remove_weak_automation_watch (boost::weak_ptr<ARDOUR::AutomationControl>);
     void thread ();
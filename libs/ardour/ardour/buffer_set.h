@@ -88,6 +88,7 @@ public:
 	ChanCount&       count()       { return _count; }
 
 	void silence (framecnt_t nframes, framecnt_t offset);
+	bool silent (framecnt_t nframes) const;
 	bool is_mirror() const { return _is_mirror; }
 
 	void set_count(const ChanCount& count) { assert(count <= _available); _count = count; }
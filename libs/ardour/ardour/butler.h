@@ -26,7 +26,6 @@
 
 #include "pbd/crossthread.h"
 #include "pbd/ringbuffer.h"
-#include "pbd/pool.h"
 #include "ardour/libardour_visibility.h"
 #include "ardour/types.h"
 #include "ardour/session_handle.h"
@@ -35,13 +34,6 @@
 
 namespace ARDOUR {
 
-/**
- *  One of the Butler's functions is to clean up (ie delete) unused CrossThreadPools.
- *  When a thread with a CrossThreadPool terminates, its CTP is added to pool_trash.
- *  When the Butler thread wakes up, we check this trash buffer for CTPs, and if they
- *  are empty they are deleted.
- */
-
 class LIBARDOUR_API Butler : public SessionHandleRef
 {
   public:
@@ -55,7 +47,6 @@ class LIBARDOUR_API Butler : public SessionHandleRef
 	void stop();
 	void wait_until_finished();
 	bool transport_work_requested() const;
-	void drop_references ();
 
         void map_parameters ();
 
@@ -85,10 +76,8 @@ class LIBARDOUR_API Butler : public SessionHandleRef
 	framecnt_t   audio_dstream_capture_buffer_size;
 	framecnt_t   audio_dstream_playback_buffer_size;
 	uint32_t     midi_dstream_buffer_size;
-	RingBuffer<CrossThreadPool*> pool_trash;
 
 private:
-	void empty_pool_trash ();
 	void config_changed (std::string);
 
 	bool flush_tracks_to_disk_normal (boost::shared_ptr<RouteList>, uint32_t& errors);
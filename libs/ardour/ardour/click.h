@@ -22,7 +22,7 @@
 
 #include <list>
 
-#include "pbd/pool.h"
+#include "pbd/arena.h"
 #include "ardour/libardour_visibility.h"
 #include "ardour/types.h"
 #include "ardour/io.h"
@@ -38,16 +38,21 @@ public:
 
 	Click (framepos_t s, framecnt_t d, const Sample *b) : start (s), duration (d), offset (0), data (b) {}
 
-	void *operator new (size_t) {
-		return pool.alloc ();
+	void *operator new (size_t sz) {
+		return arena.alloc (sz);
     };
 
 	void operator delete(void *ptr, size_t /*size*/) {
-		pool.release (ptr);
+		PBD::Arena::release (ptr);
+	}
+
+	/** Make sure that the calling (process) thread can create @param n clicks without allocating */
+	static void reserve (uint32_t n) {
+		arena.reserve (sizeof (Click), n);
 	}
 
 private:
-	static Pool pool;
+	static PBD::Arena arena;
 };
 
 class LIBARDOUR_API ClickIO : public IO
@@ -23,7 +23,7 @@
 #include <algorithm>
 #include <iostream>
 
-#include "pbd/ringbufferNPT.h"
+#include "pbd/spsc_ringbuffer.h"
 
 #include "evoral/EventSink.hpp"
 #include "evoral/types.hpp"
@@ -35,18 +35,18 @@ namespace ARDOUR {
  * This packs a timestamp, size, and size bytes of data flat into the buffer.
  * Useful for MIDI events, OSC messages, etc.
  *
- * Note: the uint8_t template argument to RingBufferNPT<> indicates "byte
+ * Note: the uint8_t template argument to SPSCRingBuffer<> indicates "byte
  * oriented data", not anything particular linked to MIDI or any other
  * possible interpretation of uint8_t.
  */
 template<typename Time>
-class EventRingBuffer : public PBD::RingBufferNPT<uint8_t>
+class EventRingBuffer : public PBD::SPSCRingBuffer<uint8_t>
                       , public Evoral::EventSink<Time> {
 public:
 
 	/** @param capacity Ringbuffer capacity in bytes.
 	 */
-	EventRingBuffer(size_t capacity) : PBD::RingBufferNPT<uint8_t>(capacity)
+	EventRingBuffer(size_t capacity) : PBD::SPSCRingBuffer<uint8_t>(capacity)
 	{}
 
 	inline size_t capacity() const { return bufsize(); }
@@ -63,17 +63,19 @@ public:
 
 	inline uint32_t write(Time  time, Evoral::EventType  type, uint32_t  size, const uint8_t* buf);
 	inline bool     read (Time* time, Evoral::EventType* type, uint32_t* size,       uint8_t* buf);
+
+private:
+	/** Copy @param n bytes to offset @param off of the reserved spans @param vec */
+	static inline void put (PBD::SPSCRingBuffer<uint8_t>::rw_vector const & vec, size_t& off, const uint8_t* src, size_t n);
 };
 
 template<typename Time>
 inline bool
 EventRingBuffer<Time>::peek (uint8_t* buf, size_t size)
 {
-	PBD::RingBufferNPT<uint8_t>::rw_vector vec;
-
-	get_read_vector (&vec);
+	PBD::SPSCRingBuffer<uint8_t>::rw_vector vec;
 
-	if (vec.len[0] + vec.len[1] < size) {
+	if (reserve_read (&vec, size) < size) {
 		return false;
 	}
 
@@ -94,19 +96,19 @@ template<typename Time>
 inline bool
 EventRingBuffer<Time>::read(Time* time, Evoral::EventType* type, uint32_t* size, uint8_t* buf)
 {
-	if (PBD::RingBufferNPT<uint8_t>::read ((uint8_t*)time, sizeof (Time)) != sizeof (Time)) {
+	if (PBD::SPSCRingBuffer<uint8_t>::read ((uint8_t*)time, sizeof (Time)) != sizeof (Time)) {
 		return false;
 	}
 
-	if (PBD::RingBufferNPT<uint8_t>::read ((uint8_t*)type, sizeof(Evoral::EventType)) != sizeof (Evoral::EventType)) {
+	if (PBD::SPSCRingBuffer<uint8_t>::read ((uint8_t*)type, sizeof(Evoral::EventType)) != sizeof (Evoral::EventType)) {
 		return false;
 	}
 
-	if (PBD::RingBufferNPT<uint8_t>::read ((uint8_t*)size, sizeof(uint32_t)) != sizeof (uint32_t)) {
+	if (PBD::SPSCRingBuffer<uint8_t>::read ((uint8_t*)size, sizeof(uint32_t)) != sizeof (uint32_t)) {
 		return false;
 	}
 
-	if (PBD::RingBufferNPT<uint8_t>::read (buf, *size) != *size) {
+	if (PBD::SPSCRingBuffer<uint8_t>::read (buf, *size) != *size) {
 		return false;
 	}
 
@@ -117,14 +119,40 @@ template<typename Time>
 inline uint32_t
 EventRingBuffer<Time>::write(Time time, Evoral::EventType type, uint32_t size, const uint8_t* buf)
 {
-	if (!buf || write_space() < (sizeof(Time) + sizeof(Evoral::EventType) + sizeof(uint32_t) + size)) {
+	const size_t total = sizeof(Time) + sizeof(Evoral::EventType) + sizeof(uint32_t) + size;
+	PBD::SPSCRingBuffer<uint8_t>::rw_vector vec;
+
+	if (!buf || reserve_write (&vec, total) < total) {
 		return 0;
-	} else {
-		PBD::RingBufferNPT<uint8_t>::write ((uint8_t*)&time, sizeof(Time));
-		PBD::RingBufferNPT<uint8_t>::write ((uint8_t*)&type, sizeof(Evoral::EventType));
-		PBD::RingBufferNPT<uint8_t>::write ((uint8_t*)&size, sizeof(uint32_t));
-		PBD::RingBufferNPT<uint8_t>::write (buf, size);
-		return size;
+	}
+
+	/* fill in the whole event and publish it at once, so that the
+	 * reader never sees a prefix without its contents.
+	 */
+	size_t off = 0;
+	put (vec, off, (const uint8_t*)&time, sizeof(Time));
+	put (vec, off, (const uint8_t*)&type, sizeof(Evoral::EventType));
+	put (vec, off, (const uint8_t*)&size, sizeof(uint32_t));
+	put (vec, off, buf, size);
+
+	commit_write (total);
+	return size;
+}
+
+template<typename Time>
+inline void
+EventRingBuffer<Time>::put (PBD::SPSCRingBuffer<uint8_t>::rw_vector const & vec, size_t& off, const uint8_t* src, size_t n)
+{
+	if (off < vec.len[0]) {
+		const size_t n0 = std::min (n, vec.len[0] - off);
+		memcpy (vec.buf[0] + off, src, n0);
+		src += n0;
+		off += n0;
+		n -= n0;
+	}
+	if (n) {
+		memcpy (vec.buf[1] + (off - vec.len[0]), src, n);
+		off += n;
 	}
 }
 
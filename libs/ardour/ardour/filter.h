@@ -40,13 +40,42 @@ class LIBARDOUR_API Filter {
 	virtual int run (boost::shared_ptr<ARDOUR::Region>, Progress* progress = 0) = 0;
 	std::vector<boost::shared_ptr<ARDOUR::Region> > results;
 
+	/** Run each of @param filters on the region at the same index of
+	 *  @param regions. The processing of filters which support it is
+	 *  spread over a pool of one thread per core; everything else,
+	 *  including all use of @param progress, happens in the calling thread.
+	 *  @return 0 if all filters succeeded. Otherwise the results of all
+	 *  filters are dropped, and their new sources removed.
+	 */
+	static int run_parallel (std::vector<Filter*> const & filters, std::vector<boost::shared_ptr<ARDOUR::Region> > const & regions, Progress* progress = 0);
+
   protected:
 	Filter (ARDOUR::Session& s) : session(s) {}
 
 	int make_new_sources (boost::shared_ptr<ARDOUR::Region>, ARDOUR::SourceList&, std::string suffix = "", bool use_session_sample_rate = true);
 	int finish (boost::shared_ptr<ARDOUR::Region>, ARDOUR::SourceList&, std::string region_name = "");
 
+	/* A filter which returns true from parallel() splits run() into the
+	 * steps below. prepare() and complete() are called from the thread
+	 * calling run_parallel(); process() is called once for each of the
+	 * n_jobs() jobs, possibly concurrently and on other threads, so it
+	 * must not change session state.
+	 */
+	virtual bool parallel () const { return false; }
+	virtual int prepare (boost::shared_ptr<ARDOUR::Region>) { return -1; }
+	virtual uint32_t n_jobs () const { return 1; }
+	virtual int process (uint32_t /*job*/, Progress*) { return -1; }
+	/** @param ok true if all jobs succeeded */
+	virtual int complete (bool /*ok*/) { return -1; }
+
 	ARDOUR::Session& session;
+
+  private:
+	struct Job;
+	static void run_job (Job*);
+	static int run_jobs (std::vector<Filter*> const &, std::vector<boost::shared_ptr<ARDOUR::Region> > const &, std::vector<size_t> const & parallel, Progress*);
+
+	void drop_results ();
 };
 
 } /* namespace */
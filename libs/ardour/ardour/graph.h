@@ -59,6 +59,8 @@ public:
 
 	void prep();
 	void trigger (GraphNode * n);
+	void trigger_and_wake (GraphNode * n);
+	bool cancel_trigger (GraphNode * n);
 	void rechain (boost::shared_ptr<RouteList>, GraphEdges const &);
 
 	void dump (int chain);
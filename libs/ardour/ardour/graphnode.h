@@ -46,18 +46,19 @@ class LIBARDOUR_API GraphNode
 
 	void prep( int chain );
 	void dec_ref();
-	void finish( int chain );
+	virtual void finish( int chain );
 
 	virtual void process();
 
+    protected:
+	boost::shared_ptr<Graph> _graph;
+
     private:
 	friend class Graph;
 
 	/** Nodes that we directly feed */
 	node_set_t  _activation_set[2];
 
-	boost::shared_ptr<Graph> _graph;
-
 	gint _refcount;
 	/** The number of nodes that we directly feed us (one count for each chain) */
 	gint _init_refcount[2];
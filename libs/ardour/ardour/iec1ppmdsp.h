@@ -31,6 +31,8 @@ public:
 
     void process (float const *p, int n);
     float read (void);
+    /** like read(), but without starting a new period */
+    float peek (void) const { return _g * _m; }
     void reset ();
 
     static void init (float fsamp);
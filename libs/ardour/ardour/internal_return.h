@@ -28,6 +28,7 @@
 namespace ARDOUR {
 
 class InternalSend;
+class MidiBuffer;
 
 class LIBARDOUR_API InternalReturn : public Return
 {
@@ -49,6 +50,10 @@ class LIBARDOUR_API InternalReturn : public Return
 	std::list<InternalSend*> _sends;
 	/** mutex to protect _sends */
 	Glib::Threads::Mutex _sends_mutex;
+	/** buffers of the sends that are active in this cycle */
+	std::vector<BufferSet const *> _send_buffers;
+	/** MIDI buffers to be merged into one of ours */
+	std::vector<MidiBuffer const *> _midi_sources;
 };
 
 } // namespace ARDOUR
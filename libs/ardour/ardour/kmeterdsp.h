@@ -31,6 +31,8 @@ public:
 
     void process (float const *p, int n);
     float read ();
+    /** like read(), but without starting a new period */
+    float peek () const { return _rms; }
     void reset ();
 
     static void init (int fsamp);
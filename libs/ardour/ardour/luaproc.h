@@ -20,21 +20,27 @@
 /* print runtime and garbage-collection timing statistics */
 //#define WITH_LUAPROC_STATS
 
-/* memory allocation system, default: ReallocPool */
-//#define USE_TLSF // use TLSF instead of ReallocPool
-//#define USE_MALLOC // or plain OS provided realloc (no mlock) -- if USE_TLSF isn't defined
+/* memory allocation system, default: SizeClassPool */
+//#define USE_TLSF // use TLSF instead of SizeClassPool
+//#define USE_REALLOCPOOL // or ReallocPool -- if USE_TLSF isn't defined
+//#define USE_MALLOC // or plain OS provided realloc (no mlock) -- if neither of the above is defined
 
 #ifndef __ardour_luaproc_h__
 #define __ardour_luaproc_h__
 
+#include <map>
 #include <set>
 #include <vector>
 #include <string>
 
+#include <glibmm/threads.h>
+
 #ifdef USE_TLSF
 #  include "pbd/tlsf.h"
-#else
+#elif defined USE_REALLOCPOOL
 #  include "pbd/reallocpool.h"
+#else
+#  include "pbd/sizeclasspool.h"
 #endif
 
 #include "pbd/stateful.h"
@@ -143,11 +149,17 @@ protected:
 private:
 #ifdef USE_TLSF
 	PBD::TLSF _mempool;
-#else
+#elif defined USE_REALLOCPOOL
 	PBD::ReallocPool _mempool;
+#else
+	PBD::SizeClassPool _mempool;
 #endif
 	LuaState lua;
 	luabridge::LuaRef * _lua_dsp;
+	luabridge::LuaRef * _lua_in_map;
+	luabridge::LuaRef * _lua_out_map;
+	std::vector<float*> _in_ptrs;
+	std::vector<float*> _out_ptrs;
 	std::string _script;
 	std::string _origin;
 	std::string _docs;
@@ -163,6 +175,20 @@ private:
 
 	void init ();
 	bool load_script ();
+	int  run_script ();
+	void reset_buffer_maps ();
+
+	/* compiled scripts, shared by all instances */
+	struct Bytecode {
+		Bytecode () : used (0) {}
+		std::string code;
+		uint64_t    used; ///< when it was last used, for eviction
+	};
+	typedef std::map<std::string, Bytecode> BytecodeCache;
+	static const size_t bytecode_cache_size = 64; ///< scripts
+	static Glib::Threads::Mutex _bytecode_lock;
+	static BytecodeCache _bytecode_cache;
+	static uint64_t _bytecode_clock;
 	void lua_print (std::string s);
 
 	std::string preset_name_to_uri (const std::string&) const;
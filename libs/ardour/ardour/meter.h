@@ -22,13 +22,11 @@
 #include <vector>
 #include "ardour/libardour_visibility.h"
 #include "ardour/types.h"
+#include "ardour/meter_snapshot.h"
 #include "ardour/processor.h"
 #include "pbd/fastlog.h"
 
-#include "ardour/kmeterdsp.h"
-#include "ardour/iec1ppmdsp.h"
-#include "ardour/iec2ppmdsp.h"
-#include "ardour/vumeterdsp.h"
+#include "ardour/multimeterdsp.h"
 
 namespace ARDOUR {
 
@@ -74,6 +72,11 @@ public:
 
 	float meter_level (uint32_t n, MeterType type);
 
+	/** @return where this meter publishes its values in the session's
+	 *  MeterSnapshot, or MeterSnapshot::no_slot.
+	 */
+	MeterSnapshot::Slot snapshot_slot () const { return _snapshot_slot; }
+
 	void set_type(MeterType t);
 	MeterType get_type() { return _meter_type; }
 
@@ -99,12 +102,15 @@ private:
 	std::vector<float> _max_peak_signal; // dB calculation is done on demand
 	float _combined_peak; // Mackie surfaces expect the highest peak of all track channels
 
-	std::vector<Kmeterdsp *> _kmeter;
-	std::vector<Iec1ppmdsp *> _iec1meter;
-	std::vector<Iec2ppmdsp *> _iec2meter;
-	std::vector<Vumeterdsp *> _vumeter;
+	MultiMeterDSP _meters; // K, IEC and VU meters of all audio channels
+	std::vector<float const *> _audio_data; // input buffers, 0 if silent
 
 	MeterType _meter_type;
+
+	MeterSnapshot::Slot _snapshot_slot;
+	uint32_t            _snapshot_size;
+
+	void write_snapshot (uint32_t n_midi, uint32_t n);
 };
 
 } // namespace ARDOUR
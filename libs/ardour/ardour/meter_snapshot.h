@@ -0,0 +1,185 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+    for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef __ardour_meter_snapshot_h__
+#define __ardour_meter_snapshot_h__
+
+#include <set>
+#include <vector>
+
+#include <glib.h>
+#include <glibmm/threads.h>
+
+#include "ardour/libardour_visibility.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+/** The values of all of a session's PeakMeters, published together by
+ *  the process thread once per cycle.
+ *
+ *  Meters write into one of a small ring of contiguous buffers as they
+ *  run; at the end of the cycle the session publishes that buffer. Any
+ *  number of non-realtime threads (the GUI, control surfaces, OSC) can
+ *  copy the most recent buffer in one pass using a Reader, without
+ *  taking any locks that the process thread would also need.
+ *
+ *  Storage is allocated once, so that meters can be added or resized
+ *  without disturbing the process thread.
+ *
+ *  K, IEC and VU meters hold their maximum until read. Each Reader is a
+ *  separate consumer, and a new period only starts once every Reader
+ *  has seen the previous one, so that a slow reader does not miss peaks
+ *  because a faster one consumed them.
+ */
+class LIBARDOUR_API MeterSnapshot
+{
+public:
+	typedef int32_t Slot;
+	static const Slot no_slot = -1;
+
+	/** Values for one channel of a meter */
+	struct Channel {
+		/** as PeakMeter::meter_level (n, MeterPeak) */
+		float peak;
+		/** coefficient; max peak since the last PeakMeter::reset_max() */
+		float max_peak;
+		/** coefficient for the meter's own (K, IEC or VU) type, if it has one */
+		float level;
+	};
+
+	/** Values for a whole meter */
+	struct Meter {
+		MeterType type;
+		uint32_t  n_midi;
+		uint32_t  n_channels;
+		/** coefficient; the highest peak of all channels (MeterMCP) */
+		float     combined_peak;
+	};
+
+	MeterSnapshot (uint32_t max_meters = 4096, uint32_t max_channels = 16384);
+	~MeterSnapshot ();
+
+	/** Allocate space for a meter with @param n_channels channels.
+	 *  @return slot, or no_slot if there is no room.
+	 */
+	Slot allocate (uint32_t n_channels);
+	void release (Slot);
+
+	/* process thread(s) */
+
+	/** @return where a meter should write its values for this cycle,
+	 *  or 0. @param channels is set to the meter's channels.
+	 */
+	Meter* write (Slot, Channel*& channels);
+
+	/** Called once per cycle, after all meters have run */
+	void publish ();
+
+	/** true if there are readers and every one of them has taken a copy
+	 *  since the previous period started, so that meters which hold their
+	 *  maximum until read should start a new one.
+	 */
+	bool reset_levels () const { return _reset_levels; }
+
+	/** A copy of a snapshot, owned by one thread. A Reader becomes one of
+	 *  the snapshot's consumers when it is first updated from it.
+	 */
+	class LIBARDOUR_API Reader
+	{
+	public:
+		Reader ();
+		~Reader ();
+
+		/** Copy the latest snapshot from @param s, unless the copy we
+		 *  have is less than @param max_age microseconds old.
+		 *  @return true if the copy was updated.
+		 */
+		bool update (MeterSnapshot const & s, int64_t max_age = 0);
+
+		/** @return a value as PeakMeter::meter_level() would */
+		float level (Slot, uint32_t n, MeterType) const;
+
+		Meter const * meter (Slot) const;
+		Channel const * channels (Slot) const;
+
+	private:
+		friend class MeterSnapshot;
+
+		Reader (Reader const &);
+		Reader& operator= (Reader const &);
+
+		void attach (MeterSnapshot const &);
+		void detach ();
+
+		std::vector<Meter>    _meters;
+		std::vector<uint32_t> _offsets;
+		std::vector<Channel>  _channels;
+		gint                  _sequence;
+		int64_t               _when;
+		MeterSnapshot const * _snapshot;
+		/** our bit in the snapshot's consumer masks, or 0 */
+		gint                  _consumer;
+	};
+
+private:
+	friend class Reader;
+
+	static const uint32_t n_buffers = 4;
+
+	struct SlotInfo {
+		uint32_t offset;
+		uint32_t size;
+		bool     used;
+	};
+
+	uint32_t _max_meters;
+	uint32_t _max_channels;
+
+	Meter*   _meters[n_buffers];
+	Channel* _channels[n_buffers];
+
+	/* layout, changed only with _layout_lock held */
+	Glib::Threads::Mutex _layout_lock;
+	SlotInfo* _slots;
+	gint      _n_slots;
+	gint      _n_channels;
+
+	/** cycle in which each slot was last written */
+	uint32_t* _written;
+
+	/** number of buffers published so far; buffer (n % n_buffers) is the latest */
+	mutable gint _sequence;
+	/** owned by the process thread */
+	uint32_t _cycle;
+	/** one bit per attached Reader */
+	mutable gint _consumers;
+	/** the Readers which have taken a copy in the current period */
+	mutable gint _consumed;
+	bool _reset_levels;
+
+	/** attached Readers, protected by reader_lock */
+	mutable std::set<Reader*> _readers;
+	static Glib::Threads::Mutex reader_lock;
+
+	uint32_t write_buffer () const { return (_cycle + 1) % n_buffers; }
+};
+
+} // namespace ARDOUR
+
+#endif // __ardour_meter_snapshot_h__
@@ -20,6 +20,8 @@
 #ifndef __ardour_midi_buffer_h__
 #define __ardour_midi_buffer_h__
 
+#include <vector>
+
 #include "evoral/EventSink.hpp"
 #include "evoral/midi_util.h"
 #include "evoral/types.hpp"
@@ -59,6 +61,7 @@ public:
 
 	bool insert_event(const Evoral::Event<TimeType>& event);
 	bool merge_in_place(const MidiBuffer &other);
+	bool merge_from (std::vector<MidiBuffer const *> const & sources);
 
 	/** EventSink interface for non-RT use (export, bounce). */
 	uint32_t write(TimeType time, Evoral::EventType type, uint32_t size, const uint8_t* buf);
@@ -21,6 +21,10 @@
 #ifndef MIDI_PATCH_MANAGER_H_
 #define MIDI_PATCH_MANAGER_H_
 
+#include <set>
+
+#include <glibmm/threads.h>
+
 #include "midi++/midnam_patch.h"
 
 #include "pbd/signals.h"
@@ -45,10 +49,10 @@ private:
 	static MidiPatchManager* _manager;
 
 public:
-	typedef std::map<std::string, boost::shared_ptr<MIDINameDocument> >    MidiNameDocuments;
-	typedef std::map<std::string, MIDINameDocument::MasterDeviceNamesList> DeviceNamesByMaker;
+	typedef std::map<std::string, boost::shared_ptr<MIDINameDocument> > MidiNameDocuments;
+	typedef std::map<std::string, MasterDeviceNames::Models>            DeviceNamesByMaker;
 
-	virtual ~MidiPatchManager() { _manager = 0; }
+	virtual ~MidiPatchManager();
 
 	static MidiPatchManager& instance() {
 		if (_manager == 0) {
@@ -67,10 +71,19 @@ public:
 
 	void remove_search_path (const PBD::Searchpath& search_path);
 
-	boost::shared_ptr<MIDINameDocument> document_by_model(std::string model_name) const;
+	/** Wait until the background scan of the search path has finished */
+	void wait_for_scan ();
+
+	/** @return the document describing @param model_name. Documents are
+	 * parsed when one of their models is first asked for.
+	 *
+	 * This does not wait for the background scan: a model which has not
+	 * been found yet has no document, and PatchesChanged is emitted
+	 * once it has been.
+	 */
+	boost::shared_ptr<MIDINameDocument> document_by_model(std::string model_name);
 
-	boost::shared_ptr<MasterDeviceNames> master_device_by_model(std::string model_name)
-		{ return _master_devices_by_model[model_name]; }
+	boost::shared_ptr<MasterDeviceNames> master_device_by_model(std::string model_name);
 
 	boost::shared_ptr<ChannelNameSet> find_channel_name_set(
 			std::string model,
@@ -130,34 +143,68 @@ public:
 		}
 	}
 
-	std::list<std::string> custom_device_mode_names_by_model(std::string model_name) {
-		if (model_name != "") {
-			if (master_device_by_model(model_name)) {
-				return master_device_by_model(model_name)->custom_device_mode_names();
-			}
-		}
-		return std::list<std::string>();
-	}
+	/** @return the custom device modes of @param model_name (without parsing its document) */
+	MasterDeviceNames::CustomDeviceModeNames custom_device_mode_names_by_model(std::string model_name);
 
-	const MasterDeviceNames::Models& all_models() const { return _all_models; }
-
-	const DeviceNamesByMaker& devices_by_manufacturer() const { return _devices_by_manufacturer; }
+	/* these return copies, the scanner thread may add to the index at any time */
+	MasterDeviceNames::Models all_models();
+	DeviceNamesByMaker devices_by_manufacturer();
 
 private:
-	bool load_midi_name_document(const std::string& file_path);
+	/** What the index knows about a model, enough to list it in the GUI */
+	struct ModelInfo {
+		std::string                              file_path;
+		std::string                              manufacturer;
+		MasterDeviceNames::CustomDeviceModeNames custom_device_modes;
+	};
+
+	typedef std::map<std::string, ModelInfo> ModelIndex;
+
+	/** An entry of the on-disk index: the models of one .midnam file */
+	struct FileInfo {
+		FileInfo () : mtime (0), size (0) {}
+		int64_t    mtime;
+		int64_t    size;
+		ModelIndex models;
+	};
+
+	typedef std::map<std::string, FileInfo> FileIndex;
+
+	static std::string index_path ();
+	void load_index ();
+	void save_index ();
+	static bool scan_midi_name_file (const std::string& file_path, FileInfo&);
+
+	void scan_thread ();
+	void scan_directory (const std::string& directory_path);
+
+	boost::shared_ptr<MIDINameDocument> load_midi_name_document (const std::string& file_path);
+	bool add_model (const std::string& model, const ModelInfo&);
 	bool add_midi_name_document(boost::shared_ptr<MIDINameDocument>);
 	bool remove_midi_name_document(const std::string& file_path, bool emit_signal = true);
 
-	void add_midnam_files_from_directory(const std::string& directory_path);
 	void remove_midnam_files_from_directory(const std::string& directory_path);
 
 private:
 	PBD::Searchpath                         _search_path;
 
+	/* protects everything below */
+	Glib::Threads::Mutex                    _lock;
+
+	ModelIndex                              _models;
 	MidiNameDocuments                       _documents;
-	MIDINameDocument::MasterDeviceNamesList _master_devices_by_model;
 	DeviceNamesByMaker                      _devices_by_manufacturer;
-	MasterDeviceNames::Models               _all_models;
+	std::set<std::string>                   _unparsable_files;
+
+	/* background scanning */
+	std::list<std::string>                  _scan_queue;
+	Glib::Threads::Thread*                  _scanner;
+	bool                                    _scanning;
+	Glib::Threads::Cond                     _scan_cond;
+
+	FileIndex                               _file_index;
+	bool                                    _file_index_loaded;
+	bool                                    _file_index_dirty;
 };
 
 } // namespace Name
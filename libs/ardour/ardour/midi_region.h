@@ -107,6 +107,8 @@ class LIBARDOUR_API MidiRegion : public Region
 
 	boost::shared_ptr<MidiModel> model();
 	boost::shared_ptr<const MidiModel> model() const;
+	/** @return the model, loading it first if nothing has needed it yet */
+	boost::shared_ptr<MidiModel> loaded_model();
 
 	void fix_negative_start ();
 	double start_beats () const {return _start_beats; }
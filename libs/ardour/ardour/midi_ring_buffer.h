@@ -70,15 +70,15 @@ template<typename T>
 inline bool
 MidiRingBuffer<T>::read_prefix(T* time, Evoral::EventType* type, uint32_t* size)
 {
-	if (PBD::RingBufferNPT<uint8_t>::read((uint8_t*)time, sizeof(T)) != sizeof (T)) {
+	if (PBD::SPSCRingBuffer<uint8_t>::read((uint8_t*)time, sizeof(T)) != sizeof (T)) {
 		return false;
 	}
 
-	if (PBD::RingBufferNPT<uint8_t>::read((uint8_t*)type, sizeof(Evoral::EventType)) != sizeof (Evoral::EventType)) {
+	if (PBD::SPSCRingBuffer<uint8_t>::read((uint8_t*)type, sizeof(Evoral::EventType)) != sizeof (Evoral::EventType)) {
 		return false;
 	}
 
-	if (PBD::RingBufferNPT<uint8_t>::read((uint8_t*)size, sizeof(uint32_t)) != sizeof (uint32_t)) {
+	if (PBD::SPSCRingBuffer<uint8_t>::read((uint8_t*)size, sizeof(uint32_t)) != sizeof (uint32_t)) {
 		return false;
 	}
 
@@ -93,7 +93,7 @@ template<typename T>
 inline bool
 MidiRingBuffer<T>::read_contents(uint32_t size, uint8_t* buf)
 {
-	return PBD::RingBufferNPT<uint8_t>::read(buf, size) == size;
+	return PBD::SPSCRingBuffer<uint8_t>::read(buf, size) == size;
 }
 
 } // namespace ARDOUR
@@ -185,6 +185,8 @@ class LIBARDOUR_API MidiSource : virtual public Source, public boost::enable_sha
 	void set_note_mode(const Glib::Threads::Mutex::Lock& lock, NoteMode mode);
 
 	boost::shared_ptr<MidiModel> model() { return _model; }
+	/** @return the model, loading it first if nothing has needed it yet */
+	boost::shared_ptr<MidiModel> loaded_model();
 	void set_model(const Glib::Threads::Mutex::Lock& lock, boost::shared_ptr<MidiModel>);
 	void drop_model(const Glib::Threads::Mutex::Lock& lock);
 
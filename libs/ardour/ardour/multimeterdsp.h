@@ -0,0 +1,120 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_multimeterdsp_h__
+#define __ardour_multimeterdsp_h__
+
+#include <stdint.h>
+
+#include "ardour/libardour_visibility.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+/** Peak, K, IEC I/II PPM and VU ballistics for many channels at once.
+ *
+ * This computes the same values as compute_peak(), Kmeterdsp, Iec1ppmdsp,
+ * Iec2ppmdsp and Vumeterdsp, but keeps the filter state of all channels in
+ * arrays and runs the filters for groups of `lanes' channels side by side,
+ * which the compiler turns into SIMD instructions. Each input buffer is
+ * read only once per cycle, whichever meter types are enabled: samples are
+ * interleaved into a small block, which the enabled filters then work on.
+ *
+ * As with the single channel meters, a channel's level is the maximum
+ * since it was last read().
+ */
+class LIBARDOUR_API MultiMeterDSP
+{
+public:
+	/** channels processed side by side */
+	static const uint32_t lanes = 4;
+
+	MultiMeterDSP ();
+	~MultiMeterDSP ();
+
+	static void init (float fsamp);
+
+	/** Allocate state for @param n channels; not realtime safe. */
+	void set_channels (uint32_t n);
+	uint32_t n_channels () const { return _n_channels; }
+
+	/** Run the meters of type @param types (a combination of MeterType)
+	 * on the first @param nframes samples of @param data, which has
+	 * n_channels() entries. A null entry is a silent channel.
+	 *
+	 * The peak absolute value of each channel is max()ed into
+	 * @param peak, which has n_channels() entries.
+	 */
+	void process (float const * const * data, uint32_t nframes, uint32_t types, float* peak);
+
+	/** @return the level (a coefficient) of channel @param c for the
+	 * K, IEC or VU meter in @param types, and start a new period for it.
+	 */
+	float read (uint32_t c, uint32_t types);
+	/** like read(), but without starting a new period */
+	float peek (uint32_t c, uint32_t types) const;
+
+	/** Reset all channels for meter types @param types */
+	void reset (uint32_t types);
+
+private:
+	enum Kind {
+		K = 0,
+		IEC1,
+		IEC2,
+		VU,
+		n_kinds
+	};
+
+	struct State {
+		float* z1;
+		float* z2;
+		float* m;    // max value since last read ()
+		bool*  res;  // set by read (), resets m
+	};
+
+	static Kind kind (uint32_t types);
+	static uint32_t mask (Kind);
+
+	void process_k (uint32_t g, uint32_t n_blocks);
+	void process_iec (Kind, uint32_t g, uint32_t n_blocks);
+	void process_vu (uint32_t g, uint32_t n_blocks);
+
+	void allocate (uint32_t n);
+	void release ();
+
+	uint32_t _n_channels;
+	uint32_t _n_padded;
+	State    _state[n_kinds];
+
+	/** interleaved samples of one group of channels */
+	float*   _block;
+
+	static float _k_omega;
+	static float _iec_w1[2];
+	static float _iec_w2[2];
+	static float _iec_w3[2];
+	static float _iec_g[2];
+	static float _vu_w;
+	static float _vu_g;
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_multimeterdsp_h__ */
@@ -241,6 +241,11 @@ class LIBARDOUR_API Plugin : public PBD::StatefulDestructible, public Latent
 	/** the max possible latency a plugin will have */
 	virtual framecnt_t max_latency () const { return 0; } // TODO = 0, require implementation
 
+	/** @return the number of samples the plugin keeps producing output after
+	 * its input has become silent (e.g. a reverb's decay), or -1 if unknown.
+	 */
+	virtual framecnt_t plugin_tail () const { return -1; }
+
 	/** Emitted when a preset is added or removed, respectively */
 	PBD::Signal0<void> PresetAdded;
 	PBD::Signal0<void> PresetRemoved;
@@ -433,6 +438,7 @@ class LIBARDOUR_API PluginInfo {
 
   protected:
 	friend class PluginManager;
+	friend class PluginInfoCache;
 	uint32_t index;
 };
 
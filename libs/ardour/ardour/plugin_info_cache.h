@@ -0,0 +1,109 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_plugin_info_cache_h__
+#define __ardour_plugin_info_cache_h__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ardour/libardour_visibility.h"
+#include "ardour/chan_count.h"
+#include "ardour/plugin.h"
+
+namespace ARDOUR {
+
+/** A persistent cache of what plugin discovery found.
+ *
+ * Entries are keyed by what discovery looks at (a LADSPA module, an LV2
+ * plugin URI) and carry a stamp made from the modification time and size
+ * of the files involved. An entry is only used while its stamp matches,
+ * so only new or changed plugins need to be looked at again.
+ *
+ * The cache lives in the user cache directory. It is discarded as a whole
+ * if it was written by a different version of this class.
+ */
+class LIBARDOUR_API PluginInfoCache
+{
+public:
+	/** What discovery found out about one plugin */
+	struct Info {
+		Info () : index (0) {}
+		Info (PluginInfo const &);
+
+		void apply (PluginInfo&) const;
+
+		std::string name;
+		std::string category;
+		std::string creator;
+		std::string path;
+		std::string unique_id;
+		uint32_t    index;
+		ChanCount   n_inputs;
+		ChanCount   n_outputs;
+	};
+
+	typedef std::vector<Info> InfoList;
+
+	PluginInfoCache (std::string const & name);
+
+	/** @return the plugins cached for @param key, or 0 if there is no entry
+	 * for it or its stamp differs from @param stamp. An empty list means
+	 * that discovery found nothing usable.
+	 */
+	InfoList const * lookup (std::string const & key, std::string const & stamp);
+
+	void add (std::string const & key, std::string const & stamp, InfoList const &);
+
+	/** Write the cache if anything changed. Entries which were neither
+	 * looked up nor added since it was loaded are dropped.
+	 */
+	void save ();
+
+	size_t hits () const { return _hits; }
+	size_t misses () const { return _misses; }
+
+	/** @return a stamp for @param files, which changes when any of them is modified */
+	static std::string stamp (std::vector<std::string> const & files);
+
+private:
+	static const int version;
+
+	struct Entry {
+		Entry () : used (false) {}
+		std::string stamp;
+		InfoList    plugins;
+		bool        used;
+	};
+
+	typedef std::map<std::string, Entry> Entries;
+
+	void load ();
+
+	std::string _path;
+	Entries     _entries;
+	bool        _dirty;
+	size_t      _hits;
+	size_t      _misses;
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_plugin_info_cache_h__ */
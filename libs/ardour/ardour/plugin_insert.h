@@ -247,6 +247,21 @@ class LIBARDOUR_API PluginInsert : public Processor
 
 	framecnt_t signal_latency () const;
 
+	/** @return the plugin's tail: the user-set value if any, otherwise what
+	 * the plugin reports; -1 if unknown.
+	 */
+	framecnt_t tail () const;
+	double user_tail () const { return _user_tail; }
+	/** @param seconds tail length, or -1 to use the plugin's own; kept in
+	 *  seconds so that it stays right when the sample rate changes.
+	 */
+	void set_user_tail (double seconds);
+
+	/** @return true if the plugin was not run in the last cycle, because its
+	 * input had been silent for longer than its tail.
+	 */
+	bool skipped () const { return _skipped; }
+
 	boost::shared_ptr<Plugin> get_impulse_analysis_plugin();
 
 	void collect_signal_for_analysis (framecnt_t nframes);
@@ -375,6 +390,12 @@ class LIBARDOUR_API PluginInsert : public Processor
 	bool _latency_changed;
 	uint32_t _bypass_port;
 
+	double     _user_tail;
+	framecnt_t _silent_frames;
+	bool       _skipped;
+
+	bool past_tail (BufferSet const &, pframes_t nframes);
+
 	void preset_load_set_value (uint32_t, float);
 };
 
@@ -37,6 +37,7 @@
 namespace ARDOUR {
 
 class Plugin;
+class PluginInfoCache;
 
 class LIBARDOUR_API PluginManager : public boost::noncopyable {
   public:
@@ -152,7 +153,7 @@ class LIBARDOUR_API PluginManager : public boost::noncopyable {
 	int lxvst_discover_from_path (std::string path, bool cache_only = false);
 	int lxvst_discover (std::string path, bool cache_only = false);
 
-	int ladspa_discover (std::string path);
+	int ladspa_discover (std::string path, PluginInfoCache&);
 
 	std::string get_ladspa_category (uint32_t id);
 	std::vector<uint32_t> ladspa_plugin_whitelist;
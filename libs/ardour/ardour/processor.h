@@ -25,6 +25,7 @@
 #include <exception>
 
 #include "pbd/statefuldestructible.h"
+#include "pbd/timing.h"
 
 #include "ardour/ardour.h"
 #include "ardour/buffer_set.h"
@@ -130,6 +131,13 @@ class LIBARDOUR_API Processor : public SessionObject, public Automatable, public
 	virtual void set_owner (SessionObject*);
 	SessionObject* owner() const;
 
+	/** Time taken by ::run() in each cycle, in nsecs, collected while
+	 *  AudioEngine::profiling() is enabled. Only the thread processing
+	 *  the owning route adds to it.
+	 */
+	PBD::TimingHistogram const & dsp_timing () const { return _dsp_timing; }
+	PBD::TimingHistogram& dsp_timing () { return _dsp_timing; }
+
 protected:
 	virtual int set_state_2X (const XMLNode&, int version);
 
@@ -145,6 +153,7 @@ protected:
 	ProcessorWindowProxy *_window_proxy;
 	PluginPinWindowProxy *_pinmgr_proxy;
 	SessionObject* _owner;
+	PBD::TimingHistogram _dsp_timing;
 };
 
 } // namespace ARDOUR
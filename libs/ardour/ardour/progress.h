@@ -39,6 +39,11 @@ public:
 
 	bool cancelled () const;
 
+	/** Report how fast the work is going, in bytes per second;
+	 *  ignored unless overridden.
+	 */
+	virtual void set_rate (double) {}
+
 protected:
 	void cancel ();
 
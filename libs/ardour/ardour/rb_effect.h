@@ -34,8 +34,25 @@ class LIBARDOUR_API RBEffect : public Filter {
 
 	int run (boost::shared_ptr<ARDOUR::Region>, Progress* progress = 0);
 
+  protected:
+	/* RubberBand already processes the channels of a region on a thread
+	 * each, so a region is a single job.
+	 */
+	bool parallel () const { return true; }
+	int prepare (boost::shared_ptr<ARDOUR::Region>);
+	int process (uint32_t, Progress*);
+	int complete (bool);
+
   private:
 	TimeFXRequest& tsr;
+
+	boost::shared_ptr<AudioRegion> _region;
+	SourceList  _nsrcs;
+	double      _stretch;
+	double      _shift;
+	framecnt_t  _read_start;
+	framecnt_t  _read_duration;
+	std::string _suffix;
 };
 
 } /* namespace */
@@ -37,6 +37,7 @@
 #include "pbd/stateful.h"
 #include "pbd/controllable.h"
 #include "pbd/destructible.h"
+#include "pbd/timing.h"
 
 #include "ardour/ardour.h"
 #include "ardour/gain_control.h"
@@ -70,6 +71,7 @@ class IOProcessor;
 class Panner;
 class PannerShell;
 class PortSet;
+class RoutePipeline;
 class Processor;
 class PluginInsert;
 class RouteGroup;
@@ -173,6 +175,33 @@ public:
 	void set_denormal_protection (bool yn);
 	bool denormal_protection() const;
 
+	/** Split the leading plugins off into a stage which runs on another
+	 *  process thread, one cycle ahead of the rest of the route. This
+	 *  adds one cycle of latency (which is compensated for).
+	 */
+	void set_pipelined (bool yn);
+	bool pipelined () const { return _pipelined; }
+
+	/** @return the number of cycles in which the route ran plugins */
+	uint64_t processed_cycles () const { return _processed_cycles; }
+	/** @return the number of cycles in which all of the route's plugins
+	 *  were skipped, because their input had been silent for longer than
+	 *  their tail (see PluginInsert::skipped())
+	 */
+	uint64_t skipped_cycles () const { return _skipped_cycles; }
+	/** Reset processed_cycles() and skipped_cycles(); the process thread
+	 *  does this before it next counts a cycle.
+	 */
+	void reset_cycle_stats () { g_atomic_int_set (&_reset_cycle_stats, 1); }
+
+	/** Time taken to process this route in each cycle, collected while
+	 *  AudioEngine::profiling() is enabled.
+	 */
+	PBD::TimingHistogram const & process_timing () const { return _process_timing; }
+	PBD::TimingHistogram& process_timing () { return _process_timing; }
+	/** Reset the process_timing() of the route and the dsp_timing() of all of its processors */
+	void reset_dsp_timing ();
+
 	void         set_meter_point (MeterPoint, bool force = false);
 	bool         apply_processor_changes_rt ();
 	void         emit_pending_signals ();
@@ -333,6 +362,7 @@ public:
 
 	PBD::Signal0<void>       active_changed;
 	PBD::Signal0<void>       denormal_protection_changed;
+	PBD::Signal0<void>       pipelined_changed;
 	PBD::Signal0<void>       comment_changed;
 
 	/** track numbers - assigned by session
@@ -638,6 +668,15 @@ public:
 
 	bool           _denormal_protection;
 
+	bool                             _pipelined;
+	boost::shared_ptr<RoutePipeline> _pipeline;
+
+	uint64_t _processed_cycles;
+	uint64_t _skipped_cycles;
+	mutable volatile gint _reset_cycle_stats;
+
+	PBD::TimingHistogram _process_timing;
+
 	bool _recordable : 1;
 	bool _silent : 1;
 	bool _declickable : 1;
@@ -695,6 +734,9 @@ protected:
 	void output_change_handler (IOChange, void *src);
 	void sidechain_change_handler (IOChange, void *src);
 
+	bool pipeline_stage (ProcessorList::const_iterator& begin, ProcessorList::const_iterator& end) const;
+	void configure_pipeline ();
+
 	void processor_selfdestruct (boost::weak_ptr<Processor>);
 	std::vector<boost::weak_ptr<Processor> > selfdestruct_sequence;
 	Glib::Threads::Mutex  selfdestruct_lock;
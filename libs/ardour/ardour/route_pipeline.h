@@ -0,0 +1,115 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_route_pipeline_h__
+#define __ardour_route_pipeline_h__
+
+#include <list>
+
+#include <boost/shared_ptr.hpp>
+
+#include "pbd/semutils.h"
+
+#include "ardour/libardour_visibility.h"
+#include "ardour/buffer_set.h"
+#include "ardour/graphnode.h"
+#include "ardour/types.h"
+
+namespace ARDOUR
+{
+
+class Graph;
+class Processor;
+
+/** The front stage of a pipelined route.
+ *
+ *  A run of plugins at the start of a route's processing chain is split
+ *  off and processes the current cycle on another process-graph thread,
+ *  while the route itself runs the rest of its processors on what the
+ *  front stage produced in the previous cycle. The stages are separated
+ *  by a delay line of one engine cycle, which is reported as part of the
+ *  route's signal latency.
+ *
+ *  The stage is not part of the graph's chain: it is queued with
+ *  Graph::trigger_and_wake() and does not take part in ref-counting.
+ *  If no thread picks it up by the time the route is done with its own
+ *  part, the route takes it back and runs it inline.
+ */
+class LIBARDOUR_API RoutePipeline : public GraphNode
+{
+public:
+	typedef std::list<boost::shared_ptr<Processor> > ProcessorList;
+
+	RoutePipeline (boost::shared_ptr<Graph>);
+
+	/** Allocate buffers for up to @param chn streams and a delay of
+	 *  @param delay samples (the engine's cycle size). Caller must hold
+	 *  the process lock.
+	 */
+	void configure (ChanCount const & chn, framecnt_t delay);
+	framecnt_t delay () const { return _delay; }
+
+	/** Start the front stage (process thread).
+	 *
+	 * The processors [@param begin, @param end) are run on a copy of
+	 * @param bufs, which is then replaced by the front stage output
+	 * from one cycle ago. @param latency is the signal latency at
+	 * @param begin, @param initial_delay and @param signal_latency those
+	 * of the route.
+	 */
+	void start (BufferSet& bufs, ProcessorList::const_iterator begin, ProcessorList::const_iterator end,
+	            framepos_t start_frame, framepos_t end_frame, double speed, pframes_t nframes,
+	            framecnt_t latency, framecnt_t initial_delay, framecnt_t signal_latency);
+
+	/** Wait for the front stage started by ::start() (process thread) */
+	void join ();
+
+	/** Silence the delay line, e.g. after a locate */
+	void flush () { _flush = true; }
+
+	void process ();
+	void finish (int chain);
+
+private:
+	void run_front ();
+
+	BufferSet _bufs;
+	BufferSet _delayed;
+
+	framecnt_t _delay;
+	framecnt_t _pos;
+	bool       _flush;
+
+	PBD::Semaphore _done;
+
+	/* parameters of the current cycle, set by ::start() */
+	ProcessorList::const_iterator _begin;
+	ProcessorList::const_iterator _end;
+	framepos_t _start_frame;
+	framepos_t _end_frame;
+	double     _speed;
+	pframes_t  _nframes;
+	framecnt_t _latency;
+	framecnt_t _initial_delay;
+	framecnt_t _signal_latency;
+};
+
+}
+
+#endif /* __ardour_route_pipeline_h__ */
@@ -63,11 +63,13 @@
 #include "ardour/interthread_info.h"
 #include "ardour/luascripting.h"
 #include "ardour/location.h"
+#include "ardour/meter_snapshot.h"
 #include "ardour/monitor_processor.h"
 #include "ardour/presentation_info.h"
 #include "ardour/rc_configuration.h"
 #include "ardour/session_configuration.h"
 #include "ardour/session_event.h"
+#include "ardour/source_usage_index.h"
 #include "ardour/interpolation.h"
 #include "ardour/plugin.h"
 #include "ardour/presentation_info.h"
@@ -271,6 +273,9 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 	BufferSet& get_route_buffers (ChanCount count = ChanCount::ZERO, bool silence = true);
 	BufferSet& get_mix_buffers (ChanCount count = ChanCount::ZERO);
 
+	/** @return the levels of all meters, as of the last process cycle */
+	MeterSnapshot& meter_snapshot () { return _meter_snapshot; }
+
 	bool have_rec_enabled_track () const;
     bool have_rec_disabled_track () const;
 
@@ -763,6 +768,11 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 	int  cleanup_sources (CleanupReport&);
 	int  cleanup_trash_sources (CleanupReport&);
 
+	/** Find how each saved snapshot of the session uses the source at
+	 * @param path, as recorded by the source usage index.
+	 */
+	int  snapshots_using_source (std::string const & path, SourceUsageIndex::SnapshotUses&);
+
 	int destroy_sources (std::list<boost::shared_ptr<Source> >);
 
 	int remove_last_capture ();
@@ -1726,6 +1736,9 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 
 	boost::shared_ptr<Graph> _process_graph;
 
+	/* must outlive the routes, whose meters use it */
+	MeterSnapshot _meter_snapshot;
+
 	SerializedRCUManager<RouteList>  routes;
 
 	void add_routes (RouteList&, bool input_auto_connect, bool output_auto_connect, bool save, PresentationInfo::order_t);
@@ -1949,7 +1962,10 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 
 	void auto_connect_master_bus ();
 
-	int find_all_sources (std::string path, std::set<std::string>& result);
+	SourceUsageIndex* _source_usage_index;
+	SourceUsageIndex& source_usage_index ();
+	int source_usage_of_state (XMLNode const &, SourceUsageIndex::Usage&);
+	int refresh_source_usage_index (std::vector<std::string>& state_files);
 	int find_all_sources_across_snapshots (std::set<std::string>& result, bool exclude_this_snapshot);
 
 	typedef std::set<boost::shared_ptr<PBD::Controllable> > Controllables;
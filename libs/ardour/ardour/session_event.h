@@ -24,7 +24,7 @@
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 
-#include "pbd/pool.h"
+#include "pbd/arena.h"
 #include "pbd/ringbuffer.h"
 #include "pbd/event_loop.h"
 
@@ -141,13 +141,10 @@ public:
 	static void create_per_thread_pool (const std::string& n, uint32_t nitems);
 	static void init_event_pool ();
 
-	CrossThreadPool* event_pool() const { return own_pool; }
+	static PBD::Arena* event_pool () { return pool; }
 
 private:
-	static PerThreadPool* pool;
-	CrossThreadPool* own_pool;
-
-	friend class Butler;
+	static PBD::Arena* pool;
 };
 
 class SessionEventManager {
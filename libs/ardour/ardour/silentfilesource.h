@@ -39,6 +39,9 @@ public:
 
 	bool clamped_at_unity() const { return false; }
 
+	/* reading silence is cheaper than looking it up */
+	bool cacheable () const { return false; }
+
 protected:
 	void close() {}
 	friend class SourceFactory;
@@ -80,10 +80,6 @@ public:
 	bool _open;
 	Evoral::Beats       _last_ev_time_beats;
 	framepos_t          _last_ev_time_frames;
-	/** end time (start + duration) of last call to read_unlocked */
-	mutable framepos_t _smf_last_read_end;
-	/** time (in SMF ticks, 1 tick per _ppqn) of the last event read by read_unlocked */
-	mutable framepos_t _smf_last_read_time;
 
 	int open_for_write ();
 
@@ -0,0 +1,106 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_source_usage_index_h__
+#define __ardour_source_usage_index_h__
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "ardour/libardour_visibility.h"
+
+namespace ARDOUR {
+
+/** A persistent index of the sources used by each snapshot of a session.
+ *
+ * For every snapshot (state file) it records the paths of the sources the
+ * snapshot lists, and for each of those the playlists and the number of
+ * regions which use it. An entry is stamped with the modification time and
+ * size of its state file, and is only used while that still matches, so
+ * only snapshots which changed behind our back have to be parsed again.
+ *
+ * The index lives in the session directory. It is discarded as a whole if
+ * it was written by a different version of this class.
+ */
+class LIBARDOUR_API SourceUsageIndex
+{
+public:
+	/** How one snapshot uses a source */
+	struct Use {
+		Use () : regions (0) {}
+		std::set<std::string> playlists;
+		uint32_t regions;
+	};
+
+	/** Source path to its use; sources which are listed by a snapshot
+	 * but not used by any region have an empty Use.
+	 */
+	typedef std::map<std::string, Use> Usage;
+
+	/** Snapshot (state file) path and how it uses a source */
+	typedef std::vector<std::pair<std::string, Use> > SnapshotUses;
+
+	static const char* const file_name;
+
+	SourceUsageIndex (std::string const & session_dir);
+
+	/** @return the usage recorded for the state file at @param snapshot,
+	 * or 0 if there is none or the file has changed since.
+	 */
+	Usage const * lookup (std::string const & snapshot) const;
+
+	/** Record @param usage for the state file at @param snapshot, which
+	 * must already have been written.
+	 */
+	void add (std::string const & snapshot, Usage const & usage);
+
+	/** Drop the entries for all snapshots except @param snapshots */
+	void retain (std::set<std::string> const & snapshots);
+
+	/** Add the snapshots using the source at @param path to @param uses */
+	void snapshots_using (std::string const & path, SnapshotUses& uses) const;
+
+	/** Write the index if anything changed */
+	void save ();
+
+private:
+	static const int version;
+
+	struct Entry {
+		std::string stamp;
+		Usage       usage;
+	};
+
+	typedef std::map<std::string, Entry> Entries;
+
+	void load ();
+	static std::string stamp (std::string const & file);
+
+	std::string _path;
+	Entries     _entries;
+	bool        _dirty;
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_source_usage_index_h__ */
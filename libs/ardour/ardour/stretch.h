@@ -43,21 +43,31 @@ class LIBARDOUR_API RBStretch : public RBEffect {
 
 #else
 
-#include <soundtouch/SoundTouch.h>
-
 namespace ARDOUR {
 
+class AudioRegion;
+
 class LIBARDOUR_API STStretch : public Filter {
   public:
 	STStretch (ARDOUR::Session&, TimeFXRequest&);
 	~STStretch ();
 
-	int run (boost::shared_ptr<ARDOUR::Region>);
+	int run (boost::shared_ptr<ARDOUR::Region>, Progress* progress = 0);
+
+  protected:
+	/* each channel is stretched on its own, as a separate job */
+	bool parallel () const { return true; }
+	int prepare (boost::shared_ptr<ARDOUR::Region>);
+	uint32_t n_jobs () const { return _nsrcs.size(); }
+	int process (uint32_t, Progress*);
+	int complete (bool);
 
   private:
 	TimeFXRequest& tsr;
 
-	soundtouch::SoundTouch st;
+	boost::shared_ptr<AudioRegion> _region;
+	SourceList  _nsrcs;
+	std::string _suffix;
 };
 
 } /* namespace */
@@ -59,6 +59,7 @@ public:
 	int get_parameter_descriptor (uint32_t which, ParameterDescriptor&) const;
 	std::string describe_parameter (Evoral::Parameter);
 	framecnt_t signal_latency() const;
+	framecnt_t plugin_tail () const;
 	std::set<Evoral::Parameter> automatable() const;
 
 	PBD::Signal0<void> LoadPresetProgram;
@@ -130,6 +131,8 @@ protected:
 	float      _transport_speed;
 	mutable std::map <uint32_t, float> _parameter_defaults;
 	bool       _eff_bypassed;
+	/** effGetTailSize as of the last activate(), -1 if unknown */
+	volatile gint _tail;
 };
 
 }
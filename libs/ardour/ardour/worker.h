@@ -20,12 +20,13 @@
 #ifndef __ardour_worker_h__
 #define __ardour_worker_h__
 
+#include <string>
+
 #include <stdint.h>
 
 #include <glibmm/threads.h>
 
 #include "pbd/ringbuffer.h"
-#include "pbd/semutils.h"
 
 #include "ardour/libardour_visibility.h"
 
@@ -54,9 +55,16 @@ public:
 /**
    A worker for non-realtime tasks scheduled from another thread.
 
-   A worker may be a separate thread that runs to execute scheduled work
-   asynchronously, or unthreaded, in which case work is executed immediately
-   upon scheduling by the calling thread.
+   A worker may be threaded, in which case scheduled work is executed
+   asynchronously by a pool of threads shared by all threaded workers, or
+   unthreaded, in which case work is executed immediately upon scheduling
+   by the calling thread.
+
+   Each worker keeps its own request and response queues. The work of
+   one worker is never executed concurrently, and the pool takes one
+   request from each worker in turn, so that responses are emitted in
+   the order the requests were scheduled and a busy worker cannot starve
+   the others.
 */
 class LIBARDOUR_API Worker
 {
@@ -91,8 +99,43 @@ public:
 	*/
 	void set_synchronous(bool synchronous) { _synchronous = synchronous; }
 
+	/** @return bytes of requests waiting for the pool */
+	uint32_t pending_requests() const;
+	/** @return bytes of responses waiting for emit_responses() */
+	uint32_t pending_responses() const;
+
+	/**
+	   Set the number of threads shared by all threaded workers, 0 for one
+	   per CPU core (at most 4). Takes effect when the pool next starts.
+	*/
+	static void set_pool_size(uint32_t n);
+	/** @return number of threads currently running in the pool */
+	static uint32_t pool_threads();
+	/** @return number of threaded workers using the pool */
+	static uint32_t pool_workers();
+
+	struct PoolStats {
+		uint32_t threads;              ///< threads currently running
+		uint32_t workers;              ///< threaded workers using the pool
+		uint32_t executed;             ///< requests executed so far
+		uint32_t pending_requests;     ///< bytes of requests queued, over all workers
+		uint32_t pending_responses;    ///< bytes of responses queued, over all workers
+		uint32_t max_pending_requests; ///< most bytes of requests seen queued for one worker
+	};
+
+	static PoolStats pool_stats();
+	/** @return the pool statistics as one line of text */
+	static std::string pool_report();
+
 private:
-	void run();
+	friend class WorkerPool;
+
+	/**
+	   Execute the next request, if any (pool thread, with the worker
+	   claimed).
+	   @return false if there was no complete request.
+	*/
+	bool process_request(void*& buf, size_t& buf_size);
 	/**
 	   Peek in RB, get size and check if a block of 'size' is available.
 
@@ -108,9 +151,7 @@ private:
 	RingBuffer<uint8_t>*   _requests;
 	RingBuffer<uint8_t>*   _responses;
 	uint8_t*               _response;
-	PBD::Semaphore         _sem;
-	Glib::Threads::Thread* _thread;
-	bool                   _exit;
+	gint                   _busy;
 	bool                   _synchronous;
 };
 
@@ -412,7 +412,7 @@ AudioDiskstream::prepare_record_status(framepos_t capture_start_frame)
 		boost::shared_ptr<ChannelList> c = channels.reader();
 		for (ChannelList::iterator chan = c->begin(); chan != c->end(); ++chan) {
 
-			RingBufferNPT<CaptureTransition>::rw_vector transitions;
+			SPSCRingBuffer<CaptureTransition>::rw_vector transitions;
 			(*chan)->capture_transition_buf->get_write_vector (&transitions);
 
 			if (transitions.len[0] > 0) {
@@ -514,7 +514,7 @@ AudioDiskstream::process (BufferSet& bufs, framepos_t transport_frame, pframes_t
 
 			ChannelInfo* chaninfo (*chan);
 
-			chaninfo->capture_buf->get_write_vector (&chaninfo->capture_vector);
+			chaninfo->capture_buf->reserve_write (&chaninfo->capture_vector, rec_nframes);
 
 			if (rec_nframes <= (framecnt_t) chaninfo->capture_vector.len[0]) {
 
@@ -620,7 +620,7 @@ AudioDiskstream::process (BufferSet& bufs, framepos_t transport_frame, pframes_t
 		}
 
 		for (chan = c->begin(); chan != c->end(); ++chan) {
-			(*chan)->playback_buf->get_read_vector (&(*chan)->playback_vector);
+			(*chan)->playback_buf->reserve_read (&(*chan)->playback_vector, necessary_samples);
 		}
 
 		n = 0;
@@ -857,11 +857,6 @@ AudioDiskstream::overwrite_existing_buffers ()
 	mixdown_buffer = new Sample[size];
 	gain_buffer = new float[size];
 
-	/* reduce size so that we can fill the buffer correctly (ringbuffers
-	   can only handle size-1, otherwise they appear to be empty)
-	*/
-	size--;
-
 	uint32_t n=0;
 	framepos_t start;
 
@@ -1118,7 +1113,7 @@ AudioDiskstream::_do_refill (Sample* mixdown_buffer, float* gain_buffer, framecn
 {
 	int32_t ret = 0;
 	framecnt_t to_read;
-	RingBufferNPT<Sample>::rw_vector vector;
+	SPSCRingBuffer<Sample>::rw_vector vector;
 	bool const reversed = (_visible_speed * _session.transport_speed()) < 0.0f;
 	framecnt_t total_space;
 	framecnt_t zero_fill;
@@ -1385,8 +1380,8 @@ AudioDiskstream::do_flush (RunContext /*context*/, bool force_flush)
 {
 	uint32_t to_write;
 	int32_t ret = 0;
-	RingBufferNPT<Sample>::rw_vector vector;
-	RingBufferNPT<CaptureTransition>::rw_vector transvec;
+	SPSCRingBuffer<Sample>::rw_vector vector;
+	SPSCRingBuffer<CaptureTransition>::rw_vector transvec;
 	framecnt_t total;
 
 	transvec.buf[0] = 0;
@@ -1720,7 +1715,7 @@ AudioDiskstream::transport_looped (framepos_t transport_frame)
 		if (recordable() && destructive()) {
 			for (ChannelList::iterator chan = c->begin(); chan != c->end(); ++chan) {
 
-				RingBufferNPT<CaptureTransition>::rw_vector transvec;
+				SPSCRingBuffer<CaptureTransition>::rw_vector transvec;
 				(*chan)->capture_transition_buf->get_write_vector(&transvec);
 
 				if (transvec.len[0] > 0) {
@@ -1753,7 +1748,7 @@ AudioDiskstream::finish_capture (boost::shared_ptr<ChannelList> c)
 	if (recordable() && destructive()) {
 		for (ChannelList::iterator chan = c->begin(); chan != c->end(); ++chan) {
 
-			RingBufferNPT<CaptureTransition>::rw_vector transvec;
+			SPSCRingBuffer<CaptureTransition>::rw_vector transvec;
 			(*chan)->capture_transition_buf->get_write_vector(&transvec);
 
 			if (transvec.len[0] > 0) {
@@ -2563,9 +2558,9 @@ AudioDiskstream::ChannelInfo::ChannelInfo (framecnt_t playback_bufsize, framecnt
 	playback_wrap_buffer = new Sample[wrap_size];
 	capture_wrap_buffer = new Sample[wrap_size];
 
-	playback_buf = new RingBufferNPT<Sample> (playback_bufsize);
-	capture_buf = new RingBufferNPT<Sample> (capture_bufsize);
-	capture_transition_buf = new RingBufferNPT<CaptureTransition> (256);
+	playback_buf = new SPSCRingBuffer<Sample> (playback_bufsize);
+	capture_buf = new SPSCRingBuffer<Sample> (capture_bufsize);
+	capture_transition_buf = new SPSCRingBuffer<CaptureTransition> (256);
 
 	/* touch the ringbuffer buffers, which will cause
 	   them to be mapped into locked physical RAM if
@@ -2582,7 +2577,7 @@ void
 AudioDiskstream::ChannelInfo::resize_playback (framecnt_t playback_bufsize)
 {
 	delete playback_buf;
-	playback_buf = new RingBufferNPT<Sample> (playback_bufsize);
+	playback_buf = new SPSCRingBuffer<Sample> (playback_bufsize);
 	memset (playback_buf->buffer(), 0, sizeof (Sample) * playback_buf->bufsize());
 }
 
@@ -2591,7 +2586,7 @@ AudioDiskstream::ChannelInfo::resize_capture (framecnt_t capture_bufsize)
 {
 	delete capture_buf;
 
-	capture_buf = new RingBufferNPT<Sample> (capture_bufsize);
+	capture_buf = new SPSCRingBuffer<Sample> (capture_bufsize);
 	memset (capture_buf->buffer(), 0, sizeof (Sample) * capture_buf->bufsize());
 }
 
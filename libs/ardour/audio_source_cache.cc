@@ -0,0 +1,262 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <cstring>
+
+#include "pbd/compose.h"
+
+#include "ardour/audio_source_cache.h"
+#include "ardour/audiosource.h"
+#include "ardour/rc_configuration.h"
+
+using namespace std;
+using namespace ARDOUR;
+using namespace PBD;
+
+AudioSourceCache* AudioSourceCache::_instance = 0;
+const framecnt_t AudioSourceCache::block_frames;
+
+AudioSourceCache&
+AudioSourceCache::instance ()
+{
+	if (!_instance) {
+		_instance = new AudioSourceCache;
+	}
+	return *_instance;
+}
+
+AudioSourceCache::AudioSourceCache ()
+	: _bytes (0)
+	, _generation (0)
+{
+	Config->ParameterChanged.connect_same_thread (_config_connection, boost::bind (&AudioSourceCache::parameter_changed, this, _1));
+}
+
+AudioSourceCache::~AudioSourceCache ()
+{
+	clear ();
+}
+
+size_t
+AudioSourceCache::max_bytes ()
+{
+	return (size_t) Config->get_audio_source_cache_megabytes () * 1048576;
+}
+
+void
+AudioSourceCache::parameter_changed (string const & p)
+{
+	if (p == "audio-source-cache-megabytes") {
+		trim (max_bytes ());
+	}
+}
+
+framecnt_t
+AudioSourceCache::read (AudioSource const & src, Sample* dst, framepos_t start, framecnt_t cnt)
+{
+	if (max_bytes () == 0) {
+		Glib::Threads::Mutex::Lock lm (src._lock);
+		return src.read_unlocked (dst, start, cnt);
+	}
+
+	framecnt_t done = 0;
+
+	while (done < cnt) {
+
+		framepos_t const pos = start + done;
+		Key const key (src.id (), pos / block_frames);
+		framepos_t const block_start = key.second * block_frames;
+		framecnt_t const offset = pos - block_start;
+		framecnt_t const n = min (cnt - done, block_frames - offset);
+
+		/* the last block of a source is shorter than the others */
+		framecnt_t const length = min (block_frames, src.readable_length () - block_start);
+
+		if (offset + n > length) {
+			/* reading beyond the end of the source: leave it to the
+			 * source to decide what that means, and report whatever
+			 * it managed to read, as an uncached read would.
+			 */
+			framecnt_t nread;
+			{
+				Glib::Threads::Mutex::Lock lm (src._lock);
+				nread = src.read_unlocked (dst + done, pos, n);
+			}
+			if (nread != n) {
+				return done + nread;
+			}
+			done += n;
+			continue;
+		}
+
+		uint64_t generation;
+
+		if (!lookup (key, dst + done, offset, n, generation)) {
+
+			/* read the whole block without holding the cache lock,
+			 * so that other threads are not held up by the disk.
+			 * If two threads miss the same block, both read it and
+			 * the first one to finish gets to insert it. A block
+			 * dropped while it was being read (e.g. because the
+			 * source's gain changed) is not inserted at all.
+			 */
+
+			Block* block = new Block (key, length);
+			framecnt_t nread;
+
+			{
+				Glib::Threads::Mutex::Lock lm (src._lock);
+				nread = src.read_unlocked (block->data, block_start, length);
+			}
+
+			if (nread != length) {
+				delete block;
+				return done;
+			}
+
+			memcpy (dst + done, block->data + offset, sizeof (Sample) * n);
+			insert (block, generation);
+		}
+
+		done += n;
+	}
+
+	return done;
+}
+
+bool
+AudioSourceCache::lookup (Key const & key, Sample* dst, framecnt_t offset, framecnt_t cnt, uint64_t& generation)
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	generation = _generation;
+
+	Blocks::iterator i = _blocks.find (key);
+
+	if (i == _blocks.end ()) {
+		++_stats.misses;
+		return false;
+	}
+
+	Block* block = i->second;
+	memcpy (dst, block->data + offset, sizeof (Sample) * cnt);
+
+	_lru.splice (_lru.begin (), _lru, block->lru);
+	++_stats.hits;
+
+	return true;
+}
+
+void
+AudioSourceCache::insert (Block* block, uint64_t generation)
+{
+	size_t const size = block->length * sizeof (Sample);
+	size_t const limit = max_bytes ();
+
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	if (size > limit || generation != _generation || _blocks.find (block->key) != _blocks.end ()) {
+		delete block;
+		return;
+	}
+
+	while (_bytes + size > limit) {
+		erase (_blocks.find (_lru.back ()->key));
+		++_stats.evictions;
+	}
+
+	block->lru = _lru.insert (_lru.begin (), block);
+	_blocks.insert (make_pair (block->key, block));
+	_bytes += size;
+}
+
+void
+AudioSourceCache::trim (size_t bytes)
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	while (_bytes > bytes) {
+		erase (_blocks.find (_lru.back ()->key));
+		++_stats.evictions;
+	}
+}
+
+void
+AudioSourceCache::erase (Blocks::iterator i)
+{
+	Block* block = i->second;
+	_bytes -= block->length * sizeof (Sample);
+	_lru.erase (block->lru);
+	_blocks.erase (i);
+	delete block;
+}
+
+void
+AudioSourceCache::drop (PBD::ID const & id)
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	++_generation;
+
+	Blocks::iterator i = _blocks.lower_bound (Key (id, 0));
+
+	while (i != _blocks.end () && i->first.first == id) {
+		erase (i++);
+	}
+}
+
+void
+AudioSourceCache::clear ()
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	++_generation;
+
+	while (!_blocks.empty ()) {
+		erase (_blocks.begin ());
+	}
+}
+
+AudioSourceCache::Stats
+AudioSourceCache::stats () const
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+	Stats s (_stats);
+	s.blocks = _blocks.size ();
+	s.bytes = _bytes;
+	return s;
+}
+
+void
+AudioSourceCache::reset_stats ()
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+	_stats = Stats ();
+}
+
+string
+AudioSourceCache::summary () const
+{
+	Stats const s (stats ());
+	uint64_t const total = s.hits + s.misses;
+
+	return string_compose ("%1 hits, %2 misses (%3%% hit rate), %4 evictions, %5 MB cached\n",
+	                       s.hits, s.misses, total ? (100 * s.hits) / total : 0, s.evictions,
+	                       s.bytes / 1048576);
+}
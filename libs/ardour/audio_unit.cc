@@ -432,6 +432,7 @@ AUPlugin::AUPlugin (AudioEngine& engine, Session& session, boost::shared_ptr<CAC
 	, initialized (false)
 	, _last_nframes (0)
 	, _current_latency (UINT_MAX)
+	, _tail (-1)
 	, _requires_fixed_size_buffers (false)
 	, buffers (0)
 	, variable_inputs (false)
@@ -473,6 +474,7 @@ AUPlugin::AUPlugin (const AUPlugin& other)
 	, initialized (false)
 	, _last_nframes (0)
 	, _current_latency (UINT_MAX)
+	, _tail (-1)
 	, _requires_fixed_size_buffers (false)
 	, buffers (0)
 	, variable_inputs (false)
@@ -952,6 +954,12 @@ AUPlugin::default_value (uint32_t port)
 	return 0;
 }
 
+framecnt_t
+AUPlugin::plugin_tail () const
+{
+	return g_atomic_int_get (&_tail);
+}
+
 framecnt_t
 AUPlugin::signal_latency () const
 {
@@ -1041,6 +1049,17 @@ AUPlugin::activate ()
 			initialized = true;
 		}
 	}
+
+	/* plugin_tail() is called from the process thread, so ask here,
+	 * where the sample rate is also known to be current.
+	 */
+	Float64 t;
+	UInt32 size = sizeof (t);
+	if (unit->GetProperty (kAudioUnitProperty_TailTime, kAudioUnitScope_Global, 0, &t, &size) == noErr) {
+		g_atomic_int_set (&_tail, (gint) (t * _session.frame_rate()));
+	} else {
+		g_atomic_int_set (&_tail, -1);
+	}
 }
 
 void
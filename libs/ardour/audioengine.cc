@@ -44,6 +44,8 @@
 #include "ardour/audioengine.h"
 #include "ardour/search_paths.h"
 #include "ardour/buffer.h"
+#include "ardour/butler.h"
+#include "ardour/click.h"
 #include "ardour/cycle_timer.h"
 #include "ardour/internal_send.h"
 #include "ardour/meter.h"
@@ -78,6 +80,8 @@ AudioEngine::AudioEngine ()
 	, monitor_check_interval (INT32_MAX)
 	, last_monitor_check (0)
 	, _processed_frames (0)
+	, _profiling (false)
+	, _wait_for_butler (false)
 	, m_meter_thread (0)
 	, _main_thread (0)
 	, _mtdm (0)
@@ -191,6 +195,15 @@ AudioEngine::process_callback (pframes_t nframes)
 {
 	Glib::Threads::Mutex::Lock tm (_process_lock, Glib::Threads::TRY_LOCK);
 
+	if (_wait_for_butler && tm.locked () && _session && _session->butler ()) {
+		/* make sure we've caught up with disk i/o, since we're
+		 * running faster than realtime (not realtime safe).
+		 */
+		_session->butler ()->wait_until_finished ();
+	}
+
+	PBD::HistogramTimer cycle_timer (_cycle_timing, _profiling);
+
 	PT_TIMING_REF;
 	PT_TIMING_CHECK (1);
 
@@ -1251,6 +1264,7 @@ AudioEngine::thread_init_callback (void* arg)
 	const string thread_name = string_compose (X_("AudioEngine %1"), thread_num);
 
 	SessionEvent::create_per_thread_pool (thread_name, 512);
+	Click::reserve (1024);
 	PBD::notify_event_loops_about_thread_creation (pthread_self(), thread_name, 4096);
 	AsyncMIDIPort::set_process_thread (pthread_self());
 
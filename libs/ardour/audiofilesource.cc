@@ -47,6 +47,7 @@
 #include <glibmm/fileutils.h>
 #include <glibmm/threads.h>
 
+#include "ardour/audio_source_cache.h"
 #include "ardour/audiofilesource.h"
 #include "ardour/debug.h"
 #include "ardour/sndfilesource.h"
@@ -293,6 +294,8 @@ AudioFileSource::set_gain (float g, bool temporarily)
 		return;
 	}
 	_gain = g;
+	/* the gain is applied when reading */
+	AudioSourceCache::instance ().drop (id ());
 	if (temporarily) {
 		return;
 	}
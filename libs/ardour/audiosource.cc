@@ -53,6 +53,7 @@
 #include "pbd/scoped_file_descriptor.h"
 #include "pbd/xml++.h"
 
+#include "ardour/audio_source_cache.h"
 #include "ardour/audiosource.h"
 #include "ardour/rc_configuration.h"
 #include "ardour/runtime_functions.h"
@@ -113,6 +114,8 @@ AudioSource::AudioSource (Session& s, const XMLNode& node)
 
 AudioSource::~AudioSource ()
 {
+	AudioSourceCache::instance ().drop (id ());
+
 	/* shouldn't happen but make sure we don't leak file descriptors anyway */
 
 	if (peak_leftover_cnt) {
@@ -318,6 +321,10 @@ AudioSource::read (Sample *dst, framepos_t start, framecnt_t cnt, int /*channel*
 {
 	assert (cnt >= 0);
 
+	if (cacheable ()) {
+		return AudioSourceCache::instance ().read (*this, dst, start, cnt);
+	}
+
 	Glib::Threads::Mutex::Lock lm (_lock);
 	return read_unlocked (dst, start, cnt);
 }
@@ -26,6 +26,7 @@
 #include "ardour/automation_control.h"
 #include "ardour/automation_watch.h"
 #include "ardour/debug.h"
+#include "ardour/rc_configuration.h"
 #include "ardour/session.h"
 
 using namespace ARDOUR;
@@ -44,12 +45,38 @@ AutomationWatch::instance ()
 
 AutomationWatch::AutomationWatch ()
 	: _thread (0)
-	, _last_time (0)
 	, _run_thread (false)
+	, _captures (new Captures)
+	, _capture_interval (0)
+	, _capture_rolling (false)
 {
 
 }
 
+AutomationWatch::Capture::Capture (boost::shared_ptr<AutomationControl> ac)
+	: control (ac)
+	, values (1024)
+	, last_when (-1)
+	, last_value (0)
+	, last_cycle (-1)
+	, merged_when (-1)
+{
+}
+
+void
+AutomationWatch::Capture::push (framepos_t when, double value)
+{
+	CapturedValue v;
+	v.when = when;
+	v.value = value;
+
+	/* if the merge falls this far behind, drop values rather than block */
+	values.write (&v, 1);
+
+	last_when = when;
+	last_value = value;
+}
+
 AutomationWatch::~AutomationWatch ()
 {
 	if (_thread) {
@@ -67,7 +94,15 @@ AutomationWatch::add_automation_watch (boost::shared_ptr<AutomationControl> ac)
 {
 	Glib::Threads::Mutex::Lock lm (automation_watch_lock);
 	DEBUG_TRACE (DEBUG::Automation, string_compose ("now watching control %1 for automation, astate = %2\n", ac->name(), enum_2_string (ac->automation_state())));
-	automation_watches.insert (ac);
+	if (automation_watches.insert (ac).second) {
+		RCUWriter<Captures> writer (_captures);
+		writer.get_copy ()->push_back (boost::shared_ptr<Capture> (new Capture (ac)));
+	}
+
+	/* captured values are thinned as they are added, so that finishing
+	 * a pass does not have to go through the whole list.
+	 */
+	ac->alist()->set_write_pass_thinning (Config->get_automation_thinning_factor ());
 
 	/* if an automation control is added here while the transport is
 	 * rolling, make sure that it knows that there is a write pass going
@@ -108,6 +143,19 @@ AutomationWatch::remove_automation_watch (boost::shared_ptr<AutomationControl> a
 	Glib::Threads::Mutex::Lock lm (automation_watch_lock);
 	DEBUG_TRACE (DEBUG::Automation, string_compose ("remove control %1 from automation watch\n", ac->name()));
 	automation_watches.erase (ac);
+
+	{
+		RCUWriter<Captures> writer (_captures);
+		boost::shared_ptr<Captures> c = writer.get_copy ();
+		for (Captures::iterator i = c->begin(); i != c->end(); ++i) {
+			if ((*i)->control == ac) {
+				merge_captured (**i);
+				c->erase (i);
+				break;
+			}
+		}
+	}
+
 	ac->list()->set_in_write_pass (false);
 }
 
@@ -128,6 +176,13 @@ AutomationWatch::transport_stop_automation_watches (framepos_t when)
 		*/
 
 		automation_watches.clear ();
+
+		RCUWriter<Captures> writer (_captures);
+		boost::shared_ptr<Captures> c = writer.get_copy ();
+		for (Captures::iterator i = c->begin(); i != c->end(); ++i) {
+			merge_captured (**i);
+		}
+		c->clear ();
 	}
 
 	for (AutomationWatches::iterator i = tmp.begin(); i != tmp.end(); ++i) {
@@ -142,32 +197,106 @@ AutomationWatch::timer ()
 		return TRUE;
 	}
 
-	{
-		Glib::Threads::Mutex::Lock lm (automation_watch_lock);
+	_capture_interval = (framecnt_t) floor (Config->get_automation_interval_msecs() * _session->nominal_frame_rate() / 1000.0);
 
-		framepos_t time = _session->audible_frame ();
-		if (time > _last_time) {  //we only write automation in the forward direction; this fixes automation-recording in a loop
-			for (AutomationWatches::iterator aw = automation_watches.begin(); aw != automation_watches.end(); ++aw) {
-				if ((*aw)->alist()->automation_write()) {
-					(*aw)->list()->add (time, (*aw)->user_double(), true);
-				}
-			}
-		} else if (time != _last_time) {  //transport stopped or reversed.  stop the automation pass and start a new one (for bonus points, someday store the previous pass in an undo record)
-			for (AutomationWatches::iterator aw = automation_watches.begin(); aw != automation_watches.end(); ++aw) {
-				DEBUG_TRACE (DEBUG::Automation, string_compose ("%1: transport in rewind, speed %2, in write pass ? %3 writing ? %4\n",
-										(*aw)->name(), _session->transport_speed(), _session->transport_rolling(),
-										(*aw)->alist()->automation_write()));
-				(*aw)->list()->set_in_write_pass (false);
-				if ( (*aw)->alist()->automation_write() ) {
-					(*aw)->list()->set_in_write_pass (true, time);
-				}
+	merge_captured ();
+
+	return TRUE;
+}
+
+/** Called by the process thread in every cycle, with the audible frame at
+ * its start. Record the values of all controls that are being written, in
+ * the cycle in which they change and otherwise once per automation interval,
+ * for the automation watch thread to add to their lists.
+ */
+void
+AutomationWatch::capture (framepos_t when, bool rolling)
+{
+	/* the process thread must not create the instance */
+	if (_instance) {
+		_instance->capture_values (when, rolling);
+	}
+}
+
+void
+AutomationWatch::capture_values (framepos_t when, bool rolling)
+{
+	if (!rolling && !_capture_rolling) {
+		return;
+	}
+
+	boost::shared_ptr<Captures> c = _captures.reader ();
+
+	for (Captures::iterator i = c->begin(); i != c->end(); ++i) {
+
+		Capture& cap (**i);
+
+		if (!rolling || !cap.control->automation_write ()) {
+			cap.last_cycle = -1;
+			continue;
+		}
+
+		const double value = cap.control->user_double ();
+
+		if (cap.last_cycle < 0 || when <= cap.last_cycle) {
+			/* first cycle of a pass, or the transport moved back */
+			cap.push (when, value);
+		} else if (value != cap.last_value) {
+			/* the previous value held until the last cycle */
+			if (cap.last_cycle > cap.last_when) {
+				cap.push (cap.last_cycle, cap.last_value);
 			}
+			cap.push (when, value);
+		} else if (when - cap.last_when >= _capture_interval) {
+			cap.push (when, value);
 		}
 
-		_last_time = time;
+		cap.last_cycle = when;
 	}
 
-	return TRUE;
+	_capture_rolling = rolling;
+}
+
+/** Add all values captured by the process thread to the lists of their controls */
+void
+AutomationWatch::merge_captured ()
+{
+	Glib::Threads::Mutex::Lock lm (automation_watch_lock);
+	boost::shared_ptr<Captures> c = _captures.reader ();
+
+	for (Captures::iterator i = c->begin(); i != c->end(); ++i) {
+		merge_captured (**i);
+	}
+}
+
+/* automation_watch_lock must be held */
+void
+AutomationWatch::merge_captured (Capture& cap)
+{
+	boost::shared_ptr<AutomationList> al = cap.control->alist ();
+	CapturedValue v;
+
+	if (!al) {
+		return;
+	}
+
+	while (cap.values.read (&v, 1) == 1) {
+
+		if (v.when <= cap.merged_when) {
+			/* transport reversed or looped. stop the automation pass and start a new one (for bonus points, someday store the previous pass in an undo record) */
+			DEBUG_TRACE (DEBUG::Automation, string_compose ("%1: transport moved back to %2 during write pass\n", cap.control->name(), v.when));
+			al->set_in_write_pass (false);
+			if (al->automation_write ()) {
+				al->set_in_write_pass (true, v.when);
+			}
+		}
+
+		if (al->automation_write ()) {
+			al->add (v.when, v.value, true);
+		}
+
+		cap.merged_when = v.when;
+	}
 }
 
 void
@@ -192,6 +321,11 @@ AutomationWatch::set_session (Session* s)
 
 	SessionHandlePtr::set_session (s);
 
+	if (!_session) {
+		/* the process thread has stopped looking */
+		_captures.flush ();
+	}
+
 	if (_session) {
 		_run_thread = true;
 		_thread = Glib::Threads::Thread::create (boost::bind (&AutomationWatch::thread, this));
@@ -209,8 +343,6 @@ AutomationWatch::transport_state_change ()
 
 	bool rolling = _session->transport_rolling();
 
-	_last_time = _session->audible_frame ();
-
 	{
 		Glib::Threads::Mutex::Lock lm (automation_watch_lock);
 
@@ -224,5 +356,11 @@ AutomationWatch::transport_state_change ()
 				(*aw)->list()->set_in_write_pass (false);
 			}
 		}
+
+		/* a new pass starts, whatever the position */
+		boost::shared_ptr<Captures> c = _captures.reader ();
+		for (Captures::iterator i = c->begin(); i != c->end(); ++i) {
+			(*i)->merged_when = -1;
+		}
 	}
 }
@@ -28,6 +28,7 @@
 #include "pbd/compose.h"
 #include "pbd/failed_constructor.h"
 
+#include "ardour/audio_buffer.h"
 #include "ardour/buffer.h"
 #include "ardour/buffer_set.h"
 #include "ardour/debug.h"
@@ -491,5 +492,28 @@ BufferSet::silence (framecnt_t nframes, framecnt_t offset)
 	}
 }
 
+/** @return true if the first @a nframes of all audio buffers in use are
+ *  silent, and all MIDI buffers in use are empty.
+ */
+bool
+BufferSet::silent (framecnt_t nframes) const
+{
+	for (uint32_t n = 0; n < _count.n_midi (); ++n) {
+		if (!get_midi (n).empty ()) {
+			return false;
+		}
+	}
+
+	for (uint32_t n = 0; n < _count.n_audio (); ++n) {
+		AudioBuffer const & ab (get_audio (n));
+		pframes_t first;
+		if (!ab.silent () && !ab.check_silence (nframes, first)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 } // namespace ARDOUR
 
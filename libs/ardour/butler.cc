@@ -48,11 +48,9 @@ Butler::Butler(Session& s)
 	, audio_dstream_capture_buffer_size(0)
 	, audio_dstream_playback_buffer_size(0)
 	, midi_dstream_buffer_size(0)
-	, pool_trash(16)
 	, _xthread (true)
 {
 	g_atomic_int_set(&should_do_transport_work, 0);
-	SessionEvent::pool->set_trash (&pool_trash);
 
         /* catch future changes to parameters */
         Config->ParameterChanged.connect_same_thread (*this, boost::bind (&Butler::config_changed, this, _1));
@@ -299,9 +297,6 @@ Butler::thread_work ()
                         DEBUG_TRACE (DEBUG::Butler, string_compose ("%1: butler signals pause @ %2\n", DEBUG_THREAD_SELF, g_get_monotonic_time()));
 			paused.signal();
 		}
-
-		DEBUG_TRACE (DEBUG::Butler, "butler emptying pool trash\n");
-		empty_pool_trash ();
 	}
 
 	return (0);
@@ -458,43 +453,5 @@ Butler::transport_work_requested () const
 	return g_atomic_int_get(&should_do_transport_work);
 }
 
-void
-Butler::empty_pool_trash ()
-{
-	/* look in the trash, deleting empty pools until we come to one that is not empty */
-
-	RingBuffer<CrossThreadPool*>::rw_vector vec;
-	pool_trash.get_read_vector (&vec);
-
-	guint deleted = 0;
-
-	for (int i = 0; i < 2; ++i) {
-		for (guint j = 0; j < vec.len[i]; ++j) {
-			if (vec.buf[i][j]->empty()) {
-				delete vec.buf[i][j];
-				++deleted;
-			} else {
-				/* found a non-empty pool, so stop deleting */
-				if (deleted) {
-					pool_trash.increment_read_idx (deleted);
-				}
-				return;
-			}
-		}
-	}
-
-	if (deleted) {
-		pool_trash.increment_read_idx (deleted);
-	}
-}
-
-void
-Butler::drop_references ()
-{
-	std::cerr << "Butler drops pool trash\n";
-	SessionEvent::pool->set_trash (0);
-}
-
-
 } // namespace ARDOUR
 
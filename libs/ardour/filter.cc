@@ -20,12 +20,17 @@
 #include <time.h>
 #include <cerrno>
 
+#include <glibmm/threadpool.h>
+#include <glibmm/timer.h>
+
 #include "pbd/basename.h"
+#include "pbd/cpus.h"
 
 #include "ardour/analyser.h"
 #include "ardour/audiofilesource.h"
 #include "ardour/audioregion.h"
 #include "ardour/filter.h"
+#include "ardour/progress.h"
 #include "ardour/region.h"
 #include "ardour/region_factory.h"
 #include "ardour/session.h"
@@ -161,3 +166,181 @@ Filter::finish (boost::shared_ptr<Region> region, SourceList& nsrcs, string regi
 }
 
 
+
+/** One call of Filter::process(). Progress is recorded here for the thread
+ * which called run_parallel() to report.
+ */
+struct Filter::Job : public Progress
+{
+	Job (Filter* f, uint32_t j, gint* d)
+		: filter (f)
+		, job (j)
+		, status (-1)
+		, permille (0)
+		, n_done (d)
+	{}
+
+	float done () const { return g_atomic_int_get (&permille) / 1000.f; }
+
+	Filter*  filter;
+	uint32_t job;
+	int      status;
+	gint     permille;
+	gint*    n_done;
+
+  private:
+	void set_overall_progress (float p) { g_atomic_int_set (&permille, (gint) (p * 1000)); }
+};
+
+void
+Filter::run_job (Job* j)
+{
+	j->status = j->filter->process (j->job, j);
+	g_atomic_int_set (&j->permille, 1000);
+	g_atomic_int_inc (j->n_done);
+}
+
+int
+Filter::run_parallel (vector<Filter*> const & filters, vector<boost::shared_ptr<Region> > const & regions, Progress* progress)
+{
+	if (filters.size() != regions.size()) {
+		return -1;
+	}
+
+	size_t const N = filters.size();
+	int ret = 0;
+
+	/* filters which cannot be split up run one after the other */
+
+	vector<size_t> parallel;
+
+	for (size_t i = 0; i < N; ++i) {
+		if (filters[i]->parallel ()) {
+			parallel.push_back (i);
+			continue;
+		}
+
+		if (progress) {
+			progress->descend (1.0 / N);
+		}
+
+		if (filters[i]->run (regions[i], progress)) {
+			ret = -1;
+		}
+
+		if (progress) {
+			progress->ascend ();
+		}
+	}
+
+	if (!parallel.empty () && run_jobs (filters, regions, parallel, progress)) {
+		ret = -1;
+	}
+
+	if (ret) {
+		/* all or nothing: do not leave the new regions and files of
+		   the filters which succeeded behind.
+		*/
+		for (size_t i = 0; i < N; ++i) {
+			filters[i]->drop_results ();
+		}
+	}
+
+	return ret;
+}
+
+/** Prepare the filters at the indices @param parallel here, since that
+ *  creates sources, then run all of their jobs on a thread pool.
+ */
+int
+Filter::run_jobs (vector<Filter*> const & filters, vector<boost::shared_ptr<Region> > const & regions, vector<size_t> const & parallel, Progress* progress)
+{
+	size_t const N = filters.size();
+	int ret = 0;
+
+	vector<bool> prepared (N, false);
+	vector<Job*> jobs;
+	vector<float> weights;
+	gint n_done = 0;
+
+	for (vector<size_t>::const_iterator i = parallel.begin(); i != parallel.end(); ++i) {
+		if (filters[*i]->prepare (regions[*i])) {
+			ret = -1;
+			continue;
+		}
+		prepared[*i] = true;
+		uint32_t const n = filters[*i]->n_jobs ();
+		for (uint32_t j = 0; j < n; ++j) {
+			jobs.push_back (new Job (filters[*i], j, &n_done));
+			weights.push_back (1.0 / (parallel.size() * n));
+		}
+	}
+
+	{
+		Glib::ThreadPool pool (hardware_concurrency ());
+
+		for (vector<Job*>::iterator j = jobs.begin(); j != jobs.end(); ++j) {
+			pool.push (sigc::bind (sigc::ptr_fun (&Filter::run_job), *j));
+		}
+
+		if (progress) {
+			progress->descend ((float) parallel.size() / N);
+
+			while (g_atomic_int_get (&n_done) < (gint) jobs.size ()) {
+				Glib::usleep (100000);
+
+				float done = 0;
+				for (size_t j = 0; j < jobs.size (); ++j) {
+					done += jobs[j]->done () * weights[j];
+				}
+				progress->set_progress (done);
+			}
+
+			progress->ascend ();
+		}
+
+		pool.shutdown ();
+	}
+
+	for (vector<size_t>::const_iterator i = parallel.begin(); i != parallel.end(); ++i) {
+		if (!prepared[*i]) {
+			continue;
+		}
+
+		bool ok = true;
+		for (vector<Job*>::const_iterator j = jobs.begin(); j != jobs.end(); ++j) {
+			if ((*j)->filter == filters[*i] && (*j)->status) {
+				ok = false;
+			}
+		}
+
+		if (filters[*i]->complete (ok)) {
+			ret = -1;
+		}
+	}
+
+	for (vector<Job*>::iterator j = jobs.begin(); j != jobs.end(); ++j) {
+		delete *j;
+	}
+
+	return ret;
+}
+
+/** Forget the regions made by finish(), and remove their sources */
+void
+Filter::drop_results ()
+{
+	for (vector<boost::shared_ptr<Region> >::iterator r = results.begin(); r != results.end(); ++r) {
+		SourceList srcs ((*r)->sources ());
+
+		(*r)->drop_sources ();
+		(*r)->drop_references ();
+
+		for (SourceList::iterator s = srcs.begin(); s != srcs.end(); ++s) {
+			(*s)->mark_for_remove ();
+			(*s)->drop_references ();
+		}
+	}
+
+	results.clear ();
+}
@@ -86,6 +86,7 @@
 
 #include "ardour/analyser.h"
 #include "ardour/audio_library.h"
+#include "ardour/audio_source_cache.h"
 #include "ardour/audio_backend.h"
 #include "ardour/audioengine.h"
 #include "ardour/audioplaylist.h"
@@ -483,6 +484,9 @@ ARDOUR::init (bool use_windows_vst, bool try_optimization, const char* localedir
 
 	Profile = new RuntimeProfile;
 
+	/* create it now, before butler threads can race to do so */
+	AudioSourceCache::instance ();
+
 
 #ifdef WINDOWS_VST_SUPPORT
 	if (Config->get_use_windows_vst() && fst_init (0)) {
@@ -19,6 +19,7 @@
 */
 #include <stdio.h>
 #include <cmath>
+#include <algorithm>
 
 #include "pbd/compose.h"
 #include "pbd/debug_rt_alloc.h"
@@ -233,6 +234,40 @@ Graph::trigger (GraphNode* n)
 	pthread_mutex_unlock (&_trigger_mutex);
 }
 
+/** Queue a node which is not part of the graph (and hence does not take part
+ *  in its ref-counting) to run in parallel with the caller, and wake up a
+ *  sleeping thread to pick it up.
+ */
+void
+Graph::trigger_and_wake (GraphNode* n)
+{
+	pthread_mutex_lock (&_trigger_mutex);
+	_trigger_queue.push_back (n);
+	if (_execution_tokens > 0) {
+		_execution_tokens -= 1;
+		_execution_sem.signal ();
+	}
+	pthread_mutex_unlock (&_trigger_mutex);
+}
+
+/** Remove a node queued by ::trigger_and_wake() if no thread has picked it
+ *  up yet.
+ *  @return true if the node was removed, and the caller has to run it itself.
+ */
+bool
+Graph::cancel_trigger (GraphNode* n)
+{
+	bool rv = false;
+	pthread_mutex_lock (&_trigger_mutex);
+	std::vector<GraphNode*>::iterator i = std::find (_trigger_queue.begin(), _trigger_queue.end(), n);
+	if (i != _trigger_queue.end()) {
+		_trigger_queue.erase (i);
+		rv = true;
+	}
+	pthread_mutex_unlock (&_trigger_mutex);
+	return rv;
+}
+
 /** Called when a node at the `output' end of the chain (ie one that has no-one to feed)
  *  is finished.
  */
@@ -578,6 +613,8 @@ Graph::process_one_route (Route* route)
 
         DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 runs route %2\n", pthread_name(), route->name()));
 
+        PBD::HistogramTimer route_timer (route->process_timing (), AudioEngine::instance()->profiling ());
+
         if (_process_silent) {
                 retval = route->silent_roll (_process_nframes, _process_start_frame, _process_end_frame, need_butler);
         } else if (_process_noroll) {
@@ -41,6 +41,7 @@
 #include <boost/shared_array.hpp>
 
 #include "pbd/basename.h"
+#include "pbd/cpus.h"
 #include "pbd/convert.h"
 
 #include "evoral/SMF.hpp"
@@ -237,7 +238,8 @@ compose_status_message (const string& path,
 
 static void
 write_audio_data_to_new_files (ImportableSource* source, ImportStatus& status,
-                               vector<boost::shared_ptr<Source> >& newfiles)
+                               vector<boost::shared_ptr<Source> >& newfiles,
+                               volatile float& progress)
 {
 	const framecnt_t nframes = ResampledImportableSource::blocksize;
 	boost::shared_ptr<AudioFileSource> afs;
@@ -258,7 +260,7 @@ write_audio_data_to_new_files (ImportableSource* source, ImportStatus& status,
 	boost::shared_ptr<AudioSource> s = boost::dynamic_pointer_cast<AudioSource> (newfiles[0]);
 	assert (s);
 
-	status.progress = 0.0f;
+	progress = 0.0f;
 	float progress_multiplier = 1;
 	float progress_base = 0;
 
@@ -281,7 +283,7 @@ write_audio_data_to_new_files (ImportableSource* source, ImportStatus& status,
 			peak = compute_peak (data.get(), nread * channels, peak);
 
 			read_count += nread / channels;
-			status.progress = 0.5 * read_count / (source->ratio() * source->length() * channels);
+			progress = 0.5 * read_count / (source->ratio() * source->length() * channels);
 		}
 
 		if (peak >= 1) {
@@ -340,8 +342,52 @@ write_audio_data_to_new_files (ImportableSource* source, ImportStatus& status,
 		}
 
 		read_count += nread;
-		status.progress = progress_base + progress_multiplier * read_count / (source->ratio () * source->length() * channels);
+		progress = progress_base + progress_multiplier * read_count / (source->ratio () * source->length() * channels);
+	}
+}
+
+namespace {
+
+/** An audio file being copied into the session by Session::import_files()
+ * on a pool thread. The file is opened by the job, so that no more input
+ * files are open at once than there are threads.
+ */
+struct AudioImportJob
+{
+	AudioImportJob (string const & p, framecnt_t sr, ImportStatus& s, vector<boost::shared_ptr<Source> > const & n, gint* d)
+		: path (p)
+		, samplerate (sr)
+		, status (s)
+		, newfiles (n)
+		, progress (0)
+		, failed (false)
+		, n_done (d)
+	{}
+
+	string                              path;
+	framecnt_t                          samplerate;
+	ImportStatus&                       status;
+	vector<boost::shared_ptr<Source> >  newfiles;
+	string                              doing_what;
+	volatile float                      progress;
+	bool                                failed;
+	gint*                               n_done;
+};
+
+}
+
+static void
+run_audio_import_job (AudioImportJob* job)
+{
+	try {
+		boost::shared_ptr<ImportableSource> source = open_importable_source (job->path, job->samplerate, job->status.quality);
+		write_audio_data_to_new_files (source.get(), job->status, job->newfiles, job->progress);
+	} catch (...) {
+		job->failed = true;
 	}
+
+	job->progress = 1;
+	g_atomic_int_inc (job->n_done);
 }
 
 static void
@@ -493,6 +539,8 @@ Session::import_files (ImportStatus& status)
 	boost::shared_ptr<SMFSource> smfs;
 	uint32_t channels = 0;
 	vector<string> smf_names;
+	vector<AudioImportJob*> audio_jobs;
+	gint n_audio_done = 0;
 
 	status.sources.clear ();
 
@@ -510,8 +558,8 @@ Session::import_files (ImportStatus& status)
 				channels = source->channels();
 			} catch (const failed_constructor& err) {
 				error << string_compose(_("Import: cannot open input sound file \"%1\""), (*p)) << endmsg;
-				status.done = status.cancel = true;
-				return;
+				status.cancel = true;
+				break;
 			}
 
 		} else {
@@ -539,8 +587,8 @@ Session::import_files (ImportStatus& status)
 				}
 			} catch (...) {
 				error << _("Import: error opening MIDI file") << endmsg;
-				status.done = status.cancel = true;
-				return;
+				status.cancel = true;
+				break;
 			}
 		}
 
@@ -574,10 +622,12 @@ Session::import_files (ImportStatus& status)
 			}
 		}
 
-		if (source) { // audio
-			status.doing_what = compose_status_message (*p, source->samplerate(),
-			                                            frame_rate(), status.current, status.total);
-			write_audio_data_to_new_files (source.get(), status, newfiles);
+		if (source) { // audio, copied below
+			AudioImportJob* job = new AudioImportJob (*p, frame_rate(), status, newfiles, &n_audio_done);
+			job->doing_what = compose_status_message (*p, source->samplerate(),
+			                                          frame_rate(), status.current, status.total);
+			audio_jobs.push_back (job);
+			continue;
 		} else if (smf_reader.get()) { // midi
 			status.doing_what = string_compose(_("Loading MIDI file %1"), *p);
 			write_midi_data_to_new_files (smf_reader.get(), status, newfiles, status.split_midi_channels);
@@ -587,6 +637,52 @@ Session::import_files (ImportStatus& status)
 		status.progress = 0;
 	}
 
+	/* audio files are copied (and resampled) in parallel, each by
+	   a job which reports its own progress; combine those here.
+	*/
+
+	if (!audio_jobs.empty () && !status.cancel) {
+		uint32_t const first = status.current;
+		Glib::ThreadPool pool (hardware_concurrency ());
+
+		for (vector<AudioImportJob*>::iterator j = audio_jobs.begin(); j != audio_jobs.end(); ++j) {
+			pool.push (sigc::bind (sigc::ptr_fun (&run_audio_import_job), *j));
+		}
+
+		while (g_atomic_int_get (&n_audio_done) < (gint) audio_jobs.size ()) {
+			Glib::usleep (100000);
+
+			float done = 0;
+			AudioImportJob* running = 0;
+
+			for (vector<AudioImportJob*>::iterator j = audio_jobs.begin(); j != audio_jobs.end(); ++j) {
+				done += (*j)->progress;
+				if (!running && (*j)->progress < 1) {
+					running = *j;
+				}
+			}
+
+			if (running) {
+				status.doing_what = running->doing_what;
+			}
+			status.current = first + (uint32_t) done;
+			status.progress = done - (uint32_t) done;
+		}
+
+		pool.shutdown ();
+
+		status.current = first + audio_jobs.size ();
+		status.progress = 0;
+	}
+
+	for (vector<AudioImportJob*>::iterator j = audio_jobs.begin(); j != audio_jobs.end(); ++j) {
+		if ((*j)->failed) {
+			error << string_compose(_("Import: cannot open input sound file \"%1\""), (*j)->path) << endmsg;
+			status.cancel = true;
+		}
+		delete *j;
+	}
+
 	if (!status.cancel) {
 		struct tm* now;
 		time_t xnow;
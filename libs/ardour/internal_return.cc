@@ -20,7 +20,9 @@
 
 #include "ardour/internal_return.h"
 #include "ardour/internal_send.h"
+#include "ardour/midi_buffer.h"
 #include "ardour/route.h"
+#include "ardour/session.h"
 
 using namespace std;
 using namespace ARDOUR;
@@ -41,11 +43,52 @@ InternalReturn::run (BufferSet& bufs, framepos_t /*start_frame*/, framepos_t /*e
 	Glib::Threads::Mutex::Lock lm (_sends_mutex, Glib::Threads::TRY_LOCK);
 
 	if (lm.locked ()) {
+
+		/* sum audio one send at a time, and collect the sends for MIDI */
+
+		_send_buffers.clear ();
+
 		for (list<InternalSend*>::iterator i = _sends.begin(); i != _sends.end(); ++i) {
 			if ((*i)->active () && (!(*i)->source_route() || (*i)->source_route()->active())) {
-				bufs.merge_from ((*i)->get_buffers(), nframes);
+				BufferSet const & sb ((*i)->get_buffers ());
+				BufferSet::iterator o = bufs.begin (DataType::AUDIO);
+				for (BufferSet::const_iterator b = sb.begin (DataType::AUDIO); b != sb.end (DataType::AUDIO) && o != bufs.end (DataType::AUDIO); ++b, ++o) {
+					o->merge_from (*b, nframes);
+				}
+				_send_buffers.push_back (&sb);
 			}
 		}
+
+		/* merge the MIDI of all sends in one pass per channel, rather
+		 * than inserting each send's events into our buffer in turn.
+		 */
+
+		for (uint32_t n = 0; n < bufs.count().n_midi(); ++n) {
+
+			MidiBuffer& mb (bufs.get_midi (n));
+
+			_midi_sources.clear ();
+			_midi_sources.push_back (&mb);
+
+			for (vector<BufferSet const *>::const_iterator i = _send_buffers.begin(); i != _send_buffers.end(); ++i) {
+				if ((*i)->count().n_midi() > n && !(*i)->get_midi (n).empty ()) {
+					_midi_sources.push_back (&(*i)->get_midi (n));
+				}
+			}
+
+			if (_midi_sources.size () == 1) {
+				continue;
+			}
+
+			if (_midi_sources.size () == 2 && mb.empty ()) {
+				mb.copy (*_midi_sources[1]);
+				continue;
+			}
+
+			MidiBuffer& scratch (_session.get_scratch_buffers (ChanCount (DataType::MIDI, 1)).get_midi (0));
+			scratch.merge_from (_midi_sources);
+			mb.copy (scratch);
+		}
 	}
 
 	_active = _pending_active;
@@ -56,6 +99,9 @@ InternalReturn::add_send (InternalSend* send)
 {
 	Glib::Threads::Mutex::Lock lm (_sends_mutex);
 	_sends.push_back (send);
+	/* keep run() from allocating */
+	_send_buffers.reserve (_sends.size ());
+	_midi_sources.reserve (_sends.size () + 1);
 }
 
 void
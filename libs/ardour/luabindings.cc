@@ -21,6 +21,7 @@
 #include "timecode/bbt_time.h"
 #include "pbd/stateful_diff_command.h"
 #include "pbd/openuri.h"
+#include "pbd/timing.h"
 #include "evoral/Control.hpp"
 #include "evoral/ControlList.hpp"
 #include "evoral/Range.hpp"
@@ -196,6 +197,7 @@ CLASSKEYS(PBD::ID);
 CLASSKEYS(PBD::Configuration);
 CLASSKEYS(PBD::PropertyChange);
 CLASSKEYS(PBD::StatefulDestructible);
+CLASSKEYS(PBD::TimingHistogram);
 
 CLASSKEYS(Evoral::Beats);
 CLASSKEYS(Evoral::Event<framepos_t>);
@@ -426,6 +428,19 @@ LuaBindings::common (lua_State* L)
 		.addFunction ("increment_write_ptr", &PBD::RingBufferNPT<int>::increment_write_ptr)
 		.endClass ()
 
+		.beginClass <PBD::TimingHistogram> ("TimingHistogram")
+		.addFunction ("reset", &PBD::TimingHistogram::reset)
+		.addFunction ("count", &PBD::TimingHistogram::count)
+		.addFunction ("minimum", &PBD::TimingHistogram::minimum)
+		.addFunction ("maximum", &PBD::TimingHistogram::maximum)
+		.addFunction ("total", &PBD::TimingHistogram::total)
+		.addFunction ("average", &PBD::TimingHistogram::average)
+		.addFunction ("bin", &PBD::TimingHistogram::bin)
+		.addStaticFunction ("bin_start", &PBD::TimingHistogram::bin_start)
+		.addFunction ("percentile", &PBD::TimingHistogram::percentile)
+		.addFunction ("summary", &PBD::TimingHistogram::summary)
+		.endClass ()
+
 		/* PBD enums */
 		.beginNamespace ("GroupControlDisposition")
 		.addConst ("InverseGroup", PBD::Controllable::GroupControlDisposition(PBD::Controllable::InverseGroup))
@@ -983,6 +998,13 @@ LuaBindings::common (lua_State* L)
 		.addFunction ("set_comment", &Route::set_comment)
 		.addFunction ("strict_io", &Route::strict_io)
 		.addFunction ("set_strict_io", &Route::set_strict_io)
+		.addFunction ("pipelined", &Route::pipelined)
+		.addFunction ("set_pipelined", &Route::set_pipelined)
+		.addFunction ("processed_cycles", &Route::processed_cycles)
+		.addFunction ("skipped_cycles", &Route::skipped_cycles)
+		.addFunction ("reset_cycle_stats", &Route::reset_cycle_stats)
+		.addFunction ("process_timing", (PBD::TimingHistogram const & (Route::*)() const)&Route::process_timing)
+		.addFunction ("reset_dsp_timing", &Route::reset_dsp_timing)
 		.addFunction ("reset_plugin_insert", &Route::reset_plugin_insert)
 		.addFunction ("customize_plugin_insert", &Route::customize_plugin_insert)
 		.addFunction ("add_sidechain", &Route::add_sidechain)
@@ -1134,7 +1156,8 @@ LuaBindings::common (lua_State* L)
 		.deriveWSPtrClass <MidiRegion, Region> ("MidiRegion")
 		.addFunction ("do_export", &MidiRegion::do_export)
 		.addFunction ("midi_source", &MidiRegion::midi_source)
-		.addFunction ("model", (boost::shared_ptr<MidiModel> (MidiRegion::*)())&MidiRegion::model)
+		/* sources are created without a model, so load it for scripts */
+		.addFunction ("model", &MidiRegion::loaded_model)
 		.addFunction ("start_beats", &MidiRegion::start_beats)
 		.addFunction ("length_beats", &MidiRegion::length_beats)
 		.endClass ()
@@ -1167,7 +1190,7 @@ LuaBindings::common (lua_State* L)
 		.deriveWSPtrClass <MidiSource, Source> ("MidiSource")
 		.addFunction ("empty", &MidiSource::empty)
 		.addFunction ("length", &MidiSource::length)
-		.addFunction ("model", &MidiSource::model)
+		.addFunction ("model", &MidiSource::loaded_model)
 		.endClass ()
 
 		.deriveWSPtrClass <AudioSource, Source> ("AudioSource")
@@ -1245,6 +1268,7 @@ LuaBindings::common (lua_State* L)
 		.addFunction ("active", &Processor::active)
 		.addFunction ("activate", &Processor::activate)
 		.addFunction ("deactivate", &Processor::deactivate)
+		.addFunction ("dsp_timing", (PBD::TimingHistogram const & (Processor::*)() const)&Processor::dsp_timing)
 		.addFunction ("output_streams", &PluginInsert::output_streams)
 		.addFunction ("input_streams", &PluginInsert::input_streams)
 		.endClass ()
@@ -1308,6 +1332,10 @@ LuaBindings::common (lua_State* L)
 		.addFunction ("natural_output_streams", &PluginInsert::natural_output_streams)
 		.addFunction ("natural_input_streams", &PluginInsert::natural_input_streams)
 		.addFunction ("reset_parameters_to_default", &PluginInsert::reset_parameters_to_default)
+		.addFunction ("tail", &PluginInsert::tail)
+		.addFunction ("user_tail", &PluginInsert::user_tail)
+		.addFunction ("set_user_tail", &PluginInsert::set_user_tail)
+		.addFunction ("skipped", &PluginInsert::skipped)
 		.endClass ()
 
 		.deriveWSPtrClass <AutomationControl, PBD::Controllable> ("AutomationControl")
@@ -1826,6 +1854,10 @@ LuaBindings::common (lua_State* L)
 		.addFunction ("start", &AudioEngine::start)
 		.addFunction ("stop", &AudioEngine::stop)
 		.addFunction ("get_dsp_load", &AudioEngine::get_dsp_load)
+		.addFunction ("profiling", &AudioEngine::profiling)
+		.addFunction ("set_profiling", &AudioEngine::set_profiling)
+		.addFunction ("cycle_timing", &AudioEngine::cycle_timing)
+		.addFunction ("reset_cycle_timing", &AudioEngine::reset_cycle_timing)
 		.addFunction ("set_device_name", &AudioEngine::set_device_name)
 		.addFunction ("set_sample_rate", &AudioEngine::set_sample_rate)
 		.addFunction ("set_buffer_size", &AudioEngine::set_buffer_size)
@@ -33,6 +33,7 @@
 #include "ardour/luascripting.h"
 #include "ardour/midi_buffer.h"
 #include "ardour/plugin.h"
+#include "ardour/rc_configuration.h"
 #include "ardour/session.h"
 
 #include "LuaBridge/LuaBridge.h"
@@ -42,6 +43,11 @@
 using namespace ARDOUR;
 using namespace PBD;
 
+const size_t LuaProc::bytecode_cache_size;
+Glib::Threads::Mutex LuaProc::_bytecode_lock;
+LuaProc::BytecodeCache LuaProc::_bytecode_cache;
+uint64_t LuaProc::_bytecode_clock = 0;
+
 LuaProc::LuaProc (AudioEngine& engine,
                   Session& session,
                   const std::string &script)
@@ -49,12 +55,16 @@ LuaProc::LuaProc (AudioEngine& engine,
 	, _mempool ("LuaProc", 3145728)
 #ifdef USE_TLSF
 	, lua (lua_newstate (&PBD::TLSF::lalloc, &_mempool))
+#elif defined USE_REALLOCPOOL
+	, lua (lua_newstate (&PBD::ReallocPool::lalloc, &_mempool))
 #elif defined USE_MALLOC
 	, lua ()
 #else
-	, lua (lua_newstate (&PBD::ReallocPool::lalloc, &_mempool))
+	, lua (lua_newstate (&PBD::SizeClassPool::lalloc, &_mempool))
 #endif
 	, _lua_dsp (0)
+	, _lua_in_map (0)
+	, _lua_out_map (0)
 	, _script (script)
 	, _lua_does_channelmapping (false)
 	, _lua_has_inline_display (false)
@@ -80,12 +90,16 @@ LuaProc::LuaProc (const LuaProc &other)
 	, _mempool ("LuaProc", 3145728)
 #ifdef USE_TLSF
 	, lua (lua_newstate (&PBD::TLSF::lalloc, &_mempool))
+#elif defined USE_REALLOCPOOL
+	, lua (lua_newstate (&PBD::ReallocPool::lalloc, &_mempool))
 #elif defined USE_MALLOC
 	, lua ()
 #else
-	, lua (lua_newstate (&PBD::ReallocPool::lalloc, &_mempool))
+	, lua (lua_newstate (&PBD::SizeClassPool::lalloc, &_mempool))
 #endif
 	, _lua_dsp (0)
+	, _lua_in_map (0)
+	, _lua_out_map (0)
 	, _script (other.script ())
 	, _origin (other._origin)
 	, _lua_does_channelmapping (false)
@@ -124,6 +138,8 @@ LuaProc::~LuaProc () {
 #endif
 	lua.do_command ("collectgarbage();");
 	delete (_lua_dsp);
+	delete (_lua_in_map);
+	delete (_lua_out_map);
 	delete [] _control_data;
 	delete [] _shadow_data;
 }
@@ -171,6 +187,49 @@ LuaProc::init ()
 	lua.do_command ("function ardour () end");
 }
 
+/** Run the script's main chunk. Sessions commonly use the same script for
+ * many instances, so it is compiled once and the bytecode is shared.
+ * The cache keeps the most recently used bytecode_cache_size scripts.
+ */
+int
+LuaProc::run_script ()
+{
+	std::string bytecode;
+
+	{
+		Glib::Threads::Mutex::Lock lm (_bytecode_lock);
+		BytecodeCache::iterator i = _bytecode_cache.find (_script);
+		if (i != _bytecode_cache.end ()) {
+			bytecode = i->second.code;
+			i->second.used = ++_bytecode_clock;
+		}
+	}
+
+	if (bytecode.empty ()) {
+		if (lua.compile (_script, bytecode)) {
+			return -1;
+		}
+
+		Glib::Threads::Mutex::Lock lm (_bytecode_lock);
+
+		while (_bytecode_cache.size () >= bytecode_cache_size) {
+			BytecodeCache::iterator oldest = _bytecode_cache.begin ();
+			for (BytecodeCache::iterator i = _bytecode_cache.begin (); i != _bytecode_cache.end (); ++i) {
+				if (i->second.used < oldest->second.used) {
+					oldest = i;
+				}
+			}
+			_bytecode_cache.erase (oldest);
+		}
+
+		Bytecode& b (_bytecode_cache[_script]);
+		b.code = bytecode;
+		b.used = ++_bytecode_clock;
+	}
+
+	return lua.do_bytecode (bytecode);
+}
+
 boost::weak_ptr<Route>
 LuaProc::route () const
 {
@@ -209,7 +268,7 @@ LuaProc::load_script ()
 	}
 
 	lua_State* L = lua.getState ();
-	lua.do_command (_script);
+	run_script ();
 
 	// check if script has a DSP callback
 	luabridge::LuaRef lua_dsp_run = luabridge::getGlobal (L, "dsp_run");
@@ -230,6 +289,9 @@ LuaProc::load_script ()
 		assert (0);
 	}
 
+	_lua_in_map = new luabridge::LuaRef (luabridge::newTable (L));
+	_lua_out_map = new luabridge::LuaRef (luabridge::newTable (L));
+
 	// initialize the DSP if needed
 	luabridge::LuaRef lua_dsp_init = luabridge::getGlobal (L, "dsp_init");
 	if (lua_dsp_init.type () == LUA_TFUNCTION) {
@@ -589,9 +651,30 @@ LuaProc::configure_io (ChanCount in, ChanCount out)
 	_configured_in = in;
 	_configured_out = out;
 
+	reset_buffer_maps ();
+
 	return true;
 }
 
+/** Start dsp_run() buffer tables afresh for the current configuration.
+ * While the configuration stays the same, connect_and_run() only updates
+ * the entries whose buffers moved.
+ */
+void
+LuaProc::reset_buffer_maps ()
+{
+	if (!_lua_in_map) {
+		return;
+	}
+
+	lua_State* L = lua.getState ();
+	*_lua_in_map = luabridge::newTable (L);
+	*_lua_out_map = luabridge::newTable (L);
+
+	_in_ptrs.assign (_configured_in.n_audio (), (float*) 0);
+	_out_ptrs.assign (_configured_out.n_audio (), (float*) 0);
+}
+
 int
 LuaProc::connect_and_run (BufferSet& bufs,
 		framepos_t start, framepos_t end, double speed,
@@ -634,8 +717,16 @@ LuaProc::connect_and_run (BufferSet& bufs,
 			BufferSet& scratch_bufs = _session.get_scratch_buffers (ChanCount (DataType::AUDIO, 1));
 
 			lua_State* L = lua.getState ();
-			luabridge::LuaRef in_map (luabridge::newTable (L));
-			luabridge::LuaRef out_map (luabridge::newTable (L));
+
+			/* pushing a buffer pointer allocates a userdata, so unless
+			 * asked for fresh tables, keep them and only update entries
+			 * that changed since the last cycle (usually none).
+			 */
+			if (Config->get_lua_dsp_fresh_buffer_tables ()) {
+				reset_buffer_maps ();
+			}
+			luabridge::LuaRef& in_map (*_lua_in_map);
+			luabridge::LuaRef& out_map (*_lua_out_map);
 
 			const uint32_t audio_in = _configured_in.n_audio ();
 			const uint32_t audio_out = _configured_out.n_audio ();
@@ -644,25 +735,38 @@ LuaProc::connect_and_run (BufferSet& bufs,
 			for (uint32_t ap = 0; ap < audio_in; ++ap) {
 				bool valid;
 				const uint32_t buf_index = in.get(DataType::AUDIO, ap, &valid);
+				float* data;
 				if (valid) {
-					in_map[ap + 1] = bufs.get_audio (buf_index).data (offset);
+					data = bufs.get_audio (buf_index).data (offset);
 				} else {
-					in_map[ap + 1] = silent_bufs.get_audio (0).data (offset);
+					data = silent_bufs.get_audio (0).data (offset);
+				}
+				if (_in_ptrs[ap] != data) {
+					in_map[ap + 1] = data;
+					_in_ptrs[ap] = data;
 				}
 			}
 			for (uint32_t ap = 0; ap < audio_out; ++ap) {
 				bool valid;
 				const uint32_t buf_index = out.get(DataType::AUDIO, ap, &valid);
+				float* data;
 				if (valid) {
-					out_map[ap + 1] = bufs.get_audio (buf_index).data (offset);
+					data = bufs.get_audio (buf_index).data (offset);
 				} else {
-					out_map[ap + 1] = scratch_bufs.get_audio (0).data (offset);
+					data = scratch_bufs.get_audio (0).data (offset);
+				}
+				if (_out_ptrs[ap] != data) {
+					out_map[ap + 1] = data;
+					_out_ptrs[ap] = data;
 				}
 			}
 
-			luabridge::LuaRef lua_midi_src_tbl (luabridge::newTable (L));
+			luabridge::LuaRef lua_midi_src_tbl (L);
+			if (_has_midi_input) {
+				lua_midi_src_tbl = luabridge::newTable (L);
+			}
 			int e = 1; // > 1 port, we merge events (unsorted)
-			for (uint32_t mp = 0; mp < midi_in; ++mp) {
+			for (uint32_t mp = 0; _has_midi_input && mp < midi_in; ++mp) {
 				bool valid;
 				const uint32_t idx = in.get(DataType::MIDI, mp, &valid);
 				if (valid) {
@@ -690,8 +794,9 @@ LuaProc::connect_and_run (BufferSet& bufs,
 				lua_setglobal (L, "midiin");
 			}
 
-			luabridge::LuaRef lua_midi_sink_tbl (luabridge::newTable (L));
+			luabridge::LuaRef lua_midi_sink_tbl (L);
 			if (_has_midi_output) {
+				lua_midi_sink_tbl = luabridge::newTable (L);
 				luabridge::push (L, lua_midi_sink_tbl);
 				lua_setglobal (L, "midiout");
 			}
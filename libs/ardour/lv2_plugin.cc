@@ -18,6 +18,7 @@
 */
 
 #include <cctype>
+#include <map>
 #include <string>
 #include <vector>
 #include <limits>
@@ -46,6 +47,7 @@
 #include "ardour/debug.h"
 #include "ardour/lv2_plugin.h"
 #include "ardour/midi_patch_manager.h"
+#include "ardour/plugin_info_cache.h"
 #include "ardour/session.h"
 #include "ardour/tempo.h"
 #include "ardour/types.h"
@@ -119,6 +121,10 @@ public:
 	~LV2World ();
 
 	void load_bundled_plugins(bool verbose=false);
+	void load_new_bundles();
+
+	/** @return true if the bundle in @param dir was modified since it was loaded */
+	bool bundle_changed(const std::string& dir) const;
 
 	LilvWorld* world;
 
@@ -192,7 +198,13 @@ public:
 #endif
 
 private:
-	bool _bundle_checked;
+	void check_bundles(bool load);
+
+	typedef std::map<std::string, std::string> Stamps;
+
+	bool   _bundle_checked;
+	Stamps _dir_stamps;    ///< search path directories, to spot new bundles
+	Stamps _bundle_stamps; ///< bundle directories, as loaded
 };
 
 static LV2World _world;
@@ -3272,10 +3284,114 @@ LV2World::load_bundled_plugins(bool verbose)
 		}
 
 		lilv_world_load_all(world);
+		check_bundles(false);
 		_bundle_checked = true;
 	}
 }
 
+/** The directories lilv_world_load_all() looks for bundles in */
+static Searchpath
+lv2_search_path ()
+{
+	string const env = Glib::getenv ("LV2_PATH");
+	if (!env.empty ()) {
+		return Searchpath (env);
+	}
+
+	Searchpath sp;
+#if defined PLATFORM_WINDOWS
+	sp += Glib::build_filename (Glib::getenv ("APPDATA"), "LV2");
+	sp += Glib::build_filename (Glib::getenv ("COMMONPROGRAMFILES"), "LV2");
+#elif defined __APPLE__
+	sp += Glib::build_filename (Glib::get_home_dir (), "Library/Audio/Plug-Ins/LV2");
+	sp += Glib::build_filename (Glib::get_home_dir (), ".lv2");
+	sp += "/usr/local/lib/lv2";
+	sp += "/usr/lib/lv2";
+	sp += "/Library/Audio/Plug-Ins/LV2";
+#else
+	sp += Glib::build_filename (Glib::get_home_dir (), ".lv2");
+	sp += "/usr/local/lib/lv2";
+	sp += "/usr/lib/lv2";
+#endif
+	return sp;
+}
+
+static string
+lv2_dir_stamp (const string& dir)
+{
+	vector<string> files;
+	files.push_back (dir);
+	return PluginInfoCache::stamp (files);
+}
+
+/** Find bundles which are not loaded yet, and load them if @param load is
+ * true. Only search path directories whose modification time changed are
+ * listed again, so this is cheap when nothing was installed.
+ */
+void
+LV2World::check_bundles(bool load)
+{
+	Searchpath sp (lv2_search_path ());
+	sp += ARDOUR::lv2_bundled_search_path ();
+
+	for (vector<string>::const_iterator d = sp.begin(); d != sp.end(); ++d) {
+		string const stamp = lv2_dir_stamp (*d);
+		Stamps::iterator i = _dir_stamps.find (*d);
+
+		if (i != _dir_stamps.end() && i->second == stamp) {
+			continue;
+		}
+
+		_dir_stamps[*d] = stamp;
+
+		vector<string> bundles;
+		find_paths_matching_filter (bundles, *d, lv2_filter, 0, true, true, false);
+
+		for (vector<string>::const_iterator b = bundles.begin(); b != bundles.end(); ++b) {
+			if (_bundle_stamps.find (*b) != _bundle_stamps.end()) {
+				continue;
+			}
+
+			_bundle_stamps[*b] = lv2_dir_stamp (*b);
+
+			if (!load) {
+				continue;
+			}
+
+			DEBUG_TRACE (DEBUG::PluginManager, string_compose ("LV2: loading new bundle %1\n", *b));
+#ifdef PLATFORM_WINDOWS
+			string uri = "file:///" + *b + "/";
+#else
+			string uri = "file://" + *b + "/";
+#endif
+			LilvNode *node = lilv_new_uri(world, uri.c_str());
+			lilv_world_load_bundle(world, node);
+			lilv_node_free(node);
+		}
+	}
+}
+
+/** Load bundles which were installed after the world was loaded.
+ * Bundles which were already loaded are not reloaded, since running
+ * plugins refer to their data.
+ */
+void
+LV2World::load_new_bundles()
+{
+	if (!_bundle_checked) {
+		load_bundled_plugins(true);
+	} else {
+		check_bundles(true);
+	}
+}
+
+bool
+LV2World::bundle_changed(const string& dir) const
+{
+	Stamps::const_iterator i = _bundle_stamps.find (dir);
+	return i != _bundle_stamps.end() && i->second != lv2_dir_stamp (dir);
+}
+
 LV2PluginInfo::LV2PluginInfo (const char* plugin_uri)
 {
 	type = ARDOUR::LV2;
@@ -3379,119 +3495,204 @@ LV2PluginInfo::is_instrument () const
 	return false;
 }
 
-PluginInfoList*
-LV2PluginInfo::discover()
+/** @return the directory of the bundle containing @param p, or an empty string if it is not local */
+static string
+lv2_bundle_dir (const LilvPlugin* p)
 {
-	LV2World world;
-	world.load_bundled_plugins();
-	_world.load_bundled_plugins(true);
+	try {
+		string dir = Glib::filename_from_uri (lilv_node_as_uri(lilv_plugin_get_bundle_uri(p)));
+		if (dir.length() > 1 && G_IS_DIR_SEPARATOR (dir[dir.length() - 1])) {
+			dir.erase (dir.length() - 1);
+		}
+		return dir;
+	} catch (Glib::ConvertError const &) {
+		return string ();
+	}
+}
 
-	PluginInfoList*    plugs   = new PluginInfoList;
-	const LilvPlugins* plugins = lilv_world_get_all_plugins(world.world);
+/** The files describing @param p, whose modification invalidates its cache
+ * entry. This includes the bundle directory, which changes when files are
+ * added to or removed from the bundle.
+ */
+static vector<string>
+lv2_plugin_files (const LilvPlugin* p, const string& bundle_dir)
+{
+	vector<string> files;
 
-	LILV_FOREACH(plugins, i, plugins) {
-		const LilvPlugin* p = lilv_plugins_get(plugins, i);
-		const LilvNode* pun = lilv_plugin_get_uri(p);
-		if (!pun) continue;
-		LV2PluginInfoPtr info(new LV2PluginInfo(lilv_node_as_string(pun)));
+	if (bundle_dir.empty ()) {
+		return files;
+	}
 
-		LilvNode* name = lilv_plugin_get_name(p);
-		if (!name || !lilv_plugin_get_port_by_index(p, 0)) {
-			warning << "Ignoring invalid LV2 plugin "
-			        << lilv_node_as_string(lilv_plugin_get_uri(p))
-			        << endmsg;
-			continue;
-		}
+	files.push_back (bundle_dir);
+	files.push_back (Glib::build_filename (bundle_dir, "manifest.ttl"));
 
-		if (lilv_plugin_has_feature(p, world.lv2_inPlaceBroken)) {
-			warning << string_compose(
-			    _("Ignoring LV2 plugin \"%1\" since it cannot do inplace processing."),
-			    lilv_node_as_string(name)) << endmsg;
-			lilv_node_free(name);
-			continue;
+	try {
+		const LilvNodes* data = lilv_plugin_get_data_uris(p);
+		LILV_FOREACH(nodes, i, data) {
+			files.push_back (Glib::filename_from_uri (lilv_node_as_uri(lilv_nodes_get(data, i))));
 		}
+	} catch (Glib::ConvertError const &) {
+		/* not a local file, stamp what we have */
+	}
+
+	return files;
+}
+
+/** Query the details of @param p, and add them to @param plugins unless
+ * the plugin cannot be used. This loads all of its data.
+ */
+static void
+lv2_scan_plugin (LV2World& world, const LilvPlugin* p, PluginInfoCache::InfoList& plugins)
+{
+	LilvNode* name = lilv_plugin_get_name(p);
+	if (!name || !lilv_plugin_get_port_by_index(p, 0)) {
+		warning << "Ignoring invalid LV2 plugin "
+		        << lilv_node_as_string(lilv_plugin_get_uri(p))
+		        << endmsg;
+		lilv_node_free(name);
+		return;
+	}
+
+	if (lilv_plugin_has_feature(p, world.lv2_inPlaceBroken)) {
+		warning << string_compose(
+		    _("Ignoring LV2 plugin \"%1\" since it cannot do inplace processing."),
+		    lilv_node_as_string(name)) << endmsg;
+		lilv_node_free(name);
+		return;
+	}
 
 #ifdef HAVE_LV2_1_2_0
-		LilvNodes *required_features = lilv_plugin_get_required_features (p);
-		if (lilv_nodes_contains (required_features, world.bufz_powerOf2BlockLength) ||
-				lilv_nodes_contains (required_features, world.bufz_fixedBlockLength)
-		   ) {
-			warning << string_compose(
-			    _("Ignoring LV2 plugin \"%1\" because its buffer-size requirements cannot be satisfied."),
-			    lilv_node_as_string(name)) << endmsg;
-			lilv_nodes_free(required_features);
-			lilv_node_free(name);
-			continue;
-		}
+	LilvNodes *required_features = lilv_plugin_get_required_features (p);
+	if (lilv_nodes_contains (required_features, world.bufz_powerOf2BlockLength) ||
+			lilv_nodes_contains (required_features, world.bufz_fixedBlockLength)
+	   ) {
+		warning << string_compose(
+		    _("Ignoring LV2 plugin \"%1\" because its buffer-size requirements cannot be satisfied."),
+		    lilv_node_as_string(name)) << endmsg;
 		lilv_nodes_free(required_features);
+		lilv_node_free(name);
+		return;
+	}
+	lilv_nodes_free(required_features);
 #endif
 
-		info->type = LV2;
+	PluginInfoCache::Info info;
 
-		info->name = string(lilv_node_as_string(name));
-		lilv_node_free(name);
-		ARDOUR::PluginScanMessage(_("LV2"), info->name, false);
+	info.name = string(lilv_node_as_string(name));
+	lilv_node_free(name);
+	ARDOUR::PluginScanMessage(_("LV2"), info.name, false);
 
-		const LilvPluginClass* pclass = lilv_plugin_get_class(p);
-		const LilvNode*        label  = lilv_plugin_class_get_label(pclass);
-		info->category = lilv_node_as_string(label);
+	const LilvPluginClass* pclass = lilv_plugin_get_class(p);
+	const LilvNode*        label  = lilv_plugin_class_get_label(pclass);
+	info.category = lilv_node_as_string(label);
 
-		LilvNode* author_name = lilv_plugin_get_author_name(p);
-		info->creator = author_name ? string(lilv_node_as_string(author_name)) : "Unknown";
-		lilv_node_free(author_name);
+	LilvNode* author_name = lilv_plugin_get_author_name(p);
+	info.creator = author_name ? string(lilv_node_as_string(author_name)) : "Unknown";
+	lilv_node_free(author_name);
 
-		info->path = "/NOPATH"; // Meaningless for LV2
+	info.path = "/NOPATH"; // Meaningless for LV2
 
-		/* count atom-event-ports that feature
-		 * atom:supports <http://lv2plug.in/ns/ext/midi#MidiEvent>
-		 *
-		 * TODO: nicely ask drobilla to make a lilv_ call for that
-		 */
-		int count_midi_out = 0;
-		int count_midi_in = 0;
-		for (uint32_t i = 0; i < lilv_plugin_get_num_ports(p); ++i) {
-			const LilvPort* port  = lilv_plugin_get_port_by_index(p, i);
-			if (lilv_port_is_a(p, port, world.atom_AtomPort)) {
-				LilvNodes* buffer_types = lilv_port_get_value(
-					p, port, world.atom_bufferType);
-				LilvNodes* atom_supports = lilv_port_get_value(
-					p, port, world.atom_supports);
-
-				if (lilv_nodes_contains(buffer_types, world.atom_Sequence)
-						&& lilv_nodes_contains(atom_supports, world.midi_MidiEvent)) {
-					if (lilv_port_is_a(p, port, world.lv2_InputPort)) {
-						count_midi_in++;
-					}
-					if (lilv_port_is_a(p, port, world.lv2_OutputPort)) {
-						count_midi_out++;
-					}
+	/* count atom-event-ports that feature
+	 * atom:supports <http://lv2plug.in/ns/ext/midi#MidiEvent>
+	 *
+	 * TODO: nicely ask drobilla to make a lilv_ call for that
+	 */
+	int count_midi_out = 0;
+	int count_midi_in = 0;
+	for (uint32_t i = 0; i < lilv_plugin_get_num_ports(p); ++i) {
+		const LilvPort* port  = lilv_plugin_get_port_by_index(p, i);
+		if (lilv_port_is_a(p, port, world.atom_AtomPort)) {
+			LilvNodes* buffer_types = lilv_port_get_value(
+				p, port, world.atom_bufferType);
+			LilvNodes* atom_supports = lilv_port_get_value(
+				p, port, world.atom_supports);
+
+			if (lilv_nodes_contains(buffer_types, world.atom_Sequence)
+					&& lilv_nodes_contains(atom_supports, world.midi_MidiEvent)) {
+				if (lilv_port_is_a(p, port, world.lv2_InputPort)) {
+					count_midi_in++;
+				}
+				if (lilv_port_is_a(p, port, world.lv2_OutputPort)) {
+					count_midi_out++;
 				}
-				lilv_nodes_free(buffer_types);
-				lilv_nodes_free(atom_supports);
 			}
+			lilv_nodes_free(buffer_types);
+			lilv_nodes_free(atom_supports);
 		}
+	}
 
-		info->n_inputs.set_audio(
-			lilv_plugin_get_num_ports_of_class(
-				p, world.lv2_InputPort, world.lv2_AudioPort, NULL));
-		info->n_inputs.set_midi(
-			lilv_plugin_get_num_ports_of_class(
-				p, world.lv2_InputPort, world.ev_EventPort, NULL)
-			+ count_midi_in);
+	info.n_inputs.set_audio(
+		lilv_plugin_get_num_ports_of_class(
+			p, world.lv2_InputPort, world.lv2_AudioPort, NULL));
+	info.n_inputs.set_midi(
+		lilv_plugin_get_num_ports_of_class(
+			p, world.lv2_InputPort, world.ev_EventPort, NULL)
+		+ count_midi_in);
 
-		info->n_outputs.set_audio(
-			lilv_plugin_get_num_ports_of_class(
-				p, world.lv2_OutputPort, world.lv2_AudioPort, NULL));
-		info->n_outputs.set_midi(
-			lilv_plugin_get_num_ports_of_class(
-				p, world.lv2_OutputPort, world.ev_EventPort, NULL)
-			+ count_midi_out);
+	info.n_outputs.set_audio(
+		lilv_plugin_get_num_ports_of_class(
+			p, world.lv2_OutputPort, world.lv2_AudioPort, NULL));
+	info.n_outputs.set_midi(
+		lilv_plugin_get_num_ports_of_class(
+			p, world.lv2_OutputPort, world.ev_EventPort, NULL)
+		+ count_midi_out);
 
-		info->unique_id = lilv_node_as_uri(lilv_plugin_get_uri(p));
-		info->index     = 0; // Meaningless for LV2
+	info.unique_id = lilv_node_as_uri(lilv_plugin_get_uri(p));
+	info.index     = 0; // Meaningless for LV2
+
+	plugins.push_back (info);
+}
 
-		plugs->push_back(info);
+/** Find all LV2 plugins.
+ *
+ * Loading the world only reads the manifests of all bundles. The data of
+ * a plugin (its name, ports etc) is only read here if the plugin is not
+ * in the cache, or any of its files changed since. Otherwise lilv loads
+ * it when the plugin is instantiated.
+ */
+PluginInfoList*
+LV2PluginInfo::discover()
+{
+	_world.load_new_bundles();
+
+	PluginInfoCache    cache (X_("lv2_cache"));
+	PluginInfoList*    plugs   = new PluginInfoList;
+	const LilvPlugins* plugins = lilv_world_get_all_plugins(_world.world);
+
+	LILV_FOREACH(plugins, i, plugins) {
+		const LilvPlugin* p = lilv_plugins_get(plugins, i);
+		const LilvNode* pun = lilv_plugin_get_uri(p);
+		if (!pun) continue;
+
+		string const uri    = lilv_node_as_uri(pun);
+		string const bundle = lv2_bundle_dir (p);
+		string const stamp  = PluginInfoCache::stamp (lv2_plugin_files (p, bundle));
+
+		PluginInfoCache::InfoList scanned;
+		PluginInfoCache::InfoList const * found = cache.lookup (uri, stamp);
+
+		if (!found) {
+			lv2_scan_plugin (_world, p, scanned);
+			/* the world still holds what the bundle was like when it
+			 * was loaded, do not cache that under its new stamp.
+			 */
+			if (!_world.bundle_changed (bundle)) {
+				cache.add (uri, stamp, scanned);
+			}
+			found = &scanned;
+		}
+
+		for (PluginInfoCache::InfoList::const_iterator f = found->begin(); f != found->end(); ++f) {
+			LV2PluginInfoPtr info(new LV2PluginInfo(uri.c_str()));
+			f->apply (*info);
+			info->type = LV2;
+			plugs->push_back(info);
+		}
 	}
 
+	cache.save ();
+
+	DEBUG_TRACE (DEBUG::PluginManager, string_compose ("LV2: %1 plugins from cache, %2 scanned\n", cache.hits (), cache.misses ()));
+
 	return plugs;
 }
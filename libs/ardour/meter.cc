@@ -29,7 +29,6 @@
 #include "ardour/midi_buffer.h"
 #include "ardour/session.h"
 #include "ardour/rc_configuration.h"
-#include "ardour/runtime_functions.h"
 
 using namespace std;
 
@@ -38,30 +37,21 @@ using namespace ARDOUR;
 PeakMeter::PeakMeter (Session& s, const std::string& name)
     : Processor (s, string_compose ("meter-%1", name))
 {
-	Kmeterdsp::init(s.nominal_frame_rate());
-	Iec1ppmdsp::init(s.nominal_frame_rate());
-	Iec2ppmdsp::init(s.nominal_frame_rate());
-	Vumeterdsp::init(s.nominal_frame_rate());
+	MultiMeterDSP::init(s.nominal_frame_rate());
 	_pending_active = true;
 	_meter_type = MeterPeak;
 	_reset_dpm = true;
 	_reset_max = true;
 	_bufcnt = 0;
 	_combined_peak = 0;
+	_snapshot_slot = MeterSnapshot::no_slot;
+	_snapshot_size = 0;
 }
 
 PeakMeter::~PeakMeter ()
 {
-	while (_kmeter.size() > 0) {
-		delete (_kmeter.back());
-		delete (_iec1meter.back());
-		delete (_iec2meter.back());
-		delete (_vumeter.back());
-		_kmeter.pop_back();
-		_iec1meter.pop_back();
-		_iec2meter.pop_back();
-		_vumeter.pop_back();
-	}
+	_session.meter_snapshot().release (_snapshot_slot);
+
 	while (_peak_power.size() > 0) {
 		_peak_buffer.pop_back();
 		_peak_power.pop_back();
@@ -100,6 +90,13 @@ PeakMeter::run (BufferSet& bufs, framepos_t /*start_frame*/, framepos_t /*end_fr
 	const uint32_t zoh = _session.nominal_frame_rate() * .021;
 	_bufcnt += nframes;
 
+	/* Audio peaks are integrated over zoh samples anyway, so there is
+	 * no need to convert them to dB and apply the falloff any more often
+	 * than that; it is still faster than any GUI redraws.
+	 */
+	const bool update_dB = _bufcnt > zoh;
+	const float period_falloff_dB = Config->get_meter_falloff() * _bufcnt / _session.nominal_frame_rate();
+
 	// Meter MIDI in to the first n_midi peaks
 	for (uint32_t i = 0; i < n_midi; ++i, ++n) {
 		float val = 0.0f;
@@ -134,16 +131,26 @@ PeakMeter::run (BufferSet& bufs, framepos_t /*start_frame*/, framepos_t /*end_fr
 		_max_peak_signal[n] = 0;
 	}
 
-	// Meter audio in to the rest of the peaks
-	for (uint32_t i = 0; i < n_audio; ++i, ++n) {
-		if (bufs.get_audio(i).silent()) {
-			_peak_buffer[n] = 0;
+	// Meter audio in to the rest of the peaks, all channels at once
+	const uint32_t n_meters = _meters.n_channels();
+
+	for (uint32_t i = 0; i < n_meters; ++i) {
+		if (i < n_audio && !bufs.get_audio(i).silent()) {
+			_audio_data[i] = bufs.get_audio(i).data();
 		} else {
-			_peak_buffer[n] = compute_peak (bufs.get_audio(i).data(), nframes, _peak_buffer[n]);
-			_peak_buffer[n] = std::min (_peak_buffer[n], 100.f); // cut off at +40dBFS for falloff.
-			_max_peak_signal[n] = std::max(_peak_buffer[n], _max_peak_signal[n]); // todo sync reset
-			_combined_peak = std::max(_peak_buffer[n], _combined_peak);
+			_audio_data[i] = 0;
+			_peak_buffer[n + i] = 0;
 		}
+	}
+
+	if (n_meters > 0) {
+		_meters.process (&_audio_data[0], nframes, _meter_type, &_peak_buffer[n]);
+	}
+
+	for (uint32_t i = 0; i < n_audio; ++i, ++n) {
+		_peak_buffer[n] = std::min (_peak_buffer[n], 100.f); // cut off at +40dBFS for falloff.
+		_max_peak_signal[n] = std::max(_peak_buffer[n], _max_peak_signal[n]); // todo sync reset
+		_combined_peak = std::max(_peak_buffer[n], _combined_peak);
 
 		if (do_reset_max) {
 			_max_peak_signal[n] = 0;
@@ -152,31 +159,16 @@ PeakMeter::run (BufferSet& bufs, framepos_t /*start_frame*/, framepos_t /*end_fr
 		if (do_reset_dpm) {
 			_peak_buffer[n] = 0;
 			_peak_power[n] = -std::numeric_limits<float>::infinity();
-		} else {
+		} else if (update_dB) {
 			// falloff
 			if (_peak_power[n] >  -318.8f) {
-				_peak_power[n] -= falloff_dB;
+				_peak_power[n] -= period_falloff_dB;
 			} else {
 				_peak_power[n] = -std::numeric_limits<float>::infinity();
 			}
 			_peak_power[n] = max(_peak_power[n], accurate_coefficient_to_dB(_peak_buffer[n]));
 			// integration buffer, retain peaks > 49Hz
-			if (_bufcnt > zoh) {
-				_peak_buffer[n] = 0;
-			}
-		}
-
-		if (_meter_type & (MeterKrms | MeterK20 | MeterK14 | MeterK12)) {
-			_kmeter[i]->process(bufs.get_audio(i).data(), nframes);
-		}
-		if (_meter_type & (MeterIEC1DIN | MeterIEC1NOR)) {
-			_iec1meter[i]->process(bufs.get_audio(i).data(), nframes);
-		}
-		if (_meter_type & (MeterIEC2BBC | MeterIEC2EBU)) {
-			_iec2meter[i]->process(bufs.get_audio(i).data(), nframes);
-		}
-		if (_meter_type & MeterVU) {
-			_vumeter[i]->process(bufs.get_audio(i).data(), nframes);
+			_peak_buffer[n] = 0;
 		}
 	}
 
@@ -186,13 +178,56 @@ PeakMeter::run (BufferSet& bufs, framepos_t /*start_frame*/, framepos_t /*end_fr
 		_max_peak_signal[n] = 0;
 	}
 
-	if (_bufcnt > zoh) {
+	if (update_dB) {
 		_bufcnt = 0;
 	}
 
+	write_snapshot (n_midi, n);
+
 	_active = _pending_active;
 }
 
+/** Publish the values computed in this cycle to the session's snapshot,
+ * for @param n channels of which the first @param n_midi are MIDI.
+ */
+void
+PeakMeter::write_snapshot (uint32_t n_midi, uint32_t n)
+{
+	MeterSnapshot& snapshot (_session.meter_snapshot());
+	MeterSnapshot::Channel* channels;
+	MeterSnapshot::Meter* m = snapshot.write (_snapshot_slot, channels);
+
+	if (!m) {
+		return;
+	}
+
+	n = min (n, _snapshot_size);
+
+	m->type = _meter_type;
+	m->n_midi = n_midi;
+	m->n_channels = n;
+	m->combined_peak = _combined_peak;
+
+	/* K, IEC and VU meters hold their maximum until read, so only start
+	 * a new period once every reader has seen the last one.
+	 */
+	const bool reset = snapshot.reset_levels ();
+
+	for (uint32_t i = 0; i < n; ++i) {
+		channels[i].peak = _peak_power[i];
+		channels[i].max_peak = _max_peak_signal[i];
+		channels[i].level = 0;
+
+		if (i < n_midi) {
+			continue;
+		}
+
+		const uint32_t a = i - n_midi;
+
+		channels[i].level = reset ? _meters.read (a, _meter_type) : _meters.peek (a, _meter_type);
+	}
+}
+
 void
 PeakMeter::reset ()
 {
@@ -206,12 +241,7 @@ PeakMeter::reset ()
 	}
 
 	// these are handled async just fine.
-	for (size_t n = 0; n < _kmeter.size(); ++n) {
-		_kmeter[n]->reset();
-		_iec1meter[n]->reset();
-		_iec2meter[n]->reset();
-		_vumeter[n]->reset();
-	}
+	_meters.reset (~0);
 }
 
 void
@@ -294,26 +324,15 @@ PeakMeter::set_max_channels (const ChanCount& chn)
 	assert(_max_peak_signal.size() == limit);
 
 	/* alloc/free other audio-only meter types. */
-	while (_kmeter.size() > n_audio) {
-		delete (_kmeter.back());
-		delete (_iec1meter.back());
-		delete (_iec2meter.back());
-		delete (_vumeter.back());
-		_kmeter.pop_back();
-		_iec1meter.pop_back();
-		_iec2meter.pop_back();
-		_vumeter.pop_back();
+	_meters.set_channels (n_audio);
+	_audio_data.resize (n_audio, 0);
+
+	if (_snapshot_slot == MeterSnapshot::no_slot || _snapshot_size != limit) {
+		MeterSnapshot& snapshot (_session.meter_snapshot());
+		snapshot.release (_snapshot_slot);
+		_snapshot_slot = snapshot.allocate (limit);
+		_snapshot_size = limit;
 	}
-	while (_kmeter.size() < n_audio) {
-		_kmeter.push_back(new Kmeterdsp());
-		_iec1meter.push_back(new Iec1ppmdsp());
-		_iec2meter.push_back(new Iec2ppmdsp());
-		_vumeter.push_back(new Vumeterdsp());
-	}
-	assert(_kmeter.size() == n_audio);
-	assert(_iec1meter.size() == n_audio);
-	assert(_iec2meter.size() == n_audio);
-	assert(_vumeter.size() == n_audio);
 
 	reset();
 	reset_max();
@@ -324,8 +343,6 @@ PeakMeter::set_max_channels (const ChanCount& chn)
  * of meter size during this call.
  */
 
-#define CHECKSIZE(MTR) (n < MTR.size() + n_midi && n >= n_midi)
-
 float
 PeakMeter::meter_level(uint32_t n, MeterType type) {
 	float mcptmp;
@@ -334,36 +351,15 @@ PeakMeter::meter_level(uint32_t n, MeterType type) {
 		case MeterK20:
 		case MeterK14:
 		case MeterK12:
-			{
-				const uint32_t n_midi = current_meters.n_midi();
-				if (CHECKSIZE(_kmeter)) {
-					return accurate_coefficient_to_dB (_kmeter[n - n_midi]->read());
-				}
-			}
-			break;
 		case MeterIEC1DIN:
 		case MeterIEC1NOR:
-			{
-				const uint32_t n_midi = current_meters.n_midi();
-				if (CHECKSIZE(_iec1meter)) {
-					return accurate_coefficient_to_dB (_iec1meter[n - n_midi]->read());
-				}
-			}
-			break;
 		case MeterIEC2BBC:
 		case MeterIEC2EBU:
-			{
-				const uint32_t n_midi = current_meters.n_midi();
-				if (CHECKSIZE(_iec2meter)) {
-					return accurate_coefficient_to_dB (_iec2meter[n - n_midi]->read());
-				}
-			}
-			break;
 		case MeterVU:
 			{
 				const uint32_t n_midi = current_meters.n_midi();
-				if (CHECKSIZE(_vumeter)) {
-					return accurate_coefficient_to_dB (_vumeter[n - n_midi]->read());
+				if (n < _meters.n_channels() + n_midi && n >= n_midi) {
+					return accurate_coefficient_to_dB (_meters.read (n - n_midi, type));
 				}
 			}
 			break;
@@ -398,30 +394,7 @@ PeakMeter::set_type(MeterType t)
 
 	_meter_type = t;
 
-	if (t & (MeterKrms | MeterK20 | MeterK14 | MeterK12)) {
-		const size_t n_audio = current_meters.n_audio();
-		for (size_t n = 0; n < n_audio; ++n) {
-			_kmeter[n]->reset();
-		}
-	}
-	if (t & (MeterIEC1DIN | MeterIEC1NOR)) {
-		const size_t n_audio = current_meters.n_audio();
-		for (size_t n = 0; n < n_audio; ++n) {
-			_iec1meter[n]->reset();
-		}
-	}
-	if (t & (MeterIEC2BBC | MeterIEC2EBU)) {
-		const size_t n_audio = current_meters.n_audio();
-		for (size_t n = 0; n < n_audio; ++n) {
-			_iec2meter[n]->reset();
-		}
-	}
-	if (t & MeterVU) {
-		const size_t n_audio = current_meters.n_audio();
-		for (size_t n = 0; n < n_audio; ++n) {
-			_vumeter[n]->reset();
-		}
-	}
+	_meters.reset (t);
 
 	TypeChanged(t);
 }
@@ -0,0 +1,391 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+    for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include <cstring>
+#include <limits>
+
+#include "pbd/fastlog.h"
+
+#include "ardour/dB.h"
+#include "ardour/meter_snapshot.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+const MeterSnapshot::Slot MeterSnapshot::no_slot;
+Glib::Threads::Mutex MeterSnapshot::reader_lock;
+
+/** @return which of the meter DSP classes computes @param t, or 0 for
+ *  the types computed from plain peaks.
+ */
+static int
+meter_dsp (MeterType t)
+{
+	switch (t) {
+	case MeterKrms:
+	case MeterK20:
+	case MeterK14:
+	case MeterK12:
+		return 1;
+	case MeterIEC1DIN:
+	case MeterIEC1NOR:
+		return 2;
+	case MeterIEC2BBC:
+	case MeterIEC2EBU:
+		return 3;
+	case MeterVU:
+		return 4;
+	default:
+		break;
+	}
+	return 0;
+}
+
+static void
+clear_channels (MeterSnapshot::Channel* c, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; ++i) {
+		c[i].peak = -std::numeric_limits<float>::infinity();
+		c[i].max_peak = 0;
+		c[i].level = 0;
+	}
+}
+
+MeterSnapshot::MeterSnapshot (uint32_t max_meters, uint32_t max_channels)
+	: _max_meters (max_meters)
+	, _max_channels (max_channels)
+	, _n_slots (0)
+	, _n_channels (0)
+	, _sequence (0)
+	, _cycle (0)
+	, _consumers (0)
+	, _consumed (0)
+	, _reset_levels (false)
+{
+	for (uint32_t b = 0; b < n_buffers; ++b) {
+		_meters[b] = new Meter[_max_meters];
+		memset (_meters[b], 0, sizeof (Meter) * _max_meters);
+		_channels[b] = new Channel[_max_channels];
+		clear_channels (_channels[b], _max_channels);
+	}
+
+	_slots = new SlotInfo[_max_meters];
+	memset (_slots, 0, sizeof (SlotInfo) * _max_meters);
+
+	_written = new uint32_t[_max_meters];
+	memset (_written, 0, sizeof (uint32_t) * _max_meters);
+}
+
+MeterSnapshot::~MeterSnapshot ()
+{
+	{
+		Glib::Threads::Mutex::Lock lm (reader_lock);
+		for (std::set<Reader*>::iterator r = _readers.begin(); r != _readers.end(); ++r) {
+			(*r)->_snapshot = 0;
+			(*r)->_consumer = 0;
+		}
+	}
+
+	for (uint32_t b = 0; b < n_buffers; ++b) {
+		delete [] _meters[b];
+		delete [] _channels[b];
+	}
+
+	delete [] _slots;
+	delete [] _written;
+}
+
+MeterSnapshot::Slot
+MeterSnapshot::allocate (uint32_t n_channels)
+{
+	Glib::Threads::Mutex::Lock lm (_layout_lock);
+
+	int32_t const n_slots = g_atomic_int_get (&_n_slots);
+	uint32_t const n_used = g_atomic_int_get (&_n_channels);
+
+	/* first fit: re-use a released slot that is big enough ... */
+
+	Slot slot = no_slot;
+
+	for (int32_t s = 0; s < n_slots; ++s) {
+		if (!_slots[s].used && _slots[s].size >= n_channels) {
+			slot = s;
+			break;
+		}
+	}
+
+	/* ... or add a new one */
+
+	if (slot == no_slot) {
+		if ((uint32_t) n_slots >= _max_meters || n_used + n_channels > _max_channels) {
+			return no_slot;
+		}
+		slot = n_slots;
+		_slots[slot].offset = n_used;
+		_slots[slot].size = n_channels;
+	}
+
+	for (uint32_t b = 0; b < n_buffers; ++b) {
+		Meter& m (_meters[b][slot]);
+		m.type = MeterPeak;
+		m.n_midi = 0;
+		m.n_channels = 0;
+		m.combined_peak = 0;
+		clear_channels (_channels[b] + _slots[slot].offset, _slots[slot].size);
+	}
+
+	_slots[slot].used = true;
+
+	if (slot == n_slots) {
+		g_atomic_int_set (&_n_channels, n_used + n_channels);
+		g_atomic_int_set (&_n_slots, n_slots + 1);
+	}
+
+	return slot;
+}
+
+void
+MeterSnapshot::release (Slot slot)
+{
+	if (slot == no_slot) {
+		return;
+	}
+
+	Glib::Threads::Mutex::Lock lm (_layout_lock);
+	_slots[slot].used = false;
+}
+
+MeterSnapshot::Meter*
+MeterSnapshot::write (Slot slot, Channel*& channels)
+{
+	if (slot == no_slot || !_slots[slot].used) {
+		return 0;
+	}
+
+	uint32_t const b = write_buffer ();
+
+	_written[slot] = _cycle + 1;
+	channels = _channels[b] + _slots[slot].offset;
+	return &_meters[b][slot];
+}
+
+void
+MeterSnapshot::publish ()
+{
+	uint32_t const b = write_buffer ();
+	uint32_t const prev = _cycle % n_buffers;
+	int32_t const n_slots = g_atomic_int_get (&_n_slots);
+
+	/* carry over meters that did not run in this cycle, so that readers
+	 * see their last values rather than whatever was left in this buffer
+	 * from an earlier cycle.
+	 */
+
+	for (int32_t s = 0; s < n_slots; ++s) {
+		if (_written[s] != _cycle + 1 && _slots[s].used) {
+			_meters[b][s] = _meters[prev][s];
+			memcpy (_channels[b] + _slots[s].offset, _channels[prev] + _slots[s].offset, sizeof (Channel) * _slots[s].size);
+		}
+	}
+
+	++_cycle;
+	g_atomic_int_set (&_sequence, _cycle);
+
+	/* start a new period once every reader has seen this one. A reader
+	 * which takes a copy between these two steps is simply counted in
+	 * the next period, too.
+	 */
+	gint const consumers = g_atomic_int_get (&_consumers);
+
+	/* without readers the levels belong to PeakMeter::meter_level()
+	 * callers, which must not be reset from here.
+	 */
+	_reset_levels = consumers != 0 && (g_atomic_int_get (&_consumed) & consumers) == consumers;
+
+	if (_reset_levels) {
+		g_atomic_int_and ((guint*) &_consumed, ~consumers);
+	}
+}
+
+MeterSnapshot::Reader::Reader ()
+	: _sequence (0)
+	, _when (0)
+	, _snapshot (0)
+	, _consumer (0)
+{
+}
+
+MeterSnapshot::Reader::~Reader ()
+{
+	detach ();
+}
+
+void
+MeterSnapshot::Reader::attach (MeterSnapshot const & s)
+{
+	detach ();
+
+	_meters.clear ();
+	_offsets.clear ();
+	_channels.clear ();
+	_sequence = 0;
+	_when = 0;
+
+	Glib::Threads::Mutex::Lock lm (reader_lock);
+
+	_snapshot = &s;
+	s._readers.insert (this);
+
+	/* take a free consumer bit; beyond 32 readers, the others do not
+	 * hold back new periods.
+	 */
+	gint const used = g_atomic_int_get (&s._consumers);
+
+	for (gint b = 0; b < 32; ++b) {
+		if (!(used & (1 << b))) {
+			_consumer = 1 << b;
+			g_atomic_int_and ((guint*) &s._consumed, ~_consumer);
+			g_atomic_int_or ((guint*) &s._consumers, _consumer);
+			break;
+		}
+	}
+}
+
+void
+MeterSnapshot::Reader::detach ()
+{
+	Glib::Threads::Mutex::Lock lm (reader_lock);
+
+	if (!_snapshot) {
+		return;
+	}
+
+	g_atomic_int_and ((guint*) &_snapshot->_consumers, ~_consumer);
+	_snapshot->_readers.erase (this);
+	_snapshot = 0;
+	_consumer = 0;
+}
+
+bool
+MeterSnapshot::Reader::update (MeterSnapshot const & s, int64_t max_age)
+{
+	if (_snapshot != &s) {
+		attach (s);
+	}
+
+	gint seq = g_atomic_int_get (&s._sequence);
+
+	if (seq == 0 || seq == _sequence) {
+		return false;
+	}
+
+	int64_t const now = g_get_monotonic_time ();
+
+	if (max_age > 0 && _when > 0 && now - _when < max_age) {
+		return false;
+	}
+
+	/* the process thread is writing the buffer after the latest one, so
+	 * the copy is good unless it has published n_buffers - 1 times since
+	 * we started.
+	 */
+
+	for (int tries = 0; tries < 4; ++tries) {
+
+		seq = g_atomic_int_get (&s._sequence);
+
+		uint32_t const b = seq % n_buffers;
+		int32_t const n_slots = g_atomic_int_get (&s._n_slots);
+		int32_t const n_channels = g_atomic_int_get (&s._n_channels);
+
+		_meters.assign (s._meters[b], s._meters[b] + n_slots);
+		_channels.assign (s._channels[b], s._channels[b] + n_channels);
+
+		_offsets.resize (n_slots);
+		for (int32_t i = 0; i < n_slots; ++i) {
+			_offsets[i] = s._slots[i].offset;
+		}
+
+		if ((uint32_t) (g_atomic_int_get (&s._sequence) - seq) < n_buffers - 1) {
+			_sequence = seq;
+			_when = now;
+			g_atomic_int_or ((guint*) &s._consumed, _consumer);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+MeterSnapshot::Meter const *
+MeterSnapshot::Reader::meter (Slot slot) const
+{
+	if (slot == no_slot || slot >= (Slot) _meters.size()) {
+		return 0;
+	}
+	return &_meters[slot];
+}
+
+MeterSnapshot::Channel const *
+MeterSnapshot::Reader::channels (Slot slot) const
+{
+	if (slot == no_slot || slot >= (Slot) _meters.size()) {
+		return 0;
+	}
+	return &_channels[_offsets[slot]];
+}
+
+float
+MeterSnapshot::Reader::level (Slot slot, uint32_t n, MeterType type) const
+{
+	Meter const * m = meter (slot);
+
+	if (!m || n >= m->n_channels) {
+		return minus_infinity ();
+	}
+
+	Channel const & c (_channels[_offsets[slot] + n]);
+
+	switch (type) {
+	case MeterKrms:
+	case MeterK20:
+	case MeterK14:
+	case MeterK12:
+	case MeterIEC1DIN:
+	case MeterIEC1NOR:
+	case MeterIEC2BBC:
+	case MeterIEC2EBU:
+	case MeterVU:
+		if (n < m->n_midi || meter_dsp (type) != meter_dsp (m->type)) {
+			return minus_infinity ();
+		}
+		return accurate_coefficient_to_dB (c.level);
+	case MeterPeak:
+	case MeterPeak0dB:
+		return c.peak;
+	case MeterMCP:
+		return accurate_coefficient_to_dB (m->combined_peak);
+	case MeterMaxSignal:
+		break;
+	default:
+	case MeterMaxPeak:
+		return accurate_coefficient_to_dB (c.max_peak);
+	}
+
+	return minus_infinity ();
+}
@@ -17,8 +17,13 @@
     675 Mass Ave, Cambridge, MA 02139, USA.
 */
 
+#include <cstdlib>
 #include <iostream>
 
+#ifdef COMPILER_MSVC
+#include <malloc.h>
+#endif
+
 #include "pbd/malign.h"
 #include "pbd/compose.h"
 #include "pbd/debug.h"
@@ -601,3 +606,141 @@ MidiBuffer::merge_in_place (const MidiBuffer &other)
 
 	return true;
 }
+
+namespace {
+
+/** The next event of one of the buffers merged by MidiBuffer::merge_from() */
+struct MergeSource {
+	uint8_t const * data;
+	size_t size;
+	size_t offset;
+	size_t index;
+	MidiBuffer::TimeType time;
+	int rank;
+
+	void read () {
+		const uint8_t status = data[offset + sizeof (MidiBuffer::TimeType)];
+
+		time = *(reinterpret_cast<MidiBuffer::TimeType const *>((uintptr_t)(data + offset)));
+
+		/* the order of simultaneous events on one channel, as in
+		 * MidiBuffer::second_simultaneous_midi_byte_is_first()
+		 */
+		switch (status >= 0xf0 ? 0 : status & 0xf0) {
+		case MIDI_CMD_PGM_CHANGE:       rank = 1; break;
+		case MIDI_CMD_NOTE_OFF:         rank = 2; break;
+		case MIDI_CMD_NOTE_ON:          rank = 3; break;
+		case MIDI_CMD_NOTE_PRESSURE:    rank = 4; break;
+		case MIDI_CMD_CHANNEL_PRESSURE: rank = 5; break;
+		case MIDI_CMD_BENDER:           rank = 6; break;
+		default:                        rank = 0; break;
+		}
+	}
+
+	bool before (MergeSource const & other) const {
+		if (time != other.time) {
+			return time < other.time;
+		}
+		if (rank != other.rank) {
+			return rank < other.rank;
+		}
+		return index < other.index;
+	}
+};
+
+/** Restore the heap order of @a heap below @a i */
+void
+merge_sift_down (MergeSource** heap, size_t n, size_t i)
+{
+	MergeSource* s = heap[i];
+
+	while (true) {
+		size_t child = 2 * i + 1;
+		if (child >= n) {
+			break;
+		}
+		if (child + 1 < n && heap[child + 1]->before (*heap[child])) {
+			++child;
+		}
+		if (!heap[child]->before (*s)) {
+			break;
+		}
+		heap[i] = heap[child];
+		i = child;
+	}
+
+	heap[i] = s;
+}
+
+} // anonymous namespace
+
+/** Replace the contents of this buffer with the events of all @a sources,
+ * merged in time order in a single pass. Simultaneous events are ordered by
+ * type as described for second_simultaneous_midi_byte_is_first(), otherwise
+ * they keep the order of @a sources. This buffer must not be one of the
+ * sources. Realtime safe.
+ *
+ * @return false if not all events fit; the ones that did are kept.
+ */
+bool
+MidiBuffer::merge_from (std::vector<MidiBuffer const *> const & sources)
+{
+	/* a heap of the sources that still have events, earliest event
+	 * first. There are only ever a few sources, and this must not
+	 * allocate.
+	 */
+	const size_t n_sources = sources.size ();
+	MergeSource* state = (MergeSource*) alloca (n_sources * sizeof (MergeSource));
+	MergeSource** heap = (MergeSource**) alloca (n_sources * sizeof (MergeSource*));
+	size_t n_active = 0;
+
+	for (size_t i = 0; i < n_sources; ++i) {
+		assert (sources[i] != this);
+		if (sources[i]->size ()) {
+			MergeSource& s (state[n_active]);
+			s.data = sources[i]->_data;
+			s.size = sources[i]->size ();
+			s.offset = 0;
+			s.index = i;
+			s.read ();
+			heap[n_active] = &s;
+			++n_active;
+		}
+	}
+
+	for (size_t i = n_active / 2; i > 0; --i) {
+		merge_sift_down (heap, n_active, i - 1);
+	}
+
+	_size = 0;
+
+	while (n_active) {
+
+		MergeSource& s (*heap[0]);
+		const int event_size = Evoral::midi_event_size (s.data + s.offset + sizeof (TimeType));
+		assert (event_size >= 0);
+		const size_t bytes = sizeof (TimeType) + event_size;
+
+		if (_size + bytes > _capacity) {
+			_silent = (_size == 0);
+			return false;
+		}
+
+		memcpy (_data + _size, s.data + s.offset, bytes);
+		_size += bytes;
+		s.offset += bytes;
+
+		if (s.offset < s.size) {
+			s.read ();
+		} else {
+			heap[0] = heap[--n_active];
+		}
+
+		if (n_active) {
+			merge_sift_down (heap, n_active, 0);
+		}
+	}
+
+	_silent = (_size == 0);
+	return true;
+}
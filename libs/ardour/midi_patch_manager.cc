@@ -18,13 +18,22 @@
     $Id$
 */
 
+#include <set>
+
 #include <boost/shared_ptr.hpp>
 
 #include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
 
+#include "pbd/compose.h"
+#include "pbd/convert.h"
 #include "pbd/file_utils.h"
 #include "pbd/error.h"
+#include "pbd/gstdio_compat.h"
+#include "pbd/pthread_utils.h"
+#include "pbd/xml++.h"
 
+#include "ardour/filesystem_paths.h"
 #include "ardour/midi_patch_manager.h"
 
 #include "ardour/search_paths.h"
@@ -40,32 +49,348 @@ using namespace PBD;
 MidiPatchManager* MidiPatchManager::_manager = 0;
 
 MidiPatchManager::MidiPatchManager ()
+	: _scanner (0)
+	, _scanning (false)
+	, _file_index_loaded (false)
+	, _file_index_dirty (false)
 {
 	add_search_path(midi_patch_search_path ());
 }
 
+MidiPatchManager::~MidiPatchManager ()
+{
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
+		_scan_queue.clear ();
+	}
+	if (_scanner) {
+		_scanner->join ();
+	}
+	_manager = 0;
+}
+
+/** Queue the directories of @param search_path to be scanned for .midnam files.
+ *
+ * Scanning happens in a background thread, which only looks at the model
+ * names and other metadata of each file (taken from the on-disk index if
+ * the file has not changed since it was last seen). Documents are parsed
+ * on demand by ::document_by_model().
+ */
 void
 MidiPatchManager::add_search_path (const Searchpath& search_path)
 {
-	for (Searchpath::const_iterator i = search_path.begin(); i != search_path.end(); ++i) {
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
 
-		if (_search_path.contains(*i)) {
-			// already processed files from this path
-			continue;
+		for (Searchpath::const_iterator i = search_path.begin(); i != search_path.end(); ++i) {
+
+			if (_search_path.contains(*i)) {
+				// already processed files from this path
+				continue;
+			}
+
+			if (!Glib::file_test (*i, Glib::FILE_TEST_EXISTS)) {
+				continue;
+			}
+
+			if (!Glib::file_test (*i, Glib::FILE_TEST_IS_DIR)) {
+				continue;
+			}
+
+			_scan_queue.push_back (*i);
+
+			_search_path.add_directory (*i);
+		}
+
+		if (_scan_queue.empty () || _scanning) {
+			/* nothing to do, or the scanner will pick it up */
+			return;
 		}
 
-		if (!Glib::file_test (*i, Glib::FILE_TEST_EXISTS)) {
+		_scanning = true;
+	}
+
+	if (_scanner) {
+		/* it is done, or about to return */
+		_scanner->join ();
+	}
+
+	_scanner = Glib::Threads::Thread::create (sigc::mem_fun (*this, &MidiPatchManager::scan_thread));
+}
+
+void
+MidiPatchManager::wait_for_scan ()
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+	while (_scanning) {
+		_scan_cond.wait (_lock);
+	}
+}
+
+void
+MidiPatchManager::scan_thread ()
+{
+	pthread_set_name (X_("midnam-scanner"));
+
+	if (!_file_index_loaded) {
+		load_index ();
+	}
+
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	while (!_scan_queue.empty ()) {
+		std::string const directory_path = _scan_queue.front ();
+		_scan_queue.pop_front ();
+
+		lm.release ();
+		scan_directory (directory_path);
+		lm.acquire ();
+
+		if (_scan_queue.empty ()) {
+			lm.release ();
+			save_index ();
+			lm.acquire ();
+		}
+	}
+
+	_scanning = false;
+	_scan_cond.broadcast ();
+}
+
+/** Scanner thread */
+void
+MidiPatchManager::scan_directory (const std::string& directory_path)
+{
+	vector<std::string> result;
+	find_files_matching_pattern (result, directory_path, "*.midnam");
+
+	info << string_compose(
+			P_("Loading %1 MIDI patch from %2", "Loading %1 MIDI patches from %2", result.size()),
+			result.size(), directory_path)
+	     << endmsg;
+
+	vector<FileIndex::const_iterator> files;
+	std::set<std::string> found;
+
+	for (vector<std::string>::const_iterator i = result.begin(); i != result.end(); ++i) {
+		GStatBuf sb;
+		if (g_stat (i->c_str(), &sb)) {
 			continue;
 		}
 
-		if (!Glib::file_test (*i, Glib::FILE_TEST_IS_DIR)) {
+		found.insert (*i);
+
+		FileIndex::iterator f = _file_index.find (*i);
+
+		if (f == _file_index.end () || f->second.mtime != (int64_t) sb.st_mtime || f->second.size != (int64_t) sb.st_size) {
+			FileInfo fi;
+			fi.mtime = sb.st_mtime;
+			fi.size = sb.st_size;
+
+			if (!scan_midi_name_file (*i, fi)) {
+				error << string_compose(_("Error parsing MIDI patch file %1"), *i)
+				      << endmsg;
+				if (f != _file_index.end ()) {
+					_file_index.erase (f);
+					_file_index_dirty = true;
+				}
+				continue;
+			}
+
+			_file_index[*i] = fi;
+			_file_index_dirty = true;
+			f = _file_index.find (*i);
+
+			/* it may parse now */
+			Glib::Threads::Mutex::Lock lm (_lock);
+			_unparsable_files.erase (*i);
+		}
+
+		files.push_back (f);
+	}
+
+	/* forget about files which have been removed */
+	for (FileIndex::iterator f = _file_index.begin (); f != _file_index.end ();) {
+		if (Glib::path_get_dirname (f->first) == directory_path && found.find (f->first) == found.end ()) {
+			_file_index.erase (f++);
+			_file_index_dirty = true;
+		} else {
+			++f;
+		}
+	}
+
+	bool added = false;
+
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
+
+		if (_search_path.contains (directory_path)) {
+			for (vector<FileIndex::const_iterator>::const_iterator f = files.begin(); f != files.end(); ++f) {
+				for (ModelIndex::const_iterator m = (*f)->second.models.begin(); m != (*f)->second.models.end(); ++m) {
+					added |= add_model (m->first, m->second);
+				}
+			}
+		} /* else it was removed while we were busy */
+	}
+
+	if (added) {
+		PatchesChanged(); /* EMIT SIGNAL */
+	}
+}
+
+/** Get the models, manufacturer and custom device modes of the .midnam
+ * file @param file_path without building its MIDINameDocument.
+ * This mirrors MasterDeviceNames::set_state().
+ */
+bool
+MidiPatchManager::scan_midi_name_file (const std::string& file_path, FileInfo& fi)
+{
+	XMLTree tree;
+	if (!tree.read (file_path)) {
+		return false;
+	}
+
+	boost::shared_ptr<XMLSharedNodeList> manufacturer = tree.find ("//Manufacturer");
+	boost::shared_ptr<XMLSharedNodeList> models = tree.find ("//Model");
+
+	if (manufacturer->size () != 1 || manufacturer->front()->children().empty () || models->empty ()) {
+		return false;
+	}
+
+	ModelInfo mi;
+	mi.file_path = file_path;
+	mi.manufacturer = manufacturer->front()->children().front()->content();
+
+	boost::shared_ptr<XMLSharedNodeList> custom_device_modes = tree.find ("//CustomDeviceMode");
+	for (XMLSharedNodeList::const_iterator i = custom_device_modes->begin(); i != custom_device_modes->end(); ++i) {
+		XMLProperty const * prop = (*i)->property ("Name");
+		if (prop) {
+			mi.custom_device_modes.push_back (prop->value ());
+		}
+	}
+
+	for (XMLSharedNodeList::const_iterator i = models->begin(); i != models->end(); ++i) {
+		if ((*i)->children().size () != 1 || !(*i)->children().front()->is_content ()) {
+			return false;
+		}
+		fi.models[(*i)->children().front()->content()] = mi;
+	}
+
+	return true;
+}
+
+std::string
+MidiPatchManager::index_path ()
+{
+	return Glib::build_filename (ARDOUR::user_cache_directory (), "midnam_index");
+}
+
+/** Scanner thread */
+void
+MidiPatchManager::load_index ()
+{
+	_file_index_loaded = true;
+
+	std::string const path = index_path ();
+
+	if (!Glib::file_test (path, Glib::FILE_TEST_EXISTS)) {
+		return;
+	}
+
+	XMLTree tree;
+	if (!tree.read (path) || !tree.root () || tree.root()->name () != X_("MidnamIndex")) {
+		warning << string_compose (_("Ignoring invalid MIDI patch index %1"), path) << endmsg;
+		return;
+	}
+
+	XMLProperty const * prop = tree.root()->property ("version");
+	if (!prop || prop->value () != X_("1")) {
+		return;
+	}
+
+	XMLNodeList const & files = tree.root()->children ();
+
+	for (XMLNodeConstIterator i = files.begin(); i != files.end(); ++i) {
+		XMLProperty const * file_path = (*i)->property ("path");
+		XMLProperty const * mtime = (*i)->property ("mtime");
+		XMLProperty const * size = (*i)->property ("size");
+
+		if ((*i)->name () != X_("File") || !file_path || !mtime || !size) {
 			continue;
 		}
 
-		add_midnam_files_from_directory (*i);
+		FileInfo fi;
+		fi.mtime = PBD::atoll (mtime->value ());
+		fi.size = PBD::atoll (size->value ());
+
+		XMLNodeList const & devices = (*i)->children ();
+
+		for (XMLNodeConstIterator d = devices.begin(); d != devices.end(); ++d) {
+			XMLProperty const * model = (*d)->property ("model");
+			XMLProperty const * manufacturer = (*d)->property ("manufacturer");
+
+			if (!model || !manufacturer) {
+				continue;
+			}
+
+			ModelInfo mi;
+			mi.file_path = file_path->value ();
+			mi.manufacturer = manufacturer->value ();
+
+			XMLNodeList const & modes = (*d)->children ();
+			for (XMLNodeConstIterator m = modes.begin(); m != modes.end(); ++m) {
+				if ((prop = (*m)->property ("name")) != 0) {
+					mi.custom_device_modes.push_back (prop->value ());
+				}
+			}
+
+			fi.models[model->value ()] = mi;
+		}
+
+		if (!fi.models.empty ()) {
+			_file_index[file_path->value ()] = fi;
+		}
+	}
+}
+
+/** Scanner thread */
+void
+MidiPatchManager::save_index ()
+{
+	if (!_file_index_dirty) {
+		return;
+	}
+
+	XMLNode* root = new XMLNode (X_("MidnamIndex"));
+	root->add_property ("version", X_("1"));
+
+	for (FileIndex::const_iterator i = _file_index.begin(); i != _file_index.end(); ++i) {
+		XMLNode* file = root->add_child (X_("File"));
+		file->add_property ("path", i->first);
+		file->add_property ("mtime", string_compose ("%1", i->second.mtime));
+		file->add_property ("size", string_compose ("%1", i->second.size));
 
-		_search_path.add_directory (*i);
+		for (ModelIndex::const_iterator m = i->second.models.begin(); m != i->second.models.end(); ++m) {
+			XMLNode* device = file->add_child (X_("Device"));
+			device->add_property ("model", m->first);
+			device->add_property ("manufacturer", m->second.manufacturer);
+
+			for (MasterDeviceNames::CustomDeviceModeNames::const_iterator n = m->second.custom_device_modes.begin();
+			     n != m->second.custom_device_modes.end(); ++n) {
+				device->add_child (X_("CustomDeviceMode"))->add_property ("name", *n);
+			}
+		}
 	}
+
+	XMLTree tree;
+	tree.set_root (root);
+
+	if (!tree.write (index_path ())) {
+		warning << string_compose (_("Could not write MIDI patch index %1"), index_path ()) << endmsg;
+		return;
+	}
+
+	_file_index_dirty = false;
 }
 
 bool
@@ -97,34 +422,23 @@ MidiPatchManager::update_custom_midnam (const std::string& id, const std::string
 	return add_custom_midnam (id, midnam);
 }
 
-void
-MidiPatchManager::add_midnam_files_from_directory(const std::string& directory_path)
-{
-	vector<std::string> result;
-	find_files_matching_pattern (result, directory_path, "*.midnam");
-
-	info << string_compose(
-			P_("Loading %1 MIDI patch from %2", "Loading %1 MIDI patches from %2", result.size()),
-			result.size(), directory_path)
-	     << endmsg;
-
-	for (vector<std::string>::const_iterator i = result.begin(); i != result.end(); ++i) {
-		load_midi_name_document (*i);
-	}
-}
-
 void
 MidiPatchManager::remove_search_path (const Searchpath& search_path)
 {
 	for (Searchpath::const_iterator i = search_path.begin(); i != search_path.end(); ++i) {
 
-		if (!_search_path.contains(*i)) {
-			continue;
+		{
+			Glib::Threads::Mutex::Lock lm (_lock);
+
+			if (!_search_path.contains(*i)) {
+				continue;
+			}
+
+			_search_path.remove_directory (*i);
+			_scan_queue.remove (*i);
 		}
 
 		remove_midnam_files_from_directory(*i);
-
-		_search_path.remove_directory (*i);
 	}
 }
 
@@ -144,7 +458,10 @@ MidiPatchManager::remove_midnam_files_from_directory(const std::string& director
 	}
 }
 
-bool
+/** Parse @param file_path and share the document between all of its
+ * models. Caller must not hold _lock, files are parsed without it.
+ */
+boost::shared_ptr<MIDINameDocument>
 MidiPatchManager::load_midi_name_document (const std::string& file_path)
 {
 	boost::shared_ptr<MIDINameDocument> document;
@@ -154,53 +471,138 @@ MidiPatchManager::load_midi_name_document (const std::string& file_path)
 	catch (...) {
 		error << string_compose(_("Error parsing MIDI patch file %1"), file_path)
 		      << endmsg;
-		return false;
+		/* do not try again on every lookup, only once the file changed */
+		Glib::Threads::Mutex::Lock lm (_lock);
+		_unparsable_files.insert (file_path);
+		return boost::shared_ptr<MIDINameDocument> ();
 	}
-	return add_midi_name_document (document);
+
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	for (ModelIndex::const_iterator m = _models.begin(); m != _models.end(); ++m) {
+		if (m->second.file_path != file_path) {
+			continue;
+		}
+		/* another thread may have been quicker */
+		MidiNameDocuments::const_iterator d = _documents.find (m->first);
+		if (d != _documents.end ()) {
+			document = d->second;
+		} else {
+			_documents[m->first] = document;
+		}
+	}
+
+	return document;
 }
 
 boost::shared_ptr<MIDINameDocument>
-MidiPatchManager::document_by_model(std::string model_name) const
+MidiPatchManager::document_by_model(std::string model_name)
+{
+	std::string file_path;
+
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
+
+		MidiNameDocuments::const_iterator i = _documents.find (model_name);
+		if (i != _documents.end ()) {
+			return i->second;
+		}
+
+		ModelIndex::const_iterator m = _models.find (model_name);
+		if (m == _models.end () || _unparsable_files.find (m->second.file_path) != _unparsable_files.end ()) {
+			/* unknown (perhaps not scanned yet), or broken */
+			return boost::shared_ptr<MIDINameDocument> ();
+		}
+
+		file_path = m->second.file_path;
+	}
+
+	return load_midi_name_document (file_path);
+}
+
+boost::shared_ptr<MasterDeviceNames>
+MidiPatchManager::master_device_by_model(std::string model_name)
+{
+	boost::shared_ptr<MIDINameDocument> document = document_by_model (model_name);
+	if (document) {
+		return document->master_device_names (model_name);
+	}
+	return boost::shared_ptr<MasterDeviceNames> ();
+}
+
+MasterDeviceNames::CustomDeviceModeNames
+MidiPatchManager::custom_device_mode_names_by_model(std::string model_name)
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	ModelIndex::const_iterator m = _models.find (model_name);
+	if (m != _models.end ()) {
+		return m->second.custom_device_modes;
+	}
+	return MasterDeviceNames::CustomDeviceModeNames ();
+}
+
+MasterDeviceNames::Models
+MidiPatchManager::all_models()
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	MasterDeviceNames::Models models;
+	for (ModelIndex::const_iterator m = _models.begin(); m != _models.end(); ++m) {
+		models.insert (m->first);
+	}
+	return models;
+}
+
+MidiPatchManager::DeviceNamesByMaker
+MidiPatchManager::devices_by_manufacturer()
 {
-	MidiNameDocuments::const_iterator i = _documents.find (model_name);
-	if (i != _documents.end ()) {
-		return i->second;
+	Glib::Threads::Mutex::Lock lm (_lock);
+	return _devices_by_manufacturer;
+}
+
+/** Caller must hold _lock */
+bool
+MidiPatchManager::add_model (const std::string& model, const ModelInfo& mi)
+{
+	ModelIndex::const_iterator m = _models.find (model);
+
+	if (m != _models.end ()) {
+		if (m->second.file_path != mi.file_path) {
+			warning << string_compose(_("Duplicate MIDI device `%1' in `%2' ignored"),
+			                          model, mi.file_path) << endmsg;
+		}
+		return false;
 	}
-	return boost::shared_ptr<MIDINameDocument> ();
+
+	_models[model] = mi;
+	_devices_by_manufacturer[mi.manufacturer].insert (model);
+	return true;
 }
 
 bool
 MidiPatchManager::add_midi_name_document (boost::shared_ptr<MIDINameDocument> document)
 {
 	bool added = false;
-	for (MIDINameDocument::MasterDeviceNamesList::const_iterator device =
-	         document->master_device_names_by_model().begin();
-	     device != document->master_device_names_by_model().end();
-	     ++device) {
-		if (_documents.find(device->first) != _documents.end()) {
-			warning << string_compose(_("Duplicate MIDI device `%1' in `%2' ignored"),
-			                          device->first,
-			                          document->file_path()) << endmsg;
-			continue;
-		}
 
-		_documents[device->first] = document;
-		_master_devices_by_model[device->first] = device->second;
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
 
-		_all_models.insert(device->first);
-		const std::string& manufacturer = device->second->manufacturer();
-		if (_devices_by_manufacturer.find(manufacturer) ==
-		    _devices_by_manufacturer.end()) {
-			MIDINameDocument::MasterDeviceNamesList empty;
-			_devices_by_manufacturer.insert(std::make_pair(manufacturer, empty));
-		}
-		_devices_by_manufacturer[manufacturer].insert(
-		    std::make_pair(device->first, device->second));
+		for (MIDINameDocument::MasterDeviceNamesList::const_iterator device =
+		         document->master_device_names_by_model().begin();
+		     device != document->master_device_names_by_model().end();
+		     ++device) {
 
-		added = true;
-		// TODO: handle this gracefully.
-		assert(_documents.count(device->first) == 1);
-		assert(_master_devices_by_model.count(device->first) == 1);
+			ModelInfo mi;
+			mi.file_path = document->file_path ();
+			mi.manufacturer = device->second->manufacturer ();
+			mi.custom_device_modes = device->second->custom_device_mode_names ();
+
+			if (add_model (device->first, mi)) {
+				_documents[device->first] = document;
+				added = true;
+			}
+		}
 	}
 
 	if (added) {
@@ -213,33 +615,36 @@ bool
 MidiPatchManager::remove_midi_name_document (const std::string& file_path, bool emit_signal)
 {
 	bool removed = false;
-	for (MidiNameDocuments::iterator i = _documents.begin(); i != _documents.end();) {
-		if (i->second->file_path() == file_path) {
-
-			boost::shared_ptr<MIDINameDocument> document = i->second;
-
-			info << string_compose(_("Removing MIDI patch file %1"), file_path) << endmsg;
-
-			_documents.erase(i++);
-
-			for (MIDINameDocument::MasterDeviceNamesList::const_iterator device =
-			         document->master_device_names_by_model().begin();
-			     device != document->master_device_names_by_model().end();
-			     ++device) {
 
-				_master_devices_by_model.erase(device->first);
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
 
-				_all_models.erase(device->first);
+		for (ModelIndex::iterator i = _models.begin(); i != _models.end();) {
+			if (i->second.file_path != file_path) {
+				++i;
+				continue;
+			}
 
-				const std::string& manufacturer = device->second->manufacturer();
+			if (!removed) {
+				info << string_compose(_("Removing MIDI patch file %1"), file_path) << endmsg;
+				removed = true;
+			}
 
-				_devices_by_manufacturer[manufacturer].erase(device->first);
+			DeviceNamesByMaker::iterator maker = _devices_by_manufacturer.find (i->second.manufacturer);
+			if (maker != _devices_by_manufacturer.end ()) {
+				maker->second.erase (i->first);
+				if (maker->second.empty ()) {
+					_devices_by_manufacturer.erase (maker);
+				}
 			}
-			removed = true;
-		} else {
-			++i;
+
+			_documents.erase (i->first);
+			_models.erase (i++);
 		}
+
+		_unparsable_files.erase (file_path);
 	}
+
 	if (removed && emit_signal) {
 		PatchesChanged(); /* EMIT SIGNAL */
 	}
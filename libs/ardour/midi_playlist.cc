@@ -471,6 +471,12 @@ MidiPlaylist::contained_automation()
 	for (RegionList::const_iterator r = regions.begin(); r != regions.end(); ++r) {
 		boost::shared_ptr<MidiRegion> mr = boost::dynamic_pointer_cast<MidiRegion>(*r);
 
+		if (!mr->model()) {
+			boost::shared_ptr<MidiSource> ms = mr->midi_source(0);
+			Source::Lock lm (ms->mutex());
+			ms->load_model (lm);
+		}
+
 		for (Automatable::Controls::iterator c = mr->model()->controls().begin();
 				c != mr->model()->controls().end(); ++c) {
 			if (c->second->list()->size() > 0) {
@@ -518,12 +518,20 @@ MidiRegion::separate_by_channel (ARDOUR::Session&, vector< boost::shared_ptr<Reg
 boost::shared_ptr<Evoral::Control>
 MidiRegion::control (const Evoral::Parameter& id, bool create)
 {
+	if (!model()) {
+		boost::shared_ptr<MidiSource> ms = midi_source(0);
+		Source::Lock lm (ms->mutex());
+		ms->load_model (lm);
+	}
 	return model()->control(id, create);
 }
 
 boost::shared_ptr<const Evoral::Control>
 MidiRegion::control (const Evoral::Parameter& id) const
 {
+	if (!model()) {
+		return boost::shared_ptr<const Evoral::Control> ();
+	}
 	return model()->control(id);
 }
 
@@ -539,6 +547,12 @@ MidiRegion::model() const
 	return midi_source()->model();
 }
 
+boost::shared_ptr<MidiModel>
+MidiRegion::loaded_model()
+{
+	return midi_source()->loaded_model();
+}
+
 boost::shared_ptr<MidiSource>
 MidiRegion::midi_source (uint32_t n) const
 {
@@ -646,6 +660,12 @@ MidiRegion::fix_negative_start ()
 
 	_ignore_shift = true;
 
+	{
+		boost::shared_ptr<MidiSource> ms = midi_source(0);
+		Source::Lock lm (ms->mutex());
+		ms->load_model (lm);
+	}
+
 	model()->insert_silence_at_start (Evoral::Beats (- _start_beats));
 
 	_start = 0;
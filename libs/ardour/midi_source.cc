@@ -383,11 +383,28 @@ MidiSource::mark_streaming_write_completed (const Lock& lock)
 	mark_midi_streaming_write_completed (lock, Evoral::Sequence<Evoral::Beats>::DeleteStuckNotes);
 }
 
+boost::shared_ptr<MidiModel>
+MidiSource::loaded_model ()
+{
+	Lock lm (_lock);
+
+	if (!_model) {
+		load_model (lm);
+	}
+
+	return _model;
+}
+
 int
 MidiSource::export_write_to (const Lock& lock, boost::shared_ptr<MidiSource> newsrc, Evoral::Beats begin, Evoral::Beats end)
 {
 	Lock newsrc_lock (newsrc->mutex ());
 
+	if (!_model) {
+		/* not yet needed by anything else */
+		load_model (lock);
+	}
+
 	if (!_model) {
 		error << string_compose (_("programming error: %1"), X_("no model for MidiSource during export"));
 		return -1;
@@ -409,6 +426,10 @@ MidiSource::write_to (const Lock& lock, boost::shared_ptr<MidiSource> newsrc, Ev
 	newsrc->copy_interpolation_from (this);
 	newsrc->copy_automation_state_from (this);
 
+	if (!_model) {
+		load_model (lock);
+	}
+
 	if (_model) {
 		if (begin == Evoral::MinBeats && end == Evoral::MaxBeats) {
 			_model->write_to (newsrc, newsrc_lock);
@@ -0,0 +1,476 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef COMPILER_MSVC
+#include <float.h>
+// 'std::isnan()' is not available in MSVC.
+#define isnan_local(val) (bool)_isnan((double)val)
+#else
+#define isnan_local std::isnan
+#endif
+
+#include "pbd/malign.h"
+
+#include "ardour/multimeterdsp.h"
+#include "ardour/runtime_functions.h"
+
+using namespace ARDOUR;
+
+/* frames per interleaved block; a multiple of 4, since the second
+ * filter stages run every 4th sample. lanes * block_frames floats
+ * stay comfortably in L1.
+ */
+static const uint32_t block_frames = 128;
+
+float MultiMeterDSP::_k_omega;
+float MultiMeterDSP::_iec_w1[2];
+float MultiMeterDSP::_iec_w2[2];
+float MultiMeterDSP::_iec_w3[2];
+float MultiMeterDSP::_iec_g[2];
+float MultiMeterDSP::_vu_w;
+float MultiMeterDSP::_vu_g;
+
+/* The coefficients and the clamping of the filter state below are those
+ * of Kmeterdsp, Iec1ppmdsp, Iec2ppmdsp and Vumeterdsp.
+ */
+void
+MultiMeterDSP::init (float fsamp)
+{
+	_k_omega = 9.72f / fsamp;
+
+	_iec_w1[0] = 450.0f / fsamp;
+	_iec_w2[0] = 1300.0f / fsamp;
+	_iec_w3[0] = 1.0f - 5.4f / fsamp;
+	_iec_g[0]  = 0.5108f;
+
+	_iec_w1[1] = 200.0f / fsamp;
+	_iec_w2[1] = 860.0f / fsamp;
+	_iec_w3[1] = 1.0f - 4.0f / fsamp;
+	_iec_g[1]  = 0.5141f;
+
+	_vu_w = 11.1f / fsamp;
+	_vu_g = 1.5f * 1.571f;
+}
+
+MultiMeterDSP::MultiMeterDSP ()
+	: _n_channels (0)
+	, _n_padded (0)
+	, _block (0)
+{
+	memset (_state, 0, sizeof (_state));
+}
+
+MultiMeterDSP::~MultiMeterDSP ()
+{
+	release ();
+}
+
+/* like PeakMeter, prefer K over IEC I over IEC II over VU if several are set */
+MultiMeterDSP::Kind
+MultiMeterDSP::kind (uint32_t types)
+{
+	for (int k = 0; k < n_kinds; ++k) {
+		if (types & mask ((Kind) k)) {
+			return (Kind) k;
+		}
+	}
+	return n_kinds;
+}
+
+uint32_t
+MultiMeterDSP::mask (Kind k)
+{
+	switch (k) {
+	case K:
+		return MeterKrms | MeterK20 | MeterK14 | MeterK12;
+	case IEC1:
+		return MeterIEC1DIN | MeterIEC1NOR;
+	case IEC2:
+		return MeterIEC2BBC | MeterIEC2EBU;
+	case VU:
+		return MeterVU;
+	default:
+		break;
+	}
+	return 0;
+}
+
+void
+MultiMeterDSP::set_channels (uint32_t n)
+{
+	if (n == _n_channels) {
+		return;
+	}
+
+	release ();
+
+	_n_channels = n;
+	_n_padded = lanes * ((n + lanes - 1) / lanes);
+
+	if (_n_padded == 0) {
+		return;
+	}
+
+	cache_aligned_malloc ((void**) &_block, sizeof (float) * lanes * block_frames);
+
+	for (int k = 0; k < n_kinds; ++k) {
+		cache_aligned_malloc ((void**) &_state[k].z1, sizeof (float) * _n_padded);
+		cache_aligned_malloc ((void**) &_state[k].z2, sizeof (float) * _n_padded);
+		cache_aligned_malloc ((void**) &_state[k].m, sizeof (float) * _n_padded);
+		_state[k].res = new bool[_n_padded];
+	}
+
+	reset (~0);
+}
+
+void
+MultiMeterDSP::release ()
+{
+	if (_n_padded == 0) {
+		return;
+	}
+
+	cache_aligned_free (_block);
+
+	for (int k = 0; k < n_kinds; ++k) {
+		cache_aligned_free (_state[k].z1);
+		cache_aligned_free (_state[k].z2);
+		cache_aligned_free (_state[k].m);
+		delete [] _state[k].res;
+	}
+
+	memset (_state, 0, sizeof (_state));
+	_block = 0;
+	_n_channels = 0;
+	_n_padded = 0;
+}
+
+void
+MultiMeterDSP::reset (uint32_t types)
+{
+	for (int k = 0; k < n_kinds; ++k) {
+		if (!(types & mask ((Kind) k))) {
+			continue;
+		}
+		State& s (_state[k]);
+		for (uint32_t c = 0; c < _n_padded; ++c) {
+			s.z1[c] = s.z2[c] = s.m[c] = 0;
+			/* Kmeterdsp::reset() clears its flag, the others set it */
+			s.res[c] = (k != K);
+		}
+	}
+}
+
+float
+MultiMeterDSP::read (uint32_t c, uint32_t types)
+{
+	const Kind k = kind (types);
+	if (k == n_kinds || c >= _n_channels) {
+		return 0;
+	}
+	const float rv = peek (c, types);
+	_state[k].res[c] = true;
+	return rv;
+}
+
+float
+MultiMeterDSP::peek (uint32_t c, uint32_t types) const
+{
+	const Kind k = kind (types);
+	if (k == n_kinds || c >= _n_channels) {
+		return 0;
+	}
+	switch (k) {
+	case IEC1:
+		return _iec_g[0] * _state[k].m[c];
+	case IEC2:
+		return _iec_g[1] * _state[k].m[c];
+	case VU:
+		return _vu_g * _state[k].m[c];
+	default:
+		break;
+	}
+	return _state[k].m[c];
+}
+
+static inline float
+clamp (float v, float lo, float hi)
+{
+	return v > hi ? hi : (v < lo ? lo : v);
+}
+
+void
+MultiMeterDSP::process (float const * const * data, uint32_t nframes, uint32_t types, float* peak)
+{
+	bool run[n_kinds];
+	for (int k = 0; k < n_kinds; ++k) {
+		run[k] = (types & mask ((Kind) k)) != 0;
+	}
+
+	/* load filter state, as the single channel meters do at the start of process () */
+	if (run[K]) {
+		State& s (_state[K]);
+		for (uint32_t c = 0; c < _n_padded; ++c) {
+			s.z1[c] = clamp (s.z1[c], 0, 50);
+			s.z2[c] = clamp (s.z2[c], 0, 50);
+		}
+	}
+	for (int k = IEC1; k <= VU; ++k) {
+		if (!run[k]) {
+			continue;
+		}
+		State& s (_state[k]);
+		const float lo = (k == VU) ? -20 : 0;
+		for (uint32_t c = 0; c < _n_padded; ++c) {
+			s.z1[c] = clamp (s.z1[c], lo, 20);
+			s.z2[c] = clamp (s.z2[c], lo, 20);
+			if (s.res[c]) {
+				s.m[c] = 0;
+				s.res[c] = false;
+			}
+		}
+	}
+
+	if (!(run[K] || run[IEC1] || run[IEC2] || run[VU])) {
+		/* plain peak meter, nothing to interleave for */
+		for (uint32_t c = 0; c < _n_channels; ++c) {
+			if (data[c]) {
+				peak[c] = compute_peak (data[c], nframes, peak[c]);
+			}
+		}
+		return;
+	}
+
+	/* filters only see whole groups of 4 samples, like the originals */
+	const uint32_t n_filtered = nframes & ~3;
+
+	for (uint32_t g = 0; g < _n_padded; g += lanes) {
+
+		float pk[lanes];
+		for (uint32_t l = 0; l < lanes; ++l) {
+			pk[l] = 0;
+		}
+
+		for (uint32_t offset = 0; offset < nframes; offset += block_frames) {
+
+			const uint32_t nf = std::min (block_frames, nframes - offset);
+
+			/* interleave, and compute peaks while we are at it */
+			for (uint32_t l = 0; l < lanes; ++l) {
+				float const * p = (g + l < _n_channels) ? data[g + l] : 0;
+				if (!p) {
+					for (uint32_t f = 0; f < nf; ++f) {
+						_block[f * lanes + l] = 0;
+					}
+					continue;
+				}
+				p += offset;
+				float mx = pk[l];
+				for (uint32_t f = 0; f < nf; ++f) {
+					const float x = p[f];
+					const float a = fabsf (x);
+					mx = a > mx ? a : mx;
+					_block[f * lanes + l] = x;
+				}
+				pk[l] = mx;
+			}
+
+			if (offset >= n_filtered) {
+				continue;
+			}
+
+			const uint32_t nb = std::min (nf, n_filtered - offset) / 4;
+
+			if (run[K]) {
+				process_k (g, nb);
+			}
+			if (run[IEC1]) {
+				process_iec (IEC1, g, nb);
+			}
+			if (run[IEC2]) {
+				process_iec (IEC2, g, nb);
+			}
+			if (run[VU]) {
+				process_vu (g, nb);
+			}
+		}
+
+		for (uint32_t l = 0; l < lanes && g + l < _n_channels; ++l) {
+			peak[g + l] = pk[l] > peak[g + l] ? pk[l] : peak[g + l];
+		}
+	}
+
+	/* save filter state; the added constants avoid denormals */
+	if (run[K]) {
+		State& s (_state[K]);
+		for (uint32_t c = 0; c < _n_padded; ++c) {
+			if (isnan_local (s.z1[c])) s.z1[c] = 0;
+			if (isnan_local (s.z2[c])) s.z2[c] = 0;
+			s.z1[c] += 1e-20f;
+			s.z2[c] += 1e-20f;
+			const float rms = sqrtf (2.0f * s.z2[c]);
+			if (s.res[c]) {
+				s.m[c] = rms;
+				s.res[c] = false;
+			} else if (rms > s.m[c]) {
+				s.m[c] = rms;
+			}
+		}
+	}
+	for (int k = IEC1; k <= VU; ++k) {
+		if (!run[k]) {
+			continue;
+		}
+		State& s (_state[k]);
+		for (uint32_t c = 0; c < _n_padded; ++c) {
+			if (k == VU) {
+				if (isnan_local (s.z1[c])) s.z1[c] = 0;
+				if (isnan_local (s.z2[c])) s.z2[c] = 0;
+				s.z2[c] += 1e-10f;
+			} else {
+				s.z1[c] += 1e-10f;
+				s.z2[c] += 1e-10f;
+			}
+		}
+	}
+}
+
+/* The filters below work on lanes channels of the interleaved block at a
+ * time, starting at channel @param g, for @param n_blocks groups of 4
+ * samples. The inner loops over lanes are what gets vectorized.
+ */
+
+void
+MultiMeterDSP::process_k (uint32_t g, uint32_t n_blocks)
+{
+	State& s (_state[K]);
+	const float w = _k_omega;
+	float z1[lanes];
+	float z2[lanes];
+
+	for (uint32_t l = 0; l < lanes; ++l) {
+		z1[l] = s.z1[g + l];
+		z2[l] = s.z2[g + l];
+	}
+
+	float const * x = _block;
+	for (uint32_t b = 0; b < n_blocks; ++b) {
+		for (uint32_t i = 0; i < 4; ++i, x += lanes) {
+			for (uint32_t l = 0; l < lanes; ++l) {
+				z1[l] += w * (x[l] * x[l] - z1[l]);
+			}
+		}
+		for (uint32_t l = 0; l < lanes; ++l) {
+			z2[l] += 4 * w * (z1[l] - z2[l]);
+		}
+	}
+
+	for (uint32_t l = 0; l < lanes; ++l) {
+		s.z1[g + l] = z1[l];
+		s.z2[g + l] = z2[l];
+	}
+}
+
+void
+MultiMeterDSP::process_iec (Kind k, uint32_t g, uint32_t n_blocks)
+{
+	State& s (_state[k]);
+	const int i = (k == IEC1) ? 0 : 1;
+	const float w1 = _iec_w1[i];
+	const float w2 = _iec_w2[i];
+	const float w3 = _iec_w3[i];
+	float z1[lanes];
+	float z2[lanes];
+	float m[lanes];
+
+	for (uint32_t l = 0; l < lanes; ++l) {
+		z1[l] = s.z1[g + l];
+		z2[l] = s.z2[g + l];
+		m[l] = s.m[g + l];
+	}
+
+	float const * x = _block;
+	for (uint32_t b = 0; b < n_blocks; ++b) {
+		for (uint32_t l = 0; l < lanes; ++l) {
+			z1[l] *= w3;
+			z2[l] *= w3;
+		}
+		for (uint32_t j = 0; j < 4; ++j, x += lanes) {
+			for (uint32_t l = 0; l < lanes; ++l) {
+				/* attack only: if (t > z) z += w * (t - z) */
+				const float t = fabsf (x[l]);
+				z1[l] += w1 * std::max (t - z1[l], 0.f);
+				z2[l] += w2 * std::max (t - z2[l], 0.f);
+			}
+		}
+		for (uint32_t l = 0; l < lanes; ++l) {
+			const float t = z1[l] + z2[l];
+			m[l] = t > m[l] ? t : m[l];
+		}
+	}
+
+	for (uint32_t l = 0; l < lanes; ++l) {
+		s.z1[g + l] = z1[l];
+		s.z2[g + l] = z2[l];
+		s.m[g + l] = m[l];
+	}
+}
+
+void
+MultiMeterDSP::process_vu (uint32_t g, uint32_t n_blocks)
+{
+	State& s (_state[VU]);
+	const float w = _vu_w;
+	float z1[lanes];
+	float z2[lanes];
+	float m[lanes];
+
+	for (uint32_t l = 0; l < lanes; ++l) {
+		z1[l] = s.z1[g + l];
+		z2[l] = s.z2[g + l];
+		m[l] = s.m[g + l];
+	}
+
+	float const * x = _block;
+	for (uint32_t b = 0; b < n_blocks; ++b) {
+		float t2[lanes];
+		for (uint32_t l = 0; l < lanes; ++l) {
+			t2[l] = z2[l] / 2;
+		}
+		for (uint32_t j = 0; j < 4; ++j, x += lanes) {
+			for (uint32_t l = 0; l < lanes; ++l) {
+				z1[l] += w * (fabsf (x[l]) - t2[l] - z1[l]);
+			}
+		}
+		for (uint32_t l = 0; l < lanes; ++l) {
+			z2[l] += 4 * w * (z1[l] - z2[l]);
+			m[l] = z2[l] > m[l] ? z2[l] : m[l];
+		}
+	}
+
+	for (uint32_t l = 0; l < lanes; ++l) {
+		s.z1[g + l] = z1[l];
+		s.z2[g + l] = z2[l];
+		s.m[g + l] = m[l];
+	}
+}
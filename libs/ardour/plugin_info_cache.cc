@@ -0,0 +1,229 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+
+#include "pbd/compose.h"
+#include "pbd/error.h"
+#include "pbd/gstdio_compat.h"
+#include "pbd/xml++.h"
+
+#include "ardour/filesystem_paths.h"
+#include "ardour/plugin_info_cache.h"
+
+#include "pbd/i18n.h"
+
+using namespace std;
+using namespace ARDOUR;
+using namespace PBD;
+
+/* bump this whenever discovery starts to fill in PluginInfo differently */
+const int PluginInfoCache::version = 1;
+
+PluginInfoCache::Info::Info (PluginInfo const & pi)
+	: name (pi.name)
+	, category (pi.category)
+	, creator (pi.creator)
+	, path (pi.path)
+	, unique_id (pi.unique_id)
+	, index (pi.index)
+	, n_inputs (pi.n_inputs)
+	, n_outputs (pi.n_outputs)
+{
+}
+
+void
+PluginInfoCache::Info::apply (PluginInfo& pi) const
+{
+	pi.name = name;
+	pi.category = category;
+	pi.creator = creator;
+	pi.path = path;
+	pi.unique_id = unique_id;
+	pi.index = index;
+	pi.n_inputs = n_inputs;
+	pi.n_outputs = n_outputs;
+}
+
+PluginInfoCache::PluginInfoCache (string const & name)
+	: _path (Glib::build_filename (user_cache_directory (), name))
+	, _dirty (false)
+	, _hits (0)
+	, _misses (0)
+{
+	load ();
+}
+
+string
+PluginInfoCache::stamp (vector<string> const & files)
+{
+	string s;
+	for (vector<string>::const_iterator i = files.begin(); i != files.end(); ++i) {
+		GStatBuf sb;
+		if (g_stat (i->c_str(), &sb)) {
+			s += "-;";
+		} else {
+			s += string_compose ("%1:%2;", (int64_t) sb.st_mtime, (int64_t) sb.st_size);
+		}
+	}
+	return s;
+}
+
+PluginInfoCache::InfoList const *
+PluginInfoCache::lookup (string const & key, string const & stamp)
+{
+	Entries::iterator i = _entries.find (key);
+
+	if (i == _entries.end () || i->second.stamp != stamp) {
+		++_misses;
+		return 0;
+	}
+
+	++_hits;
+	i->second.used = true;
+	return &i->second.plugins;
+}
+
+void
+PluginInfoCache::add (string const & key, string const & stamp, InfoList const & plugins)
+{
+	Entry& e (_entries[key]);
+	e.stamp = stamp;
+	e.plugins = plugins;
+	e.used = true;
+	_dirty = true;
+}
+
+void
+PluginInfoCache::load ()
+{
+	if (!Glib::file_test (_path, Glib::FILE_TEST_EXISTS)) {
+		return;
+	}
+
+	XMLTree tree;
+	if (!tree.read (_path) || !tree.root () || tree.root()->name () != X_("PluginInfoCache")) {
+		warning << string_compose (_("Ignoring invalid plugin cache %1"), _path) << endmsg;
+		return;
+	}
+
+	XMLProperty const * prop = tree.root()->property ("version");
+	if (!prop || atoi (prop->value ().c_str ()) != version) {
+		return;
+	}
+
+	XMLNodeList const & entries = tree.root()->children ();
+
+	for (XMLNodeConstIterator i = entries.begin(); i != entries.end(); ++i) {
+		XMLProperty const * key = (*i)->property ("key");
+		XMLProperty const * stamp = (*i)->property ("stamp");
+
+		if (!key || !stamp) {
+			continue;
+		}
+
+		Entry& e (_entries[key->value ()]);
+		e.stamp = stamp->value ();
+
+		XMLNodeList const & plugins = (*i)->children ();
+
+		for (XMLNodeConstIterator p = plugins.begin(); p != plugins.end(); ++p) {
+			Info info;
+
+			if ((prop = (*p)->property ("name")) != 0) {
+				info.name = prop->value ();
+			}
+			if ((prop = (*p)->property ("category")) != 0) {
+				info.category = prop->value ();
+			}
+			if ((prop = (*p)->property ("creator")) != 0) {
+				info.creator = prop->value ();
+			}
+			if ((prop = (*p)->property ("path")) != 0) {
+				info.path = prop->value ();
+			}
+			if ((prop = (*p)->property ("unique-id")) != 0) {
+				info.unique_id = prop->value ();
+			}
+			if ((prop = (*p)->property ("index")) != 0) {
+				info.index = atoi (prop->value ().c_str ());
+			}
+
+			XMLNode* child;
+			if ((child = (*p)->child (X_("Inputs"))) != 0) {
+				info.n_inputs = ChanCount (*child);
+			}
+			if ((child = (*p)->child (X_("Outputs"))) != 0) {
+				info.n_outputs = ChanCount (*child);
+			}
+
+			e.plugins.push_back (info);
+		}
+	}
+}
+
+void
+PluginInfoCache::save ()
+{
+	for (Entries::iterator i = _entries.begin(); i != _entries.end();) {
+		if (i->second.used) {
+			++i;
+		} else {
+			/* the plugin has been removed */
+			_entries.erase (i++);
+			_dirty = true;
+		}
+	}
+
+	if (!_dirty) {
+		return;
+	}
+
+	XMLNode* root = new XMLNode (X_("PluginInfoCache"));
+	root->add_property ("version", (long) version);
+
+	for (Entries::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		XMLNode* entry = root->add_child (X_("Entry"));
+		entry->add_property ("key", i->first);
+		entry->add_property ("stamp", i->second.stamp);
+
+		for (InfoList::const_iterator p = i->second.plugins.begin(); p != i->second.plugins.end(); ++p) {
+			XMLNode* node = entry->add_child (X_("Plugin"));
+			node->add_property ("name", p->name);
+			node->add_property ("category", p->category);
+			node->add_property ("creator", p->creator);
+			node->add_property ("path", p->path);
+			node->add_property ("unique-id", p->unique_id);
+			node->add_property ("index", (long) p->index);
+			node->add_child_nocopy (*p->n_inputs.state (X_("Inputs")));
+			node->add_child_nocopy (*p->n_outputs.state (X_("Outputs")));
+		}
+	}
+
+	XMLTree tree;
+	tree.set_root (root);
+
+	if (!tree.write (_path)) {
+		warning << string_compose (_("Could not write plugin cache %1"), _path) << endmsg;
+		return;
+	}
+
+	_dirty = false;
+}
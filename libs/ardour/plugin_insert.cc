@@ -34,9 +34,11 @@
 #include "ardour/event_type_map.h"
 #include "ardour/ladspa_plugin.h"
 #include "ardour/luaproc.h"
+#include "ardour/midi_buffer.h"
 #include "ardour/plugin.h"
 #include "ardour/plugin_insert.h"
 #include "ardour/port.h"
+#include "ardour/rc_configuration.h"
 
 #ifdef LV2_SUPPORT
 #include "ardour/lv2_plugin.h"
@@ -83,6 +85,9 @@ PluginInsert::PluginInsert (Session& s, boost::shared_ptr<Plugin> plug)
 	, _maps_from_state (false)
 	, _latency_changed (false)
 	, _bypass_port (UINT32_MAX)
+	, _user_tail (-1)
+	, _silent_frames (0)
+	, _skipped (false)
 {
 	/* the first is the master */
 
@@ -1150,7 +1155,22 @@ PluginInsert::run (BufferSet& bufs, framepos_t start_frame, framepos_t end_frame
 		_sidechain->run (bufs, start_frame, end_frame, speed, nframes, true);
 	}
 
-	if (_pending_active) {
+	_skipped = false;
+
+	if (_pending_active && past_tail (bufs, nframes)) {
+		/* the plugin has nothing left to say; its input is silent,
+		 * hence so is everything the route passes through it.
+		 */
+		ChanCount const out (output_streams ());
+		for (uint32_t n = 0; n < out.n_audio (); ++n) {
+			bufs.get_audio (n).silence (nframes);
+		}
+		for (uint32_t n = 0; n < out.n_midi (); ++n) {
+			bufs.get_midi (n).silence (nframes);
+		}
+		_skipped = true;
+
+	} else if (_pending_active) {
 		/* run as normal if we are active or moving from inactive to active */
 
 		if (_session.transport_rolling() || _session.bounce_processing()) {
@@ -1172,6 +1192,53 @@ PluginInsert::run (BufferSet& bufs, framepos_t start_frame, framepos_t end_frame
 	 */
 }
 
+/** Keep track of how long the plugin's input has been silent.
+ *  @return true if that is longer than the plugin's tail and latency,
+ *  and the plugin does not need to be run.
+ */
+bool
+PluginInsert::past_tail (BufferSet const & bufs, pframes_t nframes)
+{
+	framecnt_t const t = tail ();
+
+	if (t < 0 || !_active || _sidechain || _configured_in == ChanCount::ZERO || _configured_in.n_midi () > 0
+			|| _session.bounce_processing () || !Config->get_skip_silent_plugins ()) {
+		/* unknown tail, just (re)activated, external input, a generator,
+		 * an instrument (which may be holding notes without receiving
+		 * any events), or no-one wants it
+		 */
+		_silent_frames = 0;
+		return false;
+	}
+
+	if (!bufs.silent (nframes)) {
+		_silent_frames = 0;
+		return false;
+	}
+
+	bool const rv = _silent_frames >= t + signal_latency ();
+	if (!rv) {
+		_silent_frames += nframes;
+	}
+	return rv;
+}
+
+framecnt_t
+PluginInsert::tail () const
+{
+	if (_user_tail >= 0) {
+		return _user_tail * _session.frame_rate ();
+	}
+	return _plugins.front()->plugin_tail ();
+}
+
+void
+PluginInsert::set_user_tail (double seconds)
+{
+	_user_tail = max (-1.0, seconds);
+	_silent_frames = 0;
+}
+
 void
 PluginInsert::automation_run (BufferSet& bufs, framepos_t start, framepos_t end, double speed, pframes_t nframes)
 {
@@ -2351,6 +2418,9 @@ PluginInsert::state (bool full)
 
 	/* save custom i/o config */
 	node.add_property("custom", _custom_cfg ? "yes" : "no");
+	if (_user_tail >= 0) {
+		node.add_property("user-tail-seconds", string_compose ("%1", _user_tail));
+	}
 	for (uint32_t pc = 0; pc < get_count(); ++pc) {
 		char tmp[128];
 		snprintf (tmp, sizeof(tmp), "InputMap-%d", pc);
@@ -2633,6 +2703,10 @@ PluginInsert::set_state(const XMLNode& node, int version)
 		_custom_cfg = string_is_affirmative (prop->value());
 	}
 
+	if ((prop = node.property (X_("user-tail-seconds"))) != 0) {
+		set_user_tail (PBD::atof (prop->value()));
+	}
+
 	uint32_t in_maps = 0;
 	uint32_t out_maps = 0;
 	XMLNodeList kids = node.children ();
@@ -78,6 +78,7 @@
 #include "ardour/luascripting.h"
 #include "ardour/luaproc.h"
 #include "ardour/plugin.h"
+#include "ardour/plugin_info_cache.h"
 #include "ardour/plugin_manager.h"
 #include "ardour/rc_configuration.h"
 
@@ -540,10 +541,16 @@ PluginManager::ladspa_refresh ()
 	find_files_matching_pattern (ladspa_modules, ladspa_search_path (), "*.dylib");
 	find_files_matching_pattern (ladspa_modules, ladspa_search_path (), "*.dll");
 
+	PluginInfoCache cache (X_("ladspa_cache"));
+
 	for (vector<std::string>::iterator i = ladspa_modules.begin(); i != ladspa_modules.end(); ++i) {
 		ARDOUR::PluginScanMessage(_("LADSPA"), *i, false);
-		ladspa_discover (*i);
+		ladspa_discover (*i, cache);
 	}
+
+	cache.save ();
+
+	DEBUG_TRACE (DEBUG::PluginManager, string_compose ("LADSPA: %1 modules from cache, %2 scanned\n", cache.hits (), cache.misses ()));
 }
 
 #ifdef HAVE_LRDF
@@ -625,8 +632,9 @@ PluginManager::add_lrdf_data (const string &path)
 #endif
 }
 
-int
-PluginManager::ladspa_discover (string path)
+/** Load the LADSPA module at @param path and add details of all of its plugins to @param plugins */
+static int
+ladspa_scan_module (string const & path, PluginInfoCache::InfoList& plugins)
 {
 	DEBUG_TRACE (DEBUG::PluginManager, string_compose ("Checking for LADSPA plugin at %1\n", path));
 
@@ -662,41 +670,77 @@ PluginManager::ladspa_discover (string path)
 			break;
 		}
 
-		if (!ladspa_plugin_whitelist.empty()) {
-			if (find (ladspa_plugin_whitelist.begin(), ladspa_plugin_whitelist.end(), descriptor->UniqueID) == ladspa_plugin_whitelist.end()) {
-				continue;
-			}
-		}
-
-		PluginInfoPtr info(new LadspaPluginInfo);
-		info->name = descriptor->Name;
-		info->category = get_ladspa_category(descriptor->UniqueID);
-		info->creator = descriptor->Maker;
-		info->path = path;
-		info->index = i;
-		info->n_inputs = ChanCount();
-		info->n_outputs = ChanCount();
-		info->type = ARDOUR::LADSPA;
+		PluginInfoCache::Info info;
+		info.name = descriptor->Name;
+		info.creator = descriptor->Maker;
+		info.path = path;
+		info.index = i;
 
 		char buf[32];
 		snprintf (buf, sizeof (buf), "%lu", descriptor->UniqueID);
-		info->unique_id = buf;
+		info.unique_id = buf;
 
 		for (uint32_t n=0; n < descriptor->PortCount; ++n) {
 			if ( LADSPA_IS_PORT_AUDIO (descriptor->PortDescriptors[n]) ) {
 				if ( LADSPA_IS_PORT_INPUT (descriptor->PortDescriptors[n]) ) {
-					info->n_inputs.set_audio(info->n_inputs.n_audio() + 1);
+					info.n_inputs.set_audio(info.n_inputs.n_audio() + 1);
 				}
 				else if ( LADSPA_IS_PORT_OUTPUT (descriptor->PortDescriptors[n]) ) {
-					info->n_outputs.set_audio(info->n_outputs.n_audio() + 1);
+					info.n_outputs.set_audio(info.n_outputs.n_audio() + 1);
 				}
 			}
 		}
 
-		if(_ladspa_plugin_info->empty()){
-			_ladspa_plugin_info->push_back (info);
+		plugins.push_back (info);
+	}
+
+// GDB WILL NOT LIKE YOU IF YOU DO THIS
+//	dlclose (module);
+
+	return 0;
+}
+
+/** Add the plugins of the LADSPA module at @param path, which is only
+ * loaded if @param cache has nothing up-to-date for it.
+ */
+int
+PluginManager::ladspa_discover (string path, PluginInfoCache& cache)
+{
+	vector<string> files;
+	files.push_back (path);
+	string const stamp = PluginInfoCache::stamp (files);
+
+	PluginInfoCache::InfoList scanned;
+	PluginInfoCache::InfoList const * plugins = cache.lookup (path, stamp);
+
+	if (!plugins) {
+		int const rv = ladspa_scan_module (path, scanned);
+		/* a module which fails to load is cached without any plugins,
+		 * so that it is not dlopen()ed again until it changes.
+		 */
+		cache.add (path, stamp, scanned);
+		if (rv) {
+			return -1;
+		}
+		plugins = &scanned;
+	}
+
+	for (PluginInfoCache::InfoList::const_iterator p = plugins->begin(); p != plugins->end(); ++p) {
+
+		uint32_t const id = strtoul (p->unique_id.c_str(), 0, 10);
+
+		if (!ladspa_plugin_whitelist.empty()) {
+			if (find (ladspa_plugin_whitelist.begin(), ladspa_plugin_whitelist.end(), id) == ladspa_plugin_whitelist.end()) {
+				continue;
+			}
 		}
 
+		PluginInfoPtr info(new LadspaPluginInfo);
+		p->apply (*info);
+		/* not cached, the RDF data may have changed */
+		info->category = get_ladspa_category(id);
+		info->type = ARDOUR::LADSPA;
+
 		//Ensure that the plugin is not already in the plugin list.
 
 		bool found = false;
@@ -714,9 +758,6 @@ PluginManager::ladspa_discover (string path)
 		DEBUG_TRACE (DEBUG::PluginManager, string_compose ("Found LADSPA plugin, name: %1, Inputs: %2, Outputs: %3\n", info->name, info->n_inputs, info->n_outputs));
 	}
 
-// GDB WILL NOT LIKE YOU IF YOU DO THIS
-//	dlclose (module);
-
 	return 0;
 }
 
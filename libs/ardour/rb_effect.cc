@@ -64,22 +64,24 @@ RBEffect::~RBEffect ()
 int
 RBEffect::run (boost::shared_ptr<Region> r, Progress* progress)
 {
-	boost::shared_ptr<AudioRegion> region = boost::dynamic_pointer_cast<AudioRegion> (r);
+	if (prepare (r)) {
+		return -1;
+	}
+
+	return complete (process (0, progress) == 0);
+}
 
-	if (!region) {
+int
+RBEffect::prepare (boost::shared_ptr<Region> r)
+{
+	_region = boost::dynamic_pointer_cast<AudioRegion> (r);
+
+	if (!_region) {
 		error << "RBEffect::run() passed a non-audio region! WTF?" << endmsg;
 		return -1;
 	}
 
-	SourceList nsrcs;
-	int ret = -1;
-	const framecnt_t bufsize = 256;
-	gain_t* gain_buffer = 0;
-	Sample** buffers = 0;
-	char suffix[32];
-	string new_name;
-	string::size_type at;
-	boost::shared_ptr<AudioRegion> result;
+	boost::shared_ptr<AudioRegion> region (_region);
 
 	cerr << "RBEffect: source region: position = " << region->position()
 	     << ", start = " << region->start()
@@ -144,56 +146,81 @@ RBEffect::run (boost::shared_ptr<Region> r, Progress* progress)
 	   I hope this is clear.
 	*/
 
-	double stretch = region->stretch() * tsr.time_fraction;
-	double shift = region->shift() * tsr.pitch_fraction;
+	_stretch = region->stretch() * tsr.time_fraction;
+	_shift = region->shift() * tsr.pitch_fraction;
 
-	framecnt_t read_start = region->ancestral_start() +
+	_read_start = region->ancestral_start() +
 		framecnt_t(region->start() / (double)region->stretch());
 
-	framecnt_t read_duration =
+	_read_duration =
 		framecnt_t(region->length() / (double)region->stretch());
 
-	uint32_t channels = region->n_channels();
-
-	RubberBandStretcher stretcher
-		(session.frame_rate(), channels,
-		 (RubberBandStretcher::Options) tsr.opts, stretch, shift);
-
-	progress->set_progress (0);
 	tsr.done = false;
 
-	stretcher.setExpectedInputDuration(read_duration);
-	stretcher.setDebugLevel(1);
-
 	/* the name doesn't need to be super-precise, but allow for 2 fractional
 	   digits just to disambiguate close but not identical FX
 	*/
 
-	if (stretch == 1.0) {
-		snprintf (suffix, sizeof (suffix), "@%d", (int) floor (shift * 100.0f));
-	} else if (shift == 1.0) {
-		snprintf (suffix, sizeof (suffix), "@%d", (int) floor (stretch * 100.0f));
+	char suffix[32];
+
+	if (_stretch == 1.0) {
+		snprintf (suffix, sizeof (suffix), "@%d", (int) floor (_shift * 100.0f));
+	} else if (_shift == 1.0) {
+		snprintf (suffix, sizeof (suffix), "@%d", (int) floor (_stretch * 100.0f));
 	} else {
 		snprintf (suffix, sizeof (suffix), "@%d-%d",
-			  (int) floor (stretch * 100.0f),
-			  (int) floor (shift * 100.0f));
+			  (int) floor (_stretch * 100.0f),
+			  (int) floor (_shift * 100.0f));
 	}
 
+	_suffix = suffix;
+
 	/* create new sources */
 
+	_nsrcs.clear ();
+
+	if (make_new_sources (region, _nsrcs, _suffix)) {
+		complete (false);
+		return -1;
+	}
+
+	return 0;
+}
+
+/** Stretch the region given to prepare() into the new sources. This only
+ * reads the region and writes the new sources (which writes their peak
+ * files as it goes), so several regions may be processed concurrently.
+ */
+int
+RBEffect::process (uint32_t, Progress* progress)
+{
+	boost::shared_ptr<AudioRegion> region (_region);
+	const framecnt_t bufsize = 256;
+	uint32_t channels = region->n_channels();
+	framecnt_t const read_start = _read_start;
+	framecnt_t const read_duration = _read_duration;
+
+	RubberBandStretcher stretcher
+		(session.frame_rate(), channels,
+		 (RubberBandStretcher::Options) tsr.opts, _stretch, _shift);
+
+	if (progress) {
+		progress->set_progress (0);
+	}
+
+	stretcher.setExpectedInputDuration(read_duration);
+	stretcher.setDebugLevel(1);
+
 	framepos_t pos   = 0;
 	framecnt_t avail = 0;
 	framecnt_t done  = 0;
 
-	if (make_new_sources (region, nsrcs, suffix)) {
-		goto out;
-	}
-
-	gain_buffer = new gain_t[bufsize];
-	buffers = new float *[channels];
+	vector<gain_t> gain_buffer (bufsize);
+	vector<vector<float> > channel_buffers (channels, vector<float> (bufsize));
+	vector<float*> buffers (channels);
 
 	for (uint32_t i = 0; i < channels; ++i) {
-		buffers[i] = new float[bufsize];
+		buffers[i] = &channel_buffers[i][0];
 	}
 
 	/* we read from the master (original) sources for the region,
@@ -219,7 +246,7 @@ RBEffect::run (boost::shared_ptr<Region> r, Progress* progress)
 				this_read = region->master_read_at
 					(buffers[i],
 					 buffers[i],
-					 gain_buffer,
+					 &gain_buffer[0],
 					 this_position,
 					 this_time,
 					 i);
@@ -228,16 +255,18 @@ RBEffect::run (boost::shared_ptr<Region> r, Progress* progress)
 					error << string_compose
 						(_("tempoize: error reading data from %1 at %2 (wanted %3, got %4)"),
 						 region->name(), this_position, this_time, this_read) << endmsg;
-					goto out;
+					return -1;
 				}
 			}
 
 			pos += this_read;
 			done += this_read;
 
-			progress->set_progress (((float) done / read_duration) * 0.25);
+			if (progress) {
+				progress->set_progress (((float) done / read_duration) * 0.25);
+			}
 
-			stretcher.study(buffers, this_read, pos == read_duration);
+			stretcher.study(&buffers[0], this_read, pos == read_duration);
 		}
 
 		done = 0;
@@ -259,7 +288,7 @@ RBEffect::run (boost::shared_ptr<Region> r, Progress* progress)
 				this_read = region->master_read_at
 					(buffers[i],
 					 buffers[i],
-					 gain_buffer,
+					 &gain_buffer[0],
 					 this_position,
 					 this_time,
 					 i);
@@ -268,16 +297,18 @@ RBEffect::run (boost::shared_ptr<Region> r, Progress* progress)
 					error << string_compose
 						(_("tempoize: error reading data from %1 at %2 (wanted %3, got %4)"),
 						 region->name(), pos + region->position(), this_time, this_read) << endmsg;
-					goto out;
+					return -1;
 				}
 			}
 
 			pos += this_read;
 			done += this_read;
 
-			progress->set_progress (0.25 + ((float) done / read_duration) * 0.75);
+			if (progress) {
+				progress->set_progress (0.25 + ((float) done / read_duration) * 0.75);
+			}
 
-			stretcher.process(buffers, this_read, pos == read_duration);
+			stretcher.process(&buffers[0], this_read, pos == read_duration);
 
 			framecnt_t avail = 0;
 
@@ -285,18 +316,18 @@ RBEffect::run (boost::shared_ptr<Region> r, Progress* progress)
 
 				this_read = min (bufsize, avail);
 
-				stretcher.retrieve(buffers, this_read);
+				stretcher.retrieve(&buffers[0], this_read);
 
-				for (uint32_t i = 0; i < nsrcs.size(); ++i) {
+				for (uint32_t i = 0; i < _nsrcs.size(); ++i) {
 
-					boost::shared_ptr<AudioSource> asrc = boost::dynamic_pointer_cast<AudioSource>(nsrcs[i]);
+					boost::shared_ptr<AudioSource> asrc = boost::dynamic_pointer_cast<AudioSource>(_nsrcs[i]);
 					if (!asrc) {
 						continue;
 					}
 
 					if (asrc->write(buffers[i], this_read) != this_read) {
-						error << string_compose (_("error writing tempo-adjusted data to %1"), nsrcs[i]->name()) << endmsg;
-						goto out;
+						error << string_compose (_("error writing tempo-adjusted data to %1"), _nsrcs[i]->name()) << endmsg;
+						return -1;
 					}
 				}
 			}
@@ -306,19 +337,19 @@ RBEffect::run (boost::shared_ptr<Region> r, Progress* progress)
 
 			framecnt_t this_read = min (bufsize, avail);
 
-			stretcher.retrieve(buffers, this_read);
+			stretcher.retrieve(&buffers[0], this_read);
 
-			for (uint32_t i = 0; i < nsrcs.size(); ++i) {
+			for (uint32_t i = 0; i < _nsrcs.size(); ++i) {
 
-				boost::shared_ptr<AudioSource> asrc = boost::dynamic_pointer_cast<AudioSource>(nsrcs[i]);
+				boost::shared_ptr<AudioSource> asrc = boost::dynamic_pointer_cast<AudioSource>(_nsrcs[i]);
 				if (!asrc) {
 					continue;
 				}
 
 				if (asrc->write(buffers[i], this_read) !=
 				    this_read) {
-					error << string_compose (_("error writing tempo-adjusted data to %1"), nsrcs[i]->name()) << endmsg;
-					goto out;
+					error << string_compose (_("error writing tempo-adjusted data to %1"), _nsrcs[i]->name()) << endmsg;
+					return -1;
 				}
 			}
 		}
@@ -326,67 +357,66 @@ RBEffect::run (boost::shared_ptr<Region> r, Progress* progress)
 	} catch (runtime_error& err) {
 		error << string_compose (_("programming error: %1"), X_("timefx code failure")) << endmsg;
 		error << err.what() << endmsg;
-		goto out;
+		return -1;
 	}
 
-	new_name = region->name();
-	at = new_name.find ('@');
+	return 0;
+}
 
-	// remove any existing stretch indicator
+int
+RBEffect::complete (bool ok)
+{
+	boost::shared_ptr<AudioRegion> region (_region);
+	int ret = -1;
 
-	if (at != string::npos && at > 2) {
-		new_name = new_name.substr (0, at - 1);
-	}
+	if (ok && !tsr.cancel) {
 
-	new_name += suffix;
+		string new_name = region->name();
+		string::size_type at = new_name.find ('@');
 
-	ret = finish (region, nsrcs, new_name);
+		// remove any existing stretch indicator
 
-	/* now reset ancestral data for each new region */
+		if (at != string::npos && at > 2) {
+			new_name = new_name.substr (0, at - 1);
+		}
 
-	for (vector<boost::shared_ptr<Region> >::iterator x = results.begin(); x != results.end(); ++x) {
+		new_name += _suffix;
 
-		(*x)->set_ancestral_data (read_start,
-					  read_duration,
-					  stretch,
-					  shift);
-		(*x)->set_master_sources (region->master_sources());
-		/* multiply the old (possibly previously stretched) region length by the extra
-		   stretch this time around to get its new length. this is a non-music based edit atm.
-		*/
-		(*x)->set_length ((*x)->length() * tsr.time_fraction, 0);
-	}
+		ret = finish (region, _nsrcs, new_name);
 
-	/* stretch region gain envelope */
-	/* XXX: assuming we've only processed one input region into one result here */
+		/* now reset ancestral data for each new region */
 
-	if (tsr.time_fraction != 1) {
-		result = boost::dynamic_pointer_cast<AudioRegion> (results.front());
-		assert (result);
-		result->envelope()->x_scale (tsr.time_fraction);
-	}
+		for (vector<boost::shared_ptr<Region> >::iterator x = results.begin(); x != results.end(); ++x) {
 
-  out:
+			(*x)->set_ancestral_data (_read_start,
+						  _read_duration,
+						  _stretch,
+						  _shift);
+			(*x)->set_master_sources (region->master_sources());
+			/* multiply the old (possibly previously stretched) region length by the extra
+			   stretch this time around to get its new length. this is a non-music based edit atm.
+			*/
+			(*x)->set_length ((*x)->length() * tsr.time_fraction, 0);
+		}
 
-	delete [] gain_buffer;
+		/* stretch region gain envelope */
+		/* XXX: assuming we've only processed one input region into one result here */
 
-	if (buffers) {
-		for (uint32_t i = 0; i < channels; ++i) {
-			delete [] buffers[i];
+		if (tsr.time_fraction != 1) {
+			boost::shared_ptr<AudioRegion> result = boost::dynamic_pointer_cast<AudioRegion> (results.front());
+			assert (result);
+			result->envelope()->x_scale (tsr.time_fraction);
 		}
-		delete [] buffers;
 	}
 
 	if (ret || tsr.cancel) {
-		for (SourceList::iterator si = nsrcs.begin(); si != nsrcs.end(); ++si) {
+		for (SourceList::iterator si = _nsrcs.begin(); si != _nsrcs.end(); ++si) {
 			(*si)->mark_for_remove ();
 		}
 	}
 
+	_nsrcs.clear ();
+	_region.reset ();
+
 	return ret;
 }
-
-
-
-
-
@@ -67,6 +67,7 @@
 #include "ardour/profile.h"
 #include "ardour/route.h"
 #include "ardour/route_group.h"
+#include "ardour/route_pipeline.h"
 #include "ardour/send.h"
 #include "ardour/session.h"
 #include "ardour/solo_control.h"
@@ -102,6 +103,10 @@ Route::Route (Session& sess, string name, PresentationInfo::Flag flag, DataType
 	, _pending_meter_point (MeterPostFader)
 	, _meter_type (MeterPeak)
 	, _denormal_protection (false)
+	, _pipelined (false)
+	, _processed_cycles (0)
+	, _skipped_cycles (0)
+	, _reset_cycle_stats (0)
 	, _recordable (true)
 	, _silent (false)
 	, _declickable (false)
@@ -418,9 +423,32 @@ Route::process_output_buffers (BufferSet& bufs,
 
 	framecnt_t latency = 0;
 	const double speed = _session.transport_speed ();
+	const bool profile = _session.engine().profiling ();
+
+	uint32_t n_plugins = 0;
+	uint32_t n_skipped = 0;
+
+	/* with pipelining, a run of plugins is handed to another thread */
+	ProcessorList::const_iterator pipe_begin;
+	ProcessorList::const_iterator pipe_end;
+	bool const pipelining = pipeline_stage (pipe_begin, pipe_end) && nframes <= _pipeline->delay ();
 
 	for (ProcessorList::const_iterator i = _processors.begin(); i != _processors.end(); ++i) {
 
+		if (pipelining && i == pipe_begin) {
+			/* the rest of the chain processes what the stage produced
+			 * one cycle ago, see also ::update_signal_latency()
+			 */
+			_pipeline->start (bufs, pipe_begin, pipe_end, start_frame, end_frame, speed, nframes,
+			                  latency, _initial_delay, _signal_latency);
+			for (; i != pipe_end; ++i) {
+				if ((*i)->active ()) {
+					latency += (*i)->signal_latency ();
+				}
+			}
+			latency += _pipeline->delay ();
+		}
+
 		if (meter_already_run && boost::dynamic_pointer_cast<PeakMeter> (*i)) {
 			/* don't ::run() the meter, otherwise it will have its previous peak corrupted */
 			continue;
@@ -447,19 +475,45 @@ Route::process_output_buffers (BufferSet& bufs,
 		if (boost::dynamic_pointer_cast<Send>(*i) != 0) {
 			boost::dynamic_pointer_cast<Send>(*i)->set_delay_in(_signal_latency - latency);
 		}
-		if (boost::dynamic_pointer_cast<PluginInsert>(*i) != 0) {
+		boost::shared_ptr<PluginInsert> pi = boost::dynamic_pointer_cast<PluginInsert>(*i);
+		if (pi) {
 			const framecnt_t longest_session_latency = _initial_delay + _signal_latency;
-			boost::dynamic_pointer_cast<PluginInsert>(*i)->set_sidechain_latency (
-					_initial_delay + latency, longest_session_latency - latency);
+			pi->set_sidechain_latency (_initial_delay + latency, longest_session_latency - latency);
 		}
 
-		(*i)->run (bufs, start_frame - latency, end_frame - latency, speed, nframes, *i != _processors.back());
+		{
+			PBD::HistogramTimer timer ((*i)->dsp_timing (), profile);
+			(*i)->run (bufs, start_frame - latency, end_frame - latency, speed, nframes, *i != _processors.back());
+		}
 		bufs.set_count ((*i)->output_streams());
 
+		if (pi) {
+			++n_plugins;
+			if (pi->skipped ()) {
+				++n_skipped;
+			}
+		}
+
 		if ((*i)->active ()) {
 			latency += (*i)->signal_latency ();
 		}
 	}
+
+	if (pipelining) {
+		_pipeline->join ();
+	}
+
+	if (g_atomic_int_compare_and_exchange (&_reset_cycle_stats, 1, 0)) {
+		_processed_cycles = _skipped_cycles = 0;
+	}
+
+	if (n_plugins > 0) {
+		if (n_plugins == n_skipped) {
+			++_skipped_cycles;
+		} else {
+			++_processed_cycles;
+		}
+	}
 }
 
 void
@@ -1841,6 +1895,8 @@ Route::configure_processors_unlocked (ProcessorStreams* err, Glib::Threads::RWLo
 	*/
 	_session.ensure_buffers (n_process_buffers ());
 
+	configure_pipeline ();
+
 	DEBUG_TRACE (DEBUG::Processors, string_compose ("%1: configuration complete\n", _name));
 
 	_in_configure_processors = false;
@@ -2306,6 +2362,7 @@ Route::state(bool full_state)
 	node->add_property("active", _active?"yes":"no");
 	string p;
 	node->add_property("denormal-protection", _denormal_protection?"yes":"no");
+	node->add_property("pipelined", _pipelined?"yes":"no");
 	node->add_property("meter-point", enum_2_string (_meter_point));
 
 	node->add_property("meter-type", enum_2_string (_meter_type));
@@ -2480,6 +2537,10 @@ Route::set_state (const XMLNode& node, int version)
 		set_denormal_protection (string_is_affirmative (prop->value()));
 	}
 
+	if ((prop = node.property (X_("pipelined"))) != 0) {
+		set_pipelined (string_is_affirmative (prop->value()));
+	}
+
 	if ((prop = node.property (X_("active"))) != 0) {
 		bool yn = string_is_affirmative (prop->value());
 		set_active (yn, this);
@@ -3818,7 +3879,15 @@ Route::update_signal_latency ()
 	framecnt_t ltrim = 0;
 	bool before_trim = true;
 
+	ProcessorList::const_iterator pipe_begin;
+	ProcessorList::const_iterator pipe_end;
+	bool const pipelining = pipeline_stage (pipe_begin, pipe_end);
+
 	for (ProcessorList::iterator i = _processors.begin(); i != _processors.end(); ++i) {
+		if (pipelining && *i == *pipe_end) {
+			/* one cycle between the pipeline stages */
+			l += _pipeline->delay ();
+		}
 		if ((*i)->active ()) {
 			l += (*i)->signal_latency ();
 		}
@@ -3890,6 +3959,7 @@ Route::set_block_size (pframes_t nframes)
 	}
 
 	_session.ensure_buffers (n_process_buffers ());
+	configure_pipeline ();
 }
 
 void
@@ -4117,6 +4187,94 @@ Route::denormal_protection () const
 	return _denormal_protection;
 }
 
+void
+Route::reset_dsp_timing ()
+{
+	_process_timing.reset ();
+
+	Glib::Threads::RWLock::ReaderLock lm (_processor_lock);
+	for (ProcessorList::const_iterator i = _processors.begin(); i != _processors.end(); ++i) {
+		(*i)->dsp_timing ().reset ();
+	}
+}
+
+void
+Route::set_pipelined (bool yn)
+{
+	if (_pipelined == yn) {
+		return;
+	}
+
+	{
+		Glib::Threads::Mutex::Lock lx (AudioEngine::instance()->process_lock ());
+		Glib::Threads::RWLock::WriterLock lm (_processor_lock);
+		_pipelined = yn;
+		configure_pipeline ();
+	}
+
+	_session.update_latency_compensation ();
+	pipelined_changed (); /* EMIT SIGNAL */
+}
+
+/** Caller must hold the process lock */
+void
+Route::configure_pipeline ()
+{
+	if (!_pipelined || !_session._process_graph || is_monitor () || is_auditioner ()) {
+		/* without a process graph there is nothing to run the stage in parallel */
+		_pipeline.reset ();
+		return;
+	}
+
+	if (!_pipeline) {
+		_pipeline.reset (new RoutePipeline (_session._process_graph));
+	}
+
+	_pipeline->configure (n_process_buffers (), _session.engine ().samples_per_cycle ());
+}
+
+static bool
+can_pipeline (boost::shared_ptr<Processor> p)
+{
+	return boost::dynamic_pointer_cast<PluginInsert> (p)
+		&& p->input_streams ().n_midi () == 0
+		&& p->output_streams ().n_midi () == 0;
+}
+
+/** Find the front stage of a pipelined route: the first half of the first
+ *  run of (at least two) audio-only plugins.
+ *  Caller must hold the processor lock.
+ *  @return true if the route is to be pipelined
+ */
+bool
+Route::pipeline_stage (ProcessorList::const_iterator& begin, ProcessorList::const_iterator& end) const
+{
+	if (!_pipelined || !_pipeline || _pipeline->delay () == 0) {
+		return false;
+	}
+
+	ProcessorList::const_iterator i = _processors.begin ();
+
+	while (i != _processors.end () && !can_pipeline (*i)) {
+		++i;
+	}
+
+	begin = i;
+
+	uint32_t n = 0;
+	for (; i != _processors.end () && can_pipeline (*i); ++i) {
+		++n;
+	}
+
+	if (n < 2 || i == _processors.end ()) {
+		return false;
+	}
+
+	end = begin;
+	std::advance (end, (n + 1) / 2);
+	return true;
+}
+
 void
 Route::set_active (bool yn, void* src)
 {
@@ -4759,6 +4917,10 @@ Route::non_realtime_locate (framepos_t pos)
 		_delayline.get()->flush();
 	}
 
+	if (_pipeline) {
+		_pipeline->flush ();
+	}
+
 	{
 		//Glib::Threads::Mutex::Lock lx (AudioEngine::instance()->process_lock ());
 		Glib::Threads::RWLock::ReaderLock lm (_processor_lock);
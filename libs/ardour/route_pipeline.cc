@@ -0,0 +1,174 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "ardour/audio_buffer.h"
+#include "ardour/audioengine.h"
+#include "ardour/graph.h"
+#include "ardour/plugin_insert.h"
+#include "ardour/route_pipeline.h"
+
+using namespace ARDOUR;
+
+RoutePipeline::RoutePipeline (boost::shared_ptr<Graph> graph)
+	: GraphNode (graph)
+	, _delay (0)
+	, _pos (0)
+	, _flush (false)
+	, _done ("route_pipeline", 0)
+	, _start_frame (0)
+	, _end_frame (0)
+	, _speed (0)
+	, _nframes (0)
+	, _latency (0)
+	, _initial_delay (0)
+	, _signal_latency (0)
+{
+}
+
+void
+RoutePipeline::configure (ChanCount const & chn, framecnt_t delay)
+{
+	_bufs.ensure_buffers (chn, std::max (delay, (framecnt_t) 1));
+	_delayed.ensure_buffers (DataType::AUDIO, chn.n_audio (), std::max (delay, (framecnt_t) 1));
+
+	if (_delay != delay) {
+		_delay = delay;
+		_pos = 0;
+	}
+
+	for (BufferSet::audio_iterator i = _delayed.audio_begin (); i != _delayed.audio_end (); ++i) {
+		memset (i->data (), 0, sizeof (Sample) * _delay);
+	}
+}
+
+void
+RoutePipeline::start (BufferSet& bufs, ProcessorList::const_iterator begin, ProcessorList::const_iterator end,
+                      framepos_t start_frame, framepos_t end_frame, double speed, pframes_t nframes,
+                      framecnt_t latency, framecnt_t initial_delay, framecnt_t signal_latency)
+{
+	assert (begin != end);
+	assert (nframes <= _delay);
+
+	if (_flush) {
+		for (BufferSet::audio_iterator i = _delayed.audio_begin (); i != _delayed.audio_end (); ++i) {
+			memset (i->data (), 0, sizeof (Sample) * _delay);
+		}
+		_pos = 0;
+		_flush = false;
+	}
+
+	_begin = begin;
+	_end = end;
+	_start_frame = start_frame;
+	_end_frame = end_frame;
+	_speed = speed;
+	_nframes = nframes;
+	_latency = latency;
+	_initial_delay = initial_delay;
+	_signal_latency = signal_latency;
+
+	_bufs.read_from (bufs, nframes);
+
+	/* hand the output of the previous cycle(s) to the rest of the route */
+	ProcessorList::const_iterator last = end;
+	--last;
+	ChanCount out = (*last)->output_streams ();
+	out.set (DataType::AUDIO, std::min (out.n_audio (), _delayed.available ().n_audio ()));
+
+	framecnt_t const n0 = std::min ((framecnt_t) nframes, _delay - _pos);
+
+	for (uint32_t c = 0; c < out.n_audio (); ++c) {
+		Sample* dst = bufs.get_audio (c).data ();
+		Sample const* src = _delayed.get_audio (c).data ();
+		memcpy (dst, src + _pos, sizeof (Sample) * n0);
+		memcpy (dst + n0, src, sizeof (Sample) * (nframes - n0));
+	}
+
+	bufs.set_count (out);
+
+	if (_graph) {
+		_graph->trigger_and_wake (this);
+	}
+}
+
+void
+RoutePipeline::join ()
+{
+	if (!_graph || _graph->cancel_trigger (this)) {
+		/* nobody picked it up, do it ourselves */
+		run_front ();
+	} else {
+		_done.wait ();
+	}
+
+	uint32_t const n_audio = std::min (_bufs.count ().n_audio (), _delayed.available ().n_audio ());
+	framecnt_t const n0 = std::min ((framecnt_t) _nframes, _delay - _pos);
+
+	for (uint32_t c = 0; c < n_audio; ++c) {
+		Sample const* src = _bufs.get_audio (c).data ();
+		Sample* dst = _delayed.get_audio (c).data ();
+		memcpy (dst + _pos, src, sizeof (Sample) * n0);
+		memcpy (dst, src + n0, sizeof (Sample) * (_nframes - n0));
+	}
+
+	_pos = (_pos + _nframes) % _delay;
+}
+
+void
+RoutePipeline::run_front ()
+{
+	framecnt_t latency = _latency;
+	framecnt_t const longest_session_latency = _initial_delay + _signal_latency;
+	bool const profile = AudioEngine::instance ()->profiling ();
+
+	for (ProcessorList::const_iterator i = _begin; i != _end; ++i) {
+		boost::shared_ptr<PluginInsert> pi = boost::dynamic_pointer_cast<PluginInsert> (*i);
+		if (pi) {
+			pi->set_sidechain_latency (_initial_delay + latency, longest_session_latency - latency);
+		}
+
+		{
+			PBD::HistogramTimer timer ((*i)->dsp_timing (), profile);
+			(*i)->run (_bufs, _start_frame - latency, _end_frame - latency, _speed, _nframes, true);
+		}
+		_bufs.set_count ((*i)->output_streams ());
+
+		if ((*i)->active ()) {
+			latency += (*i)->signal_latency ();
+		}
+	}
+}
+
+/** Called by a graph thread which picked up the queued stage */
+void
+RoutePipeline::process ()
+{
+	run_front ();
+	_done.signal ();
+}
+
+void
+RoutePipeline::finish (int)
+{
+	/* not part of the graph's chain; nothing to activate */
+}
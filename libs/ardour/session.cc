@@ -308,6 +308,7 @@ Session::Session (AudioEngine &eng,
 	, _preroll_record_trim_len (0)
 	, _count_in_once (false)
 	, main_outs (0)
+	, _source_usage_index (0)
 	, first_file_data_format_reset (true)
 	, first_file_header_format_reset (true)
 	, have_looped (false)
@@ -653,6 +654,14 @@ Session::destroy ()
 	delete state_tree;
 	state_tree = 0;
 
+	if (_source_usage_index) {
+		if (_writable) {
+			_source_usage_index->save ();
+		}
+		delete _source_usage_index;
+		_source_usage_index = 0;
+	}
+
 	// unregister all lua functions, drop held references (if any)
 	(*_lua_cleanup)();
 	lua.do_command ("Session = nil");
@@ -668,7 +677,6 @@ Session::destroy ()
 	/* reset dynamic state version back to default */
 	Stateful::loading_state_version = 0;
 
-	_butler->drop_references ();
 	delete _butler;
 	_butler = 0;
 
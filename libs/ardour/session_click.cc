@@ -37,7 +37,7 @@ using namespace std;
 using namespace ARDOUR;
 using namespace PBD;
 
-Pool Click::pool ("click", sizeof (Click), 1024);
+PBD::Arena Click::arena ("click");
 
 void
 Session::add_click (framepos_t pos, bool emphasis)
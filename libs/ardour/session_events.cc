@@ -34,28 +34,32 @@ using namespace std;
 using namespace ARDOUR;
 using namespace PBD;
 
-PerThreadPool* SessionEvent::pool;
+PBD::Arena* SessionEvent::pool;
+
+static void delete_event (SessionEvent* ev) { delete ev; }
 
 void
 SessionEvent::init_event_pool ()
 {
-	pool = new PerThreadPool;
+	pool = new PBD::Arena (X_("SessionEvent"));
 }
 
 bool
 SessionEvent::has_per_thread_pool ()
 {
-	return pool->has_per_thread_pool ();
+	return pool->has_heap ();
 }
 
 void
 SessionEvent::create_per_thread_pool (const std::string& name, uint32_t nitems)
 {
-	/* this is a per-thread call that simply creates a thread-private ptr to
-	   a CrossThreadPool for use by this thread whenever events are allocated/released
-	   from SessionEvent::pool()
+	/* this is a per-thread call that makes sure that this thread's heap in
+	   the event arena holds at least nitems events, so that it can allocate
+	   them without touching the system allocator. Events may be deleted
+	   by any thread.
 	*/
-	pool->create_per_thread_pool (name, sizeof (SessionEvent), nitems);
+	DEBUG_TRACE (DEBUG::SessionEvents, string_compose ("%1 reserves %2 events for %3\n", pthread_name(), nitems, name));
+	pool->reserve (sizeof (SessionEvent), nitems);
 }
 
 SessionEvent::SessionEvent (Type t, Action a, framepos_t when, framepos_t where, double spd, bool yn, bool yn2, bool yn3)
@@ -73,38 +77,22 @@ SessionEvent::SessionEvent (Type t, Action a, framepos_t when, framepos_t where,
 }
 
 void *
-SessionEvent::operator new (size_t)
+SessionEvent::operator new (size_t sz)
 {
-	CrossThreadPool* p = pool->per_thread_pool ();
-	SessionEvent* ev = static_cast<SessionEvent*> (p->alloc ());
-	DEBUG_TRACE (DEBUG::SessionEvents, string_compose ("%1 Allocating SessionEvent from %2 ev @ %3 pool size %4 free %5 used %6\n", pthread_name(), p->name(), ev,
-	                                                   p->total(), p->available(), p->used()));
-
-	ev->own_pool = p;
+	void* ev = pool->alloc (sz);
+	DEBUG_TRACE (DEBUG::SessionEvents, string_compose ("%1 Allocating SessionEvent ev @ %2\n", pthread_name(), ev));
 	return ev;
 }
 
 void
 SessionEvent::operator delete (void *ptr, size_t /*size*/)
 {
-	Pool* p = pool->per_thread_pool (false);
-	SessionEvent* ev = static_cast<SessionEvent*> (ptr);
-
-	DEBUG_TRACE (DEBUG::SessionEvents, string_compose (
-		             "%1 Deleting SessionEvent @ %2 type %3 action %4 ev thread pool = %5 ev pool = %6 size %7 free %8 used %9\n",
-		             pthread_name(), ev, enum_2_string (ev->type), enum_2_string (ev->action), p->name(), ev->own_pool->name(), ev->own_pool->total(), ev->own_pool->available(), ev->own_pool->used()
-		             ));
+	DEBUG_TRACE (DEBUG::SessionEvents, string_compose ("%1 Deleting SessionEvent @ %2\n", pthread_name(), ptr));
 
-	if (p && p == ev->own_pool) {
-		p->release (ptr);
-	} else {
-		assert(ev->own_pool);
-		ev->own_pool->push (ev);
-		DEBUG_TRACE (DEBUG::SessionEvents, string_compose ("%1 was wrong thread for this pool, pushed event onto pending list, will be deleted on next alloc from %2 pool size %3 free %4 used %5 pending %6\n",
-		                                                   pthread_name(), ev->own_pool->name(),
-		                                                   ev->own_pool->total(), ev->own_pool->available(), ev->own_pool->used(),
-		                                                   ev->own_pool->pending_size()));
-	}
+	/* the event goes back to the heap of the thread that allocated it,
+	   whichever thread deletes it.
+	*/
+	PBD::Arena::release (ptr);
 }
 
 void
@@ -141,14 +129,13 @@ SessionEventManager::clear_events (SessionEvent::Type type, boost::function<void
 	SessionEvent* ev = new SessionEvent (type, SessionEvent::Clear, SessionEvent::Immediate, 0, 0);
 	ev->rt_slot = after;
 
-	/* in the calling thread, after the clear is complete, arrange to flush things from the event
-	   pool pending list (i.e. to make sure they are really back in the free list and available
-	   for future events).
+	/* in the calling thread, after the clear is complete, delete the event
+	   (and with it the "after" functor) outside of the realtime context.
 	*/
 
 	ev->event_loop = PBD::EventLoop::get_event_loop_for_thread ();
 	if (ev->event_loop) {
-		ev->rt_return = boost::bind (&CrossThreadPool::flush_pending_with_ev, ev->event_pool(), _1);
+		ev->rt_return = delete_event;
 	}
 
 	queue_event (ev);
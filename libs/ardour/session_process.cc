@@ -29,6 +29,7 @@
 
 #include "ardour/audioengine.h"
 #include "ardour/auditioner.h"
+#include "ardour/automation_watch.h"
 #include "ardour/butler.h"
 #include "ardour/cycle_timer.h"
 #include "ardour/debug.h"
@@ -73,8 +74,17 @@ Session::process (pframes_t nframes)
 
 	_engine.main_thread()->get_buffers ();
 
+	const framepos_t audible_at_start = audible_frame ();
+	const bool rolling_at_start = transport_rolling ();
+
 	(this->*process_function) (nframes);
 
+	/* record the values of controls in automation write passes */
+	AutomationWatch::capture (audible_at_start, rolling_at_start);
+
+	/* all meters have run */
+	_meter_snapshot.publish ();
+
 	/* realtime-safe meter-position and processor-order changes
 	 *
 	 * ideally this would be done in
@@ -155,6 +165,8 @@ Session::no_roll (pframes_t nframes)
 
 			(*i)->set_pending_declick (declick);
 
+			PBD::HistogramTimer route_timer ((*i)->process_timing (), _engine.profiling ());
+
 			if ((*i)->no_roll (nframes, _transport_frame, end_frame, non_realtime_work_pending())) {
 				error << string_compose(_("Session: error in no roll for %1"), (*i)->name()) << endmsg;
 				ret = -1;
@@ -200,6 +212,8 @@ Session::process_routes (pframes_t nframes, bool& need_butler)
 
 			bool b = false;
 
+			PBD::HistogramTimer route_timer ((*i)->process_timing (), _engine.profiling ());
+
 			if ((ret = (*i)->roll (nframes, start_frame, end_frame, declick, b)) < 0) {
 				stop_transport ();
 				return -1;
@@ -238,6 +252,8 @@ Session::silent_process_routes (pframes_t nframes, bool& need_butler)
 
 			bool b = false;
 
+			PBD::HistogramTimer route_timer ((*i)->process_timing (), _engine.profiling ());
+
 			if ((ret = (*i)->silent_roll (nframes, start_frame, end_frame, b)) < 0) {
 				stop_transport ();
 				return -1;
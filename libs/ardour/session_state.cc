@@ -63,6 +63,7 @@
 #include "evoral/SMF.hpp"
 
 #include "pbd/basename.h"
+#include "pbd/cpus.h"
 #include "pbd/debug.h"
 #include "pbd/enumwriter.h"
 #include "pbd/error.h"
@@ -892,6 +893,16 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 
 		save_history (snapshot_name);
 
+		if (!template_only) {
+			/* keep the source usage index up to date, using the state
+			 * we have in hand rather than reading the file again later.
+			 */
+			SourceUsageIndex::Usage usage;
+			if (source_usage_of_state (*tree.root(), usage) == 0) {
+				source_usage_index ().add (Glib::build_filename (_path, legalize_for_path (snapshot_name)) + statefile_suffix, usage);
+			}
+		}
+
 		if (mark_as_clean) {
 			bool was_dirty = dirty();
 
@@ -2977,28 +2988,24 @@ accept_all_state_files (const string& path, void* /*arg*/)
 	}
 }
 
+/** Add the sources listed by the state in @param root to @param usage,
+ * with the playlists and number of regions using each of them.
+ */
 int
-Session::find_all_sources (string path, set<string>& result)
+Session::source_usage_of_state (XMLNode const & root, SourceUsageIndex::Usage& usage)
 {
-	XMLTree tree;
 	XMLNode* node;
 
-	if (!tree.read (path)) {
-		return -1;
-	}
-
-	if ((node = find_named_node (*tree.root(), "Sources")) == 0) {
+	if ((node = find_named_node (root, "Sources")) == 0) {
 		return -2;
 	}
 
-	XMLNodeList nlist;
-	XMLNodeConstIterator niter;
-
-	nlist = node->children();
+	/* source ID to path, for the regions below */
+	map<string,string> paths;
 
-	set_dirty();
+	XMLNodeList const & nlist = node->children();
 
-	for (niter = nlist.begin(); niter != nlist.end(); ++niter) {
+	for (XMLNodeConstIterator niter = nlist.begin(); niter != nlist.end(); ++niter) {
 
 		XMLProperty const * prop;
 
@@ -3017,26 +3024,100 @@ Session::find_all_sources (string path, set<string>& result)
 			continue;
 		}
 
+		XMLProperty const * id = (*niter)->property (X_("id"));
 		string found_path;
-		bool is_new;
-		uint16_t chan;
 
-		if (FileSource::find (*this, type, prop->value(), true, is_new, chan, found_path)) {
-			result.insert (found_path);
+		/* sources are shared by all snapshots, so most are already
+		 * known and there is no need to look for their files.
+		 */
+
+		if (id) {
+			Glib::Threads::Mutex::Lock lm (source_lock);
+			SourceMap::const_iterator i = sources.find (PBD::ID (id->value()));
+			boost::shared_ptr<FileSource> fs;
+			if (i != sources.end() && (fs = boost::dynamic_pointer_cast<FileSource> (i->second)) != 0) {
+				found_path = fs->path();
+			}
+		}
+
+		if (found_path.empty()) {
+			bool is_new;
+			uint16_t chan;
+
+			if (!FileSource::find (*this, type, prop->value(), true, is_new, chan, found_path)) {
+				continue;
+			}
+		}
+
+		usage[found_path];
+
+		if (id) {
+			paths[id->value()] = found_path;
+		}
+	}
+
+	const char* const playlist_nodes[] = { X_("Playlists"), X_("UnusedPlaylists") };
+
+	for (size_t n = 0; n < sizeof (playlist_nodes) / sizeof (playlist_nodes[0]); ++n) {
+
+		if ((node = root.child (playlist_nodes[n])) == 0) {
+			continue;
+		}
+
+		XMLNodeList const & playlists = node->children();
+
+		for (XMLNodeConstIterator p = playlists.begin(); p != playlists.end(); ++p) {
+
+			XMLProperty const * name = (*p)->property (X_("name"));
+
+			if (!name) {
+				continue;
+			}
+
+			XMLNodeList const & regions = (*p)->children (X_("Region"));
+
+			for (XMLNodeConstIterator r = regions.begin(); r != regions.end(); ++r) {
+
+				XMLPropertyList const & props = (*r)->properties();
+
+				for (XMLPropertyConstIterator i = props.begin(); i != props.end(); ++i) {
+
+					if ((*i)->name().compare (0, 7, X_("source-")) != 0) {
+						continue;
+					}
+
+					map<string,string>::const_iterator s = paths.find ((*i)->value());
+
+					if (s != paths.end()) {
+						SourceUsageIndex::Use& use (usage[s->second]);
+						use.playlists.insert (name->value());
+						++use.regions;
+					}
+				}
+			}
 		}
 	}
 
 	return 0;
 }
 
+SourceUsageIndex&
+Session::source_usage_index ()
+{
+	if (!_source_usage_index) {
+		_source_usage_index = new SourceUsageIndex (_path);
+	}
+	return *_source_usage_index;
+}
+
+/** Bring the source usage index up to date with the state files of the
+ * session, parsing only those which changed since they were indexed.
+ * @param state_files is filled with the paths of the state files.
+ */
 int
-Session::find_all_sources_across_snapshots (set<string>& result, bool exclude_this_snapshot)
+Session::refresh_source_usage_index (vector<string>& state_files)
 {
-	vector<string> state_files;
 	string ripped;
-	string this_snapshot_path;
-
-	result.clear ();
 
 	ripped = _path;
 
@@ -3046,9 +3127,40 @@ Session::find_all_sources_across_snapshots (set<string>& result, bool exclude_th
 
 	find_files_matching_filter (state_files, ripped, accept_all_state_files, (void *) 0, true, true);
 
-	if (state_files.empty()) {
-		/* impossible! */
-		return 0;
+	SourceUsageIndex& index (source_usage_index ());
+
+	for (vector<string>::iterator i = state_files.begin(); i != state_files.end(); ++i) {
+
+		if (index.lookup (*i)) {
+			continue;
+		}
+
+		XMLTree tree;
+		SourceUsageIndex::Usage usage;
+
+		if (!tree.read (*i) || source_usage_of_state (*tree.root(), usage) < 0) {
+			return -1;
+		}
+
+		index.add (*i, usage);
+	}
+
+	index.retain (set<string> (state_files.begin(), state_files.end()));
+	index.save ();
+
+	return 0;
+}
+
+int
+Session::find_all_sources_across_snapshots (set<string>& result, bool exclude_this_snapshot)
+{
+	vector<string> state_files;
+	string this_snapshot_path;
+
+	result.clear ();
+
+	if (refresh_source_usage_index (state_files)) {
+		return -1;
 	}
 
 	this_snapshot_path = Glib::build_filename (_path, legalize_for_path (_current_snapshot_name));
@@ -3056,19 +3168,37 @@ Session::find_all_sources_across_snapshots (set<string>& result, bool exclude_th
 
 	for (vector<string>::iterator i = state_files.begin(); i != state_files.end(); ++i) {
 
-		cerr << "Looking at snapshot " << (*i) << " ( with this = [" << this_snapshot_path << "])\n";
-
 		if (exclude_this_snapshot && *i == this_snapshot_path) {
-			cerr << "\texcluded\n";
 			continue;
-
 		}
 
-		if (find_all_sources (*i, result) < 0) {
+		SourceUsageIndex::Usage const * usage = source_usage_index ().lookup (*i);
+
+		if (!usage) {
+			/* changed since it was indexed a moment ago */
 			return -1;
 		}
+
+		for (SourceUsageIndex::Usage::const_iterator u = usage->begin(); u != usage->end(); ++u) {
+			result.insert (u->first);
+		}
+	}
+
+	return 0;
+}
+
+int
+Session::snapshots_using_source (string const & path, SourceUsageIndex::SnapshotUses& uses)
+{
+	vector<string> state_files;
+
+	uses.clear ();
+
+	if (refresh_source_usage_index (state_files)) {
+		return -1;
 	}
 
+	source_usage_index ().snapshots_using (path, uses);
 	return 0;
 }
 
@@ -3209,10 +3339,8 @@ Session::cleanup_sources (CleanupReport& rep)
 	vector<string> candidates;
 	vector<string> unused;
 	set<string> sources_used_by_all_snapshots;
-	string spath;
+	set<string> canonical_sources_used;
 	int ret = -1;
-	string tmppath1;
-	string tmppath2;
 	Searchpath asp;
 	Searchpath msp;
 	set<boost::shared_ptr<Source> > sources_used_by_this_snapshot;
@@ -3368,26 +3496,13 @@ Session::cleanup_sources (CleanupReport& rep)
 	cerr << "Candidates: " << candidates.size() << endl;
 	cerr << "Used by others: " << sources_used_by_all_snapshots.size() << endl;
 
-	for (vector<string>::iterator x = candidates.begin(); x != candidates.end(); ++x) {
-
-		bool used = false;
-		spath = *x;
-
-		for (set<string>::iterator i = sources_used_by_all_snapshots.begin(); i != sources_used_by_all_snapshots.end(); ++i) {
-
-			tmppath1 = canonical_path (spath);
-			tmppath2 = canonical_path ((*i));
-
-			cerr << "\t => " << tmppath2 << endl;
-
-			if (tmppath1 == tmppath2) {
-				used = true;
-				break;
-			}
-		}
+	for (set<string>::iterator i = sources_used_by_all_snapshots.begin(); i != sources_used_by_all_snapshots.end(); ++i) {
+		canonical_sources_used.insert (canonical_path (*i));
+	}
 
-		if (!used) {
-			unused.push_back (spath);
+	for (vector<string>::iterator x = candidates.begin(); x != candidates.end(); ++x) {
+		if (canonical_sources_used.find (canonical_path (*x)) == canonical_sources_used.end()) {
+			unused.push_back (*x);
 		}
 	}
 
@@ -3889,6 +4004,11 @@ Session::restore_history (string snapshot_name)
 				boost::shared_ptr<MidiSource> midi_source =
 					boost::dynamic_pointer_cast<MidiSource, Source>(source_by_id(id));
 				if (midi_source) {
+					{
+						/* models are loaded when first needed */
+						Source::Lock lm (midi_source->mutex());
+						midi_source->load_model (lm);
+					}
 					ut->add_command (new MidiModel::NoteDiffCommand(midi_source->model(), *n));
 				} else {
 					error << _("Failed to downcast MidiSource for NoteDiffCommand") << endmsg;
@@ -3900,6 +4020,10 @@ Session::restore_history (string snapshot_name)
 				boost::shared_ptr<MidiSource> midi_source =
 					boost::dynamic_pointer_cast<MidiSource, Source>(source_by_id(id));
 				if (midi_source) {
+					{
+						Source::Lock lm (midi_source->mutex());
+						midi_source->load_model (lm);
+					}
 					ut->add_command (new MidiModel::SysExDiffCommand (midi_source->model(), *n));
 				} else {
 					error << _("Failed to downcast MidiSource for SysExDiffCommand") << endmsg;
@@ -3911,6 +4035,10 @@ Session::restore_history (string snapshot_name)
 				boost::shared_ptr<MidiSource> midi_source =
 					boost::dynamic_pointer_cast<MidiSource, Source>(source_by_id(id));
 				if (midi_source) {
+					{
+						Source::Lock lm (midi_source->mutex());
+						midi_source->load_model (lm);
+					}
 					ut->add_command (new MidiModel::PatchChangeDiffCommand (midi_source->model(), *n));
 				} else {
 					error << _("Failed to downcast MidiSource for PatchChangeDiffCommand") << endmsg;
@@ -5116,9 +5244,67 @@ Session::save_as (SaveAs& saveas)
 	return 0;
 }
 
-static void set_progress (Progress* p, size_t n, size_t t)
+static void set_progress (Progress* p, gint64 start, size_t n, size_t t)
 {
 	p->set_progress (float (n) / float(t));
+
+	gint64 const elapsed = g_get_monotonic_time () - start;
+	if (elapsed > 0) {
+		p->set_rate (n * 1e6 / elapsed);
+	}
+}
+
+namespace {
+
+/** One source to be encoded to FLAC by Session::archive_session(), on a
+ * worker thread. Progress is collected here for the calling thread to
+ * report, since a Progress may only be used by the GUI thread.
+ */
+struct ArchiveEncodeJob : public Progress
+{
+	ArchiveEncodeJob (Session& s, boost::shared_ptr<AudioFileSource> a, std::string const & p, bool b16, gint* d)
+		: session (s)
+		, afs (a)
+		, new_path (p)
+		, use16bits (b16)
+		, encoded (0)
+		, bytes (0)
+		, permille (0)
+		, n_done (d)
+	{
+		GStatBuf sb;
+		if (g_stat (afs->path().c_str(), &sb) == 0) {
+			bytes = sb.st_size;
+		}
+	}
+
+	void run ()
+	{
+		try {
+			encoded = new SndFileSource (session, *(afs.get()), new_path, use16bits, this);
+		} catch (...) {
+			encoded = 0;
+		}
+		g_atomic_int_set (&permille, 1000);
+		g_atomic_int_inc (n_done);
+	}
+
+	float done () const { return g_atomic_int_get (&permille) / 1000.f; }
+
+	Session& session;
+	boost::shared_ptr<AudioFileSource> afs;
+	std::string new_path;
+	bool use16bits;
+	SndFileSource* encoded;
+	int64_t bytes;
+
+private:
+	void set_overall_progress (float p) { g_atomic_int_set (&permille, (gint) (p * 1000)); }
+
+	gint  permille;
+	gint* n_done;
+};
+
 }
 
 int
@@ -5192,9 +5378,6 @@ Session::archive_session (const std::string& dest,
 
 	PBD::ScopedConnectionList progress_connection;
 	PBD::FileArchive ar (archive);
-	if (progress) {
-		ar.progress.connect_same_thread (progress_connection, boost::bind (&set_progress, progress, _1, _2));
-	}
 
 	/* collect files to archive */
 	std::map<string,string> filemap;
@@ -5265,45 +5448,75 @@ Session::archive_session (const std::string& dest,
 			progress->set_progress (0);
 		}
 
-		Glib::Threads::Mutex::Lock lm (source_lock);
-		for (SourceMap::const_iterator i = sources.begin(); i != sources.end(); ++i) {
-			boost::shared_ptr<AudioFileSource> afs = boost::dynamic_pointer_cast<AudioFileSource> (i->second);
-			if (!afs || afs->readable_length () == 0) {
-				continue;
-			}
+		vector<ArchiveEncodeJob*> jobs;
+		gint n_done = 0;
 
-			if (only_used_sources) {
-				if (!afs->used()) {
+		{
+			Glib::Threads::Mutex::Lock lm (source_lock);
+			for (SourceMap::const_iterator i = sources.begin(); i != sources.end(); ++i) {
+				boost::shared_ptr<AudioFileSource> afs = boost::dynamic_pointer_cast<AudioFileSource> (i->second);
+				if (!afs || afs->readable_length () == 0) {
 					continue;
 				}
-				if (sources_used_by_this_snapshot.find (afs) == sources_used_by_this_snapshot.end ()) {
-					continue;
+
+				if (only_used_sources) {
+					if (!afs->used()) {
+						continue;
+					}
+					if (sources_used_by_this_snapshot.find (afs) == sources_used_by_this_snapshot.end ()) {
+						continue;
+					}
 				}
-			}
 
-			orig_sources[afs] = afs->path();
-			orig_gain[afs]    = afs->gain();
+				orig_sources[afs] = afs->path();
+				orig_gain[afs]    = afs->gain();
 
-			std::string new_path = make_new_media_path (afs->path (), to_dir, name);
-			new_path = Glib::build_filename (Glib::path_get_dirname (new_path), PBD::basename_nosuffix (new_path) + ".flac");
-			g_mkdir_with_parents (Glib::path_get_dirname (new_path).c_str (), 0755);
+				std::string new_path = make_new_media_path (afs->path (), to_dir, name);
+				new_path = Glib::build_filename (Glib::path_get_dirname (new_path), PBD::basename_nosuffix (new_path) + ".flac");
+				g_mkdir_with_parents (Glib::path_get_dirname (new_path).c_str (), 0755);
 
-			if (progress) {
-				progress->descend ((float)afs->readable_length () / total_size);
+				jobs.push_back (new ArchiveEncodeJob (*this, afs, new_path, compress_audio == FLAC_16BIT, &n_done));
 			}
+		}
 
-			try {
-				SndFileSource* ns = new SndFileSource (*this, *(afs.get()), new_path, compress_audio == FLAC_16BIT, progress);
-				afs->replace_file (new_path);
-				afs->set_gain (ns->gain(), true);
-				delete ns;
-			} catch (...) {
-				cerr << "failed to encode " << afs->path() << " to " << new_path << "\n";
+		/* encoding is CPU bound, so encode one source per core */
+
+		Glib::ThreadPool pool (hardware_concurrency ());
+
+		for (vector<ArchiveEncodeJob*>::iterator j = jobs.begin(); j != jobs.end(); ++j) {
+			pool.push (sigc::mem_fun (**j, &ArchiveEncodeJob::run));
+		}
+
+		if (progress) {
+			gint64 const start = g_get_monotonic_time ();
+
+			while (g_atomic_int_get (&n_done) < (gint) jobs.size ()) {
+				Glib::usleep (100000);
+
+				double frames = 0;
+				double bytes = 0;
+				for (vector<ArchiveEncodeJob*>::const_iterator j = jobs.begin(); j != jobs.end(); ++j) {
+					float const done = (*j)->done ();
+					frames += done * (*j)->afs->readable_length ();
+					bytes += done * (*j)->bytes;
+				}
+
+				progress->set_rate (bytes * 1e6 / std::max ((gint64) 1, g_get_monotonic_time () - start));
+				progress->set_progress (frames / total_size);
 			}
+		}
 
-			if (progress) {
-				progress->ascend ();
+		pool.shutdown ();
+
+		for (vector<ArchiveEncodeJob*>::iterator j = jobs.begin(); j != jobs.end(); ++j) {
+			if ((*j)->encoded) {
+				(*j)->afs->replace_file ((*j)->new_path);
+				(*j)->afs->set_gain ((*j)->encoded->gain(), true);
+				delete (*j)->encoded;
+			} else {
+				cerr << "failed to encode " << (*j)->afs->path() << " to " << (*j)->new_path << "\n";
 			}
+			delete *j;
 		}
 	}
 
@@ -5427,6 +5640,10 @@ Session::archive_session (const std::string& dest,
 		i->first->set_gain (i->second, true);
 	}
 
+	if (progress) {
+		ar.progress.connect_same_thread (progress_connection, boost::bind (&set_progress, progress, g_get_monotonic_time (), _1, _2));
+	}
+
 	int rv = ar.create (filemap);
 	remove_directory (to_dir);
 
@@ -798,6 +798,11 @@ Session::non_realtime_stop (bool abort, int on_entry, bool& finished)
 		}
 	}
 
+	/* add what the process thread captured for automation write passes,
+	 * before the routes finish them.
+	 */
+	AutomationWatch::instance().merge_captured ();
+
 	if (_engine.running()) {
 		PostTransportWork ptw = post_transport_work ();
 		for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
@@ -63,8 +63,6 @@ SMFSource::SMFSource (Session& s, const string& path, Source::Flag flags)
 	, _open (false)
 	, _last_ev_time_beats(0.0)
 	, _last_ev_time_frames(0)
-	, _smf_last_read_end (0)
-	, _smf_last_read_time (0)
 {
 	/* note that origin remains empty */
 
@@ -87,6 +85,7 @@ SMFSource::SMFSource (Session& s, const string& path, Source::Flag flags)
 		throw failed_constructor ();
 	}
 
+	_length_beats = Evoral::Beats::ticks_at_rate (duration (), ppqn ());
 	_open = true;
 }
 
@@ -99,8 +98,6 @@ SMFSource::SMFSource (Session& s, const string& path)
 	, _open (false)
 	, _last_ev_time_beats(0.0)
 	, _last_ev_time_frames(0)
-	, _smf_last_read_end (0)
-	, _smf_last_read_time (0)
 {
 	/* note that origin remains empty */
 
@@ -120,6 +117,7 @@ SMFSource::SMFSource (Session& s, const string& path)
 		throw failed_constructor ();
 	}
 
+	_length_beats = Evoral::Beats::ticks_at_rate (duration (), ppqn ());
 	_open = true;
 }
 
@@ -131,8 +129,6 @@ SMFSource::SMFSource (Session& s, const XMLNode& node, bool must_exist)
 	, _open (false)
 	, _last_ev_time_beats(0.0)
 	, _last_ev_time_frames(0)
-	, _smf_last_read_end (0)
-	, _smf_last_read_time (0)
 {
 	if (set_state(node, Stateful::loading_state_version)) {
 		throw failed_constructor ();
@@ -182,6 +178,7 @@ SMFSource::SMFSource (Session& s, const XMLNode& node, bool must_exist)
 		throw failed_constructor ();
 	}
 
+	_length_beats = Evoral::Beats::ticks_at_rate (duration (), ppqn ());
 	_open = true;
 }
 
@@ -205,7 +202,7 @@ SMFSource::open_for_write ()
 void
 SMFSource::close ()
 {
-	/* nothing to do: file descriptor is never kept open */
+	/* nothing to do: Evoral::SMF opens the file for reading when needed */
 }
 
 /** All stamps in audio frames */
@@ -238,28 +235,12 @@ SMFSource::read_unlocked (const Lock&                    lock,
 
 	BeatsFramesConverter converter(_session.tempo_map(), source_start);
 
-	const uint64_t start_ticks = converter.from(start).to_ticks();
+	const uint64_t start_ticks = converter.from(start).to_ticks(ppqn());
 	DEBUG_TRACE (DEBUG::MidiSourceIO, string_compose ("SMF read_unlocked: start in ticks %1\n", start_ticks));
 
-	if (_smf_last_read_end == 0 || start != _smf_last_read_end) {
-		DEBUG_TRACE (DEBUG::MidiSourceIO, string_compose ("SMF read_unlocked: seek to %1\n", start));
-		Evoral::SMF::seek_to_start();
-		while (time < start_ticks) {
-			gint ignored;
-
-			ret = read_event(&ev_delta_t, &ev_size, &ev_buffer, &ignored);
-			if (ret == -1) { // EOF
-				_smf_last_read_end = start + duration;
-				return duration;
-			}
-			time += ev_delta_t; // accumulate delta time
-		}
-	} else {
-		DEBUG_TRACE (DEBUG::MidiSourceIO, string_compose ("SMF read_unlocked: set time to %1\n", _smf_last_read_time));
-		time = _smf_last_read_time;
-	}
-
-	_smf_last_read_end = start + duration;
+	/* find the first event at or after start with the help of the file's index */
+	time = Evoral::SMF::seek_to_time (start_ticks);
+	DEBUG_TRACE (DEBUG::MidiSourceIO, string_compose ("SMF read_unlocked: seek to %1, time %2\n", start, time));
 
 	while (true) {
 		gint ignored; /* XXX don't ignore note id's ??*/
@@ -270,7 +251,6 @@ SMFSource::read_unlocked (const Lock&                    lock,
 		}
 
 		time += ev_delta_t; // accumulate delta time
-		_smf_last_read_time = time;
 
 		if (ret == 0) { // meta-event (skipped, just accumulate time)
 			continue;
@@ -617,6 +597,9 @@ SMFSource::load_model (const Glib::Threads::Mutex::Lock& lock, bool force_reload
 		return;
 	}
 
+	/* sources are opened without a model, it is made when first needed */
+	const bool new_model = !_model;
+
 	if (!_model) {
 		_model = boost::shared_ptr<MidiModel> (new MidiModel (shared_from_this ()));
 	} else {
@@ -626,6 +609,9 @@ SMFSource::load_model (const Glib::Threads::Mutex::Lock& lock, bool force_reload
 	invalidate(lock);
 
 	if (writable() && !_open) {
+		if (new_model) {
+			ModelChanged (); /* EMIT SIGNAL */
+		}
 		return;
 	}
 
@@ -720,6 +706,10 @@ SMFSource::load_model (const Glib::Threads::Mutex::Lock& lock, bool force_reload
 	invalidate(lock);
 
 	free(buf);
+
+	if (new_model) {
+		ModelChanged (); /* EMIT SIGNAL */
+	}
 }
 
 void
@@ -750,6 +740,7 @@ void
 SMFSource::set_path (const string& p)
 {
 	FileSource::set_path (p);
+	Evoral::SMF::set_file_path (_path);
 }
 
 /** Ensure that this source has some file on disk, even if it's just a SMF header */
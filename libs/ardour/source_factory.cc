@@ -220,9 +220,10 @@ SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks)
 			}
 		}
 	} else if (type == DataType::MIDI) {
+		/* the model is loaded when first needed, reading the
+		   file does not require it.
+		*/
 		boost::shared_ptr<SMFSource> src (new SMFSource (s, node));
-		Source::Lock lock(src->mutex());
-		src->load_model (lock, true);
 #ifdef BOOST_SP_ENABLE_DEBUG_HOOKS
 		// boost_debug_shared_ptr_mark_interesting (src, "Source");
 #endif
@@ -290,8 +291,6 @@ SourceFactory::createExternal (DataType type, Session& s, const string& path,
 	} else if (type == DataType::MIDI) {
 
 		boost::shared_ptr<SMFSource> src (new SMFSource (s, path));
-		Source::Lock lock(src->mutex());
-		src->load_model (lock, true);
 #ifdef BOOST_SP_ENABLE_DEBUG_HOOKS
 		// boost_debug_shared_ptr_mark_interesting (src, "Source");
 #endif
@@ -0,0 +1,245 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <sstream>
+
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+
+#include "pbd/compose.h"
+#include "pbd/error.h"
+#include "pbd/gstdio_compat.h"
+#include "pbd/xml++.h"
+
+#include "ardour/source_usage_index.h"
+
+#include "pbd/i18n.h"
+
+using namespace std;
+using namespace ARDOUR;
+using namespace PBD;
+
+/* bump this whenever the way snapshots are indexed changes */
+const int SourceUsageIndex::version = 1;
+
+const char* const SourceUsageIndex::file_name = X_("sources.index");
+
+SourceUsageIndex::SourceUsageIndex (string const & session_dir)
+	: _path (Glib::build_filename (session_dir, file_name))
+	, _dirty (false)
+{
+	load ();
+}
+
+string
+SourceUsageIndex::stamp (string const & file)
+{
+	GStatBuf sb;
+	if (g_stat (file.c_str(), &sb)) {
+		return string ();
+	}
+	return string_compose ("%1:%2", (int64_t) sb.st_mtime, (int64_t) sb.st_size);
+}
+
+SourceUsageIndex::Usage const *
+SourceUsageIndex::lookup (string const & snapshot) const
+{
+	Entries::const_iterator i = _entries.find (snapshot);
+
+	if (i == _entries.end () || i->second.stamp.empty () || i->second.stamp != stamp (snapshot)) {
+		return 0;
+	}
+
+	return &i->second.usage;
+}
+
+void
+SourceUsageIndex::add (string const & snapshot, Usage const & usage)
+{
+	Entry& e (_entries[snapshot]);
+	e.stamp = stamp (snapshot);
+	e.usage = usage;
+	_dirty = true;
+}
+
+void
+SourceUsageIndex::retain (set<string> const & snapshots)
+{
+	for (Entries::iterator i = _entries.begin(); i != _entries.end();) {
+		if (snapshots.find (i->first) != snapshots.end ()) {
+			++i;
+		} else {
+			/* the snapshot has been removed */
+			_entries.erase (i++);
+			_dirty = true;
+		}
+	}
+}
+
+void
+SourceUsageIndex::snapshots_using (string const & path, SnapshotUses& uses) const
+{
+	for (Entries::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		Usage::const_iterator u = i->second.usage.find (path);
+		if (u != i->second.usage.end ()) {
+			uses.push_back (make_pair (i->first, u->second));
+		}
+	}
+}
+
+void
+SourceUsageIndex::load ()
+{
+	if (!Glib::file_test (_path, Glib::FILE_TEST_EXISTS)) {
+		return;
+	}
+
+	XMLTree tree;
+	if (!tree.read (_path) || !tree.root () || tree.root()->name () != X_("SourceUsageIndex")) {
+		warning << string_compose (_("Ignoring invalid source index %1"), _path) << endmsg;
+		return;
+	}
+
+	XMLProperty const * prop = tree.root()->property ("version");
+	if (!prop || atoi (prop->value ().c_str ()) != version) {
+		return;
+	}
+
+	/* source paths are stored once, and referred to by their position */
+
+	vector<string> paths;
+	XMLNode const * sources = tree.root()->child (X_("Sources"));
+
+	if (sources) {
+		XMLNodeList const & children = sources->children ();
+		for (XMLNodeConstIterator i = children.begin(); i != children.end(); ++i) {
+			prop = (*i)->property ("path");
+			paths.push_back (prop ? prop->value () : string ());
+		}
+	}
+
+	XMLNodeList const & snapshots = tree.root()->children (X_("Snapshot"));
+
+	for (XMLNodeConstIterator i = snapshots.begin(); i != snapshots.end(); ++i) {
+		XMLProperty const * path = (*i)->property ("path");
+		XMLProperty const * stamp = (*i)->property ("stamp");
+		XMLProperty const * used = (*i)->property ("sources");
+		XMLProperty const * regions = (*i)->property ("regions");
+
+		if (!path || !stamp || !used || !regions) {
+			continue;
+		}
+
+		Entry& e (_entries[path->value ()]);
+		e.stamp = stamp->value ();
+
+		stringstream ss (used->value ());
+		stringstream rs (regions->value ());
+		size_t n;
+		uint32_t r;
+
+		while (ss >> n && rs >> r) {
+			if (n < paths.size ()) {
+				e.usage[paths[n]].regions = r;
+			}
+		}
+
+		XMLNodeList const & playlists = (*i)->children ();
+
+		for (XMLNodeConstIterator p = playlists.begin(); p != playlists.end(); ++p) {
+			XMLProperty const * name = (*p)->property ("name");
+			if (!name || (used = (*p)->property ("sources")) == 0) {
+				continue;
+			}
+
+			stringstream ps (used->value ());
+
+			while (ps >> n) {
+				if (n < paths.size ()) {
+					e.usage[paths[n]].playlists.insert (name->value ());
+				}
+			}
+		}
+	}
+}
+
+void
+SourceUsageIndex::save ()
+{
+	if (!_dirty) {
+		return;
+	}
+
+	XMLNode* root = new XMLNode (X_("SourceUsageIndex"));
+	root->add_property ("version", (long) version);
+
+	XMLNode* sources = root->add_child (X_("Sources"));
+	map<string, size_t> ids;
+
+	for (Entries::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+
+		stringstream used;
+		stringstream regions;
+		map<string, stringstream*> playlists;
+
+		for (Usage::const_iterator u = i->second.usage.begin(); u != i->second.usage.end(); ++u) {
+
+			map<string, size_t>::iterator id = ids.find (u->first);
+
+			if (id == ids.end ()) {
+				id = ids.insert (make_pair (u->first, ids.size ())).first;
+				sources->add_child (X_("Source"))->add_property ("path", u->first);
+			}
+
+			used << id->second << ' ';
+			regions << u->second.regions << ' ';
+
+			for (set<string>::const_iterator p = u->second.playlists.begin(); p != u->second.playlists.end(); ++p) {
+				stringstream*& ps (playlists[*p]);
+				if (!ps) {
+					ps = new stringstream;
+				}
+				*ps << id->second << ' ';
+			}
+		}
+
+		XMLNode* snapshot = root->add_child (X_("Snapshot"));
+		snapshot->add_property ("path", i->first);
+		snapshot->add_property ("stamp", i->second.stamp);
+		snapshot->add_property ("sources", used.str ());
+		snapshot->add_property ("regions", regions.str ());
+
+		for (map<string, stringstream*>::iterator p = playlists.begin(); p != playlists.end(); ++p) {
+			XMLNode* playlist = snapshot->add_child (X_("Playlist"));
+			playlist->add_property ("name", p->first);
+			playlist->add_property ("sources", p->second->str ());
+			delete p->second;
+		}
+	}
+
+	XMLTree tree;
+	tree.set_root (root);
+
+	if (!tree.write (_path)) {
+		warning << string_compose (_("Could not write source index %1"), _path) << endmsg;
+		return;
+	}
+
+	_dirty = false;
+}
@@ -20,8 +20,11 @@
 #include <algorithm>
 #include <cmath>
 
+#include <soundtouch/SoundTouch.h>
+
 #include "pbd/error.h"
 
+#include "ardour/progress.h"
 #include "ardour/types.h"
 #include "ardour/stretch.h"
 #include "ardour/audiofilesource.h"
@@ -39,23 +42,6 @@ STStretch::STStretch (Session& s, TimeFXRequest& req)
 	: Filter (s)
 	, tsr (req)
 {
-	float percentage;
-
-	/* the soundtouch code wants a *tempo* change percentage, which is
-	   of opposite sign to the length change.
-	*/
-
-	percentage = -tsr.time_fraction;
-
-	st.setSampleRate (s.frame_rate());
-	st.setChannels (1);
-	st.setTempoChange (percentage);
-	st.setPitchSemiTones (0);
-	st.setRateChange (0);
-
-	st.setSetting(SETTING_USE_QUICKSEEK, tsr.quick_seek);
-	st.setSetting(SETTING_USE_AA_FILTER, tsr.antialias);
-
 }
 
 STStretch::~STStretch ()
@@ -65,143 +51,198 @@ STStretch::~STStretch ()
 int
 STStretch::run (boost::shared_ptr<Region> a_region, Progress* progress)
 {
-	SourceList nsrcs;
-	framecnt_t total_frames;
-	framecnt_t done;
-	int ret = -1;
-	const framecnt_t bufsize = 16384;
-	gain_t *gain_buffer = 0;
-	Sample *buffer = 0;
-	char suffix[32];
-	string new_name;
-	string::size_type at;
+	if (prepare (a_region)) {
+		return -1;
+	}
+
+	int ret = 0;
 
-	progress->set_progress (0);
+	for (uint32_t i = 0; i < n_jobs () && ret == 0; ++i) {
+		if (progress) {
+			progress->descend (1.0 / n_jobs ());
+		}
+		ret = process (i, progress);
+		if (progress) {
+			progress->ascend ();
+		}
+	}
+
+	return complete (ret == 0);
+}
+
+int
+STStretch::prepare (boost::shared_ptr<Region> a_region)
+{
 	tsr.done = false;
 
-	boost::shared_ptr<AudioRegion> region = boost::dynamic_pointer_cast<AudioRegion>(a_region);
+	_region = boost::dynamic_pointer_cast<AudioRegion>(a_region);
 
-	total_frames = region->length() * region->n_channels();
-	done = 0;
+	if (!_region) {
+		return -1;
+	}
 
 	/* the name doesn't need to be super-precise, but allow for 2 fractional
 	   digits just to disambiguate close but not identical stretches.
 	*/
 
+	char suffix[32];
 	snprintf (suffix, sizeof (suffix), "@%d", (int) floor (tsr.time_fraction * 100.0f));
+	_suffix = suffix;
 
 	/* create new sources */
 
-	if (make_new_sources (region, nsrcs, suffix)) {
-		goto out;
+	_nsrcs.clear ();
+
+	if (make_new_sources (_region, _nsrcs, _suffix)) {
+		complete (false);
+		return -1;
 	}
 
-	gain_buffer = new gain_t[bufsize];
-	buffer = new Sample[bufsize];
+	return 0;
+}
 
-	// soundtouch throws runtime_error on error
+/** Stretch channel @param chn of the region given to prepare() into its
+ * new source. Each channel has its own SoundTouch, so all of them may be
+ * processed concurrently.
+ */
+int
+STStretch::process (uint32_t chn, Progress* progress)
+{
+	boost::shared_ptr<AudioRegion> region (_region);
+	const framecnt_t bufsize = 16384;
+	vector<gain_t> gain_buffer (bufsize);
+	vector<Sample> buf (bufsize);
+	Sample* buffer = &buf[0];
 
-	try {
-		for (uint32_t i = 0; i < nsrcs.size(); ++i) {
+	boost::shared_ptr<AudioSource> asrc = boost::dynamic_pointer_cast<AudioSource>(_nsrcs[chn]);
 
-			boost::shared_ptr<AudioSource> asrc
-				= boost::dynamic_pointer_cast<AudioSource>(nsrcs[i]);
+	if (!asrc) {
+		return -1;
+	}
 
-			framepos_t pos = 0;
-			framecnt_t this_read = 0;
+	if (progress) {
+		progress->set_progress (0);
+	}
 
-			st.clear();
+	/* the soundtouch code wants a *tempo* change percentage, which is
+	   of opposite sign to the length change.
+	*/
 
-			while (!tsr.cancel && pos < region->length()) {
-				framecnt_t this_time;
+	soundtouch::SoundTouch st;
 
-				this_time = min (bufsize, region->length() - pos);
+	st.setSampleRate (session.frame_rate());
+	st.setChannels (1);
+	st.setTempoChange (-tsr.time_fraction);
+	st.setPitchSemiTones (0);
+	st.setRateChange (0);
 
-				/* read from the master (original) sources for the region,
-				   not the ones currently in use, in case it's already been
-				   subject to timefx.
-				*/
+	st.setSetting(SETTING_USE_QUICKSEEK, tsr.quick_seek);
+	st.setSetting(SETTING_USE_AA_FILTER, tsr.antialias);
 
-				if ((this_read = region->master_read_at (buffer, buffer, gain_buffer, pos + region->position(), this_time)) != this_time) {
-					error << string_compose (_("tempoize: error reading data from %1"), asrc->name()) << endmsg;
-					goto out;
-				}
+	// soundtouch throws runtime_error on error
+
+	try {
+		framepos_t pos = 0;
+		framecnt_t this_read = 0;
 
-				pos += this_read;
-				done += this_read;
+		while (!tsr.cancel && pos < region->length()) {
+			framecnt_t this_time;
 
-				progress->set_progress ((float) done / total_frames);
+			this_time = min (bufsize, region->length() - pos);
 
-				st.putSamples (buffer, this_read);
+			/* read from the master (original) sources for the region,
+			   not the ones currently in use, in case it's already been
+			   subject to timefx.
+			*/
 
-				while ((this_read = st.receiveSamples (buffer, bufsize)) > 0 && !tsr.cancel) {
-					if (asrc->write (buffer, this_read) != this_read) {
-						error << string_compose (_("error writing tempo-adjusted data to %1"), asrc->name()) << endmsg;
-						goto out;
-					}
-				}
+			if ((this_read = region->master_read_at (buffer, buffer, &gain_buffer[0], pos + region->position(), this_time, chn)) != this_time) {
+				error << string_compose (_("tempoize: error reading data from %1"), asrc->name()) << endmsg;
+				return -1;
 			}
 
-			if (!tsr.cancel) {
-				st.flush ();
+			pos += this_read;
+
+			if (progress) {
+				progress->set_progress ((float) pos / region->length());
 			}
 
-			while (!tsr.cancel && (this_read = st.receiveSamples (buffer, bufsize)) > 0) {
+			st.putSamples (buffer, this_read);
+
+			while ((this_read = st.receiveSamples (buffer, bufsize)) > 0 && !tsr.cancel) {
 				if (asrc->write (buffer, this_read) != this_read) {
 					error << string_compose (_("error writing tempo-adjusted data to %1"), asrc->name()) << endmsg;
-					goto out;
+					return -1;
 				}
 			}
 		}
 
+		if (!tsr.cancel) {
+			st.flush ();
+		}
+
+		while (!tsr.cancel && (this_read = st.receiveSamples (buffer, bufsize)) > 0) {
+			if (asrc->write (buffer, this_read) != this_read) {
+				error << string_compose (_("error writing tempo-adjusted data to %1"), asrc->name()) << endmsg;
+				return -1;
+			}
+		}
+
 	} catch (runtime_error& err) {
 		error << _("timefx code failure. please notify ardour-developers.") << endmsg;
 		error << err.what() << endmsg;
-		goto out;
+		return -1;
 	}
 
-	new_name = region->name();
-	at = new_name.find ('@');
+	return 0;
+}
 
-	// remove any existing stretch indicator
+int
+STStretch::complete (bool ok)
+{
+	int ret = -1;
 
-	if (at != string::npos && at > 2) {
-		new_name = new_name.substr (0, at - 1);
-	}
+	if (ok && !tsr.cancel) {
+		string new_name = _region->name();
+		string::size_type at = new_name.find ('@');
 
-	new_name += suffix;
+		// remove any existing stretch indicator
 
-	ret = finish (region, nsrcs, new_name);
+		if (at != string::npos && at > 2) {
+			new_name = new_name.substr (0, at - 1);
+		}
 
-	/* now reset ancestral data for each new region */
+		new_name += _suffix;
 
-	for (vector<boost::shared_ptr<Region> >::iterator x = results.begin(); x != results.end(); ++x) {
-		framepos_t astart = (*x)->ancestral_start();
-		framepos_t alength = (*x)->ancestral_length();
-		framepos_t start;
-		framecnt_t length;
+		ret = finish (_region, _nsrcs, new_name);
 
-		// note: tsr.fraction is a percentage of original length. 100 = no change,
-		// 50 is half as long, 200 is twice as long, etc.
+		/* now reset ancestral data for each new region */
 
-		float stretch = (*x)->stretch() * (tsr.time_fraction/100.0);
+		for (vector<boost::shared_ptr<Region> >::iterator x = results.begin(); x != results.end(); ++x) {
+			framepos_t astart = (*x)->ancestral_start();
+			framepos_t alength = (*x)->ancestral_length();
+			framepos_t start;
+			framecnt_t length;
 
-		start = (framepos_t) floor (astart + ((astart - (*x)->start()) / stretch));
-		length = (framecnt_t) floor (alength / stretch);
+			// note: tsr.fraction is a percentage of original length. 100 = no change,
+			// 50 is half as long, 200 is twice as long, etc.
 
-		(*x)->set_ancestral_data (start, length, stretch, (*x)->shift());
-	}
+			float stretch = (*x)->stretch() * (tsr.time_fraction/100.0);
 
-  out:
+			start = (framepos_t) floor (astart + ((astart - (*x)->start()) / stretch));
+			length = (framecnt_t) floor (alength / stretch);
 
-	delete [] gain_buffer;
-	delete [] buffer;
+			(*x)->set_ancestral_data (start, length, stretch, (*x)->shift());
+		}
+	}
 
 	if (ret || tsr.cancel) {
-		for (SourceList::iterator si = nsrcs.begin(); si != nsrcs.end(); ++si) {
+		for (SourceList::iterator si = _nsrcs.begin(); si != _nsrcs.end(); ++si) {
 			(*si)->mark_for_remove ();
 		}
 	}
 
+	_nsrcs.clear ();
+	_region.reset ();
+
 	return ret;
 }
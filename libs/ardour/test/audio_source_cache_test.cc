@@ -0,0 +1,275 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include "pbd/id.h"
+#include "pbd/xml++.h"
+
+#include "ardour/audio_source_cache.h"
+#include "ardour/audiosource.h"
+#include "ardour/rc_configuration.h"
+#include "ardour/source_factory.h"
+
+#include "audio_source_cache_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (AudioSourceCacheTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+namespace {
+
+/** A cacheable source whose frame n has the value n */
+class StaircaseSource : public AudioSource
+{
+public:
+	StaircaseSource (Session& s, framecnt_t length)
+		: Source (s, DataType::AUDIO, "staircase")
+		, AudioSource (s, "staircase")
+		, reads (0)
+		, drop_on_read (false)
+	{
+		_length = length;
+	}
+
+	float sample_rate () const { return 48000; }
+	bool clamped_at_unity () const { return false; }
+	bool cacheable () const { return true; }
+
+	mutable int  reads;        ///< calls of read_unlocked()
+	mutable bool drop_on_read; ///< drop this source's blocks from the cache during the next read
+
+protected:
+	framecnt_t read_unlocked (Sample* dst, framepos_t start, framecnt_t cnt) const {
+		++reads;
+
+		if (drop_on_read) {
+			drop_on_read = false;
+			AudioSourceCache::instance ().drop (id ());
+		}
+
+		/* like SndFileSource: silence beyond the end, which is not counted */
+		framecnt_t const n = max ((framecnt_t) 0, min (cnt, _length - start));
+
+		for (framecnt_t i = 0; i < cnt; ++i) {
+			dst[i] = i < n ? start + i : 0;
+		}
+
+		return n;
+	}
+
+	framecnt_t write_unlocked (Sample*, framecnt_t) { return 0; }
+
+	string construct_peak_filepath (const string&, const bool, const bool) const { return string (); }
+};
+
+void
+check_staircase (vector<Sample> const & buf, framepos_t start, framecnt_t cnt)
+{
+	for (framecnt_t i = 0; i < cnt; ++i) {
+		CPPUNIT_ASSERT_EQUAL ((Sample) (start + i), buf[i]);
+	}
+}
+
+}
+
+void
+AudioSourceCacheTest::setUp ()
+{
+	TestNeedingSession::setUp ();
+
+	/* room for 16 blocks */
+	_megabytes = Config->get_audio_source_cache_megabytes ();
+	Config->set_audio_source_cache_megabytes (1);
+
+	AudioSourceCache::instance ().clear ();
+	AudioSourceCache::instance ().reset_stats ();
+}
+
+void
+AudioSourceCacheTest::tearDown ()
+{
+	Config->set_audio_source_cache_megabytes (_megabytes);
+	AudioSourceCache::instance ().clear ();
+
+	TestNeedingSession::tearDown ();
+}
+
+/** The last block of a source is only as long as what is left of it */
+void
+AudioSourceCacheTest::partialBlockTest ()
+{
+	AudioSourceCache& cache (AudioSourceCache::instance ());
+	framecnt_t const bf = AudioSourceCache::block_frames;
+	boost::shared_ptr<StaircaseSource> src (new StaircaseSource (*_session, 2 * bf + 1000));
+	vector<Sample> buf (bf);
+
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 1000, src->read (&buf[0], 2 * bf, 1000));
+	check_staircase (buf, 2 * bf, 1000);
+
+	AudioSourceCache::Stats s = cache.stats ();
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 1, s.blocks);
+	CPPUNIT_ASSERT_EQUAL (1000 * sizeof (Sample), s.bytes);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 1, s.misses);
+	CPPUNIT_ASSERT_EQUAL (1, src->reads);
+
+	/* a read spanning the last two blocks only reads the one which is
+	 * not cached yet
+	 */
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 600, src->read (&buf[0], 2 * bf - 100, 600));
+	check_staircase (buf, 2 * bf - 100, 600);
+
+	s = cache.stats ();
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 2, s.blocks);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 1, s.hits);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 2, s.misses);
+	CPPUNIT_ASSERT_EQUAL (2, src->reads);
+
+	/* up to the very end */
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 100, src->read (&buf[0], 2 * bf + 900, 100));
+	check_staircase (buf, 2 * bf + 900, 100);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 2, cache.stats ().hits);
+	CPPUNIT_ASSERT_EQUAL (2, src->reads);
+}
+
+/** Reads beyond the end of a source are passed on to it, and not cached */
+void
+AudioSourceCacheTest::pastEndTest ()
+{
+	AudioSourceCache& cache (AudioSourceCache::instance ());
+	framecnt_t const bf = AudioSourceCache::block_frames;
+	framecnt_t const length = bf + 1000;
+	boost::shared_ptr<StaircaseSource> src (new StaircaseSource (*_session, length));
+	vector<Sample> buf (bf, 1);
+
+	/* a read across the end gets what there is */
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 10, src->read (&buf[0], length - 10, 20));
+	check_staircase (buf, length - 10, 10);
+	for (int i = 10; i < 20; ++i) {
+		CPPUNIT_ASSERT_EQUAL ((Sample) 0, buf[i]);
+	}
+
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, cache.stats ().blocks);
+	CPPUNIT_ASSERT_EQUAL (1, src->reads);
+
+	/* a read after the end gets nothing */
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 0, src->read (&buf[0], length + 100, 50));
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, cache.stats ().blocks);
+	CPPUNIT_ASSERT_EQUAL (2, src->reads);
+
+	/* the part before the end is still cached */
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 990, src->read (&buf[0], bf, 990));
+	check_staircase (buf, bf, 990);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 1, cache.stats ().blocks);
+}
+
+/** The least recently used blocks are evicted first */
+void
+AudioSourceCacheTest::evictionTest ()
+{
+	AudioSourceCache& cache (AudioSourceCache::instance ());
+	framecnt_t const bf = AudioSourceCache::block_frames;
+	boost::shared_ptr<StaircaseSource> src (new StaircaseSource (*_session, 20 * bf));
+	vector<Sample> buf (bf);
+
+	for (int b = 0; b < 16; ++b) {
+		CPPUNIT_ASSERT_EQUAL (bf, src->read (&buf[0], b * bf, bf));
+	}
+
+	AudioSourceCache::Stats s = cache.stats ();
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 16, s.blocks);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 0, s.evictions);
+	CPPUNIT_ASSERT_EQUAL (16, src->reads);
+
+	/* use block 0 again, so that block 1 is the least recently used */
+	src->read (&buf[0], 0, bf);
+	CPPUNIT_ASSERT_EQUAL (16, src->reads);
+
+	src->read (&buf[0], 16 * bf, bf);
+	s = cache.stats ();
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 16, s.blocks);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 1, s.evictions);
+	CPPUNIT_ASSERT_EQUAL (17, src->reads);
+
+	/* blocks 0 and 2 are still there, block 1 is not */
+	src->read (&buf[0], 0, bf);
+	src->read (&buf[0], 2 * bf, bf);
+	CPPUNIT_ASSERT_EQUAL (17, src->reads);
+
+	src->read (&buf[0], bf, bf);
+	check_staircase (buf, bf, bf);
+	CPPUNIT_ASSERT_EQUAL (18, src->reads);
+
+	/* which evicted block 3 */
+	src->read (&buf[0], 3 * bf, bf);
+	CPPUNIT_ASSERT_EQUAL (19, src->reads);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 3, cache.stats ().evictions);
+
+	/* shrinking the cache evicts what no longer fits */
+	Config->set_audio_source_cache_megabytes (0);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, cache.stats ().blocks);
+}
+
+/** A block dropped while it is being read is not inserted */
+void
+AudioSourceCacheTest::dropDuringReadTest ()
+{
+	AudioSourceCache& cache (AudioSourceCache::instance ());
+	framecnt_t const bf = AudioSourceCache::block_frames;
+	boost::shared_ptr<StaircaseSource> src (new StaircaseSource (*_session, 2 * bf));
+	vector<Sample> buf (bf);
+
+	src->drop_on_read = true;
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 100, src->read (&buf[0], 0, 100));
+	check_staircase (buf, 0, 100);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, cache.stats ().blocks);
+	CPPUNIT_ASSERT_EQUAL (1, src->reads);
+
+	/* the next read caches it */
+	src->read (&buf[0], 0, 100);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 1, cache.stats ().blocks);
+	CPPUNIT_ASSERT_EQUAL (2, src->reads);
+
+	src->read (&buf[0], 0, 100);
+	CPPUNIT_ASSERT_EQUAL (2, src->reads);
+
+	/* destroying the source drops its blocks */
+	src.reset ();
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, cache.stats ().blocks);
+}
+
+/** Silence for missing files is not worth caching */
+void
+AudioSourceCacheTest::silentSourceTest ()
+{
+	XMLNode node ("Source");
+	node.add_property ("name", "missing.wav");
+	node.add_property ("type", "audio");
+	node.add_property ("id", PBD::ID ().to_s ());
+
+	boost::shared_ptr<AudioSource> src = boost::dynamic_pointer_cast<AudioSource> (SourceFactory::createSilent (*_session, node, 1000, 48000));
+	CPPUNIT_ASSERT (src);
+	CPPUNIT_ASSERT (!src->cacheable ());
+
+	vector<Sample> buf (100, 1);
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 100, src->read (&buf[0], 0, 100));
+	CPPUNIT_ASSERT_EQUAL ((Sample) 0, buf[99]);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, AudioSourceCache::instance ().stats ().blocks);
+}
@@ -0,0 +1,43 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "test_needing_session.h"
+
+class AudioSourceCacheTest : public TestNeedingSession
+{
+	CPPUNIT_TEST_SUITE (AudioSourceCacheTest);
+	CPPUNIT_TEST (partialBlockTest);
+	CPPUNIT_TEST (pastEndTest);
+	CPPUNIT_TEST (evictionTest);
+	CPPUNIT_TEST (dropDuringReadTest);
+	CPPUNIT_TEST (silentSourceTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void setUp ();
+	void tearDown ();
+
+	void partialBlockTest ();
+	void pastEndTest ();
+	void evictionTest ();
+	void dropDuringReadTest ();
+	void silentSourceTest ();
+
+private:
+	uint32_t _megabytes;
+};
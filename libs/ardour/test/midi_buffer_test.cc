@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <vector>
+
+#include "ardour/midi_buffer.h"
+
+#include "midi_buffer_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (MidiBufferTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+static void
+push (MidiBuffer& buf, MidiBuffer::TimeType time, uint8_t status, uint8_t data1, uint8_t data2 = 0)
+{
+	uint8_t const ev[3] = { status, data1, data2 };
+	CPPUNIT_ASSERT (buf.push_back (time, ((status & 0xf0) == 0xc0 || (status & 0xf0) == 0xd0) ? 2 : 3, ev));
+}
+
+/** @return the (time, status, data1) of each event in @param buf */
+static vector<MidiBuffer::TimeType>
+events (MidiBuffer& buf)
+{
+	vector<MidiBuffer::TimeType> e;
+
+	for (MidiBuffer::iterator i = buf.begin (); i != buf.end (); ++i) {
+		e.push_back ((*i).time ());
+		e.push_back ((*i).buffer ()[0]);
+		e.push_back ((*i).buffer ()[1]);
+	}
+
+	return e;
+}
+
+void
+MidiBufferTest::mergeOrderTest ()
+{
+	MidiBuffer a (1024);
+	MidiBuffer b (1024);
+	MidiBuffer c (1024);
+	MidiBuffer empty (1024);
+	MidiBuffer out (1024);
+
+	push (a, 0, 0x90, 1, 100);
+	push (a, 10, 0x90, 4, 100);
+	push (a, 30, 0x90, 7, 100);
+	push (b, 5, 0x90, 2, 100);
+	push (b, 25, 0x90, 6, 100);
+	push (c, 6, 0x90, 3, 100);
+	push (c, 20, 0x90, 5, 100);
+
+	vector<MidiBuffer const *> sources;
+	sources.push_back (&a);
+	sources.push_back (&empty);
+	sources.push_back (&b);
+	sources.push_back (&c);
+
+	/* earlier contents of the destination are replaced */
+	push (out, 3, 0xb0, 7, 0);
+
+	CPPUNIT_ASSERT (out.merge_from (sources));
+	CPPUNIT_ASSERT_EQUAL (a.size () + b.size () + c.size (), out.size ());
+
+	MidiBuffer::TimeType const expected_times[] = { 0, 5, 6, 10, 20, 25, 30 };
+	uint8_t n = 0;
+
+	for (MidiBuffer::iterator i = out.begin (); i != out.end (); ++i, ++n) {
+		CPPUNIT_ASSERT_EQUAL (expected_times[n], (*i).time ());
+		CPPUNIT_ASSERT_EQUAL ((uint8_t) (n + 1), (*i).buffer ()[1]);
+	}
+	CPPUNIT_ASSERT_EQUAL ((uint8_t) 7, n);
+
+	/* no sources, or only empty ones, leave the destination empty */
+	sources.clear ();
+	CPPUNIT_ASSERT (out.merge_from (sources));
+	CPPUNIT_ASSERT (out.empty ());
+
+	sources.push_back (&empty);
+	CPPUNIT_ASSERT (out.merge_from (sources));
+	CPPUNIT_ASSERT (out.empty ());
+}
+
+void
+MidiBufferTest::mergeSimultaneousTest ()
+{
+	MidiBuffer a (1024);
+	MidiBuffer b (1024);
+	MidiBuffer c (1024);
+	MidiBuffer out (1024);
+
+	/* all at the same time, each source in the order by type:
+	 * controller, program change, note off, note on, note pressure,
+	 * channel pressure, pitch bend. The merge keeps that order, and
+	 * events of the same type keep the order of the sources.
+	 */
+	push (a, 8, 0x90, 1, 100);
+	push (a, 8, 0x90, 2, 100);
+	push (a, 8, 0xe0, 1, 64);
+	push (b, 8, 0xc0, 3);
+	push (b, 8, 0x80, 3, 0);
+	push (b, 8, 0x90, 3, 100);
+	push (c, 8, 0xb0, 4, 1);
+	push (c, 8, 0xa0, 4, 10);
+	push (c, 8, 0xd0, 4);
+
+	vector<MidiBuffer const *> sources;
+	sources.push_back (&a);
+	sources.push_back (&b);
+	sources.push_back (&c);
+
+	CPPUNIT_ASSERT (out.merge_from (sources));
+
+	MidiBuffer::TimeType const expected[] = {
+		8, 0xb0, 4,
+		8, 0xc0, 3,
+		8, 0x80, 3,
+		8, 0x90, 1,
+		8, 0x90, 2,
+		8, 0x90, 3,
+		8, 0xa0, 4,
+		8, 0xd0, 4,
+		8, 0xe0, 1,
+	};
+
+	vector<MidiBuffer::TimeType> const merged (events (out));
+	CPPUNIT_ASSERT_EQUAL (sizeof (expected) / sizeof (expected[0]), merged.size ());
+	CPPUNIT_ASSERT (equal (merged.begin (), merged.end (), expected));
+}
+
+void
+MidiBufferTest::mergeOverflowTest ()
+{
+	MidiBuffer a (1024);
+	MidiBuffer b (1024);
+
+	for (int i = 0; i < 10; ++i) {
+		push (a, 2 * i, 0x90, i, 100);
+		push (b, 2 * i + 1, 0x80, i, 0);
+	}
+
+	vector<MidiBuffer const *> sources;
+	sources.push_back (&a);
+	sources.push_back (&b);
+
+	/* room for 5 events with 3 bytes each */
+	const size_t event_size = sizeof (MidiBuffer::TimeType) + 3;
+	MidiBuffer out (5 * event_size + 1);
+
+	CPPUNIT_ASSERT (!out.merge_from (sources));
+
+	/* the events that fit are the earliest ones, in order */
+	CPPUNIT_ASSERT_EQUAL (5 * event_size, out.size ());
+
+	MidiBuffer::TimeType t = 0;
+	for (MidiBuffer::iterator i = out.begin (); i != out.end (); ++i, ++t) {
+		CPPUNIT_ASSERT_EQUAL (t, (*i).time ());
+		CPPUNIT_ASSERT_EQUAL ((uint8_t) ((t % 2) ? 0x80 : 0x90), (*i).buffer ()[0]);
+	}
+	CPPUNIT_ASSERT_EQUAL ((MidiBuffer::TimeType) 5, t);
+
+	/* a destination which has room for all of them */
+	MidiBuffer big (a.size () + b.size ());
+	CPPUNIT_ASSERT (big.merge_from (sources));
+	CPPUNIT_ASSERT_EQUAL (a.size () + b.size (), big.size ());
+}
@@ -0,0 +1,16 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class MidiBufferTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (MidiBufferTest);
+	CPPUNIT_TEST (mergeOrderTest);
+	CPPUNIT_TEST (mergeSimultaneousTest);
+	CPPUNIT_TEST (mergeOverflowTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void mergeOrderTest ();
+	void mergeSimultaneousTest ();
+	void mergeOverflowTest ();
+};
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <cstdlib>
+
+#include <glib.h>
+
+#include "pbd/compose.h"
+#include "pbd/failed_constructor.h"
+
+#include "ardour/ardour.h"
+#include "ardour/audioengine.h"
+#include "ardour/buffer_set.h"
+#include "ardour/chan_mapping.h"
+#include "ardour/luaproc.h"
+#include "ardour/process_thread.h"
+#include "ardour/rc_configuration.h"
+#include "ardour/session.h"
+
+#include "test_util.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+static const char* localedir = LOCALEDIR;
+
+/* Measure the cost of instantiating Lua DSP scripts and the overhead of
+ * calling dsp_run() with and without re-using the buffer tables.
+ */
+
+static const char* script =
+	"ardour { [\"type\"] = \"dsp\", name = \"Benchmark Amp\", category = \"Benchmark\", license = \"MIT\", author = \"Ardour\", description = [[ gain ]] }\n"
+	"function dsp_ioconfig () return { { audio_in = -1, audio_out = -1 } } end\n"
+	"function dsp_run (ins, outs, n_samples)\n"
+	"  for c = 1, #ins do\n"
+	"    if ins[c] ~= outs[c] then ARDOUR.DSP.copy_vector (outs[c], ins[c], n_samples) end\n"
+	"    ARDOUR.DSP.apply_gain_to_buffer (outs[c], n_samples, 0.5)\n"
+	"  end\n"
+	"end\n";
+
+static void
+run (Session* session, std::vector<LuaProc*> const & procs, int cycles, bool bind)
+{
+	Config->set_lua_dsp_fresh_buffer_tables (!bind);
+
+	pframes_t const nframes = session->engine().samples_per_cycle ();
+	ChanCount const chn (DataType::AUDIO, 2);
+	ChanMapping const map (chn);
+
+	session->engine().main_thread()->get_buffers ();
+	BufferSet& bufs = session->get_scratch_buffers (chn);
+
+	int64_t worst = 0;
+	int64_t const start = g_get_monotonic_time ();
+
+	for (int i = 0; i < cycles; ++i) {
+		int64_t const t0 = g_get_monotonic_time ();
+		for (std::vector<LuaProc*>::const_iterator p = procs.begin(); p != procs.end(); ++p) {
+			(*p)->connect_and_run (bufs, 0, nframes, 1.0, map, map, nframes, 0);
+		}
+		worst = max (worst, (int64_t) (g_get_monotonic_time () - t0));
+	}
+
+	int64_t const elapsed = g_get_monotonic_time () - start;
+	session->engine().main_thread()->drop_buffers ();
+
+	cout << (bind ? "bound buffers:  " : "fresh tables:   ")
+	     << (double) elapsed / (cycles * procs.size ()) << " us per dsp_run(), "
+	     << "worst cycle " << worst << " us\n";
+}
+
+int
+main (int argc, char* argv[])
+{
+	if (argc < 3) {
+		cerr << "Syntax: " << argv[0] << " <dir> <snapshot-name> [instances] [cycles]\n";
+		exit (EXIT_FAILURE);
+	}
+
+	int const instances = argc > 3 ? atoi (argv[3]) : 150;
+	int const cycles = argc > 4 ? atoi (argv[4]) : 2000;
+
+	ARDOUR::init (false, true, localedir);
+
+	Session* session = 0;
+
+	try {
+		session = load_session (argv[1], argv[2]);
+	} catch (failed_constructor& e) {
+		cerr << "failed_constructor: " << e.what() << "\n";
+		exit (EXIT_FAILURE);
+	}
+
+	std::vector<LuaProc*> procs;
+
+	int64_t const t0 = g_get_monotonic_time ();
+
+	for (int i = 0; i < instances; ++i) {
+		LuaProc* p = new LuaProc (session->engine(), *session, script);
+		ChanCount chn (DataType::AUDIO, 2);
+		ChanCount out;
+		p->can_support_io_configuration (chn, out, 0);
+		p->configure_io (chn, out);
+		procs.push_back (p);
+	}
+
+	cout << instances << " instances: " << (g_get_monotonic_time () - t0) / 1000.0 << " ms to create\n";
+
+	run (session, procs, cycles, false);
+	run (session, procs, cycles, true);
+
+	for (std::vector<LuaProc*>::iterator p = procs.begin(); p != procs.end(); ++p) {
+		delete *p;
+	}
+
+	AudioEngine::instance()->remove_session ();
+	delete session;
+	AudioEngine::instance()->stop ();
+	AudioEngine::destroy ();
+
+	return 0;
+}
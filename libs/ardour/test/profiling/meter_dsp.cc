@@ -0,0 +1,153 @@
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+#include <glib.h>
+
+#include "ardour/ardour.h"
+#include "ardour/iec1ppmdsp.h"
+#include "ardour/iec2ppmdsp.h"
+#include "ardour/kmeterdsp.h"
+#include "ardour/multimeterdsp.h"
+#include "ardour/runtime_functions.h"
+#include "ardour/vumeterdsp.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+static const char* localedir = LOCALEDIR;
+
+/* Compare the cost per channel of metering with the single channel meters
+ * (compute_peak() and Kmeterdsp, Iec1ppmdsp, Iec2ppmdsp, Vumeterdsp, as
+ * PeakMeter used to run them) and with MultiMeterDSP, for a few channel
+ * counts and meter types. Also check that both compute the same levels.
+ */
+
+static const uint32_t rate = 48000;
+static const uint32_t nframes = 256;
+static const int cycles = 4000;
+
+struct Channels {
+	Channels (uint32_t n) : kmeter (n), iec1 (n), iec2 (n), vu (n), peak (n, 0) {}
+
+	vector<Kmeterdsp>  kmeter;
+	vector<Iec1ppmdsp> iec1;
+	vector<Iec2ppmdsp> iec2;
+	vector<Vumeterdsp> vu;
+	vector<float>      peak;
+};
+
+static void
+run_single (Channels& c, vector<float const *> const & data, uint32_t types)
+{
+	for (uint32_t i = 0; i < data.size (); ++i) {
+		c.peak[i] = compute_peak (data[i], nframes, c.peak[i]);
+		if (types & (MeterKrms | MeterK20 | MeterK14 | MeterK12)) {
+			c.kmeter[i].process (data[i], nframes);
+		}
+		if (types & (MeterIEC1DIN | MeterIEC1NOR)) {
+			c.iec1[i].process (data[i], nframes);
+		}
+		if (types & (MeterIEC2BBC | MeterIEC2EBU)) {
+			c.iec2[i].process (data[i], nframes);
+		}
+		if (types & MeterVU) {
+			c.vu[i].process (data[i], nframes);
+		}
+	}
+}
+
+static float
+read_single (Channels& c, uint32_t i, uint32_t types)
+{
+	if (types & (MeterKrms | MeterK20 | MeterK14 | MeterK12)) {
+		return c.kmeter[i].read ();
+	} else if (types & (MeterIEC1DIN | MeterIEC1NOR)) {
+		return c.iec1[i].read ();
+	} else if (types & (MeterIEC2BBC | MeterIEC2EBU)) {
+		return c.iec2[i].read ();
+	} else if (types & MeterVU) {
+		return c.vu[i].read ();
+	}
+	return c.peak[i];
+}
+
+static void
+measure (uint32_t n_channels, uint32_t types, char const * what)
+{
+	vector<float> buffers (n_channels * nframes);
+	vector<float const *> data (n_channels);
+
+	for (uint32_t i = 0; i < n_channels; ++i) {
+		data[i] = &buffers[i * nframes];
+	}
+
+	Channels single (n_channels);
+	MultiMeterDSP multi;
+	multi.set_channels (n_channels);
+	vector<float> multi_peak (n_channels, 0);
+
+	gint64 single_time = 0;
+	gint64 multi_time = 0;
+	float max_error = 0;
+
+	for (int cycle = 0; cycle < cycles; ++cycle) {
+		for (uint32_t i = 0; i < n_channels; ++i) {
+			for (uint32_t f = 0; f < nframes; ++f) {
+				buffers[i * nframes + f] = 0.5f * sinf (.01f * (i + 1) * (cycle * nframes + f)) * (rand () / (float) RAND_MAX);
+			}
+		}
+
+		gint64 const start = g_get_monotonic_time ();
+		run_single (single, data, types);
+		gint64 const mid = g_get_monotonic_time ();
+		multi.process (&data[0], nframes, types, &multi_peak[0]);
+		multi_time += g_get_monotonic_time () - mid;
+		single_time += mid - start;
+
+		/* read every 40 ms or so, like the GUI would */
+		if (cycle % 8) {
+			continue;
+		}
+
+		for (uint32_t i = 0; i < n_channels; ++i) {
+			float const a = read_single (single, i, types);
+			float const b = (types == MeterPeak) ? multi_peak[i] : multi.read (i, types);
+			max_error = max (max_error, fabsf (a - b) / max (fabsf (a), 1e-6f));
+			single.peak[i] = multi_peak[i] = 0;
+		}
+	}
+
+	double const scale = 1000.0 / ((double) cycles * n_channels);
+
+	cout << what << " " << n_channels << " channels, ns per channel and cycle: "
+	     << "single " << single_time * scale << ", "
+	     << "multi " << multi_time * scale << ", "
+	     << "max. relative difference " << max_error << "\n";
+}
+
+int
+main (int argc, char* argv[])
+{
+	ARDOUR::init (false, true, localedir);
+
+	Kmeterdsp::init (rate);
+	Iec1ppmdsp::init (rate);
+	Iec2ppmdsp::init (rate);
+	Vumeterdsp::init (rate);
+	MultiMeterDSP::init (rate);
+
+	uint32_t const channels[] = { 2, 8, 64, 256 };
+
+	for (size_t i = 0; i < sizeof (channels) / sizeof (channels[0]); ++i) {
+		measure (channels[i], MeterPeak, "peak");
+		measure (channels[i], MeterK20, "K20 ");
+		measure (channels[i], MeterIEC1DIN, "DIN ");
+		measure (channels[i], MeterVU, "VU  ");
+		measure (channels[i], MeterK20 | MeterIEC1DIN | MeterIEC2BBC | MeterVU, "all ");
+	}
+
+	ARDOUR::cleanup ();
+	return 0;
+}
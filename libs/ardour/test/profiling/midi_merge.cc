@@ -0,0 +1,127 @@
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+#include <glib.h>
+
+#include "ardour/ardour.h"
+#include "ardour/midi_buffer.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+static const char* localedir = LOCALEDIR;
+
+/* Compare the cost of merging the MIDI of many sources into one buffer one
+ * source at a time with MidiBuffer::merge_in_place() (as InternalReturn used
+ * to for each of its sends), and in one pass with MidiBuffer::merge_from().
+ * The sources carry dense controller and pitch bend streams, like MPE.
+ */
+
+static const uint32_t nframes = 1024;
+static const uint32_t capacity = 65536;
+static const int cycles = 2000;
+
+static void
+fill (MidiBuffer& buf, uint32_t n_events, uint8_t channel)
+{
+	buf.clear ();
+
+	for (uint32_t i = 0; i < n_events; ++i) {
+		MidiBuffer::TimeType const time = (i * nframes) / n_events + (rand () % 4);
+		uint8_t ev[3];
+
+		switch (rand () % 4) {
+		case 0:
+			ev[0] = 0xe0 | channel;
+			break;
+		case 1:
+			ev[0] = 0xd0 | channel;
+			break;
+		default:
+			ev[0] = 0xb0 | channel;
+			break;
+		}
+		ev[1] = rand () & 0x7f;
+		ev[2] = rand () & 0x7f;
+
+		buf.push_back (min (time, (MidiBuffer::TimeType) nframes - 1), (ev[0] & 0xf0) == 0xd0 ? 2 : 3, ev);
+	}
+}
+
+static bool
+ordered (MidiBuffer& buf)
+{
+	MidiBuffer::TimeType last = 0;
+
+	for (MidiBuffer::iterator i = buf.begin (); i != buf.end (); ++i) {
+		if ((*i).time () < last) {
+			return false;
+		}
+		last = (*i).time ();
+	}
+
+	return true;
+}
+
+static void
+measure (uint32_t n_sources, uint32_t events_per_source)
+{
+	vector<MidiBuffer*> sources;
+	vector<MidiBuffer const *> merge_sources;
+
+	for (uint32_t i = 0; i < n_sources; ++i) {
+		sources.push_back (new MidiBuffer (capacity));
+		merge_sources.push_back (sources.back ());
+	}
+
+	MidiBuffer pairwise (capacity * 4);
+	MidiBuffer merged (capacity * 4);
+
+	gint64 pairwise_time = 0;
+	gint64 merged_time = 0;
+	bool ok = true;
+
+	for (int cycle = 0; cycle < cycles; ++cycle) {
+		for (uint32_t i = 0; i < n_sources; ++i) {
+			fill (*sources[i], events_per_source, i % 16);
+		}
+
+		gint64 const start = g_get_monotonic_time ();
+		pairwise.clear ();
+		for (uint32_t i = 0; i < n_sources; ++i) {
+			pairwise.merge_in_place (*sources[i]);
+		}
+		gint64 const mid = g_get_monotonic_time ();
+		merged.merge_from (merge_sources);
+		merged_time += g_get_monotonic_time () - mid;
+		pairwise_time += mid - start;
+
+		ok = ok && pairwise.size () == merged.size () && ordered (merged);
+	}
+
+	for (uint32_t i = 0; i < n_sources; ++i) {
+		delete sources[i];
+	}
+
+	cout << n_sources << " sources of " << events_per_source << " events, us per cycle: "
+	     << "merge_in_place " << pairwise_time / (double) cycles << ", "
+	     << "merge_from " << merged_time / (double) cycles
+	     << (ok ? "" : " (RESULTS DIFFER)") << "\n";
+}
+
+int
+main (int argc, char* argv[])
+{
+	ARDOUR::init (false, true, localedir);
+
+	uint32_t const sources[] = { 2, 8, 32, 64 };
+
+	for (size_t i = 0; i < sizeof (sources) / sizeof (sources[0]); ++i) {
+		measure (sources[i], 16);
+		measure (sources[i], 128);
+	}
+
+	ARDOUR::cleanup ();
+	return 0;
+}
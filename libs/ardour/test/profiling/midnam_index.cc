@@ -0,0 +1,85 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glibmm/miscutils.h>
+
+#include "pbd/compose.h"
+#include "pbd/gstdio_compat.h"
+
+#include "ardour/ardour.h"
+#include "ardour/filesystem_paths.h"
+#include "ardour/midi_patch_manager.h"
+
+using namespace std;
+using namespace ARDOUR;
+using namespace MIDI::Name;
+
+static const char* localedir = LOCALEDIR;
+
+/* Measure the time MidiPatchManager takes to make all .midnam files in the
+ * search path known, and the memory this takes, without and with the
+ * on-disk index. Finally, parse all documents like the manager used to
+ * do at startup.
+ */
+
+static double
+resident_mb ()
+{
+	long pages = 0;
+	long resident = 0;
+	ifstream statm ("/proc/self/statm");
+	statm >> pages >> resident;
+	return resident * (double) sysconf (_SC_PAGESIZE) / 1048576.0;
+}
+
+static void
+measure (char const * what)
+{
+	double const rss = resident_mb ();
+	gint64 const start = g_get_monotonic_time ();
+
+	MidiPatchManager& pm = MidiPatchManager::instance ();
+	gint64 const created = g_get_monotonic_time ();
+
+	pm.wait_for_scan ();
+	gint64 const scanned = g_get_monotonic_time ();
+
+	cout << what << ": " << pm.all_models ().size () << " models, "
+	     << (created - start) / 1000.0 << " ms blocking, "
+	     << (scanned - start) / 1000.0 << " ms until scanned, "
+	     << resident_mb () - rss << " MB\n";
+}
+
+int
+main (int argc, char* argv[])
+{
+	ARDOUR::init (false, true, localedir);
+
+	string const index = Glib::build_filename (user_cache_directory (), "midnam_index");
+	::g_unlink (index.c_str ());
+
+	measure ("without index");
+
+	delete &MidiPatchManager::instance ();
+
+	measure ("with index   ");
+
+	MidiPatchManager& pm = MidiPatchManager::instance ();
+	MIDI::Name::MasterDeviceNames::Models const models = pm.all_models ();
+
+	double const rss = resident_mb ();
+	gint64 const start = g_get_monotonic_time ();
+
+	for (MIDI::Name::MasterDeviceNames::Models::const_iterator m = models.begin (); m != models.end (); ++m) {
+		pm.document_by_model (*m);
+	}
+
+	cout << "parsing all documents: " << (g_get_monotonic_time () - start) / 1000.0 << " ms, "
+	     << resident_mb () - rss << " MB\n";
+
+	ARDOUR::cleanup ();
+	return 0;
+}
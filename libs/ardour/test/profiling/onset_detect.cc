@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+#include <glib.h>
+
+#include "dsp/onsets/DetectionFunction.h"
+#include "dsp/transforms/FFT.h"
+
+using namespace std;
+
+/* Measure the throughput of the qm-dsp onset detection function, which
+ * is what the "transient" analysis used by Rhythm Ferret spends its time
+ * in, and of the real FFT underneath it. Build once with and once without
+ * FFTW3 to compare it against the bundled KissFFT; either way the FFT is
+ * first checked against a direct DFT, so that both builds are known to
+ * produce the same results.
+ */
+
+static const int rate = 48000;
+static const int seconds = 600;
+
+static void
+drums (vector<double>& buf)
+{
+	buf.resize (rate * seconds);
+
+	for (size_t i = 0; i < buf.size (); ++i) {
+		/* a decaying noise burst every 1/8th of a second */
+		double const t = (i % (rate / 8)) / (double) rate;
+		buf[i] = exp (-t * 40) * (rand () / (double) RAND_MAX - 0.5);
+	}
+}
+
+static void
+measure_df (vector<double> const& buf, int type, char const* name)
+{
+	DFConfig config;
+	config.stepSize = 256;
+	config.frameLength = 512;
+	config.DFType = type;
+	config.dbRise = 3;
+	config.adaptiveWhitening = false;
+	config.whiteningRelaxCoeff = -1;
+	config.whiteningFloor = -1;
+
+	DetectionFunction df (config);
+
+	gint64 const start = g_get_monotonic_time ();
+	double sum = 0;
+
+	for (size_t i = 0; i + config.frameLength <= buf.size (); i += config.stepSize) {
+		sum += df.processTimeDomain (&buf[i]);
+	}
+
+	gint64 const elapsed = g_get_monotonic_time () - start;
+
+	cout << name << ": " << elapsed / 1000 << " ms for " << seconds << " s of audio, "
+	     << (seconds * 1e6) / elapsed << " x realtime (" << sum << ")\n";
+}
+
+/** @return the largest difference between the qm-dsp FFTs of a random
+ *  signal and its direct DFT, relative to the largest DFT magnitude.
+ */
+static double
+check_fft (int n)
+{
+	vector<double> in (n);
+
+	for (int i = 0; i < n; ++i) {
+		in[i] = rand () / (double) RAND_MAX - 0.5;
+	}
+
+	vector<double> dre (n);
+	vector<double> dim (n);
+	double peak = 0;
+
+	for (int k = 0; k < n; ++k) {
+		for (int i = 0; i < n; ++i) {
+			double const w = -2 * M_PI * (double) ((long) k * i % n) / n;
+			dre[k] += in[i] * cos (w);
+			dim[k] += in[i] * sin (w);
+		}
+		peak = max (peak, hypot (dre[k], dim[k]));
+	}
+
+	vector<double> re (n);
+	vector<double> im (n);
+	vector<double> mag (n);
+	vector<double> back (n);
+	double err = 0;
+
+	FFTReal real (n);
+	real.forward (&in[0], &re[0], &im[0]);
+	real.forwardMagnitude (&in[0], &mag[0]);
+
+	for (int k = 0; k <= n / 2; ++k) {
+		err = max (err, hypot (re[k] - dre[k], im[k] - dim[k]) / peak);
+		err = max (err, fabs (mag[k] - hypot (dre[k], dim[k])) / peak);
+	}
+
+	real.inverse (&re[0], &im[0], &back[0]);
+
+	for (int i = 0; i < n; ++i) {
+		err = max (err, fabs (back[i] - in[i]));
+	}
+
+	FFT complex (n);
+	complex.process (false, &in[0], 0, &re[0], &im[0]);
+
+	for (int k = 0; k < n; ++k) {
+		err = max (err, hypot (re[k] - dre[k], im[k] - dim[k]) / peak);
+	}
+
+	return err;
+}
+
+static void
+measure_fft (int n)
+{
+	FFTReal fft (n);
+	vector<double> in (n);
+	vector<double> re (n);
+	vector<double> im (n);
+
+	for (int i = 0; i < n; ++i) {
+		in[i] = rand () / (double) RAND_MAX - 0.5;
+	}
+
+	int const count = (1 << 24) / n;
+
+	gint64 const start = g_get_monotonic_time ();
+
+	for (int i = 0; i < count; ++i) {
+		fft.forward (&in[0], &re[0], &im[0]);
+	}
+
+	gint64 const elapsed = g_get_monotonic_time () - start;
+
+	cout << "FFTReal " << n << ": " << (elapsed * 1000.0) / count << " ns per transform\n";
+}
+
+int
+main (int argc, char* argv[])
+{
+	int const sizes[] = { 512, 1024, 2048, 4096 };
+
+	for (size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); ++i) {
+		double const err = check_fft (sizes[i]);
+		cout << "FFT " << sizes[i] << ": relative error " << err << "\n";
+		if (err > 1e-9) {
+			cerr << "FFT " << sizes[i] << " does not match the DFT\n";
+			return 1;
+		}
+	}
+
+	vector<double> buf;
+	drums (buf);
+
+	measure_df (buf, DF_COMPLEXSD, "complex domain onset");
+	measure_df (buf, DF_HFC, "high frequency content onset");
+
+	for (size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); ++i) {
+		measure_fft (sizes[i]);
+	}
+
+	return 0;
+}
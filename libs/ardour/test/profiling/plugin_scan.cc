@@ -0,0 +1,47 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+#include <glib.h>
+#include <glibmm/miscutils.h>
+
+#include "pbd/gstdio_compat.h"
+
+#include "ardour/ardour.h"
+#include "ardour/filesystem_paths.h"
+#include "ardour/plugin_manager.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+static const char* localedir = LOCALEDIR;
+
+/* Measure startup time (ARDOUR::init(), which includes plugin discovery)
+ * with the LADSPA and LV2 plugin caches removed (--cold) or in place.
+ * Run it once with --cold and then once without to compare; running
+ * both in one process would not be fair, lilv keeps what it has loaded.
+ */
+
+int
+main (int argc, char* argv[])
+{
+	bool const cold = argc > 1 && !strcmp (argv[1], "--cold");
+
+	if (cold) {
+		::g_unlink (Glib::build_filename (user_cache_directory (), "ladspa_cache").c_str ());
+		::g_unlink (Glib::build_filename (user_cache_directory (), "lv2_cache").c_str ());
+	}
+
+	gint64 const start = g_get_monotonic_time ();
+	ARDOUR::init (false, true, localedir);
+	gint64 const end = g_get_monotonic_time ();
+
+	PluginManager& pm = PluginManager::instance ();
+
+	cout << (cold ? "cold" : "warm") << " start: " << (end - start) / 1000.0 << " ms, "
+	     << pm.ladspa_plugin_info ().size () << " LADSPA, "
+	     << pm.lv2_plugin_info ().size () << " LV2 plugins\n";
+
+	ARDOUR::cleanup ();
+	return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <cstdlib>
+
+#include <glibmm.h>
+
+#include "pbd/compose.h"
+#include "pbd/failed_constructor.h"
+
+#include "ardour/ardour.h"
+#include "ardour/audioengine.h"
+#include "ardour/route.h"
+#include "ardour/session.h"
+#include "ardour/track.h"
+
+#include "test_util.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+static const char* localedir = LOCALEDIR;
+
+/* Compare the DSP load of a session with heavy busses processed as usual
+ * and with their plugin chains pipelined (Route::set_pipelined()).
+ */
+
+static void
+set_pipelined (Session* session, bool yn)
+{
+	boost::shared_ptr<RouteList> rl = session->get_routes ();
+	for (RouteList::iterator i = rl->begin(); i != rl->end(); ++i) {
+		if (boost::dynamic_pointer_cast<Track> (*i) || (*i)->is_monitor () || (*i)->is_auditioner ()) {
+			continue;
+		}
+		(*i)->set_pipelined (yn);
+	}
+}
+
+static void
+measure (Session* session, bool pipelined, int seconds)
+{
+	set_pipelined (session, pipelined);
+
+	/* let things settle */
+	Glib::usleep (500000);
+
+	float avg = 0;
+	float peak = 0;
+	int const n = seconds * 10;
+
+	for (int i = 0; i < n; ++i) {
+		Glib::usleep (100000);
+		float const load = session->engine().get_dsp_load ();
+		avg += load;
+		peak = max (peak, load);
+	}
+
+	cout << (pipelined ? "pipelined: " : "serial:    ")
+	     << "average DSP load " << avg / n << "%, peak " << peak << "%\n";
+}
+
+int
+main (int argc, char* argv[])
+{
+	if (argc < 3) {
+		cerr << "Syntax: " << argv[0] << " <dir> <snapshot-name> [seconds]\n";
+		exit (EXIT_FAILURE);
+	}
+
+	int const seconds = argc > 3 ? atoi (argv[3]) : 10;
+
+	ARDOUR::init (false, true, localedir);
+
+	Session* session = 0;
+
+	try {
+		session = load_session (argv[1], argv[2]);
+	} catch (failed_constructor& e) {
+		cerr << "failed_constructor: " << e.what() << "\n";
+		exit (EXIT_FAILURE);
+	}
+
+	cout << session->get_routes()->size() << " routes, "
+	     << session->engine().samples_per_cycle () << " samples per cycle\n";
+
+	session->request_transport_speed (1.0);
+
+	measure (session, false, seconds);
+	measure (session, true, seconds);
+
+	AudioEngine::instance()->remove_session ();
+	delete session;
+	AudioEngine::instance()->stop ();
+	AudioEngine::destroy ();
+
+	return 0;
+}
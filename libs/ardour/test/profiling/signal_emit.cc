@@ -0,0 +1,64 @@
+#include <iostream>
+#include <cstdlib>
+
+#include <glib.h>
+
+#include "pbd/signals.h"
+
+#include "ardour/ardour.h"
+
+using namespace std;
+
+static const char* localedir = LOCALEDIR;
+
+/* Measure the cost of emitting a PBD::Signal to a few slots in the same
+ * thread, which is what most emissions from the process thread do.
+ */
+
+static const int n_emissions = 1000000;
+
+static int received = 0;
+
+static void
+receiver (int n)
+{
+	received += n;
+}
+
+static void
+measure (int n_slots)
+{
+	PBD::Signal1<void, int> signal;
+	PBD::ScopedConnectionList connections;
+
+	for (int i = 0; i < n_slots; ++i) {
+		signal.connect_same_thread (connections, boost::bind (&receiver, _1));
+	}
+
+	received = 0;
+
+	gint64 const start = g_get_monotonic_time ();
+	for (int i = 0; i < n_emissions; ++i) {
+		signal (1);
+	}
+	gint64 const end = g_get_monotonic_time ();
+
+	cout << "emission of a signal with " << n_slots << " slots: "
+	     << (end - start) * 1000.0 / n_emissions << " ns"
+	     << (received == n_slots * n_emissions ? "" : " (SLOTS MISSED)") << "\n";
+}
+
+int
+main (int argc, char* argv[])
+{
+	ARDOUR::init (false, true, localedir);
+
+	int const slots[] = { 0, 1, 8, 64 };
+
+	for (size_t i = 0; i < sizeof (slots) / sizeof (slots[0]); ++i) {
+		measure (slots[i]);
+	}
+
+	ARDOUR::cleanup ();
+	return 0;
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <algorithm>
+
+#include <glib.h>
+#include <glibmm/threads.h>
+#include <sigc++/bind.h>
+
+#include "pbd/ringbufferNPT.h"
+#include "pbd/spsc_ringbuffer.h"
+
+using namespace std;
+using namespace PBD;
+
+/* Measure the throughput of SPSCRingBuffer against RingBufferNPT, with a
+ * producer and a consumer thread passing numbers through a small buffer
+ * in varying chunk sizes.
+ */
+
+static const guint n_items = 1 << 24;
+
+template<class RB>
+static void
+produce (RB* rb)
+{
+	guint chunk[64];
+	guint n = 0;
+
+	while (n < n_items) {
+		const guint cnt = min (n_items - n, 1 + n % 64);
+		for (guint i = 0; i < cnt; ++i) {
+			chunk[i] = n + i;
+		}
+		size_t w = 0;
+		while (w < cnt) {
+			size_t const c = rb->write (chunk + w, cnt - w);
+			if (c == 0) {
+				Glib::Threads::Thread::yield ();
+			}
+			w += c;
+		}
+		n += cnt;
+	}
+}
+
+/* fill the buffer in place */
+static void
+produce_spans (SPSCRingBuffer<guint>* rb)
+{
+	SPSCRingBuffer<guint>::rw_vector vec;
+	guint n = 0;
+
+	while (n < n_items) {
+		if (rb->reserve_write (&vec, min (n_items - n, (guint) 256)) == 0) {
+			Glib::Threads::Thread::yield ();
+			continue;
+		}
+		for (int p = 0; p < 2; ++p) {
+			for (size_t i = 0; i < vec.len[p]; ++i) {
+				vec.buf[p][i] = n++;
+			}
+		}
+		rb->commit_write (vec.len[0] + vec.len[1]);
+	}
+}
+
+template<class RB>
+static bool
+consume (RB* rb)
+{
+	guint chunk[64];
+	guint n = 0;
+	bool ok = true;
+
+	while (n < n_items) {
+		size_t const c = rb->read (chunk, 64);
+		if (c == 0) {
+			Glib::Threads::Thread::yield ();
+		}
+		for (size_t i = 0; i < c; ++i, ++n) {
+			ok = ok && chunk[i] == n;
+		}
+	}
+	return ok;
+}
+
+template<class RB>
+static void
+measure (RB* rb, void (*producer)(RB*), char const* name)
+{
+	gint64 const start = g_get_monotonic_time ();
+	Glib::Threads::Thread* t = Glib::Threads::Thread::create (sigc::bind (sigc::ptr_fun (producer), rb));
+	bool const ok = consume (rb);
+	t->join ();
+	gint64 const elapsed = g_get_monotonic_time () - start;
+
+	cout << name << ": " << elapsed / 1000 << " ms, "
+	     << (elapsed * 1000.0) / n_items << " ns per item"
+	     << (ok ? "" : " (DATA CORRUPTED)") << "\n";
+}
+
+int
+main (int argc, char* argv[])
+{
+	RingBufferNPT<guint> npt (1024);
+	SPSCRingBuffer<guint> spsc (1024);
+
+	cout << n_items << " items through 1024 element buffers:\n";
+
+	measure (&npt, &produce<RingBufferNPT<guint> >, "RingBufferNPT");
+	measure (&spsc, &produce<SPSCRingBuffer<guint> >, "SPSCRingBuffer");
+	spsc.reset ();
+	measure (&spsc, &produce_spans, "SPSCRingBuffer (reserve/commit)");
+
+	return 0;
+}
@@ -50,6 +50,7 @@ VSTPlugin::VSTPlugin (AudioEngine& engine, Session& session, VSTHandle* handle)
 	, _transport_frame (0)
 	, _transport_speed (0.f)
 	, _eff_bypassed (false)
+	, _tail (-1)
 {
 	memset (&_timeInfo, 0, sizeof(_timeInfo));
 }
@@ -66,6 +67,7 @@ VSTPlugin::VSTPlugin (const VSTPlugin& other)
 	, _transport_speed (0.f)
 	, _parameter_defaults (other._parameter_defaults)
 	, _eff_bypassed (other._eff_bypassed)
+	, _tail (-1)
 {
 	memset (&_timeInfo, 0, sizeof(_timeInfo));
 }
@@ -128,6 +130,13 @@ void
 VSTPlugin::activate ()
 {
 	_plugin->dispatcher (_plugin, effMainsChanged, 0, 1, NULL, 0.0f);
+
+	/* plugin_tail() is called from the process thread, so ask here.
+	 * 0 means unknown and 1 means no tail, but plugins use 1 when they
+	 * do not know either, so treat both as unknown.
+	 */
+	intptr_t const t = _plugin->dispatcher (_plugin, effGetTailSize, 0, 0, NULL, 0.0f);
+	g_atomic_int_set (&_tail, t > 1 ? (gint) t : -1);
 }
 
 int
@@ -619,6 +628,12 @@ VSTPlugin::describe_parameter (Evoral::Parameter param)
 	return name;
 }
 
+framecnt_t
+VSTPlugin::plugin_tail () const
+{
+	return g_atomic_int_get (&_tail);
+}
+
 framecnt_t
 VSTPlugin::signal_latency () const
 {
@@ -17,44 +17,314 @@
   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 */
 
+#include <algorithm>
+#include <vector>
+
 #include <stdlib.h>
 #include <unistd.h>
 
 #include "ardour/worker.h"
+#include "pbd/compose.h"
+#include "pbd/cpus.h"
 #include "pbd/error.h"
+#include "pbd/semutils.h"
 
 #include <glibmm/timer.h>
 
 namespace ARDOUR {
 
+/** The threads which execute the work of all threaded Workers.
+ *
+ * Workers signal the pool's semaphore (which is realtime-safe) for each
+ * request they queue. A pool thread then looks for a worker with a
+ * pending request, starting after the one that was served last, claims
+ * it so that no other thread runs the same worker, and executes one
+ * request.
+ */
+class WorkerPool
+{
+public:
+	static WorkerPool& instance () { return _instance; }
+
+	void add (Worker*);
+	void remove (Worker*);
+	void signal () { _sem.signal (); }
+
+	uint32_t n_threads () const { return g_atomic_int_get (&_n_threads); }
+	uint32_t n_workers () const { return g_atomic_int_get (&_n_workers); }
+	Worker::PoolStats stats () const;
+
+	uint32_t size;
+
+private:
+	WorkerPool ();
+
+	static WorkerPool _instance;
+
+	void start ();
+	void stop ();
+	void run (uint32_t generation);
+	bool process_one (void*& buf, size_t& buf_size);
+
+	Glib::Threads::Mutex                _run_lock; ///< serializes start() and stop()
+	mutable Glib::Threads::Mutex        _lock;
+	std::vector<Worker*>                _workers;
+	std::vector<Glib::Threads::Thread*> _threads;
+	size_t                              _next;
+	PBD::Semaphore                      _sem;
+	uint32_t                            _generation; ///< threads of older generations exit
+	mutable gint                        _n_threads;
+	mutable gint                        _n_workers;
+	mutable gint                        _n_executed;
+	mutable gint                        _max_pending;
+};
+
+WorkerPool WorkerPool::_instance;
+
+WorkerPool::WorkerPool ()
+	: size (0)
+	, _next (0)
+	, _sem ("worker_pool_semaphore", 0)
+	, _generation (0)
+	, _n_threads (0)
+	, _n_workers (0)
+	, _n_executed (0)
+	, _max_pending (0)
+{
+}
+
+void
+WorkerPool::add (Worker* w)
+{
+	Glib::Threads::Mutex::Lock rl (_run_lock);
+	Glib::Threads::Mutex::Lock lm (_lock);
+	_workers.push_back (w);
+	g_atomic_int_set (&_n_workers, _workers.size ());
+	if (_threads.empty ()) {
+		start ();
+	}
+}
+
+void
+WorkerPool::remove (Worker* w)
+{
+	bool last;
+
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
+		_workers.erase (std::find (_workers.begin (), _workers.end (), w));
+		g_atomic_int_set (&_n_workers, _workers.size ());
+		last = _workers.empty ();
+	}
+
+	/* nobody can claim it now, but it may still be working */
+	while (g_atomic_int_get (&w->_busy)) {
+		Glib::usleep (1000);
+	}
+
+	if (last) {
+		stop ();
+	}
+}
+
+void
+WorkerPool::start ()
+{
+	uint32_t n = size;
+	if (n == 0) {
+		n = std::max ((uint32_t) 1, std::min ((uint32_t) 4, hardware_concurrency ()));
+	}
+
+	for (uint32_t i = 0; i < n; ++i) {
+		_threads.push_back (Glib::Threads::Thread::create (sigc::bind (sigc::mem_fun (*this, &WorkerPool::run), _generation)));
+	}
+	g_atomic_int_set (&_n_threads, n);
+}
+
+void
+WorkerPool::stop ()
+{
+	Glib::Threads::Mutex::Lock rl (_run_lock);
+	std::vector<Glib::Threads::Thread*> threads;
+
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
+		if (!_workers.empty ()) {
+			/* a new worker arrived meanwhile */
+			return;
+		}
+		threads.swap (_threads);
+		++_generation;
+	}
+
+	for (size_t i = 0; i < threads.size (); ++i) {
+		_sem.signal ();
+	}
+	for (size_t i = 0; i < threads.size (); ++i) {
+		threads[i]->join ();
+	}
+
+	g_atomic_int_set (&_n_threads, 0);
+}
+
+/** Claim the next worker with a pending request and execute that request.
+ * @return false if there was nothing to do.
+ */
+bool
+WorkerPool::process_one (void*& buf, size_t& buf_size)
+{
+	Worker* w = 0;
+
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
+		const size_t n = _workers.size ();
+		for (size_t i = 0; i < n; ++i) {
+			Worker* c = _workers[(_next + i) % n];
+			if (!c->verify_message_completeness (c->_requests)) {
+				continue;
+			}
+			if (g_atomic_int_compare_and_exchange (&c->_busy, 0, 1)) {
+				w = c;
+				_next = (_next + i + 1) % n;
+				break;
+			}
+		}
+	}
+
+	if (!w) {
+		return false;
+	}
+
+	/* only pool threads write this; losing a race just loses a sample */
+	const gint pending = w->pending_requests ();
+	if (pending > g_atomic_int_get (&_max_pending)) {
+		g_atomic_int_set (&_max_pending, pending);
+	}
+
+	const bool done = w->process_request (buf, buf_size);
+	g_atomic_int_set (&w->_busy, 0);
+
+	if (done) {
+		g_atomic_int_inc (&_n_executed);
+	}
+	return done;
+}
+
+Worker::PoolStats
+WorkerPool::stats () const
+{
+	Worker::PoolStats s;
+
+	s.threads = n_threads ();
+	s.workers = n_workers ();
+	s.executed = g_atomic_int_get (&_n_executed);
+	s.max_pending_requests = g_atomic_int_get (&_max_pending);
+	s.pending_requests = 0;
+	s.pending_responses = 0;
+
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	for (std::vector<Worker*>::const_iterator i = _workers.begin (); i != _workers.end (); ++i) {
+		s.pending_requests += (*i)->pending_requests ();
+		s.pending_responses += (*i)->pending_responses ();
+	}
+
+	return s;
+}
+
+void
+WorkerPool::run (uint32_t generation)
+{
+	void*  buf      = NULL;
+	size_t buf_size = 0;
+
+	while (true) {
+		_sem.wait ();
+
+		{
+			Glib::Threads::Mutex::Lock lm (_lock);
+			if (_generation != generation) {
+				break;
+			}
+		}
+
+		/* a request may be skipped above while another thread is busy
+		 * with its worker, so keep going until there is nothing left.
+		 */
+		while (process_one (buf, buf_size)) {}
+	}
+
+	free (buf);
+}
+
 Worker::Worker(Workee* workee, uint32_t ring_size, bool threaded)
 	: _workee(workee)
 	, _requests(threaded ? new RingBuffer<uint8_t>(ring_size) : NULL)
 	, _responses(new RingBuffer<uint8_t>(ring_size))
 	, _response((uint8_t*)malloc(ring_size))
-	, _sem("worker_semaphore", 0)
-	, _thread(NULL)
-	, _exit(false)
+	, _busy(0)
 	, _synchronous(!threaded)
 {
 	if (threaded) {
-		_thread = Glib::Threads::Thread::create(
-			sigc::mem_fun(*this, &Worker::run));
+		WorkerPool::instance().add(this);
 	}
 }
 
 Worker::~Worker()
 {
-	_exit = true;
-	_sem.signal();
-	if (_thread) {
-		_thread->join();
+	if (_requests) {
+		WorkerPool::instance().remove(this);
 	}
 	delete _responses;
 	delete _requests;
 	free (_response);
 }
 
+void
+Worker::set_pool_size(uint32_t n)
+{
+	WorkerPool::instance().size = n;
+}
+
+uint32_t
+Worker::pool_threads()
+{
+	return WorkerPool::instance().n_threads();
+}
+
+uint32_t
+Worker::pool_workers()
+{
+	return WorkerPool::instance().n_workers();
+}
+
+Worker::PoolStats
+Worker::pool_stats()
+{
+	return WorkerPool::instance().stats();
+}
+
+std::string
+Worker::pool_report()
+{
+	const PoolStats s (pool_stats());
+	return string_compose ("%1 threads, %2 workers, %3 requests executed, %4/%5 bytes of requests/responses queued (max %6 for one worker)\n",
+	                       s.threads, s.workers, s.executed,
+	                       s.pending_requests, s.pending_responses, s.max_pending_requests);
+}
+
+uint32_t
+Worker::pending_requests() const
+{
+	return _requests ? _requests->read_space() : 0;
+}
+
+uint32_t
+Worker::pending_responses() const
+{
+	return _responses->read_space();
+}
+
 bool
 Worker::schedule(uint32_t size, const void* data)
 {
@@ -71,7 +341,7 @@ Worker::schedule(uint32_t size, const void* data)
 	if (_requests->write((const uint8_t*)data, size) != size) {
 		return false;
 	}
-	_sem.signal();
+	WorkerPool::instance().signal();
 	return true;
 }
 
@@ -131,55 +401,41 @@ Worker::emit_responses()
 	}
 }
 
-void
-Worker::run()
+bool
+Worker::process_request(void*& buf, size_t& buf_size)
 {
-	void*  buf      = NULL;
-	size_t buf_size = 0;
-	while (true) {
-		_sem.wait();
-		if (_exit) {
-			free(buf);
-			return;
-		}
-
-		uint32_t size = _requests->read_space();
-		if (size < sizeof(size)) {
-			PBD::error << "Worker: no work-data on ring buffer" << endmsg;
-			continue;
-		}
-		while (!verify_message_completeness(_requests)) {
-			Glib::usleep(2000);
-			if (_exit) {
-				if (buf) free(buf);
-				return;
-			}
-		}
-		if (_requests->read((uint8_t*)&size, sizeof(size)) < sizeof(size)) {
-			PBD::error << "Worker: Error reading size from request ring"
-			           << endmsg;
-			continue;
-		}
-
-		if (size > buf_size) {
-			buf = realloc(buf, size);
-			if (buf) {
-				buf_size = size;
-			} else {
-				PBD::error << "Worker: Error allocating memory"
-				           << endmsg;
-				buf_size = 0; // TODO: This is probably fatal
-			}
-		}
+	uint32_t size = _requests->read_space();
+	if (size < sizeof(size)) {
+		return false;
+	}
+	if (!verify_message_completeness(_requests)) {
+		return false;
+	}
+	if (_requests->read((uint8_t*)&size, sizeof(size)) < sizeof(size)) {
+		PBD::error << "Worker: Error reading size from request ring"
+		           << endmsg;
+		return false;
+	}
 
-		if (_requests->read((uint8_t*)buf, size) < size) {
-			PBD::error << "Worker: Error reading body from request ring"
+	if (size > buf_size) {
+		buf = realloc(buf, size);
+		if (buf) {
+			buf_size = size;
+		} else {
+			PBD::error << "Worker: Error allocating memory"
 			           << endmsg;
-			continue;  // TODO: This is probably fatal
+			buf_size = 0; // TODO: This is probably fatal
 		}
+	}
 
-		_workee->work(*this, size, buf);
+	if (_requests->read((uint8_t*)buf, size) < size) {
+		PBD::error << "Worker: Error reading body from request ring"
+		           << endmsg;
+		return false;  // TODO: This is probably fatal
 	}
+
+	_workee->work(*this, size, buf);
+	return true;
 }
 
 } // namespace ARDOUR
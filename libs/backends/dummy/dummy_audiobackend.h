@@ -229,6 +229,9 @@ class DummyAudioBackend : public AudioBackend {
 		~DummyAudioBackend ();
 
 		bool is_running () const { return _running; }
+		/** true if the "Benchmark" driver is selected: process as fast as
+		 * possible and generate the same input on every run */
+		bool benchmark () const { return _speedup == 0; }
 
 		/* AUDIOBACKEND API */
 
@@ -1,7 +1,11 @@
 #include <sys/time.h>
+#include <algorithm>
 #include "pbd/compose.h"
 #include "canvas/types.h"
 #include "canvas/canvas.h"
+#include "canvas/container.h"
+#include "canvas/poly_line.h"
+#include "canvas/rectangle.h"
 #include "benchmark.h"
 
 using namespace std;
@@ -23,6 +27,90 @@ rect_random (double rough_size)
 	return Rect (x, y, x + w, y + h);
 }
 
+void
+make_tracks (Item* parent, int tracks, int regions)
+{
+	double const track_height = 68;
+	double const region_width = 300;
+
+	srand (1);
+
+	for (int t = 0; t < tracks; ++t) {
+		Container* track = new Container (parent);
+		track->set_position (Duple (0, t * track_height));
+
+		Rectangle* bg = new Rectangle (track, Rect (0, 0, regions * region_width, track_height));
+		bg->set_fill_color (0x303030ff);
+		bg->set_outline_color (0x000000ff);
+
+		for (int r = 0; r < regions; ++r) {
+			Container* region = new Container (track);
+			region->set_position (Duple (r * region_width, 1));
+
+			Rectangle* frame = new Rectangle (region, Rect (0, 0, region_width - 4, track_height - 2));
+			frame->set_fill_color (0x5a7a9aff);
+			frame->set_outline_color (0x101010ff);
+
+			Rectangle* name = new Rectangle (region, Rect (0, track_height - 16, region_width - 4, track_height - 2));
+			name->set_fill_color (0x404040ff);
+
+			Points points;
+			for (int x = 0; x < region_width - 4; x += 2) {
+				points.push_back (Duple (x, 4 + double_random() * (track_height - 24)));
+			}
+
+			PolyLine* wave = new PolyLine (region);
+			wave->set (points);
+			wave->set_outline_color (0x000000ff);
+		}
+	}
+}
+
+void
+FrameTimes::start ()
+{
+	gettimeofday (&_start, 0);
+}
+
+void
+FrameTimes::stop ()
+{
+	timeval stop;
+	gettimeofday (&stop, 0);
+
+	int sec = stop.tv_sec - _start.tv_sec;
+	int usec = stop.tv_usec - _start.tv_usec;
+	if (usec < 0) {
+		--sec;
+		usec += 1e6;
+	}
+
+	_times.push_back (sec + ((double) usec / 1e6));
+}
+
+string
+FrameTimes::summary () const
+{
+	if (_times.empty()) {
+		return "no frames";
+	}
+
+	vector<double> t (_times);
+	sort (t.begin(), t.end());
+
+	double total = 0;
+	for (vector<double>::const_iterator i = t.begin(); i != t.end(); ++i) {
+		total += *i;
+	}
+
+	return string_compose ("%1 frames: mean %2ms median %3ms 95%% %4ms worst %5ms",
+			       t.size(),
+			       total * 1e3 / t.size(),
+			       t[t.size() / 2] * 1e3,
+			       t[(t.size() * 95) / 100] * 1e3,
+			       t.back() * 1e3);
+}
+
 Benchmark::Benchmark (string const & session)
 	: _iterations (1)
 {
@@ -1,13 +1,60 @@
+#include <sys/time.h>
+#include <vector>
 #include "pbd/xml++.h"
+#include "canvas/canvas.h"
 #include "canvas/types.h"
 
 extern double double_random ();
 extern ArdourCanvas::Rect rect_random (double);
 
+/** Fill @param parent with something like an editor's track canvas:
+ *  @param tracks rows of @param regions regions, each with a waveform-ish line.
+ */
+extern void make_tracks (ArdourCanvas::Item* parent, int tracks, int regions);
+
+/** Collects the time taken by each of a series of frames */
+class FrameTimes
+{
+public:
+	void start ();
+	void stop ();
+
+	/** @return count, mean, median, 95th percentile and worst frame times */
+	std::string summary () const;
+
+private:
+	timeval _start;
+	std::vector<double> _times;
+};
+
 namespace ArdourCanvas {
 	class ImageCanvas;
 }
 
+/** A canvas that is not attached to any window, for benchmarks that
+ *  render to an image surface or only query items.
+ */
+class BenchmarkCanvas : public ArdourCanvas::Canvas
+{
+public:
+	void request_redraw (ArdourCanvas::Rect const &) {}
+	void request_size (ArdourCanvas::Duple) {}
+	void grab (ArdourCanvas::Item *) {}
+	void ungrab () {}
+	void focus (ArdourCanvas::Item *) {}
+	void unfocus (ArdourCanvas::Item *) {}
+	ArdourCanvas::Rect visible_area () const { return ArdourCanvas::Rect (0, 0, 1920, 1080); }
+	ArdourCanvas::Coord width () const { return 1920; }
+	ArdourCanvas::Coord height () const { return 1080; }
+	bool get_mouse_position (ArdourCanvas::Duple&) const { return false; }
+	void re_enter () {}
+	Glib::RefPtr<Pango::Context> get_pango_context () { return Glib::RefPtr<Pango::Context> (); }
+
+protected:
+	void pick_current_item (int) {}
+	void pick_current_item (ArdourCanvas::Duple const &, int) {}
+};
+
 class Benchmark
 {
 public:
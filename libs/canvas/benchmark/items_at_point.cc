@@ -1,62 +1,88 @@
 #include <sys/time.h>
-#include "canvas/group.h"
 #include "canvas/canvas.h"
-#include "canvas/root_group.h"
+#include "canvas/container.h"
+#include "canvas/lookup_table.h"
 #include "canvas/rectangle.h"
 #include "benchmark.h"
 
 using namespace std;
 using namespace ArdourCanvas;
 
+/* An editor-like tree: n_tracks track groups, each holding a row of
+ * regions made of a few items, then hover the pointer around it.
+ */
+
+static int const n_tracks = 300;
+static int const regions_per_track = 100;
+static double const track_height = 60;
+static double const region_width = 200;
+
 static void
-test (int items_per_cell)
+test (size_t min_items)
 {
-	Group::default_items_per_cell = items_per_cell;
+	SpatialLookupTable::min_items = min_items;
 
-	int const n_rectangles = 10000;
-	int const n_tests = 1000;
-	double const rough_size = 1000;
+	int const n_tests = 10000;
 	srand (1);
 
-	ImageCanvas canvas;
+	BenchmarkCanvas canvas;
+	Container* tracks = new Container (canvas.root());
 
-	list<Item*> rectangles;
+	for (int t = 0; t < n_tracks; ++t) {
+		Container* track = new Container (tracks);
+		track->set_position (Duple (0, t * track_height));
+		new Rectangle (track, Rect (0, 0, regions_per_track * region_width, track_height));
 
-	for (int i = 0; i < n_rectangles; ++i) {
-		rectangles.push_back (new Rectangle (canvas.root(), rect_random (rough_size)));
+		for (int r = 0; r < regions_per_track; ++r) {
+			Container* region = new Container (track);
+			region->set_position (Duple (r * region_width, 0));
+			new Rectangle (region, Rect (0, 0, region_width - 2, track_height - 2));
+			new Rectangle (region, Rect (0, track_height - 14, region_width - 2, track_height - 2));
+		}
 	}
 
+	double const w = regions_per_track * region_width;
+	double const h = n_tracks * track_height;
+
+	timeval start;
+	timeval stop;
+
+	/* first query builds the tables */
+	vector<Item const *> items;
+	canvas.root()->add_items_at_point (Duple (1, 1), items);
+
+	gettimeofday (&start, 0);
+
+	size_t found = 0;
+
 	for (int i = 0; i < n_tests; ++i) {
-		Duple test (double_random() * rough_size, double_random() * rough_size);
+		Duple test (double_random() * w, double_random() * h);
 
-		/* ask the group what's at this point */
-		vector<Item const *> items;
+		/* ask the root what's at this point, as GtkCanvas::pick_current_item() does */
+		items.clear ();
 		canvas.root()->add_items_at_point (test, items);
+		found += items.size ();
 	}
-}
 
-int main ()
-{
-	int tests[] = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+	gettimeofday (&stop, 0);
 
-	for (unsigned int i = 0; i < sizeof (tests) / sizeof (int); ++i) {
-		timeval start;
-		timeval stop;
+	int sec = stop.tv_sec - start.tv_sec;
+	int usec = stop.tv_usec - start.tv_usec;
+	if (usec < 0) {
+		--sec;
+		usec += 1e6;
+	}
 
-		gettimeofday (&start, 0);
-		test (tests[i]);
-		gettimeofday (&stop, 0);
+	double seconds = sec + ((double) usec / 1e6);
 
-		int sec = stop.tv_sec - start.tv_sec;
-		int usec = stop.tv_usec - start.tv_usec;
-		if (usec < 0) {
-			--sec;
-			usec += 1e6;
-		}
+	cout << "min items " << min_items << ": " << (seconds * 1e6 / n_tests) << "us per pick (" << found << " hits)\n";
+}
 
-		double seconds = sec + ((double) usec / 1e6);
+int main ()
+{
+	size_t tests[] = { 1000000, 64, 32, 16 };
 
-		cout << "Test " << tests[i] << ": " << seconds << "\n";
+	for (unsigned int i = 0; i < sizeof (tests) / sizeof (size_t); ++i) {
+		test (tests[i]);
 	}
 }
-
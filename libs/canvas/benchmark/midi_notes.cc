@@ -0,0 +1,128 @@
+#include <sys/time.h>
+#include <cairomm/surface.h>
+#include <pangomm/init.h>
+#include "canvas/container.h"
+#include "canvas/note_set.h"
+#include "canvas/rectangle.h"
+#include "benchmark.h"
+
+using namespace std;
+using namespace ArdourCanvas;
+
+/* Compare drawing a dense MIDI region as one Rectangle per note against
+ * drawing it with a single NoteSet, at a few zoom levels, while stepping
+ * a 1920 pixel wide window across it.
+ */
+
+static int const n_notes = 50000;
+static double const note_height = 6;
+
+static void
+note_rect (int i, double pixels_per_note, Rect& r)
+{
+	/* a fast arpeggio over four octaves, overlapping notes */
+	int const pitch = (i * 7) % 48;
+	double const x = i * pixels_per_note;
+	r = Rect (x, pitch * note_height, x + pixels_per_note * 1.5, (pitch + 1) * note_height - 1);
+}
+
+static double
+seconds (timeval const & start, timeval const & stop)
+{
+	int sec = stop.tv_sec - start.tv_sec;
+	int usec = stop.tv_usec - start.tv_usec;
+	if (usec < 0) {
+		--sec;
+		usec += 1e6;
+	}
+	return sec + ((double) usec / 1e6);
+}
+
+static double
+scroll (BenchmarkCanvas& canvas, double region_width)
+{
+	Cairo::RefPtr<Cairo::ImageSurface> surface = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, 1920, 1080);
+	Cairo::RefPtr<Cairo::Context> context = Cairo::Context::create (surface);
+
+	timeval start;
+	timeval stop;
+	int frames = 0;
+
+	gettimeofday (&start, 0);
+
+	for (double x = 0; x < region_width && frames < 200; x += 240, ++frames) {
+		context->save ();
+		context->translate (-x, 0);
+		canvas.render (Rect (x, 0, x + 1920, 1080), context);
+		context->restore ();
+	}
+
+	gettimeofday (&stop, 0);
+
+	return seconds (start, stop) / max (1, frames);
+}
+
+static void
+test (double pixels_per_note)
+{
+	Rect r;
+
+	timeval start;
+	timeval stop;
+
+	double per_item_build;
+	double per_item_frame;
+	double set_build;
+	double set_frame;
+
+	{
+		BenchmarkCanvas canvas;
+		Container* group = new Container (canvas.root());
+
+		gettimeofday (&start, 0);
+		for (int i = 0; i < n_notes; ++i) {
+			note_rect (i, pixels_per_note, r);
+			Rectangle* rect = new Rectangle (group, r);
+			rect->set_fill_color (0x8080ffff);
+			rect->set_outline_color (0x404080ff);
+		}
+		gettimeofday (&stop, 0);
+
+		per_item_build = seconds (start, stop);
+		per_item_frame = scroll (canvas, n_notes * pixels_per_note);
+	}
+
+	{
+		BenchmarkCanvas canvas;
+		NoteSet* notes = new NoteSet (canvas.root());
+
+		gettimeofday (&start, 0);
+		notes->begin_batch ();
+		for (int i = 0; i < n_notes; ++i) {
+			note_rect (i, pixels_per_note, r);
+			notes->add (r, 0x8080ffff, 0x404080ff);
+		}
+		notes->end_batch ();
+		gettimeofday (&stop, 0);
+
+		set_build = seconds (start, stop);
+		set_frame = scroll (canvas, n_notes * pixels_per_note);
+	}
+
+	cout << pixels_per_note << " px/note: "
+	     << "items build " << per_item_build << "s frame " << per_item_frame * 1e3 << "ms, "
+	     << "note set build " << set_build << "s frame " << set_frame * 1e3 << "ms\n";
+}
+
+int main ()
+{
+	Pango::init ();
+
+	double zooms[] = { 0.1, 0.5, 2, 8, 32 };
+
+	for (unsigned int i = 0; i < sizeof (zooms) / sizeof (double); ++i) {
+		test (zooms[i]);
+	}
+
+	return 0;
+}
@@ -1,58 +1,70 @@
 #include <sys/time.h>
+#include <cairomm/surface.h>
 #include <pangomm/init.h>
 #include "pbd/compose.h"
-#include "pbd/xml++.h"
-#include "canvas/group.h"
 #include "canvas/canvas.h"
-#include "canvas/root_group.h"
-#include "canvas/rectangle.h"
+#include "canvas/scroll_group.h"
+#include "canvas/tiled_container.h"
+#include "canvas/types.h"
 #include "benchmark.h"
 
 using namespace std;
 using namespace ArdourCanvas;
 
-class RenderParts : public Benchmark
+/* Scroll a 1920x1080 window across an editor-like canvas a step at a time,
+ * rendering the whole window each frame as an expose after scrolling does,
+ * with and without a tile cache (and with some render threads).
+ */
+
+static string
+run (bool tiled, int step)
 {
-public:
-	RenderParts (string const & session) : Benchmark (session) {}
+	BenchmarkCanvas canvas;
 
-	void set_items_per_cell (int items)
-	{
-		_items_per_cell = items;
-	}
+	ScrollGroup* scroll = new ScrollGroup (canvas.root(), ScrollGroup::ScrollSensitivity (ScrollGroup::ScrollsVertically | ScrollGroup::ScrollsHorizontally));
+	canvas.add_scroller (*scroll);
 
-	void do_run (ImageCanvas& canvas)
-	{
-		Group::default_items_per_cell = _items_per_cell;
+	Container* tracks = tiled ? new TiledContainer (scroll) : new Container (scroll);
+	make_tracks (tracks, 64, 64);
 
-		for (int i = 0; i < 1e4; i += 50) {
-			canvas.render_to_image (Rect (i, 0, i + 50, 1024));
-		}
-	}
+	Cairo::RefPtr<Cairo::ImageSurface> surface = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, 1920, 1080);
+	Cairo::RefPtr<Cairo::Context> context = Cairo::Context::create (surface);
 
-private:
-	int _items_per_cell;
-};
+	FrameTimes frames;
 
-int main (int argc, char* argv[])
-{
-	if (argc < 2) {
-		cerr << "Syntax: render_parts <session>\n";
-		exit (EXIT_FAILURE);
+	/* there and back again, so that the tiles get used twice */
+
+	for (int x = 0; x < 8000; x += step) {
+		canvas.scroll_to (x, 0);
+		frames.start ();
+		canvas.render (Rect (0, 0, 1920, 1080), context);
+		frames.stop ();
 	}
 
-	Pango::init ();
+	for (int x = 8000; x > 0; x -= step) {
+		canvas.scroll_to (x, 0);
+		frames.start ();
+		canvas.render (Rect (0, 0, 1920, 1080), context);
+		frames.stop ();
+	}
 
-	RenderParts render_parts (argv[1]);
+	return frames.summary ();
+}
+
+int main ()
+{
+	Pango::init ();
 
-	int tests[] = { 16, 32, 64, 128, 256, 512, 1024, 1e4, 1e5, 1e6 };
+	int steps[] = { 10, 50, 250 };
 
-	for (unsigned int i = 0; i < sizeof (tests) / sizeof (int); ++i) {
-		render_parts.set_items_per_cell (tests[i]);
-		cout << tests[i] << " " << render_parts.run () << "\n";
+	for (unsigned int i = 0; i < sizeof (steps) / sizeof (int); ++i) {
+		cout << steps[i] << "px direct:    " << run (false, steps[i]) << "\n";
+		TiledContainer::set_render_threads (0);
+		cout << steps[i] << "px tiled:     " << run (true, steps[i]) << "\n";
+		TiledContainer::set_render_threads (4);
+		cout << steps[i] << "px tiled x4:  " << run (true, steps[i]) << "\n";
+		TiledContainer::set_render_threads (0);
 	}
 
 	return 0;
 }
-
-
@@ -1,46 +1,57 @@
 #include <sys/time.h>
+#include <cairomm/surface.h>
 #include <pangomm/init.h>
-#include "pbd/xml++.h"
 #include "pbd/compose.h"
 #include "canvas/canvas.h"
+#include "canvas/scroll_group.h"
+#include "canvas/tiled_container.h"
 #include "canvas/types.h"
 #include "benchmark.h"
 
 using namespace std;
 using namespace ArdourCanvas;
 
-class RenderWhole : public Benchmark
+/* Render a whole 1920x1080 window of an editor-like canvas, over and over,
+ * once drawing the tracks directly and once through a tile cache.
+ */
+
+static string
+run (bool tiled, int iterations)
 {
-public:
-	RenderWhole (string const & session) : Benchmark (session) {}
+	BenchmarkCanvas canvas;
 
-	void do_run (ImageCanvas& canvas)
-	{
-		canvas.render_to_image (Rect (0, 0, 4096, 1024));
-	}
+	ScrollGroup* scroll = new ScrollGroup (canvas.root(), ScrollGroup::ScrollSensitivity (ScrollGroup::ScrollsVertically | ScrollGroup::ScrollsHorizontally));
+	canvas.add_scroller (*scroll);
+
+	Container* tracks = tiled ? new TiledContainer (scroll) : new Container (scroll);
+	make_tracks (tracks, 64, 64);
 
-	void finish (ImageCanvas& canvas)
-	{
-		canvas.write_to_png ("session.png");
+	Cairo::RefPtr<Cairo::ImageSurface> surface = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, 1920, 1080);
+	Cairo::RefPtr<Cairo::Context> context = Cairo::Context::create (surface);
+
+	FrameTimes frames;
+
+	for (int i = 0; i < iterations; ++i) {
+		frames.start ();
+		canvas.render (Rect (0, 0, 1920, 1080), context);
+		frames.stop ();
 	}
-};
+
+	return frames.summary ();
+}
 
 int main (int argc, char* argv[])
 {
-	if (argc < 2) {
-		cerr << "Syntax: render_whole <session-name> [<number-of-iterations>]\n";
-		exit (EXIT_FAILURE);
+	int iterations = 50;
+
+	if (argc > 1) {
+		iterations = atoi (argv[1]);
 	}
 
 	Pango::init ();
 
-	RenderWhole render_whole (argv[1]);
-
-	if (argc > 2) {
-		render_whole.set_iterations (atoi (argv[2]));
-	}
-
-	cout << render_whole.run () << "\n";
+	cout << "direct: " << run (false, iterations) << "\n";
+	cout << "tiled:  " << run (true, iterations) << "\n";
 
 	return 0;
 }
@@ -42,6 +42,7 @@
 #include "canvas/debug.h"
 #include "canvas/line.h"
 #include "canvas/scroll_group.h"
+#include "canvas/tiled_container.h"
 #include "canvas/utils.h"
 
 #ifdef __APPLE__
@@ -88,6 +89,18 @@ Canvas::add_scroller (ScrollGroup& i)
 	scrollers.push_back (&i);
 }
 
+void
+Canvas::add_tiler (TiledContainer& i)
+{
+	tilers.push_back (&i);
+}
+
+void
+Canvas::remove_tiler (TiledContainer& i)
+{
+	tilers.remove (&i);
+}
+
 void
 Canvas::zoomed ()
 {
@@ -110,7 +123,7 @@ Canvas::render (Rect const & area, Cairo::RefPtr<Cairo::Context> const & context
 	}
 #endif
 
-	render_count = 0;
+	g_atomic_int_set (&render_count, 0);
 
 	Rect root_bbox = _root.bounding_box();
 	if (!root_bbox) {
@@ -166,7 +179,7 @@ Canvas::render_indent() const
 {
 	string s;
 
-	for (int n = 0; n < ArdourCanvas::render_depth; ++n) {
+	for (int n = 0; n < ArdourCanvas::render_depth (); ++n) {
 		s += ' ';
 	}
 
@@ -190,6 +203,8 @@ Canvas::item_shown_or_hidden (Item* item)
 	if (bbox) {
 		if (item->item_to_window (bbox).intersection (visible_area ())) {
 			queue_draw_item_area (item, bbox);
+		} else {
+			invalidate_tiles (item, bbox);
 		}
 	}
 }
@@ -205,6 +220,8 @@ Canvas::item_visual_property_changed (Item* item)
 	if (bbox) {
 		if (item->item_to_window (bbox).intersection (visible_area ())) {
 			queue_draw_item_area (item, bbox);
+		} else {
+			invalidate_tiles (item, bbox);
 		}
 	}
 }
@@ -223,6 +240,8 @@ Canvas::item_changed (Item* item, Rect pre_change_bounding_box)
 		if (item->item_to_window (pre_change_bounding_box).intersection (window_bbox)) {
 			/* request a redraw of the item's old bounding box */
 			queue_draw_item_area (item, pre_change_bounding_box);
+		} else {
+			invalidate_tiles (item, pre_change_bounding_box);
 		}
 	}
 
@@ -232,6 +251,8 @@ Canvas::item_changed (Item* item, Rect pre_change_bounding_box)
 		if (item->item_to_window (post_change_bounding_box).intersection (window_bbox)) {
 			/* request a redraw of the item's new bounding box */
 			queue_draw_item_area (item, post_change_bounding_box);
+		} else {
+			invalidate_tiles (item, post_change_bounding_box);
 		}
 	}
 }
@@ -354,11 +375,39 @@ Canvas::item_moved (Item* item, Rect pre_change_parent_bounding_box)
  *  @param area Area to redraw in the item's coordinates.
  */
 void
-Canvas::queue_draw_item_area (Item* item, Rect area)
+Canvas::queue_draw_item_area (Item const * item, Rect area)
 {
+	invalidate_tiles (item, area);
 	request_redraw (item->item_to_window (area));
 }
 
+/** Tell any TiledContainer that is (or is an ancestor of) @param item
+ *  that @param area, in the item's coordinates, needs to be rendered again.
+ */
+void
+Canvas::invalidate_tiles (Item const * item, Rect const & area)
+{
+	if (tilers.empty() || !area) {
+		return;
+	}
+
+	for (Item const * i = item; i; i = i->parent()) {
+		for (list<TiledContainer*>::iterator t = tilers.begin(); t != tilers.end(); ++t) {
+			if (*t == i) {
+				(*t)->invalidate_tiles ((*t)->window_to_item (item->item_to_window (area, false)));
+			}
+		}
+	}
+}
+
+void
+Canvas::drop_tiles ()
+{
+	for (list<TiledContainer*>::iterator t = tilers.begin(); t != tilers.end(); ++t) {
+		(*t)->drop_tiles ();
+	}
+}
+
 void
 Canvas::set_tooltip_timeout (uint32_t msecs)
 {
@@ -54,6 +54,7 @@ struct Rect;
 
 class Item;
 class ScrollGroup;
+class TiledContainer;
 
 /** The base class for our different types of canvas.
  *
@@ -120,6 +121,20 @@ public:
         void scroll_to (Coord x, Coord y);
 	void add_scroller (ScrollGroup& i);
 
+	void add_tiler (TiledContainer& i);
+	void remove_tiler (TiledContainer& i);
+
+	/** Request a redraw of an area in @param item's coordinates, and
+	 *  invalidate any tiles caching it, visible or not.
+	 */
+	void queue_draw_item_area (Item const *, Rect);
+
+	/** Drop every tile cached by a TiledContainer. Use this when the
+	 *  appearance of items changes without them being told, e.g. when
+	 *  they take colours from a theme as they render.
+	 */
+	void drop_tiles ();
+
         virtual Rect  visible_area () const = 0;
         virtual Coord width () const = 0;
         virtual Coord height () const = 0;
@@ -167,11 +182,12 @@ public:
 
 	static uint32_t tooltip_timeout_msecs;
 
-	void queue_draw_item_area (Item *, Rect);
+	void invalidate_tiles (Item const *, Rect const &);
         virtual void pick_current_item (int state) = 0;
         virtual void pick_current_item (Duple const &, int state) = 0;
 
 	std::list<ScrollGroup*> scrollers;
+	std::list<TiledContainer*> tilers;
 };
 
 /** A canvas which renders onto a GTK EventBox */
@@ -49,8 +49,10 @@ namespace ArdourCanvas {
 	LIBCANVAS_API extern void checkpoint (std::string, std::string);
 	LIBCANVAS_API extern void set_epoch ();
 	LIBCANVAS_API extern const char* event_type_string (int event_type);
+	/** number of items rendered, over all threads; use g_atomic_int_* */
 	LIBCANVAS_API extern int render_count;
-	LIBCANVAS_API extern int render_depth;
+	/** nesting of Item::render_children() in the calling thread */
+	LIBCANVAS_API extern int& render_depth ();
 	LIBCANVAS_API extern int dump_depth;
 }
 
@@ -91,6 +91,7 @@ public:
     void put_image (boost::shared_ptr<Data>);
 
     void render (Rect const &, Cairo::RefPtr<Cairo::Context>) const;
+    void prepare_for_render (Rect const &) const;
     void compute_bounding_box () const;
 
 private:
@@ -75,6 +75,13 @@ public:
 	 */
 	virtual void render (Rect const & area, Cairo::RefPtr<Cairo::Context>) const = 0;
 
+	/** Called in the GUI thread before @param area (in **window**
+	 *  coordinates) is rendered, possibly from another thread (see
+	 *  TiledContainer). Items that compute state lazily in render()
+	 *  must do so here instead. The default recurses into children.
+	 */
+	virtual void prepare_for_render (Rect const & area) const;
+
 	/** Adds one or more items to the vector @param items based on their
 	 * covering @param point which is in **window** coordinates
 	 *
@@ -212,6 +219,9 @@ public:
 	void raise_child_to_top (Item *);
 	void raise_child (Item *, int);
 	void lower_child_to_bottom (Item *);
+	/** Called when the size or position of one of our children may have
+	 * changed. Derived classes overriding this must chain up.
+	 */
 	virtual void child_changed ();
 
 	static int default_items_per_cell;
@@ -300,6 +310,8 @@ protected:
 	/* nesting ("grouping") API */
 
 	void invalidate_lut () const;
+	void update_lut (Item*) const;
+	void child_geometry_changed (Item*);
 	void clear_items (bool with_delete);
 
 	void ensure_lut () const;
@@ -309,6 +321,7 @@ protected:
 
 	void add_child_bounding_boxes (bool include_hidden = false) const;
 	void render_children (Rect const & area, Cairo::RefPtr<Cairo::Context> context) const;
+	void prepare_for_render_children (Rect const & area) const;
 
 	Duple scroll_offset() const;
 	Duple position_offset() const;
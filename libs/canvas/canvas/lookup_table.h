@@ -20,6 +20,7 @@
 #ifndef __CANVAS_LOOKUP_TABLE_H__
 #define __CANVAS_LOOKUP_TABLE_H__
 
+#include <map>
 #include <vector>
 #include <boost/multi_array.hpp>
 
@@ -42,6 +43,15 @@ public:
     virtual std::vector<Item*> items_at_point (Duple const &) const = 0;
     virtual bool has_item_at_point (Duple const & point) const = 0;
 
+    /* Incremental maintenance. Each returns false if the table cannot
+     * handle the change itself, in which case the owning item discards
+     * it and builds a new one when next needed.
+     */
+    virtual bool item_added (Item*, bool /*at_front*/) { return false; }
+    virtual bool item_removed (Item*) { return false; }
+    virtual bool item_changed (Item*) { return false; }
+    virtual bool item_restacked (Item*, bool /*to_top*/) { return false; }
+
 protected:
 
     Item const & _item;
@@ -84,6 +94,79 @@ public:
     bool _added;
 };
 
+/** An R-tree over our item's children, in the item's coordinates.
+ *
+ *  The tree is bulk-loaded (sort-tile-recursive) when first needed and
+ *  then kept up to date as children are added, removed, moved, resized or
+ *  restacked. Changes are queued and applied when the table is next
+ *  queried, so that a burst of changes costs one update per child.
+ *  Boxes are not shrunk on removal; once the number of updates since the
+ *  last build exceeds the number of entries, the table asks to be rebuilt.
+ */
+class LIBCANVAS_API SpatialLookupTable : public LookupTable
+{
+public:
+	SpatialLookupTable (Item const &);
+	~SpatialLookupTable ();
+
+	std::vector<Item*> get (Rect const &);
+	std::vector<Item*> items_at_point (Duple const &) const;
+	bool has_item_at_point (Duple const & point) const;
+
+	bool item_added (Item*, bool at_front);
+	bool item_removed (Item*);
+	bool item_changed (Item*);
+	bool item_restacked (Item*, bool to_top);
+
+	/** Items with fewer children than this use a DumbLookupTable */
+	static size_t min_items;
+	/** Maximum number of entries per tree node when bulk loading */
+	static size_t node_capacity;
+
+private:
+	struct Node;
+
+	struct Entry {
+		Item*   item;
+		Rect    bbox;
+		int64_t order;
+		Node*   leaf;
+		bool    pending;
+	};
+
+	struct Node {
+		Node () : parent (0), leaf (true) {}
+
+		Rect                bbox;
+		Node*               parent;
+		bool                leaf;
+		std::vector<Node*>  children;
+		std::vector<Entry*> entries;
+	};
+
+	typedef std::map<Item const *, Entry*> Entries;
+
+	Entries                      _entries;
+	mutable std::vector<Entry*>  _pending;
+	Node*                        _root;
+	int64_t                      _min_order;
+	int64_t                      _max_order;
+	mutable size_t               _updates;
+
+	void build ();
+	Node* build_level (std::vector<Node*>&);
+	void delete_node (Node*);
+	void flush_pending () const;
+	void place (Entry*) const;
+	void unplace (Entry*) const;
+	void queue (Entry*);
+	bool needs_rebuild () const;
+
+	Duple window_offset () const;
+	void search (Node const *, Rect const &, std::vector<Entry*>&) const;
+	void search (Node const *, Duple const &, std::vector<Entry*>&) const;
+};
+
 }
 
 #endif
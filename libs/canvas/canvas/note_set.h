@@ -0,0 +1,127 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef __CANVAS_NOTE_SET_H__
+#define __CANVAS_NOTE_SET_H__
+
+#include <vector>
+
+#include "canvas/visibility.h"
+#include "canvas/item.h"
+#include "canvas/rectangle.h"
+
+namespace ArdourCanvas {
+
+/** A single item that draws a (potentially very large) number of small,
+ *  outlined rectangles such as MIDI notes.
+ *
+ *  Notes are kept in a compact array and addressed by a stable Handle.
+ *  Rendering only visits notes that intersect the area being drawn, and
+ *  when zoomed out far enough that notes are narrower than the
+ *  level-of-detail width, neighbouring notes on the same row are merged
+ *  into a single filled span.
+ *
+ *  Each note may carry an opaque data pointer so that users can map a
+ *  hit (see note_at()) back to their own model.
+ */
+class LIBCANVAS_API NoteSet : public Item
+{
+public:
+	typedef uint32_t Handle;
+	static const Handle invalid_handle;
+
+	NoteSet (Canvas*);
+	NoteSet (Item*);
+
+	void compute_bounding_box () const;
+	void render (Rect const & area, Cairo::RefPtr<Cairo::Context>) const;
+	void prepare_for_render (Rect const & area) const;
+	bool covers (Duple const &) const;
+
+	Handle add (Rect const &, Color fill, Color outline, void* data = 0);
+	void remove (Handle);
+	void clear ();
+
+	void set (Handle, Rect const &);
+	void set_fill_color (Handle, Color);
+	void set_outline_color (Handle, Color);
+	void set_outline_what (Handle, Rectangle::What);
+	void set_visible (Handle, bool);
+
+	Rect get (Handle) const;
+	void* data (Handle) const;
+	size_t size () const { return _elements.size() - _free.size(); }
+
+	/** @return the topmost visible note at @param point (in window
+	 *  coordinates), or invalid_handle.
+	 */
+	Handle note_at (Duple const &) const;
+
+	/** Notes narrower than @param w pixels are merged with their
+	 * neighbours on the same row when rendered.
+	 */
+	void set_lod_width (Distance w);
+	Distance lod_width () const { return _lod_width; }
+
+	/** Bracket bulk changes (e.g. redisplaying a whole region) so that
+	 * the canvas is notified once rather than per note.
+	 */
+	void begin_batch ();
+	void end_batch ();
+
+private:
+	struct Element {
+		Element (Rect const & r, Color f, Color o, void* d)
+			: rect (r), fill (f), outline (o)
+			, outline_what (Rectangle::ALL)
+			, visible (true), used (true), data (d) {}
+
+		Rect            rect;
+		Color           fill;
+		Color           outline;
+		Rectangle::What outline_what;
+		bool            visible;
+		bool            used;
+		void*           data;
+	};
+
+	std::vector<Element> _elements;
+	std::vector<Handle>  _free;
+	Distance             _lod_width;
+	int                  _batch_depth;
+	Rect                 _batch_damage;
+	Rect                 _batch_pre_change;
+
+	/* visible elements sorted by x0, rebuilt lazily */
+	mutable std::vector<Handle> _order;
+	mutable std::vector<Rect>   _order_rects;
+	mutable bool                _order_dirty;
+	mutable Distance            _max_width;
+
+	bool valid (Handle h) const { return h < _elements.size() && _elements[h].used; }
+	void ensure_order () const;
+	std::vector<Handle>::const_iterator first_candidate (Coord x) const;
+	void element_changed (Rect const & before, Rect const & after);
+	bool bounding_box_contains (Rect const &) const;
+	void grow_bounding_box (Rect const &);
+	void render_note (Element const &, Rect const & self, Cairo::RefPtr<Cairo::Context>) const;
+};
+
+}
+
+#endif /* __CANVAS_NOTE_SET_H__ */
@@ -69,6 +69,7 @@ public:
 	void set_metric (const Metric&);
 
 	void render (Rect const & area, Cairo::RefPtr<Cairo::Context>) const;
+	void prepare_for_render (Rect const & area) const;
 
 	void set_divide_colors (Color top, Color bottom);
 	void set_divide_height (double);
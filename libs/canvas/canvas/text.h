@@ -36,6 +36,7 @@ public:
        ~Text();
 
 	void render (Rect const &, Cairo::RefPtr<Cairo::Context>) const;
+	void prepare_for_render (Rect const &) const;
 	void compute_bounding_box () const;
 
         ArdourCanvas::Color color () const { return _color; }
@@ -0,0 +1,139 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef __CANVAS_TILED_CONTAINER_H__
+#define __CANVAS_TILED_CONTAINER_H__
+
+#include <map>
+#include <vector>
+
+#include <stdint.h>
+
+#include <glibmm/threads.h>
+#include <sigc++/connection.h>
+
+#include "canvas/container.h"
+
+namespace ArdourCanvas {
+
+/** A Container which caches the rendering of its children in fixed size
+ *  image tiles, addressed in its own coordinate space.
+ *
+ *  When an ancestor ScrollGroup scrolls, the tiles remain valid and a
+ *  redraw only needs to composite them. Tiles are invalidated (partially)
+ *  by the canvas whenever an item inside the container changes, and tiles
+ *  just outside the visible area are rendered ahead of time when the GUI
+ *  is idle.
+ *
+ *  Missing tiles may be rendered on a shared pool of worker threads (see
+ *  set_render_threads()). The GUI thread waits for the workers, so items
+ *  cannot change while they are being drawn, and calls prepare_for_render()
+ *  on the children first; items must compute any lazily built state there
+ *  rather than in render(). While rendering a tile, in whatever thread,
+ *  rendering_tile() is true and items must only read state resolved by
+ *  prepare_for_render().
+ */
+class LIBCANVAS_API TiledContainer : public Container
+{
+public:
+	TiledContainer (Canvas *);
+	TiledContainer (Item *);
+	~TiledContainer ();
+
+	void render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) const;
+
+	/** Mark @param area (in our coordinates) as needing to be rendered again */
+	void invalidate_tiles (Rect const & area);
+	/** Drop all cached tiles */
+	void drop_tiles ();
+
+	/** Set the maximum memory used by each container's tiles, in
+	 *  bytes. Zero disables caching; children are rendered directly.
+	 */
+	static void set_cache_size (uint64_t bytes);
+	static uint64_t cache_size () { return _cache_size; }
+
+	/** Set the number of worker threads used to render tiles; zero
+	 *  renders them in the GUI thread.
+	 */
+	static void set_render_threads (uint32_t);
+
+	/** @return true if the calling thread is rendering a tile */
+	static bool rendering_tile ();
+
+	static const int tile_size;
+
+private:
+	struct Tile {
+		Tile () : used (0) {}
+
+		Cairo::RefPtr<Cairo::ImageSurface> surface;
+		/** area that needs rendering, in our coordinates */
+		Rect damage;
+		/** frame in which this tile was last composited or prefetched */
+		uint64_t used;
+	};
+
+	struct Job {
+		TiledContainer const * container;
+		Tile* tile;
+		/** area to render, in window coordinates */
+		Rect area;
+		/** window coordinates of the tile's top left corner */
+		Duple origin;
+	};
+
+	typedef std::pair<int32_t,int32_t> TileKey;
+	typedef std::map<TileKey,Tile> Tiles;
+
+	mutable Tiles _tiles;
+	mutable uint64_t _frame;
+	mutable sigc::connection _prefetch_connection;
+
+	void init ();
+	bool tiles_enabled () const;
+	Duple window_origin () const;
+	void tile_range (Rect const & area, int32_t& c0, int32_t& r0, int32_t& c1, int32_t& r1) const;
+	Rect tile_rect (TileKey const &) const;
+	Tile& tile_at (TileKey const &) const;
+	void add_job (TileKey const &, Tile&, Duple const & origin, std::vector<Job>&) const;
+	void render_jobs (std::vector<Job>&) const;
+	void render_tile (Job const &) const;
+	size_t max_tiles () const;
+	void evict () const;
+	void queue_prefetch () const;
+	bool prefetch () const;
+
+	static uint64_t _cache_size;
+
+	static std::vector<Glib::Threads::Thread*> _workers;
+	static std::vector<Job*> _queue;
+	static size_t _outstanding;
+	static bool _workers_should_quit;
+	static Glib::Threads::Mutex _queue_lock;
+	static Glib::Threads::Cond _queue_cond;
+	static Glib::Threads::Cond _done_cond;
+	static Glib::Threads::Private<bool> _rendering_tile;
+
+	static void stop_workers ();
+	static void worker ();
+};
+
+}
+
+#endif /* __CANVAS_TILED_CONTAINER_H__ */
@@ -223,6 +223,7 @@ public:
        ~WaveView ();
 
 	void render (Rect const & area, Cairo::RefPtr<Cairo::Context>) const;
+	void prepare_for_render (Rect const & area) const;
 	void compute_bounding_box () const;
 
 	void set_samples_per_pixel (double);
@@ -367,6 +368,9 @@ public:
 
         boost::shared_ptr<WaveViewCache::Entry> get_image (framepos_t start, framepos_t end, bool& full_image) const;
         boost::shared_ptr<WaveViewCache::Entry> get_image_from_cache (framepos_t start, framepos_t end, bool& full_image) const;
+        boost::shared_ptr<WaveViewCache::Entry> image_for (framepos_t sample_start, framepos_t sample_end) const;
+        bool draw_range (Rect const & area, Rect& self, Rect& draw, double& draw_start, double& draw_end,
+                         framepos_t& sample_start, framepos_t& sample_end) const;
 
         struct LineTips {
 	        double top;
@@ -395,6 +399,8 @@ public:
         void image_ready ();
 
         mutable boost::shared_ptr<WaveViewCache::Entry> _current_image;
+        /** image found by prepare_for_render(), used when rendering tiles */
+        mutable boost::shared_ptr<WaveViewCache::Entry> _prepared_image;
 
 	mutable boost::shared_ptr<WaveViewThreadRequest> current_request;
 
@@ -20,6 +20,7 @@
 #include <sys/time.h>
 #include <iostream>
 #include <gdk/gdk.h>
+#include <glibmm/threads.h>
 #include "canvas/debug.h"
 
 using namespace std;
@@ -34,9 +35,24 @@ PBD::DebugBits PBD::DEBUG::WaveView = PBD::new_debug_bit ("waveview");
 struct timeval ArdourCanvas::epoch;
 map<string, struct timeval> ArdourCanvas::last_time;
 int ArdourCanvas::render_count;
-int ArdourCanvas::render_depth;
 int ArdourCanvas::dump_depth;
 
+/* tiles may be rendered in several threads at once */
+static Glib::Threads::Private<int> thread_render_depth;
+
+int&
+ArdourCanvas::render_depth ()
+{
+	int* d = thread_render_depth.get ();
+
+	if (!d) {
+		d = new int (0);
+		thread_render_depth.set (d);
+	}
+
+	return *d;
+}
+
 void
 ArdourCanvas::set_epoch ()
 {
@@ -43,7 +43,7 @@ Image::Image (Item* parent, Cairo::Format fmt, int width, int height)
 }
 
 void
-Image::render (Rect const& area, Cairo::RefPtr<Cairo::Context> context) const
+Image::prepare_for_render (Rect const &) const
 {
 	if (_need_render && _pending) {
 		_surface = Cairo::ImageSurface::create (_pending->data,
@@ -52,7 +52,14 @@ Image::render (Rect const& area, Cairo::RefPtr<Cairo::Context> context) const
 							_pending->height,
 							_pending->stride);
 		_current = _pending;
+		_need_render = false;
 	}
+}
+
+void
+Image::render (Rect const& area, Cairo::RefPtr<Cairo::Context> context) const
+{
+	prepare_for_render (area);
 
 	Rect self = item_to_window (Rect (0, 0, _width, _height));
 	Rect draw = self.intersection (area);
@@ -280,8 +280,10 @@ Item::set_position (Duple p)
 
 
 		if (_parent) {
-			_parent->child_changed ();
+			_parent->child_geometry_changed (this);
 		}
+	} else if (_parent) {
+		_parent->update_lut (this);
 	}
 }
 
@@ -378,7 +380,7 @@ Item::propagate_show_hide ()
 	/* bounding box may have changed while we were hidden */
 
 	if (_parent) {
-		_parent->child_changed ();
+		_parent->child_geometry_changed (this);
 	}
 
 	_canvas->item_shown_or_hidden (this);
@@ -623,7 +625,7 @@ void
 Item::redraw () const
 {
 	if (visible() && _bounding_box && _canvas) {
-		_canvas->request_redraw (item_to_window (_bounding_box));
+		_canvas->queue_draw_item_area (this, _bounding_box);
 	}
 }
 
@@ -640,8 +642,10 @@ Item::end_change ()
 		_canvas->item_changed (this, _pre_change_bounding_box);
 
 		if (_parent) {
-			_parent->child_changed ();
+			_parent->child_geometry_changed (this);
 		}
+	} else if (_parent) {
+		_parent->update_lut (this);
 	}
 }
 
@@ -740,6 +744,43 @@ Item::covers (Duple const & point) const
 
 /* nesting/grouping API */
 
+void
+Item::prepare_for_render (Rect const & area) const
+{
+	prepare_for_render_children (area);
+}
+
+/** Make sure that everything render_children() would compute for @param
+ *  area has been computed, so that rendering it only reads our state.
+ */
+void
+Item::prepare_for_render_children (Rect const & area) const
+{
+	if (_items.empty()) {
+		return;
+	}
+
+	ensure_lut ();
+	std::vector<Item*> items = _lut->get (area);
+
+	for (std::vector<Item*>::const_iterator i = items.begin(); i != items.end(); ++i) {
+
+		if (!(*i)->visible ()) {
+			continue;
+		}
+
+		Rect item_bbox = (*i)->bounding_box ();
+
+		if (!item_bbox) {
+			continue;
+		}
+
+		if ((*i)->item_to_window (item_bbox, false).intersection (area)) {
+			(*i)->prepare_for_render (area);
+		}
+	}
+}
+
 void
 Item::render_children (Rect const & area, Cairo::RefPtr<Cairo::Context> context) const
 {
@@ -758,7 +799,7 @@ Item::render_children (Rect const & area, Cairo::RefPtr<Cairo::Context> context)
 	}
 #endif
 
-	++render_depth;
+	++render_depth ();
 
 	for (std::vector<Item*>::const_iterator i = items.begin(); i != items.end(); ++i) {
 
@@ -812,7 +853,7 @@ Item::render_children (Rect const & area, Cairo::RefPtr<Cairo::Context> context)
 #endif
 
 				(*i)->render (area, context);
-				++render_count;
+				g_atomic_int_inc (&render_count);
 			}
 
 		} else {
@@ -827,7 +868,7 @@ Item::render_children (Rect const & area, Cairo::RefPtr<Cairo::Context> context)
 		}
 	}
 
-	--render_depth;
+	--render_depth ();
 }
 
 void
@@ -877,8 +918,14 @@ Item::add (Item* i)
 
 	_items.push_back (i);
 	i->reparent (this, true);
-	invalidate_lut ();
+	if (_lut && !_lut->item_added (i, false)) {
+		invalidate_lut ();
+	}
 	_bounding_box_dirty = true;
+
+	if (_parent) {
+		_parent->update_lut (this);
+	}
 }
 
 void
@@ -888,8 +935,14 @@ Item::add_front (Item* i)
 
 	_items.push_front (i);
 	i->reparent (this, true);
-	invalidate_lut ();
+	if (_lut && !_lut->item_added (i, true)) {
+		invalidate_lut ();
+	}
 	_bounding_box_dirty = true;
+
+	if (_parent) {
+		_parent->update_lut (this);
+	}
 }
 
 void
@@ -914,7 +967,9 @@ Item::remove (Item* i)
 
 	i->unparent ();
 	_items.remove (i);
-	invalidate_lut ();
+	if (_lut && !_lut->item_removed (i)) {
+		invalidate_lut ();
+	}
 	_bounding_box_dirty = true;
 
 	end_change ();
@@ -936,6 +991,9 @@ Item::clear (bool with_delete)
 void
 Item::clear_items (bool with_delete)
 {
+	/* the lookup table refers to the items we are about to remove */
+	invalidate_lut ();
+
 	for (list<Item*>::iterator i = _items.begin(); i != _items.end(); ) {
 
 		list<Item*>::iterator tmp = i;
@@ -971,7 +1029,9 @@ Item::raise_child_to_top (Item* i)
 	_items.remove (i);
 	_items.push_back (i);
 
-	invalidate_lut ();
+	if (_lut && !_lut->item_restacked (i, true)) {
+		invalidate_lut ();
+	}
         redraw ();
 }
 
@@ -1004,7 +1064,9 @@ Item::lower_child_to_bottom (Item* i)
 	}
 	_items.remove (i);
 	_items.push_front (i);
-	invalidate_lut ();
+	if (_lut && !_lut->item_restacked (i, false)) {
+		invalidate_lut ();
+	}
         redraw ();
 }
 
@@ -1012,7 +1074,11 @@ void
 Item::ensure_lut () const
 {
 	if (!_lut) {
-		_lut = new DumbLookupTable (*this);
+		if (_items.size() >= SpatialLookupTable::min_items) {
+			_lut = new SpatialLookupTable (*this);
+		} else {
+			_lut = new DumbLookupTable (*this);
+		}
 	}
 }
 
@@ -1023,14 +1089,29 @@ Item::invalidate_lut () const
 	_lut = 0;
 }
 
+/** Tell our lookup table that the geometry of @param child has changed */
+void
+Item::update_lut (Item* child) const
+{
+	if (_lut && !_lut->item_changed (child)) {
+		invalidate_lut ();
+	}
+}
+
+void
+Item::child_geometry_changed (Item* child)
+{
+	update_lut (child);
+	child_changed ();
+}
+
 void
 Item::child_changed ()
 {
-	invalidate_lut ();
 	_bounding_box_dirty = true;
 
 	if (_parent) {
-		_parent->child_changed ();
+		_parent->child_geometry_changed (this);
 	}
 }
 
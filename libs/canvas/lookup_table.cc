@@ -325,3 +325,499 @@ OptimizingLookupTable::get (Rect const & area)
 	return vitems;
 }
 
+
+size_t SpatialLookupTable::min_items = 32;
+size_t SpatialLookupTable::node_capacity = 16;
+
+static inline bool
+rects_overlap (Rect const & a, Rect const & b)
+{
+	return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+}
+
+static inline bool
+rect_contains_point (Rect const & r, Duple const & p)
+{
+	return p.x >= r.x0 && p.x <= r.x1 && p.y >= r.y0 && p.y <= r.y1;
+}
+
+static inline bool
+rect_contains_rect (Rect const & outer, Rect const & inner)
+{
+	return inner.x0 >= outer.x0 && inner.x1 <= outer.x1 && inner.y0 >= outer.y0 && inner.y1 <= outer.y1;
+}
+
+static inline double
+rect_area (Rect const & r)
+{
+	return r.width() * r.height();
+}
+
+namespace ArdourCanvas {
+
+struct SpatialNodeSorter {
+	SpatialNodeSorter (bool x) : by_x (x) {}
+
+	template<typename T>
+	bool operator() (T const * a, T const * b) const {
+		if (by_x) {
+			return (a->bbox.x0 + a->bbox.x1) < (b->bbox.x0 + b->bbox.x1);
+		}
+		return (a->bbox.y0 + a->bbox.y1) < (b->bbox.y0 + b->bbox.y1);
+	}
+
+	bool by_x;
+};
+
+struct SpatialEntryOrder {
+	template<typename T>
+	bool operator() (T const * a, T const * b) const {
+		return a->order < b->order;
+	}
+};
+
+}
+
+SpatialLookupTable::SpatialLookupTable (Item const & item)
+	: LookupTable (item)
+	, _root (0)
+	, _min_order (0)
+	, _max_order (0)
+	, _updates (0)
+{
+	list<Item*> const & items = _item.items ();
+
+	for (list<Item*>::const_iterator i = items.begin(); i != items.end(); ++i) {
+		Entry* e = new Entry;
+		e->item = *i;
+		e->order = _max_order++;
+		e->leaf = 0;
+		e->pending = false;
+		_entries.insert (make_pair (*i, e));
+	}
+
+	build ();
+}
+
+SpatialLookupTable::~SpatialLookupTable ()
+{
+	delete_node (_root);
+
+	for (Entries::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		delete i->second;
+	}
+}
+
+void
+SpatialLookupTable::delete_node (Node* n)
+{
+	if (!n) {
+		return;
+	}
+	for (vector<Node*>::iterator i = n->children.begin(); i != n->children.end(); ++i) {
+		delete_node (*i);
+	}
+	delete n;
+}
+
+/** Sort-tile-recursive bulk load of all entries */
+void
+SpatialLookupTable::build ()
+{
+	delete_node (_root);
+	_root = 0;
+	_pending.clear ();
+	_updates = 0;
+
+	vector<Entry*> placed;
+
+	for (Entries::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		Entry* e = i->second;
+		Rect const bbox = e->item->bounding_box ();
+		e->leaf = 0;
+		e->pending = false;
+		if (bbox) {
+			e->bbox = e->item->item_to_parent (bbox);
+			placed.push_back (e);
+		} else {
+			e->bbox = Rect ();
+		}
+	}
+
+	size_t const M = max ((size_t) 2, node_capacity);
+	size_t const n_leaves = (placed.size() + M - 1) / M;
+	size_t const n_slices = max ((size_t) 1, (size_t) ceil (sqrt ((double) n_leaves)));
+	size_t const slice_size = n_slices * M;
+
+	vector<Node*> leaves;
+
+	sort (placed.begin(), placed.end(), SpatialNodeSorter (true));
+
+	for (size_t s = 0; s < placed.size(); s += slice_size) {
+		vector<Entry*>::iterator slice_end = placed.begin() + min (placed.size(), s + slice_size);
+		sort (placed.begin() + s, slice_end, SpatialNodeSorter (false));
+
+		for (vector<Entry*>::iterator i = placed.begin() + s; i < slice_end; ) {
+			Node* leaf = new Node;
+			leaf->bbox = (*i)->bbox;
+			for (size_t n = 0; n < M && i < slice_end; ++n, ++i) {
+				leaf->entries.push_back (*i);
+				leaf->bbox = leaf->bbox.extend ((*i)->bbox);
+				(*i)->leaf = leaf;
+			}
+			leaves.push_back (leaf);
+		}
+	}
+
+	if (leaves.empty()) {
+		_root = new Node;
+		return;
+	}
+
+	_root = build_level (leaves);
+}
+
+SpatialLookupTable::Node*
+SpatialLookupTable::build_level (vector<Node*>& nodes)
+{
+	size_t const M = max ((size_t) 2, node_capacity);
+
+	while (nodes.size() > 1) {
+		size_t const n_parents = (nodes.size() + M - 1) / M;
+		size_t const n_slices = max ((size_t) 1, (size_t) ceil (sqrt ((double) n_parents)));
+		size_t const slice_size = n_slices * M;
+
+		vector<Node*> parents;
+
+		sort (nodes.begin(), nodes.end(), SpatialNodeSorter (true));
+
+		for (size_t s = 0; s < nodes.size(); s += slice_size) {
+			vector<Node*>::iterator slice_end = nodes.begin() + min (nodes.size(), s + slice_size);
+			sort (nodes.begin() + s, slice_end, SpatialNodeSorter (false));
+
+			for (vector<Node*>::iterator i = nodes.begin() + s; i < slice_end; ) {
+				Node* p = new Node;
+				p->leaf = false;
+				p->bbox = (*i)->bbox;
+				for (size_t n = 0; n < M && i < slice_end; ++n, ++i) {
+					p->children.push_back (*i);
+					p->bbox = p->bbox.extend ((*i)->bbox);
+					(*i)->parent = p;
+				}
+				parents.push_back (p);
+			}
+		}
+
+		nodes.swap (parents);
+	}
+
+	return nodes.front ();
+}
+
+/** Insert @param e into the leaf whose box needs the least enlargement,
+ *  growing boxes on the way back up. Leaves are not split; an overfull
+ *  leaf makes the table ask to be rebuilt instead.
+ */
+void
+SpatialLookupTable::place (Entry* e) const
+{
+	Node* n = _root;
+
+	while (!n->leaf) {
+		Node* best = 0;
+		double best_growth = 0;
+		double best_area = 0;
+
+		for (vector<Node*>::const_iterator c = n->children.begin(); c != n->children.end(); ++c) {
+			double const area = rect_area ((*c)->bbox);
+			double const growth = rect_area ((*c)->bbox.extend (e->bbox)) - area;
+			if (!best || growth < best_growth || (growth == best_growth && area < best_area)) {
+				best = *c;
+				best_growth = growth;
+				best_area = area;
+			}
+		}
+
+		n = best;
+	}
+
+	n->entries.push_back (e);
+	e->leaf = n;
+
+	for (; n; n = n->parent) {
+		if (n->entries.size() == 1 && n->children.empty()) {
+			n->bbox = e->bbox;
+		} else if (!rect_contains_rect (n->bbox, e->bbox)) {
+			n->bbox = n->bbox.extend (e->bbox);
+		} else {
+			break;
+		}
+	}
+}
+
+void
+SpatialLookupTable::unplace (Entry* e) const
+{
+	if (!e->leaf) {
+		return;
+	}
+
+	vector<Entry*>& entries (e->leaf->entries);
+	vector<Entry*>::iterator i = find (entries.begin(), entries.end(), e);
+
+	if (i != entries.end()) {
+		entries.erase (i);
+	}
+
+	e->leaf = 0;
+}
+
+void
+SpatialLookupTable::queue (Entry* e)
+{
+	if (!e->pending) {
+		e->pending = true;
+		_pending.push_back (e);
+	}
+}
+
+void
+SpatialLookupTable::flush_pending () const
+{
+	if (_pending.empty()) {
+		/* don't touch anything: TiledContainer renders from several threads */
+		return;
+	}
+
+	for (vector<Entry*>::iterator i = _pending.begin(); i != _pending.end(); ++i) {
+		Entry* e = *i;
+		Rect const bbox = e->item->bounding_box ();
+
+		e->pending = false;
+
+		if (!bbox) {
+			unplace (e);
+			e->bbox = Rect ();
+			continue;
+		}
+
+		Rect const parent_bbox = e->item->item_to_parent (bbox);
+
+		if (e->leaf && rect_contains_rect (e->leaf->bbox, parent_bbox)) {
+			/* still inside its leaf, nothing else to update */
+			e->bbox = parent_bbox;
+			continue;
+		}
+
+		unplace (e);
+		e->bbox = parent_bbox;
+		place (e);
+		++_updates;
+	}
+
+	_pending.clear ();
+}
+
+bool
+SpatialLookupTable::needs_rebuild () const
+{
+	return _updates > max ((size_t) 64, _entries.size());
+}
+
+bool
+SpatialLookupTable::item_added (Item* item, bool at_front)
+{
+	if (_entries.find (item) != _entries.end()) {
+		return false;
+	}
+
+	/* don't look at the item's bounding box yet: items are added to their
+	 * parent from within their own constructor.
+	 */
+
+	Entry* e = new Entry;
+	e->item = item;
+	e->order = at_front ? --_min_order : _max_order++;
+	e->leaf = 0;
+	e->pending = false;
+	_entries.insert (make_pair (item, e));
+	queue (e);
+
+	return !needs_rebuild ();
+}
+
+bool
+SpatialLookupTable::item_removed (Item* item)
+{
+	Entries::iterator i = _entries.find (item);
+
+	if (i == _entries.end()) {
+		return true;
+	}
+
+	Entry* e = i->second;
+
+	unplace (e);
+
+	if (e->pending) {
+		_pending.erase (find (_pending.begin(), _pending.end(), e));
+	}
+
+	_entries.erase (i);
+	delete e;
+	++_updates;
+
+	return !needs_rebuild ();
+}
+
+bool
+SpatialLookupTable::item_changed (Item* item)
+{
+	Entries::iterator i = _entries.find (item);
+
+	if (i == _entries.end()) {
+		return false;
+	}
+
+	queue (i->second);
+
+	return !needs_rebuild ();
+}
+
+bool
+SpatialLookupTable::item_restacked (Item* item, bool to_top)
+{
+	Entries::iterator i = _entries.find (item);
+
+	if (i == _entries.end()) {
+		return false;
+	}
+
+	i->second->order = to_top ? _max_order++ : --_min_order;
+
+	return true;
+}
+
+/** @return offset to add to our item's coordinates to get window
+ *  coordinates for its children (which may be scrolled by our item).
+ */
+Duple
+SpatialLookupTable::window_offset () const
+{
+	list<Item*> const & items = _item.items ();
+
+	if (items.empty()) {
+		return Duple ();
+	}
+
+	Item const * child = items.front ();
+	return child->item_to_window (Duple (0, 0), false) - child->position ();
+}
+
+void
+SpatialLookupTable::search (Node const * n, Rect const & area, vector<Entry*>& found) const
+{
+	if (n->leaf) {
+		for (vector<Entry*>::const_iterator i = n->entries.begin(); i != n->entries.end(); ++i) {
+			if (rects_overlap ((*i)->bbox, area)) {
+				found.push_back (*i);
+			}
+		}
+		return;
+	}
+
+	for (vector<Node*>::const_iterator c = n->children.begin(); c != n->children.end(); ++c) {
+		if (rects_overlap ((*c)->bbox, area)) {
+			search (*c, area, found);
+		}
+	}
+}
+
+void
+SpatialLookupTable::search (Node const * n, Duple const & point, vector<Entry*>& found) const
+{
+	if (n->leaf) {
+		for (vector<Entry*>::const_iterator i = n->entries.begin(); i != n->entries.end(); ++i) {
+			if (rect_contains_point ((*i)->bbox, point)) {
+				found.push_back (*i);
+			}
+		}
+		return;
+	}
+
+	for (vector<Node*>::const_iterator c = n->children.begin(); c != n->children.end(); ++c) {
+		if (rect_contains_point ((*c)->bbox, point)) {
+			search (*c, point, found);
+		}
+	}
+}
+
+/** @param area Area in window coordinates, as for DumbLookupTable.
+ *  @return candidate items, in stacking order (lowest first).
+ */
+vector<Item*>
+SpatialLookupTable::get (Rect const & area)
+{
+	flush_pending ();
+
+	/* allow for the rounding done by Item::item_to_window() */
+	Rect const q = area.translate (-window_offset ()).expand (1.0);
+
+	vector<Entry*> found;
+	search (_root, q, found);
+	sort (found.begin(), found.end(), SpatialEntryOrder ());
+
+	vector<Item*> vitems;
+	vitems.reserve (found.size ());
+
+	for (vector<Entry*>::const_iterator i = found.begin(); i != found.end(); ++i) {
+		vitems.push_back ((*i)->item);
+	}
+
+	return vitems;
+}
+
+vector<Item*>
+SpatialLookupTable::items_at_point (Duple const & point) const
+{
+	/* Point is in window coordinate system */
+
+	flush_pending ();
+
+	Duple const p = point - window_offset ();
+
+	vector<Entry*> found;
+	search (_root, p, found);
+	sort (found.begin(), found.end(), SpatialEntryOrder ());
+
+	vector<Item*> vitems;
+
+	for (vector<Entry*>::const_iterator i = found.begin(); i != found.end(); ++i) {
+		if ((*i)->item->covers (point)) {
+			vitems.push_back ((*i)->item);
+		}
+	}
+
+	return vitems;
+}
+
+bool
+SpatialLookupTable::has_item_at_point (Duple const & point) const
+{
+	/* Point is in window coordinate system */
+
+	flush_pending ();
+
+	Duple const p = point - window_offset ();
+
+	vector<Entry*> found;
+	search (_root, p, found);
+
+	for (vector<Entry*>::const_iterator i = found.begin(); i != found.end(); ++i) {
+		if ((*i)->item->visible() && (*i)->item->covers (point)) {
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,545 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cairomm/context.h>
+
+#include "canvas/canvas.h"
+#include "canvas/note_set.h"
+#include "canvas/utils.h"
+
+using namespace std;
+using namespace ArdourCanvas;
+
+NoteSet::Handle const NoteSet::invalid_handle = ~((NoteSet::Handle) 0);
+
+NoteSet::NoteSet (Canvas* c)
+	: Item (c)
+	, _lod_width (2.0)
+	, _batch_depth (0)
+	, _order_dirty (false)
+	, _max_width (0)
+{
+}
+
+NoteSet::NoteSet (Item* parent)
+	: Item (parent)
+	, _lod_width (2.0)
+	, _batch_depth (0)
+	, _order_dirty (false)
+	, _max_width (0)
+{
+}
+
+void
+NoteSet::compute_bounding_box () const
+{
+	Rect bbox;
+	bool first = true;
+
+	for (vector<Element>::const_iterator i = _elements.begin(); i != _elements.end(); ++i) {
+		if (!i->used) {
+			continue;
+		}
+		if (first) {
+			bbox = i->rect;
+			first = false;
+		} else {
+			bbox = bbox.extend (i->rect);
+		}
+	}
+
+	if (first) {
+		_bounding_box = Rect ();
+	} else {
+		/* allow for a 1 pixel outline, as Rectangle does */
+		_bounding_box = bbox.fix().expand (1.5);
+	}
+
+	_bounding_box_dirty = false;
+}
+
+/** Called after an element's geometry or visibility changed. If the
+ *  bounding box is unaffected we only damage the area covered by the
+ *  element, instead of the whole (potentially huge) item.
+ */
+void
+NoteSet::element_changed (Rect const & before, Rect const & after)
+{
+	Rect const damage = (before && after) ? before.extend (after) : (before ? before : after);
+
+	if (!damage) {
+		return;
+	}
+
+	if (_batch_depth) {
+		_batch_damage = _batch_damage ? _batch_damage.extend (damage) : damage;
+		if (after) {
+			grow_bounding_box (after);
+		}
+		return;
+	}
+
+	if (after && !bounding_box_contains (after)) {
+		begin_change ();
+		grow_bounding_box (after);
+		end_change ();
+		return;
+	}
+
+	if (visible() && _canvas) {
+		_canvas->queue_draw_item_area (this, damage.expand (1.5));
+	}
+}
+
+bool
+NoteSet::bounding_box_contains (Rect const & r) const
+{
+	Rect const bbox = bounding_box ();
+	return bbox && r.x0 >= bbox.x0 && r.y0 >= bbox.y0 && r.x1 <= bbox.x1 && r.y1 <= bbox.y1;
+}
+
+void
+NoteSet::grow_bounding_box (Rect const & r)
+{
+	/* incremental version of compute_bounding_box(), so that adding
+	 * notes one by one does not turn into a quadratic walk.
+	 */
+	Rect const e = r.fix().expand (1.5);
+
+	if (_bounding_box_dirty) {
+		compute_bounding_box ();
+	}
+
+	if (!_bounding_box) {
+		_bounding_box = e;
+	} else {
+		_bounding_box = _bounding_box.extend (e);
+	}
+}
+
+void
+NoteSet::begin_batch ()
+{
+	if (_batch_depth++ == 0) {
+		begin_change ();
+		_batch_damage = Rect ();
+		_batch_pre_change = bounding_box ();
+	}
+}
+
+void
+NoteSet::end_batch ()
+{
+	if (_batch_depth == 0 || --_batch_depth != 0) {
+		return;
+	}
+
+	if (_batch_pre_change != bounding_box ()) {
+		end_change ();
+	} else if (_batch_damage && visible() && _canvas) {
+		_canvas->queue_draw_item_area (this, _batch_damage.expand (1.5));
+	}
+}
+
+NoteSet::Handle
+NoteSet::add (Rect const & r, Color fill, Color outline, void* data)
+{
+	Handle h;
+
+	if (!_free.empty()) {
+		h = _free.back ();
+		_free.pop_back ();
+		_elements[h] = Element (r, fill, outline, data);
+	} else {
+		h = _elements.size ();
+		_elements.push_back (Element (r, fill, outline, data));
+	}
+
+	_order_dirty = true;
+	element_changed (Rect(), r);
+
+	return h;
+}
+
+void
+NoteSet::remove (Handle h)
+{
+	if (!valid (h)) {
+		return;
+	}
+
+	Element& e (_elements[h]);
+	Rect const before = e.visible ? e.rect : Rect();
+
+	e.used = false;
+	e.data = 0;
+	_free.push_back (h);
+	_order_dirty = true;
+
+	/* the bounding box may only shrink, which is not worth an
+	 * immediate recomputation.
+	 */
+	element_changed (before, Rect());
+}
+
+void
+NoteSet::clear ()
+{
+	begin_change ();
+
+	_elements.clear ();
+	_free.clear ();
+	_order.clear ();
+	_order_dirty = false;
+	_max_width = 0;
+	_bounding_box_dirty = true;
+
+	end_change ();
+}
+
+void
+NoteSet::set (Handle h, Rect const & r)
+{
+	assert (valid (h));
+	Element& e (_elements[h]);
+
+	if (!(e.rect != r)) {
+		return;
+	}
+
+	Rect const before = e.visible ? e.rect : Rect();
+	e.rect = r;
+	_order_dirty = true;
+	element_changed (before, e.visible ? r : Rect());
+}
+
+void
+NoteSet::set_fill_color (Handle h, Color c)
+{
+	assert (valid (h));
+	Element& e (_elements[h]);
+
+	if (e.fill != c) {
+		e.fill = c;
+		if (e.visible) {
+			element_changed (e.rect, e.rect);
+		}
+	}
+}
+
+void
+NoteSet::set_outline_color (Handle h, Color c)
+{
+	assert (valid (h));
+	Element& e (_elements[h]);
+
+	if (e.outline != c) {
+		e.outline = c;
+		if (e.visible) {
+			element_changed (e.rect, e.rect);
+		}
+	}
+}
+
+void
+NoteSet::set_outline_what (Handle h, Rectangle::What what)
+{
+	assert (valid (h));
+	Element& e (_elements[h]);
+
+	if (e.outline_what != what) {
+		e.outline_what = what;
+		if (e.visible) {
+			element_changed (e.rect, e.rect);
+		}
+	}
+}
+
+void
+NoteSet::set_visible (Handle h, bool yn)
+{
+	assert (valid (h));
+	Element& e (_elements[h]);
+
+	if (e.visible != yn) {
+		e.visible = yn;
+		_order_dirty = true;
+		element_changed (yn ? Rect() : e.rect, yn ? e.rect : Rect());
+	}
+}
+
+Rect
+NoteSet::get (Handle h) const
+{
+	assert (valid (h));
+	return _elements[h].rect;
+}
+
+void*
+NoteSet::data (Handle h) const
+{
+	if (!valid (h)) {
+		return 0;
+	}
+	return _elements[h].data;
+}
+
+void
+NoteSet::set_lod_width (Distance w)
+{
+	if (w != _lod_width) {
+		begin_visual_change ();
+		_lod_width = w;
+		end_visual_change ();
+	}
+}
+
+
+namespace ArdourCanvas {
+/* sort by start position; the handle breaks ties so that rendering
+ * (and hence overlap) stays stable as notes are edited.
+ */
+class NoteSetSorter {
+public:
+	NoteSetSorter (std::vector<Rect> const & r) : rects (r) {}
+
+	bool operator() (NoteSet::Handle a, NoteSet::Handle b) const {
+		if (rects[a].x0 != rects[b].x0) {
+			return rects[a].x0 < rects[b].x0;
+		}
+		return a < b;
+	}
+
+	std::vector<Rect> const & rects;
+};
+
+struct NoteSetSpan {
+	Rect  r;
+	Color fill;
+};
+
+class NoteSetPositionCompare {
+public:
+	NoteSetPositionCompare (std::vector<Rect> const & r) : rects (r) {}
+
+	bool operator() (NoteSet::Handle a, Coord x) const {
+		return rects[a].x0 < x;
+	}
+
+	std::vector<Rect> const & rects;
+};
+}
+
+void
+NoteSet::ensure_order () const
+{
+	if (!_order_dirty) {
+		return;
+	}
+
+	_order.clear ();
+	_order_rects.resize (_elements.size ());
+	_max_width = 0;
+
+	for (Handle h = 0; h < _elements.size(); ++h) {
+		Element const & e (_elements[h]);
+		_order_rects[h] = e.rect;
+		if (e.used && e.visible) {
+			_order.push_back (h);
+			_max_width = max (_max_width, e.rect.width());
+		}
+	}
+
+	sort (_order.begin(), _order.end(), NoteSetSorter (_order_rects));
+
+	_order_dirty = false;
+}
+
+/** @return iterator to the first note in _order that may intersect
+ *  an area starting at item coordinate @param x.
+ */
+vector<NoteSet::Handle>::const_iterator
+NoteSet::first_candidate (Coord x) const
+{
+	return lower_bound (_order.begin(), _order.end(), x - _max_width - 1.0, NoteSetPositionCompare (_order_rects));
+}
+
+void
+NoteSet::render_note (Element const & e, Rect const & self, Cairo::RefPtr<Cairo::Context> context) const
+{
+	set_source_rgba (context, e.fill);
+	context->rectangle (self.x0, self.y0, self.width(), self.height());
+	context->fill ();
+
+	if (!e.outline_what) {
+		return;
+	}
+
+	/* see Rectangle::render_self() for the 0.5 pixel shift */
+	Rect const o = self.translate (Duple (0.5, 0.5));
+
+	set_source_rgba (context, e.outline);
+	context->set_line_width (1.0);
+
+	if (e.outline_what == Rectangle::ALL) {
+		context->rectangle (o.x0, o.y0, o.width(), o.height());
+	} else {
+		if (e.outline_what & Rectangle::LEFT) {
+			context->move_to (o.x0, o.y0);
+			context->line_to (o.x0, o.y1);
+		}
+		if (e.outline_what & Rectangle::TOP) {
+			context->move_to (o.x0, o.y0);
+			context->line_to (o.x1, o.y0);
+		}
+		if (e.outline_what & Rectangle::BOTTOM) {
+			context->move_to (o.x0, o.y1);
+			context->line_to (o.x1, o.y1);
+		}
+		if (e.outline_what & Rectangle::RIGHT) {
+			context->move_to (o.x1, o.y0);
+			context->line_to (o.x1, o.y1);
+		}
+	}
+
+	context->stroke ();
+}
+
+void
+NoteSet::prepare_for_render (Rect const &) const
+{
+	ensure_order ();
+}
+
+void
+NoteSet::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) const
+{
+	if (size() == 0) {
+		return;
+	}
+
+	ensure_order ();
+
+	/* area is in window coordinates; convert the horizontal extent to
+	 * item coordinates so that we can binary search for the first note
+	 * that could be visible, and stop at the first one that starts
+	 * beyond the right edge.
+	 */
+
+	Rect const item_area = window_to_item (area);
+
+	/* Notes that are narrower than _lod_width are accumulated into one
+	 * span per row (identical y0/y1) and drawn as a single fill when the
+	 * next note on that row does not touch the span, or at the end.
+	 */
+
+	vector<NoteSetSpan> spans;
+
+	for (vector<Handle>::const_iterator i = first_candidate (item_area.x0); i != _order.end(); ++i) {
+
+		Element const & e (_elements[*i]);
+
+		if (e.rect.x0 > item_area.x1) {
+			break;
+		}
+
+		if (e.rect.y1 < item_area.y0 || e.rect.y0 > item_area.y1 || e.rect.x1 < item_area.x0) {
+			continue;
+		}
+
+		Rect const self = item_to_window (e.rect, false);
+
+		if (self.width() >= _lod_width) {
+			Rect const isect = self.intersection (area.expand (1.0));
+			if (isect) {
+				render_note (e, self, context);
+			}
+			continue;
+		}
+
+		vector<NoteSetSpan>::iterator s;
+
+		for (s = spans.begin(); s != spans.end(); ++s) {
+			if (s->r.y0 == self.y0 && s->r.y1 == self.y1) {
+				break;
+			}
+		}
+
+		/* notes this small are mostly outline, so use that colour */
+
+		if (s != spans.end()) {
+			if (self.x0 <= s->r.x1 + 1.0) {
+				s->r.x1 = max (s->r.x1, self.x1);
+				continue;
+			}
+			set_source_rgba (context, s->fill);
+			context->rectangle (s->r.x0, s->r.y0, max (1.0, s->r.width()), s->r.height());
+			context->fill ();
+			s->r = self;
+			s->fill = e.outline;
+		} else {
+			NoteSetSpan n;
+			n.r = self;
+			n.fill = e.outline;
+			spans.push_back (n);
+		}
+	}
+
+	for (vector<NoteSetSpan>::const_iterator s = spans.begin(); s != spans.end(); ++s) {
+		set_source_rgba (context, s->fill);
+		context->rectangle (s->r.x0, s->r.y0, max (1.0, s->r.width()), s->r.height());
+		context->fill ();
+	}
+}
+
+NoteSet::Handle
+NoteSet::note_at (Duple const & point) const
+{
+	if (size() == 0) {
+		return invalid_handle;
+	}
+
+	ensure_order ();
+
+	Duple const p = window_to_item (point);
+	Handle found = invalid_handle;
+
+	/* later notes are drawn on top, so the last match wins */
+
+	for (vector<Handle>::const_iterator i = first_candidate (p.x); i != _order.end(); ++i) {
+		Element const & e (_elements[*i]);
+
+		if (e.rect.x0 > p.x) {
+			break;
+		}
+
+		if (e.rect.contains (p)) {
+			found = *i;
+		}
+	}
+
+	return found;
+}
+
+bool
+NoteSet::covers (Duple const & point) const
+{
+	return note_at (point) != invalid_handle;
+}
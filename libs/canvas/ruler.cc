@@ -94,6 +94,16 @@ Ruler::set_font_description (Pango::FontDescription fd)
 	end_visual_change ();
 }
 
+void
+Ruler::prepare_for_render (Rect const &) const
+{
+	if (_need_marks) {
+		marks.clear ();
+		_metric->get_marks (marks, _lower, _upper, 50);
+		_need_marks = false;
+	}
+}
+
 void
 Ruler::render (Rect const & area, Cairo::RefPtr<Cairo::Context> cr) const
 {
@@ -113,11 +123,7 @@ Ruler::render (Rect const & area, Cairo::RefPtr<Cairo::Context> cr) const
 
 	Distance height = self.height();
 
-	if (_need_marks) {
-		marks.clear ();
-		_metric->get_marks (marks, _lower, _upper, 50);
-		_need_marks = false;
-	}
+	prepare_for_render (area);
 
 	/* draw background */
 
@@ -187,6 +187,14 @@ Text::_redraw () const
 	_need_redraw = false;
 }
 
+void
+Text::prepare_for_render (Rect const &) const
+{
+	if (!_text.empty() && _need_redraw) {
+		_redraw ();
+	}
+}
+
 void
 Text::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) const
 {
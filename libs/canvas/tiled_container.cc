@@ -0,0 +1,476 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <climits>
+
+#include <glibmm/main.h>
+
+#include "canvas/canvas.h"
+#include "canvas/tiled_container.h"
+
+using namespace std;
+using namespace ArdourCanvas;
+
+int const TiledContainer::tile_size = 256;
+
+uint64_t TiledContainer::_cache_size = 64 * 1048576;
+
+vector<Glib::Threads::Thread*> TiledContainer::_workers;
+vector<TiledContainer::Job*> TiledContainer::_queue;
+size_t TiledContainer::_outstanding = 0;
+bool TiledContainer::_workers_should_quit = false;
+Glib::Threads::Mutex TiledContainer::_queue_lock;
+Glib::Threads::Cond TiledContainer::_queue_cond;
+Glib::Threads::Cond TiledContainer::_done_cond;
+
+static void do_not_delete (void*) {}
+Glib::Threads::Private<bool> TiledContainer::_rendering_tile (do_not_delete);
+static bool yes = true;
+
+TiledContainer::TiledContainer (Canvas* canvas)
+	: Container (canvas)
+{
+	init ();
+}
+
+TiledContainer::TiledContainer (Item* parent)
+	: Container (parent)
+{
+	init ();
+}
+
+void
+TiledContainer::init ()
+{
+	_frame = 0;
+	_canvas->add_tiler (*this);
+}
+
+TiledContainer::~TiledContainer ()
+{
+	_prefetch_connection.disconnect ();
+	_canvas->remove_tiler (*this);
+}
+
+void
+TiledContainer::set_cache_size (uint64_t bytes)
+{
+	_cache_size = bytes;
+}
+
+void
+TiledContainer::set_render_threads (uint32_t n)
+{
+	stop_workers ();
+
+	_workers_should_quit = false;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		_workers.push_back (Glib::Threads::Thread::create (sigc::ptr_fun (&TiledContainer::worker)));
+	}
+}
+
+void
+TiledContainer::stop_workers ()
+{
+	{
+		Glib::Threads::Mutex::Lock lm (_queue_lock);
+		_workers_should_quit = true;
+		_queue_cond.broadcast ();
+	}
+
+	for (vector<Glib::Threads::Thread*>::iterator i = _workers.begin(); i != _workers.end(); ++i) {
+		(*i)->join ();
+	}
+
+	_workers.clear ();
+}
+
+void
+TiledContainer::worker ()
+{
+	Glib::Threads::Mutex::Lock lm (_queue_lock);
+
+	while (!_workers_should_quit) {
+
+		if (_queue.empty()) {
+			_queue_cond.wait (_queue_lock);
+			continue;
+		}
+
+		Job* job = _queue.back ();
+		_queue.pop_back ();
+
+		lm.release ();
+		job->container->render_tile (*job);
+		lm.acquire ();
+
+		if (--_outstanding == 0) {
+			_done_cond.signal ();
+		}
+	}
+}
+
+bool
+TiledContainer::rendering_tile ()
+{
+	bool* r = _rendering_tile.get ();
+	return r && *r;
+}
+
+bool
+TiledContainer::tiles_enabled () const
+{
+	return max_tiles () > 0;
+}
+
+size_t
+TiledContainer::max_tiles () const
+{
+	return _cache_size / (tile_size * tile_size * 4);
+}
+
+/** @return window coordinates of our origin, rounded to whole pixels so
+ *  that tiles can be composited without resampling.
+ */
+Duple
+TiledContainer::window_origin () const
+{
+	Duple const o = item_to_window (Duple (0, 0), false);
+	return Duple (round (o.x), round (o.y));
+}
+
+static int32_t
+tile_index (Coord c)
+{
+	double const i = floor (c / TiledContainer::tile_size);
+	return (int32_t) max ((double) (INT_MIN / 2), min ((double) (INT_MAX / 2), i));
+}
+
+/** Find the tiles covering @param area, which is in our coordinates */
+void
+TiledContainer::tile_range (Rect const & area, int32_t& c0, int32_t& r0, int32_t& c1, int32_t& r1) const
+{
+	c0 = tile_index (area.x0);
+	r0 = tile_index (area.y0);
+	c1 = tile_index (ceil (area.x1) - 1);
+	r1 = tile_index (ceil (area.y1) - 1);
+}
+
+Rect
+TiledContainer::tile_rect (TileKey const & k) const
+{
+	return Rect ((Coord) k.first * tile_size, (Coord) k.second * tile_size,
+	             ((Coord) k.first + 1) * tile_size, ((Coord) k.second + 1) * tile_size);
+}
+
+TiledContainer::Tile&
+TiledContainer::tile_at (TileKey const & k) const
+{
+	Tiles::iterator i = _tiles.find (k);
+
+	if (i != _tiles.end()) {
+		return i->second;
+	}
+
+	Tile& t (_tiles[k]);
+	t.surface = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, tile_size, tile_size);
+	t.damage = tile_rect (k);
+	return t;
+}
+
+void
+TiledContainer::invalidate_tiles (Rect const & area)
+{
+	if (_tiles.empty() || !area) {
+		return;
+	}
+
+	/* allow for antialiasing, and keep damage on whole pixels */
+	Rect const a = area.expand (1.0);
+	Rect const d (floor (a.x0), floor (a.y0), ceil (a.x1), ceil (a.y1));
+
+	int32_t c0, r0, c1, r1;
+	tile_range (d, c0, r0, c1, r1);
+
+	/* the area may be enormous (e.g. a track background), so only look
+	 * at the tiles that exist.
+	 */
+	for (Tiles::iterator i = _tiles.lower_bound (TileKey (c0, INT_MIN)); i != _tiles.end() && i->first.first <= c1; ++i) {
+
+		if (i->first.second < r0 || i->first.second > r1) {
+			continue;
+		}
+
+		Rect const t = d.intersection (tile_rect (i->first));
+
+		if (t) {
+			i->second.damage = i->second.damage ? i->second.damage.extend (t) : t;
+		}
+	}
+}
+
+void
+TiledContainer::drop_tiles ()
+{
+	_tiles.clear ();
+	redraw ();
+}
+
+void
+TiledContainer::add_job (TileKey const & k, Tile& tile, Duple const & origin, vector<Job>& jobs) const
+{
+	Job job;
+
+	job.container = this;
+	job.tile = &tile;
+	Rect const t = tile_rect (k).translate (origin);
+	job.origin = Duple (t.x0, t.y0);
+	job.area = tile.damage.translate (origin);
+
+	tile.damage = Rect ();
+	jobs.push_back (job);
+}
+
+void
+TiledContainer::render_tile (Job const & job) const
+{
+	_rendering_tile.set (&yes);
+
+	try {
+		Cairo::RefPtr<Cairo::Context> context = Cairo::Context::create (job.tile->surface);
+
+		context->translate (-job.origin.x, -job.origin.y);
+		context->rectangle (job.area.x0, job.area.y0, job.area.width(), job.area.height());
+		context->clip ();
+
+		context->set_operator (Cairo::OPERATOR_CLEAR);
+		context->paint ();
+		context->set_operator (Cairo::OPERATOR_OVER);
+
+		render_children (job.area, context);
+
+	} catch (...) {
+		/* leave whatever we managed to draw; the next change will
+		 * render the tile again.
+		 */
+	}
+
+	_rendering_tile.set (0);
+}
+
+/** Render @param jobs, using the worker threads if there are any, and
+ *  return once they are all done.
+ */
+void
+TiledContainer::render_jobs (vector<Job>& jobs) const
+{
+	if (jobs.empty()) {
+		return;
+	}
+
+	Rect all;
+
+	for (vector<Job>::const_iterator j = jobs.begin(); j != jobs.end(); ++j) {
+		all = all ? all.extend (j->area) : j->area;
+	}
+
+	/* resolve everything that items would otherwise compute lazily
+	 * while rendering, so that the workers only read item state.
+	 */
+	prepare_for_render (all);
+
+	if (_workers.empty() || jobs.size() == 1) {
+		for (vector<Job>::const_iterator j = jobs.begin(); j != jobs.end(); ++j) {
+			render_tile (*j);
+		}
+		return;
+	}
+
+	Glib::Threads::Mutex::Lock lm (_queue_lock);
+
+	for (vector<Job>::iterator j = jobs.begin(); j != jobs.end(); ++j) {
+		_queue.push_back (&(*j));
+	}
+
+	_outstanding += jobs.size();
+	_queue_cond.broadcast ();
+
+	/* lend a hand rather than just waiting */
+
+	while (!_queue.empty()) {
+		Job* job = _queue.back ();
+		_queue.pop_back ();
+
+		lm.release ();
+		render_tile (*job);
+		lm.acquire ();
+
+		--_outstanding;
+	}
+
+	while (_outstanding) {
+		_done_cond.wait (_queue_lock);
+	}
+}
+
+void
+TiledContainer::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) const
+{
+	if (!tiles_enabled ()) {
+		render_children (area, context);
+		return;
+	}
+
+	Duple const origin = window_origin ();
+	Rect const draw = bounding_box ().translate (origin).intersection (area);
+
+	if (!draw) {
+		return;
+	}
+
+	int32_t c0, r0, c1, r1;
+	tile_range (draw.translate (-origin), c0, r0, c1, r1);
+
+	++_frame;
+
+	vector<Job> jobs;
+	vector<pair<TileKey,Tile*> > visible;
+
+	for (int32_t r = r0; r <= r1; ++r) {
+		for (int32_t c = c0; c <= c1; ++c) {
+			TileKey const k (c, r);
+			Tile& t (tile_at (k));
+			t.used = _frame;
+			if (t.damage) {
+				add_job (k, t, origin, jobs);
+			}
+			visible.push_back (make_pair (k, &t));
+		}
+	}
+
+	render_jobs (jobs);
+
+	for (vector<pair<TileKey,Tile*> >::const_iterator v = visible.begin(); v != visible.end(); ++v) {
+		Rect const t = tile_rect (v->first).translate (origin);
+		Rect const d = t.intersection (draw);
+
+		if (!d) {
+			continue;
+		}
+
+		context->set_source (v->second->surface, t.x0, t.y0);
+		context->rectangle (d.x0, d.y0, d.width(), d.height());
+		context->fill ();
+	}
+
+	evict ();
+	queue_prefetch ();
+}
+
+/** Drop the least recently used tiles until we are within the cache size,
+ *  sparing any that were used in the current frame.
+ */
+void
+TiledContainer::evict () const
+{
+	size_t const limit = max_tiles ();
+
+	if (_tiles.size() <= limit) {
+		return;
+	}
+
+	vector<pair<uint64_t,TileKey> > candidates;
+
+	for (Tiles::const_iterator i = _tiles.begin(); i != _tiles.end(); ++i) {
+		if (i->second.used < _frame) {
+			candidates.push_back (make_pair (i->second.used, i->first));
+		}
+	}
+
+	sort (candidates.begin(), candidates.end());
+
+	for (vector<pair<uint64_t,TileKey> >::const_iterator i = candidates.begin(); i != candidates.end() && _tiles.size() > limit; ++i) {
+		_tiles.erase (i->second);
+	}
+}
+
+void
+TiledContainer::queue_prefetch () const
+{
+	if (!_prefetch_connection.connected ()) {
+		_prefetch_connection = Glib::signal_idle().connect (sigc::mem_fun (*this, &TiledContainer::prefetch));
+	}
+}
+
+/** Idle handler which renders tiles around the visible area, so that
+ *  they are ready when we scroll.
+ *  @return true if there may be more to do.
+ */
+bool
+TiledContainer::prefetch () const
+{
+	if (!tiles_enabled () || !visible ()) {
+		return false;
+	}
+
+	Rect const window = _canvas->visible_area ();
+	Duple const origin = window_origin ();
+
+	/* half a screen either side, a row of tiles above and below */
+	Rect const ahead = window.expand (tile_size, window.width() / 2, tile_size, window.width() / 2).translate (-origin).intersection (bounding_box ());
+
+	if (!ahead) {
+		return false;
+	}
+
+	int32_t c0, r0, c1, r1;
+	tile_range (ahead, c0, r0, c1, r1);
+
+	size_t const batch = max ((size_t) 2, _workers.size() * 2);
+	vector<Job> jobs;
+
+	for (int32_t r = r0; r <= r1; ++r) {
+		for (int32_t c = c0; c <= c1; ++c) {
+
+			TileKey const k (c, r);
+
+			if (_tiles.find (k) == _tiles.end() && _tiles.size() >= max_tiles ()) {
+				/* no room; don't push out tiles we're about to show */
+				render_jobs (jobs);
+				return false;
+			}
+
+			Tile& t (tile_at (k));
+			t.used = _frame;
+
+			if (t.damage) {
+				add_job (k, t, origin, jobs);
+				if (jobs.size() == batch) {
+					render_jobs (jobs);
+					return true;
+				}
+			}
+		}
+	}
+
+	render_jobs (jobs);
+	return false;
+}
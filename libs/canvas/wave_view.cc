@@ -42,6 +42,7 @@
 #include "canvas/canvas.h"
 #include "canvas/colors.h"
 #include "canvas/debug.h"
+#include "canvas/tiled_container.h"
 #include "canvas/utils.h"
 #include "canvas/wave_view.h"
 
@@ -274,6 +275,7 @@ WaveView::invalidate_image_cache ()
 	cancel_my_render_request ();
 	Glib::Threads::Mutex::Lock lci (current_image_lock);
 	_current_image.reset ();
+	_prepared_image.reset ();
 }
 
 void
@@ -1095,7 +1097,132 @@ WaveView::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) cons
 	 * waveview, and extends to region_length() / _samples_per_pixel.
 	 */
 
-	Rect self = item_to_window (Rect (0.0, 0.0, region_length() / _samples_per_pixel, _height));
+	Rect self;
+	Rect draw;
+	double draw_start;
+	double draw_end;
+	framepos_t sample_start;
+	framepos_t sample_end;
+
+	if (!draw_range (area, self, draw, draw_start, draw_end, sample_start, sample_end)) {
+		return;
+	}
+
+	double image_origin_in_self_coordinates;
+	boost::shared_ptr<WaveViewCache::Entry> image_to_draw;
+
+	Glib::Threads::Mutex::Lock lci (current_image_lock);
+
+	if (TiledContainer::rendering_tile ()) {
+		/* possibly in a worker thread: the image cache and our
+		 * request state belong to the GUI thread, so only use the
+		 * image that prepare_for_render() found.
+		 */
+		image_to_draw = _prepared_image;
+		if (!image_to_draw || image_to_draw->start > sample_start) {
+			return;
+		}
+	} else {
+		image_to_draw = image_for (sample_start, sample_end);
+		if (!image_to_draw) {
+			/* image not currently available. A redraw will be scheduled
+			   when it is ready.
+			*/
+			return;
+		}
+	}
+
+	/* compute the first pixel of the image that should be used when we
+	 * render the specified range.
+	 */
+
+	image_origin_in_self_coordinates = (image_to_draw->start - _region_start) / _samples_per_pixel;
+
+	if (_start_shift && (sample_start == _region_start) && (self.x0 == draw.x0)) {
+		/* we are going to draw the first pixel for this region, but
+		   we may not want this to overlap a border around the
+		   waveform. If so, _start_shift will be set.
+		*/
+		//cerr << name.substr (23) << " ss = " << sample_start << " rs = " << _region_start << " sf = " << _start_shift << " ds = " << draw_start << " self = " << self << " draw = " << draw << endl;
+		//draw_start += _start_shift;
+		//image_origin_in_self_coordinates += _start_shift;
+	}
+
+	/* the image may only be a best-effort ... it may not span the entire
+	 * range requested, though it is guaranteed to cover the start. So
+	 * determine how many pixels we can actually draw.
+	 */
+
+	double draw_width;
+	bool const is_current = (image_to_draw == _current_image);
+
+	/* image_to_draw holds a reference, and the lock is shared by all
+	 * WaveViews, which tiles may be rendering in parallel.
+	 */
+	lci.release ();
+
+	if (!is_current) {
+
+		/* the image is guaranteed to start at or before
+		 * draw_start. But if it starts before draw_start, that reduces
+		 * the maximum available width we can render with.
+		 *
+		 * so .. clamp the draw width to the smaller of what we need to
+		 * draw or the available width of the image.
+		 */
+
+		draw_width = min ((double) image_to_draw->image->get_width(), (draw_end - draw_start));
+
+
+		DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 draw just %2 of %3 @ %8 (iwidth %4 off %5 img @ %6 rs @ %7)\n", name, draw_width, (draw_end - draw_start),
+		                                              image_to_draw->image->get_width(), image_origin_in_self_coordinates,
+		                                              image_to_draw->start, _region_start, draw_start));
+	} else {
+		draw_width = draw_end - draw_start;
+		DEBUG_TRACE (DEBUG::WaveView, string_compose ("use current image, span entire render width %1..%2\n", draw_start, draw_end));
+	}
+
+	context->rectangle (draw_start, draw.y0, draw_width, draw.height());
+
+	/* round image origin position to an exact pixel in device space to
+	 * avoid blurring
+	 */
+
+	double x  = self.x0 + image_origin_in_self_coordinates;
+	double y  = self.y0;
+	context->user_to_device (x, y);
+	x = round (x);
+	y = round (y);
+	context->device_to_user (x, y);
+
+	/* the coordinates specify where in "user coordinates" (i.e. what we
+	 * generally call "canvas coordinates" in this code) the image origin
+	 * will appear. So specifying (10,10) will put the upper left corner of
+	 * the image at (10,10) in user space.
+	 */
+
+	context->set_source (image_to_draw->image, x, y);
+	context->fill ();
+
+	/* image obtained, some of it painted to display: we are rendered.
+	   Future calls to get_image_in_thread are now meaningful.
+	   (prepare_for_render() takes care of this for tiles.)
+	*/
+
+	if (!TiledContainer::rendering_tile ()) {
+		rendered = true;
+	}
+}
+
+/** Find the part of @param area (in window coordinates) covered by our
+ *  region, and the range of samples needed to draw it.
+ *  @return false if there is nothing to draw.
+ */
+bool
+WaveView::draw_range (Rect const & area, Rect& self, Rect& draw, double& draw_start, double& draw_end,
+                      framepos_t& sample_start, framepos_t& sample_end) const
+{
+	self = item_to_window (Rect (0.0, 0.0, region_length() / _samples_per_pixel, _height));
 
 	// cerr << name << " RENDER " << area << " self = " << self << endl;
 
@@ -1104,10 +1231,10 @@ WaveView::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) cons
 	Rect d = self.intersection (area);
 
 	if (!d) {
-		return;
+		return false;
 	}
 
-	Rect draw = d;
+	draw = d;
 
 	/* "draw" is now a rectangle that defines the rectangle we need to
 	 * update/render the waveview into, in window coordinate space.
@@ -1118,8 +1245,8 @@ WaveView::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) cons
 	 * draw "between" pixels at the start and/or end.
 	 */
 
-	double draw_start = floor (draw.x0);
-	const double draw_end = floor (draw.x1);
+	draw_start = floor (draw.x0);
+	draw_end = floor (draw.x1);
 
 	// cerr << "Need to draw " << draw_start << " .. " << draw_end << " vs. " << area << " and self = " << self << endl;
 
@@ -1140,8 +1267,8 @@ WaveView::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) cons
 	 * samples after the first sample of the region"
 	 */
 
-	framepos_t sample_start = _region_start + (image_start * _samples_per_pixel);
-	framepos_t sample_end   = _region_start + (image_end * _samples_per_pixel);
+	sample_start = _region_start + (image_start * _samples_per_pixel);
+	sample_end   = _region_start + (image_end * _samples_per_pixel);
 
 	// cerr << "Sample space: " << sample_start << " .. " << sample_end << " @ " << _samples_per_pixel << " rs = " << _region_start << endl;
 
@@ -1154,10 +1281,18 @@ WaveView::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) cons
 
 	// cerr << debug_name() << " will need image spanning " << sample_start << " .. " << sample_end << " region spans " << _region_start << " .. " << region_end() << endl;
 
-	double image_origin_in_self_coordinates;
+	return true;
+}
+
+/** Find an image covering (at least the start of) @param sample_start
+ *  .. @param sample_end, asking for one to be drawn if there is none.
+ *  Must be called in the GUI thread, with current_image_lock held.
+ */
+boost::shared_ptr<WaveViewCache::Entry>
+WaveView::image_for (framepos_t sample_start, framepos_t sample_end) const
+{
 	boost::shared_ptr<WaveViewCache::Entry> image_to_draw;
 
-	Glib::Threads::Mutex::Lock lci (current_image_lock);
 	if (_current_image) {
 
 		/* check it covers the right sample range */
@@ -1182,10 +1317,7 @@ WaveView::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) cons
 		DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 image to draw = %2 (full? %3)\n", name, image_to_draw, full_image));
 
 		if (!image_to_draw) {
-			/* image not currently available. A redraw will be scheduled
-			   when it is ready.
-			*/
-			return;
+			return image_to_draw;
 		}
 
 		if (full_image) {
@@ -1196,78 +1328,36 @@ WaveView::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) cons
 		}
 	}
 
-	/* compute the first pixel of the image that should be used when we
-	 * render the specified range.
-	 */
-
-	image_origin_in_self_coordinates = (image_to_draw->start - _region_start) / _samples_per_pixel;
+	return image_to_draw;
+}
 
-	if (_start_shift && (sample_start == _region_start) && (self.x0 == draw.x0)) {
-		/* we are going to draw the first pixel for this region, but
-		   we may not want this to overlap a border around the
-		   waveform. If so, _start_shift will be set.
-		*/
-		//cerr << name.substr (23) << " ss = " << sample_start << " rs = " << _region_start << " sf = " << _start_shift << " ds = " << draw_start << " self = " << self << " draw = " << draw << endl;
-		//draw_start += _start_shift;
-		//image_origin_in_self_coordinates += _start_shift;
+void
+WaveView::prepare_for_render (Rect const & area) const
+{
+	if (!_region) {
+		return;
 	}
 
-	/* the image may only be a best-effort ... it may not span the entire
-	 * range requested, though it is guaranteed to cover the start. So
-	 * determine how many pixels we can actually draw.
-	 */
-
-	double draw_width;
+	Rect self;
+	Rect draw;
+	double draw_start;
+	double draw_end;
+	framepos_t sample_start;
+	framepos_t sample_end;
 
-	if (image_to_draw != _current_image) {
-		lci.release ();
-
-		/* the image is guaranteed to start at or before
-		 * draw_start. But if it starts before draw_start, that reduces
-		 * the maximum available width we can render with.
-		 *
-		 * so .. clamp the draw width to the smaller of what we need to
-		 * draw or the available width of the image.
-		 */
-
-		draw_width = min ((double) image_to_draw->image->get_width(), (draw_end - draw_start));
+	Glib::Threads::Mutex::Lock lci (current_image_lock);
 
+	_prepared_image.reset ();
 
-		DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 draw just %2 of %3 @ %8 (iwidth %4 off %5 img @ %6 rs @ %7)\n", name, draw_width, (draw_end - draw_start),
-		                                              image_to_draw->image->get_width(), image_origin_in_self_coordinates,
-		                                              image_to_draw->start, _region_start, draw_start));
-	} else {
-		draw_width = draw_end - draw_start;
-		DEBUG_TRACE (DEBUG::WaveView, string_compose ("use current image, span entire render width %1..%2\n", draw_start, draw_end));
+	if (!draw_range (area, self, draw, draw_start, draw_end, sample_start, sample_end)) {
+		return;
 	}
 
-	context->rectangle (draw_start, draw.y0, draw_width, draw.height());
-
-	/* round image origin position to an exact pixel in device space to
-	 * avoid blurring
-	 */
-
-	double x  = self.x0 + image_origin_in_self_coordinates;
-	double y  = self.y0;
-	context->user_to_device (x, y);
-	x = round (x);
-	y = round (y);
-	context->device_to_user (x, y);
-
-	/* the coordinates specify where in "user coordinates" (i.e. what we
-	 * generally call "canvas coordinates" in this code) the image origin
-	 * will appear. So specifying (10,10) will put the upper left corner of
-	 * the image at (10,10) in user space.
-	 */
-
-	context->set_source (image_to_draw->image, x, y);
-	context->fill ();
+	_prepared_image = image_for (sample_start, sample_end);
 
-	/* image obtained, some of it painted to display: we are rendered.
-	   Future calls to get_image_in_thread are now meaningful.
-	*/
-
-	rendered = true;
+	if (_prepared_image) {
+		rendered = true;
+	}
 }
 
 void
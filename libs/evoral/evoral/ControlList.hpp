@@ -163,6 +163,14 @@ public:
 	 */
 	void thin (double thinning_factor);
 
+	/** Thin points as they are added during a write pass, rather than the
+	 * whole list when the pass is finished.
+	 *
+	 * @param thinning_factor area-size as for thin(), 0 to thin when the
+	 * pass is finished (the default)
+	 */
+	void set_write_pass_thinning (double thinning_factor);
+
 	boost::shared_ptr<ControlList> cut (double, double);
 	boost::shared_ptr<ControlList> copy (double, double);
 
@@ -358,7 +366,9 @@ protected:
     bool       new_write_pass;
     bool       did_write_during_pass;
     bool       _in_write_pass;
+    double     _write_pass_thinning;
     void unlocked_invalidate_insert_iterator ();
+    void unlocked_thin_before (iterator);
     void add_guard_point (double when);
 };
 
@@ -21,16 +21,16 @@
 #define EVORAL_SMF_HPP
 
 #include <glibmm/threads.h>
+#include <cstdio>
 #include <set>
+#include <vector>
 
 #include "evoral/visibility.h"
 #include "evoral/types.hpp"
 
 struct smf_struct;
-struct smf_track_struct;
 struct smf_tempo_struct;
 typedef smf_struct smf_t;
-typedef smf_track_struct smf_track_t;
 typedef smf_tempo_struct smf_tempo_t;
 
 namespace Evoral {
@@ -42,11 +42,19 @@ namespace Evoral {
  *
  * For WRITING: this object specifically wraps a type0 file or a type1 file with only a
  * single track. It has no support at this time for a type1 file with multiple
- * tracks.
+ * tracks. begin_write() starts a temporary file next to the file, which
+ * replaces it when end_write() finishes the track; until then the file is
+ * left as it was. Events are appended to the temporary file as they are
+ * written (see flush()).
  *
  * For READING: this object can read a single arbitrary track from a type1
  * file, or the single track of a type0 file. It has no support at this time
  * for reading more than 1 track.
+ *
+ * Events are read from the file as needed rather than loaded into memory.
+ * An index of positions in the current track, made when it is first needed,
+ * allows seek_to_time() to find a position without reading from the start.
+ * Only the tempo map is parsed (with libsmf) as a whole, on demand.
  */
 class LIBEVORAL_API SMF {
 public:
@@ -72,6 +80,16 @@ public:
 	void seek_to_start() const;
 	int  seek_to_track(int track);
 
+	/** Move to the first event of the current track at or after
+	 * @param ticks, so that the next read_event() returns it.
+	 * @return the time (in ticks) that the delta time of that event
+	 * is relative to.
+	 */
+	uint64_t seek_to_time(uint64_t ticks) const;
+
+	/** @return the time (in ticks) of the last event of the current track */
+	uint64_t duration() const;
+
 	int read_event(uint32_t* delta_t, uint32_t* size, uint8_t** buf, event_id_t* note_id) const;
 
 	uint16_t num_tracks() const;
@@ -82,7 +100,8 @@ public:
 	void append_event_delta(uint32_t delta_t, uint32_t size, const uint8_t* buf, event_id_t note_id);
 	void end_write(std::string const &) THROW_FILE_ERROR;
 
-	void flush() {};
+	/** Write events appended so far to the file */
+	void flush();
 
 	double round_to_file_precision (double val) const;
 
@@ -122,12 +141,75 @@ public:
 	Tempo* tempo_at_seconds (double seconds) const;
 	Tempo* nth_tempo (size_t n) const;
 
+  protected:
+	/** Tell us that the file has been moved to @param path */
+	void set_file_path (std::string const & path);
+
   private:
-	smf_t*       _smf;
-	smf_track_t* _smf_track;
+	/** a track chunk in the file */
+	struct Track {
+		Track (long o, uint32_t l) : offset (o), length (l) {}
+		long     offset; ///< of the first event
+		uint32_t length; ///< of all events, in bytes
+	};
+
+	/** a point in the current track from which events can be read */
+	struct Position {
+		Position () : offset (0), time (0), status (0), end (false) {}
+		long     offset;
+		uint64_t time;   ///< of the previous event
+		uint8_t  status; ///< running status
+		bool     end;    ///< End Of Track has been read
+	};
+
+	void  close_unlocked ();
+	FILE* read_file () const;
+	std::string const & data_path () const;
+	bool  commit_write ();
+	void  discard_write ();
+	int   read_header ();
+	bool  write_track_length (uint32_t length);
+	bool  write_pending ();
+	bool  finish_track ();
+	int   byte_at (long offset) const;
+	bool  read_bytes (long offset, uint8_t* buf, size_t size) const;
+	bool  read_vlq (long& offset, uint32_t& value) const;
+	int   decode_event (Track const &, Position&, uint32_t& delta_t) const;
+	size_t index_track (std::set<uint8_t>* channels = 0) const;
+	std::string track_text (Track const &, uint8_t type) const;
+	void  load_tempo_map () const;
+
+	std::string  _file_path;
+	mutable FILE* _file;       ///< for reading
+	FILE*        _write_file;
+	uint16_t     _format;
+	uint16_t     _ppqn;
+	std::vector<Track> _tracks;
+	int          _track;       ///< index of the current track in _tracks, or -1
 	bool         _empty; ///< true iff file contains(non-empty) events
 	mutable Glib::Threads::Mutex _smf_lock;
 
+	/* reading */
+	mutable Position              _pos;
+	mutable std::vector<uint8_t>  _event;  ///< the last event decoded, as libsmf would store it
+	mutable std::vector<uint8_t>  _buffer; ///< a part of the file
+	mutable long                  _buffer_offset;
+	mutable size_t                _buffer_size;
+	mutable std::vector<Position> _index;
+	mutable int                   _indexed_track;
+	mutable uint64_t              _duration;
+
+	/* writing */
+	bool                 _writing;
+	std::string          _write_path;   ///< temporary file until end_write(), or empty
+	std::vector<uint8_t> _pending;      ///< appended events not yet written
+	long                 _write_offset; ///< where the next event goes
+	uint64_t             _write_time;
+	uint32_t             _n_written;
+
+	/** parsed when needed, for the tempo map only */
+	mutable smf_t*       _smf;
+
 	bool              _type0;
 	std::set<uint8_t> _type0channels;
 };
@@ -73,6 +73,7 @@ ControlList::ControlList (const Parameter& id, const ParameterDescriptor& desc)
 	did_write_during_pass = false;
 	insert_position = -1;
 	most_recent_insert_iterator = _events.end();
+	_write_pass_thinning = 0.0;
 }
 
 ControlList::ControlList (const ControlList& other)
@@ -95,6 +96,7 @@ ControlList::ControlList (const ControlList& other)
 	did_write_during_pass = false;
 	insert_position = -1;
 	most_recent_insert_iterator = _events.end();
+	_write_pass_thinning = 0.0;
 
 	copy_events (other);
 
@@ -130,6 +132,7 @@ ControlList::ControlList (const ControlList& other, double start, double end)
 	did_write_during_pass = false;
 	insert_position = -1;
 	most_recent_insert_iterator = _events.end();
+	_write_pass_thinning = 0.0;
 
 	mark_dirty ();
 }
@@ -381,13 +384,58 @@ ControlList::write_pass_finished (double /*when*/, double thinning_factor)
 	DEBUG_TRACE (DEBUG::ControlList, "write pass finished\n");
 
 	if (did_write_during_pass) {
-		thin (thinning_factor);
+		if (_write_pass_thinning == 0.0) {
+			/* otherwise already thinned while writing */
+			thin (thinning_factor);
+		}
 		did_write_during_pass = false;
 	}
 	new_write_pass = true;
 	_in_write_pass = false;
 }
 
+void
+ControlList::set_write_pass_thinning (double thinning_factor)
+{
+	Glib::Threads::RWLock::WriterLock lm (_lock);
+	_write_pass_thinning = thinning_factor;
+}
+
+/** Remove the point before @param i if it is sufficiently co-linear with its
+ * neighbours, using the same measure as thin(). Only points written in the
+ * current write pass are considered.
+ */
+void
+ControlList::unlocked_thin_before (iterator i)
+{
+	if (_write_pass_thinning == 0.0 || _desc.toggled || i == _events.end() || i == _events.begin()) {
+		return;
+	}
+
+	iterator prev = i;
+	--prev;
+
+	if (prev == _events.begin() || (*prev)->when <= insert_position) {
+		return;
+	}
+
+	iterator prevprev = prev;
+	--prevprev;
+
+	const ControlEvent* a = *prevprev;
+	const ControlEvent* b = *prev;
+	const ControlEvent* c = *i;
+
+	const double area = fabs ((a->when * (b->value - c->value)) +
+	                          (b->when * (c->value - a->value)) +
+	                          (c->when * (a->value - b->value)));
+
+	if (area < _write_pass_thinning) {
+		delete b;
+		_events.erase (prev);
+	}
+}
+
 void
 ControlList::set_in_write_pass (bool yn, bool add_point, double when)
 {
@@ -725,6 +773,10 @@ ControlList::add (double when, double value, bool with_guards, bool with_initial
 			}
 		}
 
+		if (_in_write_pass) {
+			unlocked_thin_before (most_recent_insert_iterator);
+		}
+
 		mark_dirty ();
 	}
 
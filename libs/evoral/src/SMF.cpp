@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <stdint.h>
 
@@ -39,10 +40,70 @@ using namespace std;
 
 namespace Evoral {
 
+/** events between two entries of the seek index */
+static const size_t index_interval = 256;
+/** bytes read from the file at once */
+static const size_t read_buffer_size = 65536;
+/** appended bytes kept in memory before they are written to the file */
+static const size_t write_buffer_size = 65536;
+/** size of the MThd chunk */
+static const long mthd_size = 14;
+/** offset of the first event of a file being written */
+static const long events_offset = mthd_size + 8;
+
+static uint32_t
+read_be (uint8_t const * buf, int n)
+{
+	uint32_t v = 0;
+	for (int i = 0; i < n; ++i) {
+		v = (v << 8) | buf[i];
+	}
+	return v;
+}
+
+static void
+write_be (uint8_t* buf, uint32_t v, int n)
+{
+	for (int i = n - 1; i >= 0; --i) {
+		buf[i] = v & 0xff;
+		v >>= 8;
+	}
+}
+
+static void
+append_vlq (vector<uint8_t>& buf, uint32_t value)
+{
+	unsigned char vlq[8];
+	const int len = smf_format_vlq (vlq, sizeof (vlq), value);
+	buf.insert (buf.end(), vlq, vlq + len);
+}
+
+static bool
+write_mthd (FILE* f, uint16_t format, uint16_t n_tracks, uint16_t ppqn)
+{
+	uint8_t h[mthd_size] = { 'M', 'T', 'h', 'd', 0, 0, 0, 6 };
+	write_be (&h[8], format, 2);
+	write_be (&h[10], n_tracks, 2);
+	write_be (&h[12], ppqn, 2);
+	return fwrite (h, 1, mthd_size, f) == (size_t) mthd_size;
+}
+
 SMF::SMF()
-	: _smf (0)
-	, _smf_track (0)
+	: _file (0)
+	, _write_file (0)
+	, _format (0)
+	, _ppqn (0)
+	, _track (-1)
 	, _empty (true)
+	, _buffer_offset (0)
+	, _buffer_size (0)
+	, _indexed_track (-1)
+	, _duration (0)
+	, _writing (false)
+	, _write_offset (0)
+	, _write_time (0)
+	, _n_written (0)
+	, _smf (0)
 	, _type0 (false)
 	{};
 
@@ -55,14 +116,14 @@ uint16_t
 SMF::num_tracks() const
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
-	return _smf ? _smf->number_of_tracks : 0;
+	return _tracks.size ();
 }
 
 uint16_t
 SMF::ppqn() const
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
-	return _smf->ppqn;
+	return _ppqn;
 }
 
 /** Seek to the specified track (1-based indexing)
@@ -72,13 +133,13 @@ int
 SMF::seek_to_track(int track)
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
-	_smf_track = smf_get_track_by_number(_smf, track);
-	if (_smf_track != NULL) {
-		_smf_track->next_event_number = (_smf_track->number_of_events == 0) ? 0 : 1;
-		return 0;
-	} else {
+	if (track < 1 || track > (int) _tracks.size ()) {
 		return -1;
 	}
+	_track = track - 1;
+	_pos = Position ();
+	_pos.offset = _tracks[_track].offset;
+	return 0;
 }
 
 /** Attempt to open the SMF file just to see if it is valid.
@@ -89,24 +150,17 @@ SMF::seek_to_track(int track)
 bool
 SMF::test(const std::string& path)
 {
-	FILE* f = g_fopen(path.c_str(), "r");
-	if (f == 0) {
-		return false;
-	}
-
-	smf_t* test_smf = smf_load(f);
-	fclose(f);
-
-	const bool success = (test_smf != NULL);
-	smf_delete(test_smf);
-
-	return success;
+	SMF smf;
+	return smf.open (path) == 0;
 }
 
 /** Attempt to open the SMF file for reading and/or writing.
+ *
+ * This reads the chunk headers and scans the track once to index it,
+ * events are not kept in memory.
  *
  * \return  0 on success
- *         -1 if the file can not be opened or created
+ *         -1 if the file can not be opened or is not a valid SMF
  *         -2 if the file exists but specified track does not exist
  */
 int
@@ -114,62 +168,28 @@ SMF::open(const std::string& path, int track) THROW_FILE_ERROR
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
 
-	_type0 = false;
-	_type0channels.clear ();
-
 	assert(track >= 1);
-	if (_smf) {
-		smf_delete(_smf);
-	}
+	close_unlocked ();
 
-	FILE* f = g_fopen(path.c_str(), "r");
-	if (f == 0) {
-		return -1;
-	} else if ((_smf = smf_load(f)) == 0) {
-		fclose(f);
+	_file_path = path;
+
+	if (!read_file () || read_header ()) {
+		close_unlocked ();
 		return -1;
-	} else if ((_smf_track = smf_get_track_by_number(_smf, track)) == 0) {
-		fclose(f);
-		return -2;
 	}
 
-	//cerr << "Track " << track << " # events: " << _smf_track->number_of_events << endl;
-	if (_smf_track->number_of_events == 0) {
-		_smf_track->next_event_number = 0;
-		_empty = true;
-	} else {
-		_smf_track->next_event_number = 1;
-		_empty = false;
-	}
-
-	fclose(f);
-
-	lm.release ();
-	if (_smf->format == 0 && _smf->number_of_tracks == 1 && !_empty) {
-		// type-0 file: scan file for # of used channels.
-		int ret;
-		uint32_t delta_t = 0;
-		uint32_t size    = 0;
-		uint8_t* buf     = NULL;
-		event_id_t event_id = 0;
-		seek_to_start();
-		while ((ret = read_event (&delta_t, &size, &buf, &event_id)) >= 0) {
-			if (ret == 0) {
-				continue;
-			}
-			if (size == 0) {
-				break;
-			}
-			uint8_t type = buf[0] & 0xf0;
-			uint8_t chan = buf[0] & 0x0f;
-			if (type < 0x80 || type > 0xE0) {
-				continue;
-			}
-			_type0channels.insert(chan);
-		}
-		_type0 = true;
-		seek_to_start();
+	if (track > (int) _tracks.size ()) {
+		return -2;
 	}
+
+	_track = track - 1;
+	_pos.offset = _tracks[_track].offset;
+
+	// type-0 file: scan file for # of used channels.
+	const bool type0 = _format == 0 && _tracks.size () == 1;
+	_empty = index_track (type0 ? &_type0channels : 0) == 0;
+	_type0 = type0 && !_empty;
+
 	return 0;
 }
 
@@ -186,81 +206,438 @@ SMF::create(const std::string& path, int track, uint16_t ppqn) THROW_FILE_ERROR
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
 
 	assert(track >= 1);
-	if (_smf) {
-		smf_delete(_smf);
+	close_unlocked ();
+
+	if (ppqn == 0 || (ppqn & 0x8000)) {
+		return -1;
 	}
 
-	_smf = smf_new();
+	/* put a stub file on disk */
 
-	if (_smf == NULL) {
+	FILE* f = g_fopen (path.c_str(), "wb");
+	if (f == 0) {
 		return -1;
 	}
 
-	if (smf_set_ppqn(_smf, ppqn) != 0) {
+	static const uint8_t empty_track[] = { 'M', 'T', 'r', 'k', 0, 0, 0, 4, 0, 0xff, 0x2f, 0 };
+
+	bool ok = write_mthd (f, track > 1 ? 1 : 0, track, ppqn);
+	for (int i = 0; ok && i < track; ++i) {
+		ok = fwrite (empty_track, 1, sizeof (empty_track), f) == sizeof (empty_track);
+	}
+	if (fclose (f) != 0 || !ok) {
 		return -1;
 	}
 
+	_file_path = path;
+	_format = track > 1 ? 1 : 0;
+	_ppqn = ppqn;
+
 	for (int i = 0; i < track; ++i) {
-		_smf_track = smf_track_new();
-		if (!_smf_track) {
-			return -2;
+		_tracks.push_back (Track (mthd_size + i * sizeof (empty_track) + 8, 4));
+	}
+
+	_track = track - 1;
+	_pos.offset = _tracks[_track].offset;
+
+	_empty = true;
+
+	return 0;
+}
+
+void
+SMF::close() THROW_FILE_ERROR
+{
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+	close_unlocked ();
+}
+
+void
+SMF::close_unlocked ()
+{
+	if (_writing && (_write_file || !_pending.empty ())) {
+		/* do not leave a truncated track behind */
+		if (!finish_track ()) {
+			cerr << "WARNING: SMF could not complete " << _file_path << endl;
 		}
-		smf_add_track(_smf, _smf_track);
 	}
 
-	_smf_track = smf_get_track_by_number(_smf, track);
-	if (!_smf_track)
-		return -2;
+	/* begin_write() could not start the temporary file */
+	discard_write ();
 
-	_smf_track->next_event_number = 0;
+	if (_file) {
+		fclose (_file);
+		_file = 0;
+	}
+	if (_write_file) {
+		fclose (_write_file);
+		_write_file = 0;
+	}
+	if (_smf) {
+		smf_delete (_smf);
+		_smf = 0;
+	}
 
-	{
-		/* put a stub file on disk */
+	_file_path.clear ();
+	_format = 0;
+	_ppqn = 0;
+	_tracks.clear ();
+	_track = -1;
+	_pos = Position ();
+	_buffer.clear ();
+	_buffer_size = 0;
+	_index.clear ();
+	_indexed_track = -1;
+	_duration = 0;
+	_writing = false;
+	_pending.clear ();
+	_type0 = false;
+	_type0channels.clear ();
+}
+
+void
+SMF::set_file_path (std::string const & path)
+{
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+
+	/* reopen for reading when needed. A write in progress goes on in
+	 * its temporary file, which end_write() moves to the new path.
+	 */
+	if (_file) {
+		fclose (_file);
+		_file = 0;
+	}
+	_buffer_size = 0;
+	_file_path = path;
+}
 
-		FILE* f = g_fopen (path.c_str(), "w+");
-		if (f == 0) {
+FILE*
+SMF::read_file () const
+{
+	if (!_file && !_file_path.empty ()) {
+		_file = g_fopen (data_path ().c_str(), "rb");
+		_buffer_size = 0;
+	}
+	return _file;
+}
+
+/** @return the path of the file holding the current data, which is the
+ * temporary file while a write is in progress.
+ */
+std::string const &
+SMF::data_path () const
+{
+	return _write_path.empty () ? _file_path : _write_path;
+}
+
+/** Read the header chunk and find the track chunks.
+ * \return 0 on success
+ */
+int
+SMF::read_header ()
+{
+	uint8_t h[mthd_size];
+
+	if (!read_bytes (0, h, mthd_size) || memcmp (h, "MThd", 4)) {
+		return -1;
+	}
+
+	const uint32_t length = read_be (&h[4], 4);
+	const uint16_t n_tracks = read_be (&h[10], 2);
+	const uint16_t division = read_be (&h[12], 2);
+
+	if (length < 6 || division == 0 || (division & 0x8000)) {
+		/* SMPTE based time is not supported */
+		return -1;
+	}
+
+	_format = read_be (&h[8], 2);
+	_ppqn = division;
+
+	if (fseek (_file, 0, SEEK_END)) {
+		return -1;
+	}
+	const long file_size = ftell (_file);
+
+	long offset = 8 + length;
+
+	while (_tracks.size () < n_tracks && offset + 8 <= file_size) {
+		uint8_t c[8];
+		if (!read_bytes (offset, c, 8)) {
 			return -1;
 		}
+		offset += 8;
+
+		const long chunk_length = read_be (&c[4], 4);
+
+		if (!memcmp (c, "MTrk", 4)) {
+			/* tolerate files which end early */
+			_tracks.push_back (Track (offset, std::min (chunk_length, file_size - offset)));
+		}
+
+		offset += chunk_length;
+	}
 
-		if (smf_save (_smf, f)) {
-			fclose (f);
+	return 0;
+}
+
+/** @return the byte at @param offset in the file, or -1 */
+int
+SMF::byte_at (long offset) const
+{
+	if (offset < _buffer_offset || offset >= _buffer_offset + (long) _buffer_size) {
+		if (!read_file () || fseek (_file, offset, SEEK_SET)) {
+			return -1;
+		}
+		_buffer.resize (read_buffer_size);
+		_buffer_offset = offset;
+		_buffer_size = fread (&_buffer[0], 1, read_buffer_size, _file);
+		if (_buffer_size == 0) {
 			return -1;
 		}
-		fclose (f);
 	}
+	return _buffer[offset - _buffer_offset];
+}
 
-	_empty = true;
-	_type0 = false;
-	_type0channels.clear ();
+bool
+SMF::read_bytes (long offset, uint8_t* buf, size_t size) const
+{
+	for (size_t i = 0; i < size; ++i) {
+		const int b = byte_at (offset + i);
+		if (b < 0) {
+			return false;
+		}
+		buf[i] = b;
+	}
+	return true;
+}
 
-	return 0;
+bool
+SMF::read_vlq (long& offset, uint32_t& value) const
+{
+	value = 0;
+	for (int i = 0; i < 4; ++i) {
+		const int b = byte_at (offset++);
+		if (b < 0) {
+			return false;
+		}
+		value = (value << 7) | (b & 0x7f);
+		if (!(b & 0x80)) {
+			return true;
+		}
+	}
+	return false;
 }
 
-void
-SMF::close() THROW_FILE_ERROR
+/** Read the event at @param pos in @param track into _event, and move
+ * @param pos past it.
+ *
+ * Events are stored as libsmf would: meta-events including their type
+ * and length, SysEx including the leading 0xF0, and escaped (0xF7)
+ * events without the escape.
+ *
+ * \return 1 for a MIDI event, 0 for a meta-event, or -1 at the end of
+ * the track or on error.
+ */
+int
+SMF::decode_event (Track const & track, Position& pos, uint32_t& delta_t) const
 {
-	Glib::Threads::Mutex::Lock lm (_smf_lock);
+	const long end = track.offset + (long) track.length;
+	long offset = pos.offset;
+	uint32_t delta;
 
-	if (_smf) {
-		smf_delete(_smf);
-		_smf = 0;
-		_smf_track = 0;
-		_type0 = false;
-		_type0channels.clear ();
+	if (pos.end || offset >= end || !read_vlq (offset, delta) || offset >= end) {
+		return -1;
+	}
+
+	const int b = byte_at (offset);
+	int ret = 1;
+
+	if (b < 0) {
+		return -1;
+	} else if (b == 0xff) {
+		const long start = offset;
+		uint32_t length;
+		offset += 2;
+		if (!read_vlq (offset, length) || offset + (long) length > end) {
+			return -1;
+		}
+		offset += length;
+		_event.resize (offset - start);
+		if (!read_bytes (start, &_event[0], _event.size ())) {
+			return -1;
+		}
+		if (_event[1] == 0x2f) { // End Of Track
+			pos.end = true;
+		}
+		ret = 0;
+	} else if (b == 0xf0 || b == 0xf7) {
+		uint32_t length;
+		++offset;
+		if (!read_vlq (offset, length) || offset + (long) length > end) {
+			return -1;
+		}
+		_event.clear ();
+		if (b == 0xf0) {
+			_event.push_back (0xf0);
+		}
+		if (_event.size () + length == 0) {
+			return -1;
+		}
+		const size_t start = _event.size ();
+		_event.resize (start + length);
+		if (length > 0 && !read_bytes (offset, &_event[start], length)) {
+			return -1;
+		}
+		offset += length;
+	} else {
+		uint8_t status = pos.status;
+		if (b & 0x80) {
+			status = b;
+			++offset;
+		}
+		if (!(status & 0x80)) {
+			return -1;
+		}
+		switch (status) {
+		case 0xf4: case 0xf5: case 0xf9: case 0xfd:
+			/* undefined */
+			return -1;
+		default:
+			break;
+		}
+		const int size = midi_event_size (status);
+		if (size < 1 || offset + size - 1 > end) {
+			return -1;
+		}
+		_event.resize (size);
+		_event[0] = status;
+		if (size > 1 && !read_bytes (offset, &_event[1], size - 1)) {
+			return -1;
+		}
+		offset += size - 1;
+		if (status < 0xf0) {
+			pos.status = status;
+		}
 	}
+
+	pos.offset = offset;
+	pos.time += delta;
+	delta_t = delta;
+
+	return ret;
+}
+
+/** Scan the current track, to make the seek index and find its duration.
+ * @param channels if non-null, the channels of all channel messages are added to it.
+ * \return the number of events in the track (including meta-events)
+ */
+size_t
+SMF::index_track (std::set<uint8_t>* channels) const
+{
+	Track const & track (_tracks[_track]);
+	Position pos;
+	pos.offset = track.offset;
+
+	size_t n = 0;
+	uint32_t delta_t;
+	int ret;
+
+	_index.clear ();
+
+	for (;;) {
+		if (n % index_interval == 0) {
+			_index.push_back (pos);
+		}
+		if ((ret = decode_event (track, pos, delta_t)) < 0) {
+			break;
+		}
+		++n;
+		if (ret > 0 && channels) {
+			const uint8_t type = _event[0] & 0xf0;
+			if (type >= 0x80 && type <= 0xE0) {
+				channels->insert (_event[0] & 0x0f);
+			}
+		}
+	}
+
+	_duration = pos.time;
+	_indexed_track = _track;
+
+	return n;
 }
 
 void
 SMF::seek_to_start() const
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
-	if (_smf_track) {
-		_smf_track->next_event_number = std::min(_smf_track->number_of_events, (size_t)1);
+	if (_track >= 0) {
+		_pos = Position ();
+		_pos.offset = _tracks[_track].offset;
 	} else {
 		cerr << "WARNING: SMF seek_to_start() with no track" << endl;
 	}
 }
 
+uint64_t
+SMF::seek_to_time (uint64_t ticks) const
+{
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+
+	if (_track < 0) {
+		cerr << "WARNING: SMF seek_to_time() with no track" << endl;
+		return 0;
+	}
+
+	if (_indexed_track != _track) {
+		index_track ();
+	}
+
+	/* start from the last indexed position before @param ticks; all
+	 * events before it are earlier, and the first event at or after
+	 * @param ticks comes before the next indexed position.
+	 */
+	size_t lo = 0;
+	size_t hi = _index.size ();
+	while (lo < hi) {
+		const size_t mid = (lo + hi) / 2;
+		if (_index[mid].time < ticks) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	Track const & track (_tracks[_track]);
+	Position pos = _index[lo > 0 ? lo - 1 : 0];
+	uint32_t delta_t;
+
+	for (;;) {
+		Position next = pos;
+		if (decode_event (track, next, delta_t) < 0 || next.time >= ticks) {
+			break;
+		}
+		pos = next;
+	}
+
+	_pos = pos;
+	return pos.time;
+}
+
+uint64_t
+SMF::duration () const
+{
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+
+	if (_track < 0) {
+		return 0;
+	}
+	if (_indexed_track != _track) {
+		index_track ();
+	}
+	return _duration;
+}
+
 /** Read an event from the current position in file.
  *
  * File position MUST be at the beginning of a delta time, or this will die very messily.
@@ -283,72 +660,78 @@ SMF::read_event(uint32_t* delta_t, uint32_t* size, uint8_t** buf, event_id_t* no
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
 
-	smf_event_t* event;
-
 	assert(delta_t);
 	assert(size);
 	assert(buf);
 	assert(note_id);
 
-	if ((event = smf_track_get_next_event(_smf_track)) != NULL) {
+	if (_track < 0) {
+		return -1;
+	}
+
+	uint32_t delta;
+	const int ret = decode_event (_tracks[_track], _pos, delta);
+
+	if (ret < 0) {
+		return -1;
+	}
+
+	*delta_t = delta;
 
-		*delta_t = event->delta_time_pulses;
+	if (ret == 0) {
+		*note_id = -1; // "no note id in this meta-event */
 
-		if (smf_event_is_metadata(event)) {
-			*note_id = -1; // "no note id in this meta-event */
+		const uint32_t length = _event.size ();
 
-			if (event->midi_buffer[1] == 0x7f) { // Sequencer-specific
+		if (_event[1] == 0x7f && length > 2) { // Sequencer-specific
 
-				uint32_t evsize;
-				uint32_t lenlen;
+			uint32_t evsize;
+			uint32_t lenlen;
 
-				if (smf_extract_vlq (&event->midi_buffer[2], event->midi_buffer_length-2, &evsize, &lenlen) == 0) {
+			if (smf_extract_vlq (&_event[2], length-2, &evsize, &lenlen) == 0 && length > 4+lenlen) {
 
-					if (event->midi_buffer[2+lenlen] == 0x99 &&  // Evoral
-					    event->midi_buffer[3+lenlen] == 0x1) { // Evoral Note ID
+				if (_event[2+lenlen] == 0x99 &&  // Evoral
+				    _event[3+lenlen] == 0x1) { // Evoral Note ID
 
-						uint32_t id;
-						uint32_t idlen;
+					uint32_t id;
+					uint32_t idlen;
 
-						if (smf_extract_vlq (&event->midi_buffer[4+lenlen], event->midi_buffer_length-(4+lenlen), &id, &idlen) == 0) {
-							*note_id = id;
-						}
+					if (smf_extract_vlq (&_event[4+lenlen], length-(4+lenlen), &id, &idlen) == 0) {
+						*note_id = id;
 					}
 				}
 			}
-			return 0; /* this is a meta-event */
 		}
+		return 0; /* this is a meta-event */
+	}
 
-		int event_size = event->midi_buffer_length;
-		assert(event_size > 0);
-
-		// Make sure we have enough scratch buffer
-		if (*size < (unsigned)event_size) {
-			*buf = (uint8_t*)realloc(*buf, event_size);
-		}
-		memcpy(*buf, event->midi_buffer, size_t(event_size));
-		*size = event_size;
-		if (((*buf)[0] & 0xF0) == 0x90 && (*buf)[2] == 0) {
-			/* normalize note on with velocity 0 to proper note off */
-			(*buf)[0] = 0x80 | ((*buf)[0] & 0x0F);  /* note off */
-			(*buf)[2] = 0x40;  /* default velocity */
-		}
+	int event_size = _event.size ();
+	assert(event_size > 0);
 
-		if (!midi_event_is_valid(*buf, *size)) {
-			cerr << "WARNING: SMF ignoring illegal MIDI event" << endl;
-			*size = 0;
-			return -1;
-		}
-
-		/* printf("SMF::read_event @ %u: ", *delta_t);
-		   for (size_t i = 0; i < *size; ++i) {
-		   printf("%X ", (*buf)[i]);
-		   } printf("\n") */
+	// Make sure we have enough scratch buffer
+	if (*size < (unsigned)event_size) {
+		*buf = (uint8_t*)realloc(*buf, event_size);
+	}
+	memcpy(*buf, &_event[0], size_t(event_size));
+	*size = event_size;
+	if (((*buf)[0] & 0xF0) == 0x90 && (*buf)[2] == 0) {
+		/* normalize note on with velocity 0 to proper note off */
+		(*buf)[0] = 0x80 | ((*buf)[0] & 0x0F);  /* note off */
+		(*buf)[2] = 0x40;  /* default velocity */
+	}
 
-		return event_size;
-	} else {
+	if (!midi_event_is_valid(*buf, *size)) {
+		cerr << "WARNING: SMF ignoring illegal MIDI event" << endl;
+		*size = 0;
 		return -1;
 	}
+
+	/* printf("SMF::read_event @ %u: ", *delta_t);
+	   for (size_t i = 0; i < *size; ++i) {
+	   printf("%X ", (*buf)[i]);
+	   } printf("\n") */
+
+	return event_size;
 }
 
 void
@@ -370,7 +753,14 @@ SMF::append_event_delta(uint32_t delta_t, uint32_t size, const uint8_t* buf, eve
 		return;
 	}
 
-	smf_event_t* event;
+	assert(_writing);
+
+	if (_n_written % index_interval == 0 && _indexed_track == _track) {
+		Position pos;
+		pos.offset = _write_offset + _pending.size ();
+		pos.time = _write_time;
+		_index.push_back (pos);
+	}
 
 	/* XXX july 2010: currently only store event ID's for notes, program changes and bank changes
 	 */
@@ -385,61 +775,236 @@ SMF::append_event_delta(uint32_t delta_t, uint32_t size, const uint8_t* buf, eve
 	                       );
 
 	if (store_id && note_id >= 0) {
-		int idlen;
-		int lenlen;
-		uint8_t idbuf[16];
-		uint8_t lenbuf[16];
-
-		event = smf_event_new ();
-		assert(event != NULL);
+		unsigned char idbuf[16];
 
 		/* generate VLQ representation of note ID */
-		idlen = smf_format_vlq (idbuf, sizeof(idbuf), note_id);
+		const int idlen = smf_format_vlq (idbuf, sizeof(idbuf), note_id);
+
+		append_vlq (_pending, 0);
+		_pending.push_back (0xff); // Meta-event
+		_pending.push_back (0x7f); // Sequencer-specific
+		/* the meta event length is the idlen + 2 bytes (Evoral type ID plus Note ID type) */
+		append_vlq (_pending, idlen + 2);
+		_pending.push_back (0x99); // Evoral type ID
+		_pending.push_back (0x1);  // Evoral type Note ID
+		_pending.insert (_pending.end(), idbuf, idbuf + idlen);
+	}
+
+	append_vlq (_pending, delta_t);
+
+	if (buf[0] == 0xf0) {
+		/* SysEx: the length follows the status byte */
+		_pending.push_back (0xf0);
+		append_vlq (_pending, size - 1);
+		_pending.insert (_pending.end(), buf + 1, buf + size);
+	} else if (buf[0] > 0xf0) {
+		/* other system messages are escaped, as libsmf does */
+		_pending.push_back (0xf7);
+		append_vlq (_pending, size);
+		_pending.insert (_pending.end(), buf, buf + size);
+	} else {
+		_pending.insert (_pending.end(), buf, buf + size);
+	}
+
+	_write_time += delta_t;
+	_duration = _write_time;
+	++_n_written;
+	_empty = false;
+
+	if (_pending.size () > write_buffer_size && !write_pending ()) {
+		cerr << "WARNING: SMF could not write to " << _file_path << endl;
+	}
+}
+
+void
+SMF::begin_write()
+{
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+
+	assert(_tracks.size () == 1);
 
-		/* generate VLQ representation of meta event length,
-		   which is the idlen + 2 bytes (Evoral type ID plus Note ID type)
-		*/
+	if (_write_file) {
+		fclose (_write_file);
+		_write_file = 0;
+	}
 
-		lenlen = smf_format_vlq (lenbuf, sizeof(lenbuf), idlen+2);
+	/* an earlier write which was never finished */
+	discard_write ();
 
-		event->midi_buffer_length = 2 + lenlen + 2 + idlen;
-		/* this should be allocated by malloc(3) because libsmf will
-		   call free(3) on it
-		*/
-		event->midi_buffer = (uint8_t*) malloc (sizeof(uint8_t) * event->midi_buffer_length);
+	/* start a new file with a single, empty track; its length and
+	 * End Of Track are written when events are flushed. It replaces
+	 * the file only when the track is finished, so that the file is
+	 * intact if writing fails or is never finished.
+	 */
 
-		event->midi_buffer[0] = 0xff; // Meta-event
-		event->midi_buffer[1] = 0x7f; // Sequencer-specific
-		memcpy (&event->midi_buffer[2], lenbuf, lenlen);
-		event->midi_buffer[2+lenlen] = 0x99; // Evoral type ID
-		event->midi_buffer[3+lenlen] = 0x1;  // Evoral type Note ID
-		memcpy (&event->midi_buffer[4+lenlen], idbuf, idlen);
+	static const uint8_t track_header[] = { 'M', 'T', 'r', 'k', 0, 0, 0, 0 };
 
-		assert(_smf_track);
-		smf_track_add_event_delta_pulses(_smf_track, event, 0);
+	if (_file) {
+		/* reads come from the new file from now on */
+		fclose (_file);
+		_file = 0;
 	}
 
-	event = smf_event_new_from_pointer(buf, size);
-	assert(event != NULL);
+	_write_path = _file_path + ".tmp";
+	_write_file = g_fopen (_write_path.c_str(), "wb");
 
-	assert(_smf_track);
-	smf_track_add_event_delta_pulses(_smf_track, event, delta_t);
-	_empty = false;
+	if (!_write_file
+	    || !write_mthd (_write_file, 0, 1, _ppqn)
+	    || fwrite (track_header, 1, sizeof (track_header), _write_file) != sizeof (track_header)) {
+		cerr << "WARNING: SMF could not write to " << _write_path << endl;
+	}
+
+	_format = 0;
+	_tracks[0] = Track (events_offset, 0);
+	_track = 0;
+
+	_writing = true;
+	_pending.clear ();
+	_write_offset = events_offset;
+	_write_time = 0;
+	_n_written = 0;
+
+	_pos = Position ();
+	_pos.offset = events_offset;
+	_buffer_size = 0;
+	_index.assign (1, _pos);
+	_indexed_track = 0;
+	_duration = 0;
 }
 
+/** Write appended events to the file, and update the track length so that
+ * the file can be read up to here.
+ */
+bool
+SMF::write_pending ()
+{
+	if (!_write_file) {
+		/* continue after end_write() */
+		if ((_write_file = g_fopen (data_path ().c_str(), "r+b")) == 0) {
+			return false;
+		}
+	}
+
+	if (fseek (_write_file, _write_offset, SEEK_SET)) {
+		return false;
+	}
+
+	if (!_pending.empty ()) {
+		if (fwrite (&_pending[0], 1, _pending.size (), _write_file) != _pending.size ()) {
+			return false;
+		}
+		_write_offset += _pending.size ();
+		_pending.clear ();
+	}
+
+	_buffer_size = 0;
+
+	return write_track_length (_write_offset - events_offset);
+}
+
+bool
+SMF::write_track_length (uint32_t length)
+{
+	uint8_t buf[4];
+	write_be (buf, length, 4);
+
+	if (fseek (_write_file, mthd_size + 4, SEEK_SET)
+	    || fwrite (buf, 1, 4, _write_file) != 4
+	    || fflush (_write_file)) {
+		return false;
+	}
+
+	_tracks[0].length = length;
+	return true;
+}
+
+/** Write appended events and End Of Track, close the file and replace the
+ * file with it if it is the temporary file started by begin_write(). Further
+ * events are appended (in place) before the End Of Track, as before
+ * end_write().
+ */
+bool
+SMF::finish_track ()
+{
+	static const uint8_t eot[] = { 0, 0xff, 0x2f, 0 };
+
+	bool ok = write_pending ()
+		&& fseek (_write_file, _write_offset, SEEK_SET) == 0
+		&& fwrite (eot, 1, sizeof (eot), _write_file) == sizeof (eot)
+		&& write_track_length (_write_offset + sizeof (eot) - events_offset);
+
+	if (_write_file && fclose (_write_file)) {
+		ok = false;
+	}
+	_write_file = 0;
+
+	if (!ok) {
+		/* leave the file as it was */
+		discard_write ();
+		return false;
+	}
+
+	return commit_write ();
+}
+
+/** Move the temporary file written since begin_write() over the file */
+bool
+SMF::commit_write ()
+{
+	if (_write_path.empty ()) {
+		return true;
+	}
+
+	if (_file) {
+		fclose (_file);
+		_file = 0;
+	}
+	_buffer_size = 0;
+
+#ifdef PLATFORM_WINDOWS
+	/* rename() does not replace an existing file there */
+	g_unlink (_file_path.c_str());
+#endif
+
+	if (g_rename (_write_path.c_str(), _file_path.c_str())) {
+		discard_write ();
+		return false;
+	}
+
+	_write_path.clear ();
+	return true;
+}
+
+/** Remove the temporary file of an unfinished write, if any */
 void
-SMF::begin_write()
+SMF::discard_write ()
 {
-	Glib::Threads::Mutex::Lock lm (_smf_lock);
+	if (_write_path.empty ()) {
+		return;
+	}
 
-	assert(_smf_track);
-	smf_track_delete(_smf_track);
+	if (_write_file) {
+		fclose (_write_file);
+		_write_file = 0;
+	}
+	if (_file) {
+		fclose (_file);
+		_file = 0;
+	}
+	_buffer_size = 0;
 
-	_smf_track = smf_track_new();
-	assert(_smf_track);
+	g_unlink (_write_path.c_str());
+	_write_path.clear ();
+}
 
-	smf_add_track(_smf, _smf_track);
-	assert(_smf->number_of_tracks == 1);
+void
+SMF::flush ()
+{
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+
+	if (_writing && !_pending.empty () && !write_pending ()) {
+		cerr << "WARNING: SMF could not write to " << _file_path << endl;
+	}
 }
 
 void
@@ -447,21 +1012,14 @@ SMF::end_write(string const & path) THROW_FILE_ERROR
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
 
-	if (!_smf) {
+	if (!_writing || (!_write_file && _pending.empty ())) {
+		/* nothing written since the last call */
 		return;
 	}
 
-	FILE* f = g_fopen (path.c_str(), "w+");
-	if (f == 0) {
+	if (!finish_track ()) {
 		throw FileError (path);
 	}
-
-	if (smf_save(_smf, f) != 0) {
-		fclose(f);
-		throw FileError (path);
-	}
-
-	fclose(f);
 }
 
 double
@@ -472,53 +1030,56 @@ SMF::round_to_file_precision (double val) const
 	return round (val * div) / div;
 }
 
-void
-SMF::track_names(vector<string>& names) const
+
+/** @return the text of the last meta-event of @param type in @param track */
+std::string
+SMF::track_text (Track const & track, uint8_t type) const
 {
-	if (!_smf) {
-		return;
+	Position pos;
+	pos.offset = track.offset;
+
+	string text;
+	uint32_t delta_t;
+	int ret;
+
+	while ((ret = decode_event (track, pos, delta_t)) >= 0) {
+		if (ret > 0 || _event[1] != type) {
+			continue;
+		}
+
+		uint32_t length;
+		uint32_t lenlen;
+
+		if (smf_extract_vlq (&_event[2], _event.size () - 2, &length, &lenlen) == 0
+		    && 2 + lenlen + length <= _event.size ()) {
+			text.assign ((char const *) &_event[2 + lenlen], length);
+		}
 	}
 
+	return text;
+}
+
+void
+SMF::track_names(vector<string>& names) const
+{
 	names.clear ();
 
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
 
-	for (uint16_t n = 0; n < _smf->number_of_tracks; ++n) {
-		smf_track_t* trk = smf_get_track_by_number (_smf, n+1);
-		if (!trk) {
-			names.push_back (string());
-		} else {
-			if (trk->name) {
-				names.push_back (trk->name);
-			} else {
-				names.push_back (string());
-			}
-		}
+	for (vector<Track>::const_iterator t = _tracks.begin(); t != _tracks.end(); ++t) {
+		names.push_back (track_text (*t, 0x03)); // Sequence/Track Name
 	}
 }
 
 void
 SMF::instrument_names(vector<string>& names) const
 {
-	if (!_smf) {
-		return;
-	}
-
 	names.clear ();
 
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
 
-	for (uint16_t n = 0; n < _smf->number_of_tracks; ++n) {
-		smf_track_t* trk = smf_get_track_by_number (_smf, n+1);
-		if (!trk) {
-			names.push_back (string());
-		} else {
-			if (trk->instrument) {
-				names.push_back (trk->instrument);
-			} else {
-				names.push_back (string());
-			}
-		}
+	for (vector<Track>::const_iterator t = _tracks.begin(); t != _tracks.end(); ++t) {
+		names.push_back (track_text (*t, 0x04)); // Instrument Name
 	}
 }
 
@@ -533,16 +1094,39 @@ SMF::Tempo::Tempo (smf_tempo_t* smft)
 {
 }
 
+/** Parse the whole file with libsmf, for its tempo map. This is only
+ * needed when importing, so it is not done by open().
+ */
+void
+SMF::load_tempo_map () const
+{
+	if (_smf || _file_path.empty ()) {
+		return;
+	}
+
+	FILE* f = g_fopen (_file_path.c_str(), "rb");
+	if (f) {
+		_smf = smf_load (f);
+		fclose (f);
+	}
+}
+
 int
 SMF::num_tempos () const
 {
-	assert (_smf);
-	return smf_get_tempo_count (_smf);
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+	load_tempo_map ();
+	return _smf ? smf_get_tempo_count (_smf) : 0;
 }
 
 SMF::Tempo*
 SMF::tempo_at_smf_pulse (size_t smf_pulse) const
 {
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+	load_tempo_map ();
+	if (!_smf) {
+		return 0;
+	}
 	smf_tempo_t* t = smf_get_tempo_by_seconds (_smf, smf_pulse);
 	if (!t) {
 		return 0;
@@ -553,6 +1137,11 @@ SMF::tempo_at_smf_pulse (size_t smf_pulse) const
 SMF::Tempo*
 SMF::tempo_at_seconds (double seconds) const
 {
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+	load_tempo_map ();
+	if (!_smf) {
+		return 0;
+	}
 	smf_tempo_t* t = smf_get_tempo_by_seconds (_smf, seconds);
 	if (!t) {
 		return 0;
@@ -563,7 +1152,11 @@ SMF::tempo_at_seconds (double seconds) const
 SMF::Tempo*
 SMF::nth_tempo (size_t n) const
 {
-	assert (_smf);
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+	load_tempo_map ();
+	if (!_smf) {
+		return 0;
+	}
 
 	smf_tempo_t* t = smf_get_tempo_by_number (_smf, n);
 	if (!t) {
@@ -472,3 +472,38 @@ CurveTest::constrainedCubic ()
 		CPPUNIT_ASSERT_DOUBLES_EQUAL(v, g[x], 0.000008);
 	}
 }
+
+void
+CurveTest::writePassThinning ()
+{
+	boost::shared_ptr<Evoral::ControlList> whole = TestCtrlList();
+	boost::shared_ptr<Evoral::ControlList> incremental = TestCtrlList();
+
+	whole->set_interpolation (ControlList::Linear);
+	incremental->set_interpolation (ControlList::Linear);
+	incremental->set_write_pass_thinning (20.0);
+
+	// record a ramp, a plateau and a step, as the automation watch would
+	ControlList* lists[] = { whole.get (), incremental.get () };
+	for (int l = 0; l < 2; ++l) {
+		lists[l]->start_write_pass (0);
+		lists[l]->set_in_write_pass (true);
+		for (int i = 0; i <= 400; ++i) {
+			const double when = i * 100.0;
+			const double value = i < 100 ? i / 100.0 : (i < 300 ? 1.0 : 0.5);
+			lists[l]->add (when, value, false);
+		}
+		lists[l]->write_pass_finished (40000.0, 20.0);
+	}
+
+	// thinned to roughly the corners, but not more than the whole list
+	CPPUNIT_ASSERT (incremental->events ().size () <= whole->events ().size ());
+	CPPUNIT_ASSERT (incremental->events ().size () < 10);
+
+	for (int i = 0; i <= 400; ++i) {
+		const double when = i * 100.0;
+		CPPUNIT_ASSERT_DOUBLES_EQUAL (whole->unlocked_eval (when), incremental->unlocked_eval (when), 0.02);
+	}
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (0.5, incremental->unlocked_eval (40000.0), 1e-9);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (1.0, incremental->unlocked_eval (25000.0), 1e-9);
+}
@@ -1,5 +1,7 @@
 #include "SMFTest.hpp"
 
+#include <algorithm>
+
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
 
@@ -117,3 +119,122 @@ SMFTest::writeTest ()
 
 	// TODO: Check files are actually equivalent
 }
+
+void
+SMFTest::seekTest ()
+{
+	TestSMF smf;
+	string  testdata_path;
+	CPPUNIT_ASSERT (find_file (test_search_path (), "TakeFive.mid", testdata_path));
+	CPPUNIT_ASSERT_EQUAL (0, smf.open(testdata_path));
+
+	uint32_t delta_t = 0;
+	uint32_t size    = 0;
+	uint8_t* buf     = NULL;
+	uint64_t time    = 0;
+
+	vector<uint64_t> times;
+	while (smf.read_event(&delta_t, &size, &buf) >= 0) {
+		time += delta_t;
+		times.push_back (time);
+	}
+
+	CPPUNIT_ASSERT_EQUAL (time, smf.duration());
+
+	for (uint64_t ticks = 0; ticks <= time; ticks += 997) {
+		const uint64_t expected = *lower_bound (times.begin(), times.end(), ticks);
+		const uint64_t base = smf.seek_to_time (ticks);
+		CPPUNIT_ASSERT (base <= ticks);
+		CPPUNIT_ASSERT (smf.read_event(&delta_t, &size, &buf) >= 0);
+		CPPUNIT_ASSERT_EQUAL (expected, base + delta_t);
+	}
+
+	CPPUNIT_ASSERT_EQUAL (time, smf.seek_to_time (time + 1));
+	CPPUNIT_ASSERT (smf.read_event(&delta_t, &size, &buf) < 0);
+
+	free (buf);
+}
+
+void
+SMFTest::appendTest ()
+{
+	TestSMF out;
+	const string output_dir_path = PBD::tmp_writable_directory (PACKAGE, "appendTest");
+	const string new_file_path   = Glib::build_filename (output_dir_path, "Append.mid");
+	CPPUNIT_ASSERT_EQUAL (0, out.create(new_file_path, 1, 1920));
+	out.begin_write();
+
+	uint8_t note[3] = { 0x90, 60, 100 };
+	for (int i = 0; i < 1000; ++i) {
+		note[0] = (i % 2) ? 0x80 : 0x90;
+		out.append_event_delta(10, 3, note, i);
+	}
+	out.flush();
+
+	/* events can be read back before end_write(), but the file is
+	 * only replaced by then.
+	 */
+	CPPUNIT_ASSERT_EQUAL (uint64_t(4990), out.seek_to_time (4995));
+	TestSMF in;
+	CPPUNIT_ASSERT_EQUAL (0, in.open(new_file_path));
+	CPPUNIT_ASSERT_EQUAL (uint64_t(0), in.duration());
+
+	out.end_write(new_file_path);
+
+	/* appending after end_write() continues the track */
+	out.append_event_delta(10, 3, note, 1000);
+	out.end_write(new_file_path);
+
+	CPPUNIT_ASSERT_EQUAL (0, in.open(new_file_path));
+	CPPUNIT_ASSERT_EQUAL (uint64_t(10010), in.duration());
+
+	uint32_t delta_t = 0;
+	uint32_t size    = 0;
+	uint8_t* buf     = NULL;
+	int      n_notes = 0;
+	int      ret;
+	while ((ret = in.read_event(&delta_t, &size, &buf)) >= 0) {
+		if (ret > 0) {
+			CPPUNIT_ASSERT_EQUAL (uint32_t(3), size);
+			++n_notes;
+		}
+	}
+	CPPUNIT_ASSERT_EQUAL (1001, n_notes);
+
+	free (buf);
+}
+
+void
+SMFTest::rewriteTest ()
+{
+	TestSMF out;
+	const string output_dir_path = PBD::tmp_writable_directory (PACKAGE, "rewriteTest");
+	const string new_file_path   = Glib::build_filename (output_dir_path, "Rewrite.mid");
+	CPPUNIT_ASSERT_EQUAL (0, out.create(new_file_path, 1, 1920));
+
+	uint8_t note[3] = { 0x90, 60, 100 };
+
+	out.begin_write();
+	for (int i = 0; i < 10; ++i) {
+		out.append_event_delta(10, 3, note, i);
+	}
+	out.end_write(new_file_path);
+
+	/* a new write leaves the file alone until it is finished */
+	out.begin_write();
+	for (int i = 0; i < 20; ++i) {
+		out.append_event_delta(20, 3, note, i);
+	}
+	out.flush();
+
+	TestSMF in;
+	CPPUNIT_ASSERT_EQUAL (0, in.open(new_file_path));
+	CPPUNIT_ASSERT_EQUAL (uint64_t(100), in.duration());
+	CPPUNIT_ASSERT_EQUAL (uint64_t(400), out.duration());
+
+	out.end_write(new_file_path);
+
+	CPPUNIT_ASSERT_EQUAL (0, in.open(new_file_path));
+	CPPUNIT_ASSERT_EQUAL (uint64_t(400), in.duration());
+	CPPUNIT_ASSERT (!Glib::file_test (new_file_path + ".tmp", Glib::FILE_TEST_EXISTS));
+}
@@ -55,6 +55,9 @@ class SMFTest : public CppUnit::TestFixture
 	CPPUNIT_TEST(createNewFileTest);
 	CPPUNIT_TEST(takeFiveTest);
 	CPPUNIT_TEST(writeTest);
+	CPPUNIT_TEST(seekTest);
+	CPPUNIT_TEST(appendTest);
+	CPPUNIT_TEST(rewriteTest);
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -75,6 +78,9 @@ public:
 	void createNewFileTest();
 	void takeFiveTest();
 	void writeTest();
+	void seekTest();
+	void appendTest();
+	void rewriteTest();
 
 private:
 	DummyTypeMap*     type_map;
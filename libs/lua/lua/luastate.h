@@ -33,6 +33,14 @@ public:
 
 	int do_command (std::string);
 	int do_file (std::string);
+
+	/** compile @param code without running it
+	 * @param bytecode set to the precompiled chunk, for use with do_bytecode()
+	 * @return 0 on success
+	 */
+	int compile (std::string const& code, std::string& bytecode);
+	/** run a chunk precompiled by compile(), possibly in another LuaState */
+	int do_bytecode (std::string const& bytecode);
 	void collect_garbage ();
 	void collect_garbage_step ();
 	void tweak_rt_gc ();
@@ -47,6 +55,7 @@ protected:
 private:
 	void init ();
   static int _print (lua_State *L);
+	static int _dump_writer (lua_State *L, const void* p, size_t sz, void* ud);
 	void print (std::string text);
 
 };
@@ -0,0 +1,301 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#include "pbd/arena.h"
+#include "pbd/compose.h"
+#include "pbd/debug.h"
+#include "pbd/pthread_utils.h"
+
+using namespace std;
+using namespace PBD;
+
+Arena* volatile Arena::_arenas = 0;
+
+/* Every block starts with a header saying where it has to be released to.
+ * The header is padded to header_size so that blocks stay 16-byte aligned.
+ */
+struct Arena::Header {
+	Heap*  heap; // 0 for blocks bigger than max_size, which come from malloc()
+	size_t sclass;
+};
+
+struct Arena::Heap {
+	Heap (Arena* a)
+		: arena (a)
+		, next (0)
+		, owned (1)
+	{
+		for (size_t c = 0; c < n_classes; ++c) {
+			local[c] = 0;
+			remote[c] = 0;
+			in_use[c] = 0;
+			high_water[c] = 0;
+			reserved[c] = 0;
+			exhausted[c] = 0;
+		}
+	}
+
+	Arena* arena;
+	Heap*  next;
+	gint   owned; // 0 once the owning thread has exited
+
+	/* free blocks are linked through their first word */
+	void*             local[n_classes];  // only used by the owning thread
+	volatile gpointer remote[n_classes]; // pushed to by other threads
+
+	gint in_use[n_classes];
+	gint high_water[n_classes];
+	gint reserved[n_classes];
+	gint exhausted[n_classes];
+};
+
+Arena::Arena (string const & name)
+	: _name (name)
+	, _heap (heap_orphaned)
+	, _heaps (0)
+{
+	do {
+		_next_arena = (Arena*) g_atomic_pointer_get (&_arenas);
+	} while (!g_atomic_pointer_compare_and_exchange ((volatile gpointer*) &_arenas, _next_arena, this));
+}
+
+size_t
+Arena::class_of (size_t size)
+{
+	size_t c = 0;
+	while (class_size (c) < size) {
+		++c;
+	}
+	return c;
+}
+
+void
+Arena::heap_orphaned (void* ptr)
+{
+	/* called when a thread exits; blocks may still be released into the
+	 * heap from other threads, until another thread adopts it.
+	 */
+	Heap* h = static_cast<Heap*> (ptr);
+	DEBUG_TRACE (DEBUG::Pool, string_compose ("%1 orphans its heap in arena %2\n", pthread_name(), h->arena->name()));
+	g_atomic_int_set (&h->owned, 0);
+}
+
+Arena::Heap*
+Arena::adopt_heap ()
+{
+	for (Heap* h = (Heap*) g_atomic_pointer_get (&_heaps); h; h = h->next) {
+		if (g_atomic_int_compare_and_exchange (&h->owned, 0, 1)) {
+			DEBUG_TRACE (DEBUG::Pool, string_compose ("%1 adopts an orphaned heap in arena %2\n", pthread_name(), _name));
+			return h;
+		}
+	}
+
+	Heap* h = new Heap (this);
+
+	do {
+		h->next = (Heap*) g_atomic_pointer_get (&_heaps);
+	} while (!g_atomic_pointer_compare_and_exchange ((volatile gpointer*) &_heaps, h->next, h));
+
+	DEBUG_TRACE (DEBUG::Pool, string_compose ("%1 creates a heap in arena %2\n", pthread_name(), _name));
+	return h;
+}
+
+Arena::Heap*
+Arena::heap ()
+{
+	Heap* h = _heap.get ();
+
+	if (!h) {
+		h = adopt_heap ();
+		_heap.set (h);
+	}
+
+	return h;
+}
+
+bool
+Arena::has_heap () const
+{
+	return _heap.get () != 0;
+}
+
+void
+Arena::grow (Heap* h, size_t c, guint n)
+{
+	size_t const block_size = header_size + class_size (c);
+
+	/* slabs are never returned, because blocks from them may be on any
+	 * heap's remote list at any time.
+	 */
+	char* slab = (char*) malloc (n * block_size);
+
+	if (!slab) {
+		throw std::bad_alloc ();
+	}
+
+	for (guint i = 0; i < n; ++i) {
+		Header* hdr = (Header*) (slab + i * block_size);
+		hdr->heap = h;
+		hdr->sclass = c;
+
+		void* ptr = (char*) hdr + header_size;
+		*(void**) ptr = h->local[c];
+		h->local[c] = ptr;
+	}
+
+	g_atomic_int_add (&h->reserved[c], n);
+}
+
+void
+Arena::reserve (size_t size, guint n)
+{
+	if (size > max_size) {
+		return;
+	}
+
+	Heap* h = heap ();
+	size_t const c = class_of (size);
+	guint const r = g_atomic_int_get (&h->reserved[c]);
+
+	if (r < n) {
+		grow (h, c, n - r);
+	}
+}
+
+void*
+Arena::alloc (size_t size)
+{
+	if (size > max_size) {
+		Header* hdr = (Header*) malloc (header_size + size);
+		if (!hdr) {
+			throw std::bad_alloc ();
+		}
+		hdr->heap = 0;
+		hdr->sclass = 0;
+		return (char*) hdr + header_size;
+	}
+
+	Heap* h = heap ();
+	size_t const c = class_of (size);
+	void* ptr = h->local[c];
+
+	if (!ptr) {
+		/* take over everything that other threads released into this heap */
+		do {
+			ptr = g_atomic_pointer_get (&h->remote[c]);
+		} while (ptr && !g_atomic_pointer_compare_and_exchange (&h->remote[c], ptr, 0));
+	}
+
+	if (!ptr) {
+		guint const r = g_atomic_int_get (&h->reserved[c]);
+		DEBUG_TRACE (DEBUG::Pool, string_compose ("%1 exhausted %2 blocks of %3 bytes in arena %4\n", pthread_name(), r, class_size (c), _name));
+		g_atomic_int_inc (&h->exhausted[c]);
+		grow (h, c, max (r / 2, (guint) 16));
+		ptr = h->local[c];
+	}
+
+	h->local[c] = *(void**) ptr;
+
+	gint const u = g_atomic_int_add (&h->in_use[c], 1) + 1;
+	if (u > g_atomic_int_get (&h->high_water[c])) {
+		g_atomic_int_set (&h->high_water[c], u);
+	}
+
+	return ptr;
+}
+
+void
+Arena::release (void* ptr)
+{
+	if (!ptr) {
+		return;
+	}
+
+	Header* hdr = (Header*) ((char*) ptr - header_size);
+	Heap* h = hdr->heap;
+
+	if (!h) {
+		free (hdr);
+		return;
+	}
+
+	size_t const c = hdr->sclass;
+
+	g_atomic_int_add (&h->in_use[c], -1);
+
+	if (h->arena->_heap.get () == h) {
+		*(void**) ptr = h->local[c];
+		h->local[c] = ptr;
+		return;
+	}
+
+	gpointer head;
+
+	do {
+		head = g_atomic_pointer_get (&h->remote[c]);
+		*(void**) ptr = head;
+	} while (!g_atomic_pointer_compare_and_exchange (&h->remote[c], head, ptr));
+}
+
+void
+Arena::stats (vector<Stats>& s) const
+{
+	s.clear ();
+
+	for (size_t c = 0; c < n_classes; ++c) {
+		Stats st;
+		st.size = class_size (c);
+		st.in_use = st.high_water = st.reserved = st.exhausted = 0;
+		s.push_back (st);
+	}
+
+	for (Heap* h = (Heap*) g_atomic_pointer_get (&_heaps); h; h = h->next) {
+		for (size_t c = 0; c < n_classes; ++c) {
+			s[c].in_use += g_atomic_int_get (&h->in_use[c]);
+			s[c].high_water += g_atomic_int_get (&h->high_water[c]);
+			s[c].reserved += g_atomic_int_get (&h->reserved[c]);
+			s[c].exhausted += g_atomic_int_get (&h->exhausted[c]);
+		}
+	}
+}
+
+string
+Arena::report ()
+{
+	stringstream ss;
+	vector<Stats> s;
+
+	for (Arena* a = (Arena*) g_atomic_pointer_get (&_arenas); a; a = a->_next_arena) {
+		a->stats (s);
+		for (vector<Stats>::const_iterator i = s.begin(); i != s.end(); ++i) {
+			if (i->reserved == 0) {
+				continue;
+			}
+			ss << "Arena: '" << a->name() << "' " << i->size << " bytes, in use: " << i->in_use
+			   << " max: " << i->high_water << " / " << i->reserved
+			   << " exhausted: " << i->exhausted << "\n";
+		}
+	}
+
+	return ss.str ();
+}
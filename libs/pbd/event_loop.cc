@@ -39,6 +39,7 @@ Glib::Threads::Private<EventLoop> EventLoop::thread_event_loop (do_not_delete_th
 Glib::Threads::RWLock EventLoop::thread_buffer_requests_lock;
 EventLoop::ThreadRequestBufferList EventLoop::thread_buffer_requests;
 EventLoop::RequestBufferSuppliers EventLoop::request_buffer_suppliers;
+PBD::Arena EventLoop::request_arena (X_("requests"));
 
 EventLoop::EventLoop (string const& name)
 	: _name (name)
@@ -30,6 +30,7 @@
 #include <archive_entry.h>
 #include <curl/curl.h>
 
+#include "pbd/cpus.h"
 #include "pbd/failed_constructor.h"
 #include "pbd/file_archive.h"
 #include "pbd/file_utils.h"
@@ -385,12 +386,24 @@ FileArchive::create (const std::map<std::string, std::string>& filemap)
 
 	a = archive_write_new ();
 	archive_write_set_format_pax_restricted (a);
-	archive_write_add_filter_lzma (a);
+	archive_write_add_filter_xz (a);
+
+	/* liblzma compresses independent blocks in parallel; this is
+	 * ignored by versions of libarchive which do not support it.
+	 */
+	char threads[16];
+	snprintf (threads, sizeof (threads), "%u", hardware_concurrency ());
+	archive_write_set_filter_option (a, "xz", "threads", threads);
+
 	archive_write_open_filename (a, _req.url);
 	entry = archive_entry_new ();
 
+	/* large reads, so that progress is not reported (and the GUI
+	 * updated) too often */
+	const size_t bufsize = 1048576;
+	char* buf = (char*) malloc (bufsize);
+
 	for (std::map<std::string, std::string>::const_iterator f = filemap.begin (); f != filemap.end (); ++f) {
-		char buf[8192];
 		const char* filepath = f->first.c_str ();
 		const char* filename = f->second.c_str ();
 
@@ -419,16 +432,17 @@ FileArchive::create (const std::map<std::string, std::string>& filemap)
 		int fd = g_open (filepath, O_RDONLY, 0444);
 		assert (fd >= 0);
 
-		ssize_t len = read (fd, buf, sizeof (buf));
+		ssize_t len = read (fd, buf, bufsize);
 		while (len > 0) {
 			read_bytes += len;
 			archive_write_data (a, buf, len);
 			progress (read_bytes, total_bytes);
-			len = read (fd, buf, sizeof (buf));
+			len = read (fd, buf, bufsize);
 		}
 		close (fd);
 	}
 
+	free (buf);
 	archive_entry_free (entry);
 	archive_write_close (a);
 	archive_write_free (a);
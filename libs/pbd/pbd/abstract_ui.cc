@@ -61,6 +61,18 @@ cleanup_request_buffer (void* ptr)
 template<typename R>
 Glib::Threads::Private<typename AbstractUI<R>::RequestBuffer> AbstractUI<R>::per_thread_request_buffer (cleanup_request_buffer<AbstractUI<R>::RequestBuffer>);
 
+template <typename RequestObject>
+AbstractUI<RequestObject>::RequestBuffer::~RequestBuffer ()
+{
+	RequestObject* req = static_cast<RequestObject*> (overflow);
+
+	while (req) {
+		RequestObject* next = static_cast<RequestObject*> (req->overflow_next);
+		delete req;
+		req = next;
+	}
+}
+
 template <typename RequestObject>
 AbstractUI<RequestObject>::AbstractUI (const string& name)
 	: BaseUI (name)
@@ -135,6 +147,13 @@ AbstractUI<RequestObject>::register_thread (pthread_t thread_id, string thread_n
 		*/
 
 		per_thread_request_buffer.set (b);
+
+		/* requests that do not fit into the buffer are allocated by
+		   this thread from the request arena; make sure that a few
+		   are there before they are needed.
+		*/
+
+		request_arena.reserve (sizeof (RequestObject), 64);
 	} else {
 		DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1 : %2 is already registered\n", event_loop_name(), thread_name));
 	}
@@ -171,9 +190,19 @@ AbstractUI<RequestObject>::get_request (RequestType rt)
 
 		rbuf->get_write_vector (&vec);
 
-		if (vec.len[0] == 0) {
-			DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1: no space in per thread pool for request of type %2\n", event_loop_name(), rt));
-			return 0;
+		if (vec.len[0] == 0 || g_atomic_pointer_get (&rbuf->overflow)) {
+
+			/* the ringbuffer is full, or requests that did not
+			 * fit into it earlier are still waiting. allocate the
+			 * request from the (lock-free) request arena instead;
+			 * ::send_request() will queue it behind them.
+			 */
+
+			DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1: no space in per thread pool for request of type %2, overflowing\n", event_loop_name(), rt));
+
+			RequestObject* req = new RequestObject;
+			req->type = rt;
+			return req;
 		}
 
 		DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1: allocated per-thread request of type %2, caller %3\n", event_loop_name(), rt, pthread_name()));
@@ -282,6 +311,28 @@ AbstractUI<RequestObject>::handle_ui_requests ()
 				i->second->increment_read_ptr (1);
 			}
 		}
+
+		if ((*i).second->dead) {
+			continue;
+		}
+
+		/* take the requests which did not fit into the ringbuffer, and
+		 * queue them (in the order they were sent) with the heap
+		 * requests below. The sending thread only goes back to using the
+		 * ringbuffer once they have been taken.
+		 */
+
+		gpointer overflow;
+
+		do {
+			overflow = g_atomic_pointer_get (&i->second->overflow);
+		} while (overflow && !g_atomic_pointer_compare_and_exchange (&i->second->overflow, overflow, 0));
+
+		typename std::list<RequestObject*>::iterator pos = request_list.end ();
+
+		for (RequestObject* req = static_cast<RequestObject*> (overflow); req; req = static_cast<RequestObject*> (req->overflow_next)) {
+			pos = request_list.insert (pos, req);
+		}
 	}
 
 	assert (rbml.locked ());
@@ -402,8 +453,25 @@ AbstractUI<RequestObject>::send_request (RequestObject *req)
 		RequestBuffer* rbuf = per_thread_request_buffer.get ();
 
 		if (rbuf != 0) {
-			DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1/%2 send per-thread request type %3 using ringbuffer @ %4 IR: %5\n", event_loop_name(), pthread_name(), req->type, rbuf, req->invalidation));
-			rbuf->increment_write_ptr (1);
+			RequestBufferVector vec;
+			rbuf->get_write_vector (&vec);
+
+			if (vec.len[0] && vec.buf[0] == req) {
+				DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1/%2 send per-thread request type %3 using ringbuffer @ %4 IR: %5\n", event_loop_name(), pthread_name(), req->type, rbuf, req->invalidation));
+				rbuf->increment_write_ptr (1);
+			} else {
+				/* ::get_request() found no space in the ringbuffer.
+				 * Push the request onto the buffer's overflow list,
+				 * without locking, so that realtime threads can
+				 * still use it.
+				 */
+				DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1/%2 send per-thread request type %3 via overflow of ringbuffer @ %4 IR: %5\n", event_loop_name(), pthread_name(), req->type, rbuf, req->invalidation));
+				gpointer head;
+				do {
+					head = g_atomic_pointer_get (&rbuf->overflow);
+					req->overflow_next = static_cast<RequestObject*> (head);
+				} while (!g_atomic_pointer_compare_and_exchange (&rbuf->overflow, head, req));
+			}
 		} else {
 			/* no per-thread buffer, so just use a list with a lock so that it remains
 			 * single-reader/single-writer semantics
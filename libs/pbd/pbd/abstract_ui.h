@@ -69,9 +69,15 @@ public:
 protected:
 	struct RequestBuffer : public PBD::RingBufferNPT<RequestObject> {
 		bool dead;
+		/** requests sent while the ring buffer was full, most recent
+		 * first, linked through their overflow_next member
+		 */
+		volatile gpointer overflow;
 		RequestBuffer (uint32_t size)
 			: PBD::RingBufferNPT<RequestObject> (size)
-			, dead (false) {}
+			, dead (false)
+			, overflow (0) {}
+		~RequestBuffer ();
 	};
 	typedef typename RequestBuffer::rw_vector RequestBufferVector;
 
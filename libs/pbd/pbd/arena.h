@@ -0,0 +1,115 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __pbd_arena_h__
+#define __pbd_arena_h__
+
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <glibmm/threads.h>
+
+#include "pbd/libpbd_visibility.h"
+
+namespace PBD {
+
+/** A lock-free allocator for objects which are created in one thread and
+ *  often destroyed in another (session events, cross-thread requests).
+ *
+ *  Every thread using an arena gets its own heap, with a free list for each
+ *  size class. Allocation only ever touches the calling thread's heap. A
+ *  block released by the thread that allocated it goes straight back onto
+ *  that thread's free list; a block released by any other thread is pushed
+ *  onto a lock-free "remote free" list of the heap it came from, which the
+ *  owning thread takes over the next time it runs out of blocks of that size.
+ *
+ *  Threads which need to allocate in a realtime context should call
+ *  reserve() first. If a heap runs out anyway it grows rather than failing,
+ *  which is not realtime-safe; this is counted, so that reservations can be
+ *  tuned using the numbers from stats().
+ *
+ *  When a thread exits its heap is orphaned, and blocks it handed out may
+ *  still be released into it. The next thread to use the arena adopts it,
+ *  so heaps are never freed: an arena is expected to live as long as the
+ *  program does.
+ */
+class LIBPBD_API Arena
+{
+public:
+	Arena (std::string const & name);
+
+	std::string name () const { return _name; }
+
+	/** Make sure that the calling thread's heap holds at least @param n
+	 *  blocks big enough for @param size bytes, creating the heap if needed.
+	 */
+	void reserve (size_t size, guint n);
+
+	/** @return true if the calling thread has a heap in this arena */
+	bool has_heap () const;
+
+	void* alloc (size_t size);
+
+	/** Release memory returned by alloc() of any arena, in any thread */
+	static void release (void* ptr);
+
+	/** largest size served from the size classes; bigger allocations go to malloc() */
+	static const size_t max_size = 2048;
+
+	struct Stats {
+		size_t size;       ///< block size of this size class
+		guint  in_use;     ///< blocks currently allocated
+		guint  high_water; ///< sum of each heap's highest in_use
+		guint  reserved;   ///< blocks reserved or grown, over all heaps
+		guint  exhausted;  ///< number of times a heap had to grow
+	};
+
+	/** Fill @param s with the statistics of each size class, summed over all heaps */
+	void stats (std::vector<Stats>& s) const;
+
+	/** @return the statistics of all arenas, one line per size class in use */
+	static std::string report ();
+
+private:
+	struct Heap;
+	struct Header;
+
+	static const size_t n_classes = 8; // 16 .. max_size bytes
+	static const size_t header_size = 16;
+
+	std::string _name;
+	mutable Glib::Threads::Private<Heap> _heap;
+	Heap* volatile _heaps; // all heaps ever created, most recent first
+	Arena* _next_arena;
+
+	static Arena* volatile _arenas;
+
+	Heap* heap ();
+	Heap* adopt_heap ();
+	void  grow (Heap*, size_t c, guint n);
+
+	static size_t class_of (size_t size);
+	static size_t class_size (size_t c) { return 16 << c; }
+	static void   heap_orphaned (void*);
+};
+
+} /* namespace */
+
+#endif /* __pbd_arena_h__ */
@@ -30,6 +30,7 @@
 #include <glibmm/threads.h>
 
 #include "pbd/libpbd_visibility.h"
+#include "pbd/arena.h"
 
 namespace PBD
 {
@@ -75,17 +76,31 @@ public:
 
 	static void* invalidate_request (void* data);
 
+	/** where requests which are not part of a per-thread request buffer
+	 * are allocated from; any thread may delete them.
+	 */
+	static PBD::Arena request_arena;
+
 	struct BaseRequestObject {
 		RequestType             type;
 		InvalidationRecord*     invalidation;
 		boost::function<void()> the_slot;
+		BaseRequestObject*      overflow_next; ///< while queued behind a full request buffer
 
-		BaseRequestObject() : invalidation (0) {}
+		BaseRequestObject() : invalidation (0), overflow_next (0) {}
 		~BaseRequestObject() {
 			if (invalidation) {
 				invalidation->unref ();
 			}
 		}
+
+		void* operator new (size_t sz) {
+			return request_arena.alloc (sz);
+		}
+
+		void operator delete (void* ptr, size_t /*size*/) {
+			PBD::Arena::release (ptr);
+		}
 	};
 
 	virtual void call_slot (InvalidationRecord*, const boost::function<void()>&) = 0;
@@ -49,13 +49,20 @@ class /*LIBPBD_API*/ RCUManager
 {
   public:
 
-	RCUManager (T* new_rcu_value) {
+	RCUManager (T* new_rcu_value) : _active_reads (0) {
 		x.m_rcu_value = new boost::shared_ptr<T> (new_rcu_value);
 	}
 
 	virtual ~RCUManager() { delete x.m_rcu_value; }
 
-	boost::shared_ptr<T> reader () const { return *((boost::shared_ptr<T> *) g_atomic_pointer_get (&x.gptr)); }
+	boost::shared_ptr<T> reader () const {
+		boost::shared_ptr<T> rv;
+		/* update() must not delete the shared_ptr<T> while we copy it */
+		g_atomic_int_inc (&_active_reads);
+		rv = *((boost::shared_ptr<T> *) g_atomic_pointer_get (&x.gptr));
+		g_atomic_int_add (&_active_reads, -1);
+		return rv;
+	}
 
 	/* this is an abstract base class - how these are implemented depends on the assumptions
 	   that one can make about the users of the RCUManager. See SerializedRCUManager below
@@ -79,6 +86,34 @@ class /*LIBPBD_API*/ RCUManager
 	    boost::shared_ptr<T>* m_rcu_value;
 	    mutable volatile gpointer gptr;
 	} x;
+
+	/** number of reader() calls copying the current value */
+	mutable volatile gint _active_reads;
+
+	/** Use an empty shared_ptr<T> as the initial value */
+	RCUManager () : _active_reads (0) {
+		x.m_rcu_value = new boost::shared_ptr<T> ();
+	}
+
+	/** Wait until no reader() can still be copying a value that has just been replaced.
+
+	    Readers only copy a shared_ptr, so this normally returns after a few
+	    iterations. But a reader may have been preempted during the copy, and
+	    if it shares a CPU with us (and has a lower priority, as when updates
+	    happen in an RT thread) spinning would keep it from ever finishing.
+	    So spin only briefly, then yield, then sleep for increasing times.
+	*/
+	void wait_for_readers () const {
+		for (unsigned int n = 0; g_atomic_int_get (&_active_reads) != 0; ++n) {
+			if (n < 64) {
+				/* spin */
+			} else if (n < 72) {
+				g_thread_yield ();
+			} else {
+				g_usleep (n < 82 ? 1 << (n - 72) : 1000);
+			}
+		}
+	}
 };
 
 
@@ -178,6 +213,7 @@ public:
 			// because dead_wood contains another shared_ptr<T> that
 			// references the same T, the underlying object lives on
 
+			RCUManager<T>::wait_for_readers ();
 			delete current_write_old;
 		}
 
@@ -199,6 +235,43 @@ private:
 	std::list<boost::shared_ptr<T> > m_dead_wood;
 };
 
+/** UnserializedRCUManager implements the RCUManager interface for users which
+   already serialize their writers, for example by holding a lock of their own
+   around write_copy()/update().
+
+   Unlike SerializedRCUManager, old values are not kept on a "dead wood" list:
+   an old value is deleted as soon as the last reader drops its reference to it,
+   in whatever thread that happens. So it is not suitable for RT readers, but
+   objects referenced from the value are not kept alive for longer than needed.
+
+   The initial value is an empty shared_ptr<T>, and update() may be given one.
+*/
+template<class T>
+class /*LIBPBD_API*/ UnserializedRCUManager : public RCUManager<T>
+{
+public:
+	UnserializedRCUManager () {}
+
+	boost::shared_ptr<T> write_copy ()
+	{
+		boost::shared_ptr<T> current (*RCUManager<T>::x.m_rcu_value);
+		return boost::shared_ptr<T> (current ? new T (*current) : new T);
+	}
+
+	bool update (boost::shared_ptr<T> new_value)
+	{
+		boost::shared_ptr<T>* old_spp = RCUManager<T>::x.m_rcu_value;
+		boost::shared_ptr<T>* new_spp = new boost::shared_ptr<T> (new_value);
+
+		g_atomic_pointer_set (&RCUManager<T>::x.gptr, (gpointer) new_spp);
+
+		RCUManager<T>::wait_for_readers ();
+		delete old_spp;
+
+		return true;
+	}
+};
+
 /** RCUWriter is a convenience object that implements write_copy/update via
    lifetime management. Creating the object obtains a writable copy, which can
    be obtained via the get_copy() method; deleting the object will update
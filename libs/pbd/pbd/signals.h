@@ -24,6 +24,7 @@
 
 #include <list>
 #include <map>
+#include <vector>
 
 #ifdef nil
 #undef nil
@@ -40,6 +41,7 @@
 
 #include "pbd/libpbd_visibility.h"
 #include "pbd/event_loop.h"
+#include "pbd/rcu.h"
 
 #ifndef NDEBUG
 #define DEBUG_PBD_SIGNAL_CONNECTIONS
@@ -78,7 +80,7 @@ protected:
 class LIBPBD_API Connection : public boost::enable_shared_from_this<Connection>
 {
 public:
-	Connection (SignalBase* b, PBD::EventLoop::InvalidationRecord* ir) : _signal (b), _invalidation_record (ir)
+	Connection (SignalBase* b, PBD::EventLoop::InvalidationRecord* ir) : _signal (b), _invalidation_record (ir), _connected (1)
 	{
 		if (_invalidation_record) {
 			_invalidation_record->ref ();
@@ -94,8 +96,14 @@ public:
 		}
 	}
 
+	/** @return false once the signal has disconnected us; emissions that
+	 *  are already in progress check this before calling the slot.
+	 */
+	bool connected () const { return g_atomic_int_get (&_connected); }
+
 	void disconnected ()
 	{
+		g_atomic_int_set (&_connected, 0);
 		if (_invalidation_record) {
 			_invalidation_record->unref ();
 		}
@@ -114,6 +122,7 @@ private:
         Glib::Threads::Mutex _mutex;
 	SignalBase* _signal;
 	PBD::EventLoop::InvalidationRecord* _invalidation_record;
+	volatile gint _connected;
 };
 
 template<typename R>
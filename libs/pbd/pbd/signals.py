@@ -104,6 +104,19 @@ def signal(f, n, v):
 	/** The slots that this signal will call on emission */
 	typedef std::map<boost::shared_ptr<Connection>, slot_function_type> Slots;
 	Slots _slots;
+
+	/** A copy of _slots which emission uses without taking _mutex or
+	    allocating. It is never modified: connecting or disconnecting
+	    publishes a new copy. It is empty until the first connection.
+	*/
+	typedef std::vector<std::pair<boost::shared_ptr<Connection>, slot_function_type> > SlotList;
+	UnserializedRCUManager<SlotList> _slot_list;
+
+	/** Copies which were replaced while an emission was still using them,
+	    kept so that the emitting thread does not have to delete them.
+	*/
+	typedef std::list<boost::shared_ptr<SlotList> > OldSlotLists;
+	OldSlotLists _old_slot_lists;
 """, file=f)
 
     print("public:", file=f)
@@ -230,30 +243,31 @@ def signal(f, n, v):
     else:
         print("\ttypename C::result_type operator() (%s)" % comma_separated(Anan), file=f)
     print("\t{", file=f)
-    print("\t\t/* First, take a copy of our list of slots as it is now */", file=f)
+    print("\t\t/* First, get our list of slots as it is now; this neither locks nor allocates */", file=f)
     print("", file=f)
-    print("\t\tSlots s;", file=f)
-    print("\t\t{", file=f)
-    print("\t\t\tGlib::Threads::Mutex::Lock lm (_mutex);", file=f)
-    print("\t\t\ts = _slots;", file=f)
-    print("\t\t}", file=f)
+    print("\t\tboost::shared_ptr<SlotList> s = _slot_list.reader ();", file=f)
     print("", file=f)
-    if not v:
+    if v:
+        print("\t\tif (!s) {", file=f)
+        print("\t\t\treturn;", file=f)
+        print("\t\t}", file=f)
+    else:
         print("\t\tstd::list<R> r;", file=f)
-    print("\t\tfor (%sSlots::const_iterator i = s.begin(); i != s.end(); ++i) {" % typename, file=f)
+        print("\t\tC c;", file=f)
+        print("", file=f)
+        print("\t\tif (!s) {", file=f)
+        print("\t\t\treturn c (r.begin(), r.end());", file=f)
+        print("\t\t}", file=f)
+    print("", file=f)
+    print("\t\tfor (%sSlotList::const_iterator i = s->begin(); i != s->end(); ++i) {" % typename, file=f)
     print("""
 			/* We may have just called a slot, and this may have resulted in
-			   disconnection of other slots from us.  The list copy means that
-			   this won't cause any problems with invalidated iterators, but we
-			   must check to see if the slot we are about to call is still on the list.
+			   disconnection of other slots from us.  The list we hold is never
+			   modified, so this won't cause any problems with invalidated
+			   iterators, but we must check that the slot we are about to call
+			   is still connected.
 			*/
-			bool still_there = false;
-			{
-				Glib::Threads::Mutex::Lock lm (_mutex);
-				still_there = _slots.find (i->first) != _slots.end ();
-			}
-
-			if (still_there) {""", file=f)
+			if (i->first->connected ()) {""", file=f)
     if v:
         print("\t\t\t\t(i->second)(%s);" % comma_separated(an), file=f)
     else:
@@ -263,7 +277,6 @@ def signal(f, n, v):
     print("", file=f)
     if not v:
         print("\t\t/* Call our combiner to do whatever is required to the result values */", file=f)
-        print("\t\tC c;", file=f)
         print("\t\treturn c (r.begin(), r.end());", file=f)
     print("\t}", file=f)
 
@@ -289,12 +302,35 @@ def signal(f, n, v):
     print("", file=f)
     print("\tfriend class Connection;", file=f)
 
+    print("""
+	/** Publish a copy of _slots for emission; the caller must hold _mutex */
+	void update_slot_list ()
+	{
+		boost::shared_ptr<SlotList> old = _slot_list.reader ();
+
+		_slot_list.update (boost::shared_ptr<SlotList> (new SlotList (_slots.begin(), _slots.end())));
+""", file=f)
+    print("\t\tfor (%sOldSlotLists::iterator i = _old_slot_lists.begin(); i != _old_slot_lists.end(); ) {" % typename, file=f)
+    print("""			if (i->unique ()) {
+				i = _old_slot_lists.erase (i);
+			} else {
+				++i;
+			}
+		}
+
+		if (old && !old.unique ()) {
+			/* an emission is still using it */
+			_old_slot_lists.push_back (old);
+		}
+	}""", file=f)
+
     print("""
 	boost::shared_ptr<Connection> _connect (PBD::EventLoop::InvalidationRecord* ir, slot_function_type f)
 	{
 		boost::shared_ptr<Connection> c (new Connection (this, ir));
 		Glib::Threads::Mutex::Lock lm (_mutex);
 		_slots[c] = f;
+		update_slot_list ();
 #ifdef DEBUG_PBD_SIGNAL_CONNECTIONS
                 if (_debug_connection) {
                         std::cerr << "+++++++ CONNECT " << this << " size now " << _slots.size() << std::endl;
@@ -310,6 +346,7 @@ def signal(f, n, v):
 		{
 			Glib::Threads::Mutex::Lock lm (_mutex);
     			_slots.erase (c);
+			update_slot_list ();
     		}
 		c->disconnected ();
 #ifdef DEBUG_PBD_SIGNAL_CONNECTIONS
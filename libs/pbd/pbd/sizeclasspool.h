@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2017 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef _sizeclasspool_h_
+#define _sizeclasspool_h_
+
+#include <string>
+
+#ifndef LIBPBD_API
+#include "pbd/libpbd_visibility.h"
+#endif
+
+#include "pbd/reallocpool.h"
+
+namespace PBD {
+
+/** A realtime-safe memory pool for allocators which know the size of
+ * the block they free (such as Lua's lua_Alloc).
+ *
+ * Small blocks, which make up most of what an interpreter allocates
+ * (strings, table headers, closures, upvalues), come from per size-class
+ * free lists without any per-block header; they are carved from a locked
+ * arena on demand. Larger blocks, and small ones once the arena is used
+ * up, are delegated to a ReallocPool.
+ */
+class LIBPBD_API SizeClassPool
+{
+public:
+	SizeClassPool (std::string name, size_t bytes);
+	~SizeClassPool ();
+
+	void set_name (const std::string& n) { _name = n; _large.set_name (n); }
+
+	static void * lalloc (void* pool, void *ptr, size_t oldsize, size_t newsize) {
+		return static_cast<SizeClassPool*>(pool)->_realloc (ptr, oldsize, newsize);
+	}
+
+	void * malloc (size_t size) {
+		return _realloc (NULL, 0, size);
+	}
+
+	/** @param size must be the size that @param ptr was allocated with */
+	void free (void *ptr, size_t size) {
+		if (ptr) _realloc (ptr, size, 0);
+	}
+
+	void * realloc (void *ptr, size_t oldsize, size_t newsize) {
+		return _realloc (ptr, oldsize, newsize);
+	}
+
+	/** largest block served from the size-class lists */
+	static const size_t max_small = 256;
+
+private:
+	static const size_t granularity = 16;
+	static const size_t n_classes = max_small / granularity;
+	static const size_t page_size = 4096;
+
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+
+	std::string _name;
+	size_t _arena_size;
+	char* _arena;
+	char* _top; // carved up to here
+
+	FreeBlock* _free[n_classes];
+	ReallocPool _large;
+
+	static size_t class_of (size_t size) { return (size - 1) / granularity; }
+	static size_t class_size (size_t c) { return (c + 1) * granularity; }
+
+	bool is_small (void* ptr) const {
+		return (char*) ptr >= _arena && (char*) ptr < _arena + _arena_size;
+	}
+
+	void* _realloc (void *ptr, size_t oldsize, size_t newsize);
+	void* small_alloc (size_t c);
+	void  small_free (void *ptr, size_t c);
+	bool  carve (size_t c);
+};
+
+} /* namespace */
+#endif // _sizeclasspool_h_
@@ -0,0 +1,280 @@
+/*
+    Copyright (C) 2017 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __libpbd_spsc_ringbuffer_h__
+#define __libpbd_spsc_ringbuffer_h__
+
+#include <cstring>
+#include <glib.h>
+
+#include "pbd/libpbd_visibility.h"
+
+namespace PBD {
+
+/** A single-producer, single-consumer ringbuffer.
+ *
+ * The size is rounded up to a power of two. Read and write indices run
+ * freely and are masked on access, so all of the buffer can be used (unlike
+ * RingBufferNPT, which keeps one element free to tell full from empty).
+ *
+ * Each index lives on a cache line of its own, together with the last value
+ * its owner has seen of the other side's index. The producer only looks at
+ * the read index (and the consumer at the write index) when the cached value
+ * does not offer enough space (or data), so in steady state each side keeps
+ * to its own cache line.
+ *
+ * Besides the copying read()/write() API this offers zero-copy access:
+ * reserve_write() and reserve_read() return up to two spans into the buffer,
+ * which are published to the other side in one go by commit_write() and
+ * commit_read().
+ *
+ * read(), reserve_read(), commit_read() and increment_read_ptr() may only be
+ * called by the consumer; write(), reserve_write(), commit_write() and
+ * increment_write_ptr() only by the producer. Everything else may be called
+ * from any thread.
+ */
+template<class T>
+class /*LIBPBD_API*/ SPSCRingBuffer
+{
+  public:
+	SPSCRingBuffer (size_t sz) {
+		size_t power_of_two;
+		for (power_of_two = 1; (size_t) 1 << power_of_two < sz; ++power_of_two) {}
+		size = (size_t) 1 << power_of_two;
+		size_mask = size - 1;
+		buf = new T[size];
+		reset ();
+	}
+
+	virtual ~SPSCRingBuffer () {
+		delete [] buf;
+	}
+
+	void reset () {
+		/* !!! NOT THREAD SAFE !!! */
+		g_atomic_int_set (&writer.idx, 0);
+		g_atomic_int_set (&reader.idx, 0);
+		writer.cached = 0;
+		reader.cached = 0;
+	}
+
+	size_t read  (T *dest, size_t cnt);
+	size_t write (const T *src, size_t cnt);
+	size_t write_one (const T src);
+
+	struct rw_vector {
+		T *buf[2];
+		size_t len[2];
+	};
+
+	/** Everything that can be read right now */
+	void get_read_vector (rw_vector *);
+	/** Everything that can be written right now */
+	void get_write_vector (rw_vector *);
+
+	/** Get spans for up to @param cnt elements of data (consumer).
+	 * @return the number of elements in @param vec, which is less than
+	 * @param cnt if there is not as much to read.
+	 */
+	size_t reserve_read (rw_vector *vec, size_t cnt);
+
+	/** Release @param cnt elements (consumer), normally the ones
+	 * previously obtained with reserve_read().
+	 */
+	void commit_read (size_t cnt) {
+		g_atomic_int_set (&reader.idx, (guint) g_atomic_int_get (&reader.idx) + (guint) cnt);
+	}
+
+	/** Get spans for up to @param cnt elements of space (producer).
+	 * @return the number of elements in @param vec, which is less than
+	 * @param cnt if there is not as much space.
+	 */
+	size_t reserve_write (rw_vector *vec, size_t cnt);
+
+	/** Publish @param cnt elements (producer), normally the ones
+	 * previously filled in after reserve_write().
+	 */
+	void commit_write (size_t cnt) {
+		g_atomic_int_set (&writer.idx, (guint) g_atomic_int_get (&writer.idx) + (guint) cnt);
+	}
+
+	void increment_read_ptr (size_t cnt) { commit_read (cnt); }
+	void increment_write_ptr (size_t cnt) { commit_write (cnt); }
+
+	size_t read_space () const {
+		/* the read index first: it never overtakes the write index */
+		guint const r = g_atomic_int_get (&reader.idx);
+		guint const w = g_atomic_int_get (&writer.idx);
+		size_t const n = w - r;
+		return n > size ? size : n;
+	}
+
+	size_t write_space () const {
+		return size - read_space ();
+	}
+
+	T *buffer () { return buf; }
+	size_t get_write_ptr () const { return (guint) g_atomic_int_get (&writer.idx) & size_mask; }
+	size_t get_read_ptr () const { return (guint) g_atomic_int_get (&reader.idx) & size_mask; }
+	size_t bufsize () const { return size; }
+
+  protected:
+	static const size_t cacheline = 64;
+
+	struct Index {
+		mutable gint idx; ///< free running, owned by one side
+		guint cached;     ///< the other side's index, as last seen by the owner
+		char pad[cacheline - sizeof (gint) - sizeof (guint)];
+	};
+
+	void get_vector (rw_vector *vec, guint pos, size_t cnt) const {
+		size_t const p = pos & size_mask;
+		vec->buf[0] = &buf[p];
+		if (p + cnt > size) {
+			vec->len[0] = size - p;
+			vec->buf[1] = buf;
+			vec->len[1] = cnt - vec->len[0];
+		} else {
+			vec->len[0] = cnt;
+			vec->buf[1] = 0;
+			vec->len[1] = 0;
+		}
+	}
+
+	T *buf;
+	size_t size;
+	size_t size_mask;
+
+	/* keep the indices off the cache line(s) holding the fields above,
+	 * which both sides read all the time.
+	 */
+	char pad[cacheline];
+
+	Index writer;
+	Index reader;
+};
+
+template<class T> /*LIBPBD_API*/ size_t
+SPSCRingBuffer<T>::reserve_read (typename SPSCRingBuffer<T>::rw_vector *vec, size_t cnt)
+{
+	guint const r = g_atomic_int_get (&reader.idx);
+	size_t avail = (guint) (reader.cached - r);
+
+	/* the cached value may also be stale after increment_read_ptr()
+	 * moved past it, in which case the difference wrapped around.
+	 */
+	if (avail < cnt || avail > size) {
+		reader.cached = g_atomic_int_get (&writer.idx);
+		avail = (guint) (reader.cached - r);
+	}
+
+	if (cnt > avail) {
+		cnt = avail;
+	}
+
+	get_vector (vec, r, cnt);
+	return cnt;
+}
+
+template<class T> /*LIBPBD_API*/ size_t
+SPSCRingBuffer<T>::reserve_write (typename SPSCRingBuffer<T>::rw_vector *vec, size_t cnt)
+{
+	guint const w = g_atomic_int_get (&writer.idx);
+	size_t used = (guint) (w - writer.cached);
+
+	if (used > size || size - used < cnt) {
+		writer.cached = g_atomic_int_get (&reader.idx);
+		used = (guint) (w - writer.cached);
+	}
+
+	size_t const avail = size - used;
+
+	if (cnt > avail) {
+		cnt = avail;
+	}
+
+	get_vector (vec, w, cnt);
+	return cnt;
+}
+
+template<class T> /*LIBPBD_API*/ size_t
+SPSCRingBuffer<T>::read (T *dest, size_t cnt)
+{
+	rw_vector vec;
+
+	if ((cnt = reserve_read (&vec, cnt)) == 0) {
+		return 0;
+	}
+
+	memcpy (dest, vec.buf[0], vec.len[0] * sizeof (T));
+	if (vec.len[1]) {
+		memcpy (dest + vec.len[0], vec.buf[1], vec.len[1] * sizeof (T));
+	}
+
+	commit_read (cnt);
+	return cnt;
+}
+
+template<class T> /*LIBPBD_API*/ size_t
+SPSCRingBuffer<T>::write (const T *src, size_t cnt)
+{
+	rw_vector vec;
+
+	if ((cnt = reserve_write (&vec, cnt)) == 0) {
+		return 0;
+	}
+
+	memcpy (vec.buf[0], src, vec.len[0] * sizeof (T));
+	if (vec.len[1]) {
+		memcpy (vec.buf[1], src + vec.len[0], vec.len[1] * sizeof (T));
+	}
+
+	commit_write (cnt);
+	return cnt;
+}
+
+template<class T> /*LIBPBD_API*/ size_t
+SPSCRingBuffer<T>::write_one (const T src)
+{
+	return write (&src, 1);
+}
+
+template<class T> /*LIBPBD_API*/ void
+SPSCRingBuffer<T>::get_read_vector (typename SPSCRingBuffer<T>::rw_vector *vec)
+{
+	guint const r = g_atomic_int_get (&reader.idx);
+	guint const w = g_atomic_int_get (&writer.idx);
+	size_t n = (guint) (w - r);
+
+	get_vector (vec, r, n > size ? size : n);
+}
+
+template<class T> /*LIBPBD_API*/ void
+SPSCRingBuffer<T>::get_write_vector (typename SPSCRingBuffer<T>::rw_vector *vec)
+{
+	guint const r = g_atomic_int_get (&reader.idx);
+	guint const w = g_atomic_int_get (&writer.idx);
+	size_t n = (guint) (w - r);
+
+	get_vector (vec, w, n > size ? 0 : size - n);
+}
+
+} /* namespace */
+
+#endif /* __libpbd_spsc_ringbuffer_h__ */
@@ -35,6 +35,9 @@ LIBPBD_API bool get_min_max_avg_total (const std::vector<uint64_t>& values, uint
 
 LIBPBD_API std::string timing_summary (const std::vector<uint64_t>& values);
 
+/// @return a monotonic time in nanoseconds, from an arbitrary origin
+LIBPBD_API int64_t get_nanoseconds ();
+
 /**
  * This class allows collecting timing data using two different
  * techniques. The first is using start() and update() and then
@@ -181,6 +184,80 @@ private:
 
 };
 
+/**
+ * Realtime-safe timing statistics: count, minimum, maximum and total of
+ * the values added, and a histogram with power-of-two bins. Bin 0 counts
+ * values of 0, bin n values in [2^(n-1), 2^n) and the last bin everything
+ * larger than that. Values are nanoseconds when added by HistogramTimer.
+ *
+ * There is a single writer. Readers on other threads may see a value that
+ * is being added only partially accounted for, which is good enough for
+ * statistics.
+ */
+class LIBPBD_API TimingHistogram
+{
+public:
+	static const int n_bins = 32;
+
+	TimingHistogram () { reset (); }
+
+	void reset ();
+	void add (uint64_t value);
+
+	uint64_t count () const { return m_count; }
+	uint64_t minimum () const { return m_count ? m_min : 0; }
+	uint64_t maximum () const { return m_max; }
+	uint64_t total () const { return m_total; }
+	uint64_t average () const { return m_count ? m_total / m_count : 0; }
+
+	uint64_t bin (int n) const { return m_bins[n]; }
+
+	/// @return the smallest value in bin @param n
+	static uint64_t bin_start (int n) { return n == 0 ? 0 : (uint64_t) 1 << (n - 1); }
+
+	/// @return the upper bound of the bin that holds the value below
+	/// which @param fraction of all values lie
+	uint64_t percentile (double fraction) const;
+
+	std::string summary () const;
+
+private:
+	uint64_t m_count;
+	uint64_t m_min;
+	uint64_t m_max;
+	uint64_t m_total;
+	uint64_t m_bins[n_bins];
+};
+
+/**
+ * Add the lifetime of this object, in nanoseconds, to a TimingHistogram
+ * unless disabled. e.g.
+ *
+ * {
+ *   HistogramTimer t (histogram, profiling_enabled);
+ *   do_stuff ();
+ * }
+ */
+class LIBPBD_API HistogramTimer
+{
+public:
+	HistogramTimer (TimingHistogram& data, bool enabled = true)
+		: m_data (enabled ? &data : 0)
+		, m_start (enabled ? get_nanoseconds () : 0)
+	{}
+
+	~HistogramTimer ()
+	{
+		if (m_data) {
+			m_data->add (get_nanoseconds () - m_start);
+		}
+	}
+
+private:
+	TimingHistogram* m_data;
+	int64_t m_start;
+};
+
 } // namespace PBD
 
 #endif // __libpbd_timing_h__
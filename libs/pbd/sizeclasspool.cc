@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2017 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef PLATFORM_WINDOWS
+#include <sys/mman.h>
+#endif
+
+#include "pbd/sizeclasspool.h"
+
+using namespace PBD;
+
+const size_t SizeClassPool::max_small;
+const size_t SizeClassPool::granularity;
+const size_t SizeClassPool::n_classes;
+const size_t SizeClassPool::page_size;
+
+/* Interpreters mostly allocate small objects, so give them the larger
+ * part of the pool; the remainder backs tables' array and hash parts,
+ * long strings and anything that does not fit.
+ */
+SizeClassPool::SizeClassPool (std::string name, size_t bytes)
+	: _name (name)
+	, _arena_size ((bytes / 2) & ~(page_size - 1))
+	, _arena (0)
+	, _large (name, bytes - _arena_size)
+{
+	_arena = (char*) ::malloc (_arena_size);
+
+	if (!_arena) {
+		/* no small blocks; everything comes from the ReallocPool */
+		_arena_size = 0;
+	} else {
+		memset (_arena, 0, _arena_size); // make resident
+#ifndef PLATFORM_WINDOWS
+		mlock (_arena, _arena_size);
+#endif
+	}
+
+	_top = _arena;
+
+	for (size_t c = 0; c < n_classes; ++c) {
+		_free[c] = 0;
+	}
+}
+
+SizeClassPool::~SizeClassPool ()
+{
+	::free (_arena);
+	_arena = NULL;
+}
+
+/** Add blocks of class @param c to its free list, from the part of the
+ * arena that has not been used yet.
+ */
+bool
+SizeClassPool::carve (size_t c)
+{
+	const size_t cs = class_size (c);
+	size_t avail = _arena + _arena_size - _top;
+
+	if (avail < cs) {
+		return false;
+	}
+
+	avail = std::min (avail, page_size);
+
+	for (size_t n = avail / cs; n > 0; --n) {
+		FreeBlock* b = (FreeBlock*) _top;
+		b->next = _free[c];
+		_free[c] = b;
+		_top += cs;
+	}
+	return true;
+}
+
+void *
+SizeClassPool::small_alloc (size_t c)
+{
+	if (!_free[c] && !carve (c)) {
+		return NULL;
+	}
+	FreeBlock* b = _free[c];
+	_free[c] = b->next;
+	return b;
+}
+
+void
+SizeClassPool::small_free (void *ptr, size_t c)
+{
+	FreeBlock* b = (FreeBlock*) ptr;
+	b->next = _free[c];
+	_free[c] = b;
+}
+
+// realloc() does it all, malloc(), realloc() and free()
+void *
+SizeClassPool::_realloc (void *ptr, size_t oldsize, size_t newsize)
+{
+	void *rv;
+
+	if (ptr == 0) {
+		if (newsize == 0) {
+			return NULL;
+		}
+		if (newsize <= max_small && (rv = small_alloc (class_of (newsize)))) {
+			return rv;
+		}
+		return _large.malloc (newsize);
+	}
+
+	if (!is_small (ptr)) {
+		/* hand blocks which shrink into a size-class back to the
+		 * lists, to keep the ReallocPool from fragmenting.
+		 */
+		if (newsize == 0) {
+			_large.free (ptr);
+			return NULL;
+		}
+		if (newsize <= max_small && (rv = small_alloc (class_of (newsize)))) {
+			memcpy (rv, ptr, std::min (oldsize, newsize));
+			_large.free (ptr);
+			return rv;
+		}
+		return _large.realloc (ptr, newsize);
+	}
+
+	/* a small block; oldsize is the size it was allocated with, or
+	 * (after a failed move, see below) anything smaller. Either way,
+	 * the block is at least class_size (class_of (oldsize)) bytes.
+	 */
+	const size_t oc = class_of (oldsize);
+
+	if (newsize == 0) {
+		small_free (ptr, oc);
+		return NULL;
+	}
+
+	if (newsize <= max_small && class_of (newsize) == oc) {
+		return ptr;
+	}
+
+	if (newsize <= max_small) {
+		rv = small_alloc (class_of (newsize));
+	} else {
+		rv = NULL;
+	}
+
+	if (!rv) {
+		rv = _large.malloc (newsize);
+	}
+
+	if (!rv) {
+		/* Lua does not expect shrinking to fail. Keep the block;
+		 * it will be freed into the (smaller) class it is then
+		 * reported as, which merely wastes the difference.
+		 */
+		return newsize < oldsize ? ptr : NULL;
+	}
+
+	memcpy (rv, ptr, std::min (oldsize, newsize));
+	small_free (ptr, oc);
+	return rv;
+}
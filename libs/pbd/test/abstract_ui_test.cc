@@ -0,0 +1,171 @@
+#include <vector>
+
+#include <glib.h>
+#include <glibmm/threads.h>
+#include <sigc++/bind.h>
+
+#include "abstract_ui_test.h"
+
+#include "pbd/abstract_ui.h"
+#include "pbd/abstract_ui.cc" // instantiate template
+
+CPPUNIT_TEST_SUITE_REGISTRATION (AbstractUITest);
+
+using namespace std;
+
+struct OrderTestRequest : public BaseUI::BaseRequestObject
+{
+	guint seq;
+};
+
+template class AbstractUI<OrderTestRequest>;
+
+/** A UI whose requests are handled by the test itself, in the thread
+ * which created it; every request records its sequence number.
+ */
+class OrderTestUI : public AbstractUI<OrderTestRequest>
+{
+public:
+	OrderTestUI ()
+		: AbstractUI<OrderTestRequest> ("order test")
+	{
+		run_loop_thread = Glib::Threads::Thread::self ();
+	}
+
+	void send (guint seq) {
+		OrderTestRequest* req = get_request (Sequence);
+		req->seq = seq;
+		send_request (req);
+	}
+
+	void handle () {
+		handle_ui_requests ();
+	}
+
+	vector<guint> received;
+
+	static RequestType Sequence;
+
+protected:
+	void do_request (OrderTestRequest* req) {
+		received.push_back (req->seq);
+	}
+};
+
+BaseUI::RequestType OrderTestUI::Sequence = BaseUI::new_request_type ();
+
+namespace {
+
+/* RingBufferNPT keeps one slot empty, so this holds 7 requests */
+static const uint32_t ring_size = 8;
+
+struct Sender {
+	Sender (OrderTestUI& u, guint b, guint n, bool w)
+		: ui (u)
+		, batches (b)
+		, per_batch (n)
+		, wait (w)
+		, sent (0)
+		, handled (0)
+		, done (0)
+	{}
+
+	OrderTestUI& ui;
+	guint batches;
+	guint per_batch;
+	bool  wait;  ///< wait for each batch to be handled before sending the next
+
+	gint sent;    ///< batches sent
+	gint handled; ///< batches handled by the UI, if waiting
+	gint done;    ///< set when the UI no longer needs the request buffer
+};
+
+void
+send_requests (Sender* s)
+{
+	s->ui.register_thread (pthread_self (), "order test sender", ring_size);
+
+	guint seq = 0;
+
+	for (guint b = 0; b < s->batches; ++b) {
+		for (guint i = 0; i < s->per_batch; ++i) {
+			s->ui.send (seq++);
+		}
+		g_atomic_int_inc (&s->sent);
+
+		while (s->wait && (guint) g_atomic_int_get (&s->handled) <= b && !g_atomic_int_get (&s->done)) {
+			Glib::Threads::Thread::yield ();
+		}
+	}
+
+	/* the request buffer is dropped when this thread exits */
+	while (!g_atomic_int_get (&s->done)) {
+		Glib::Threads::Thread::yield ();
+	}
+}
+
+void
+check_order (vector<guint> const & received, guint n)
+{
+	CPPUNIT_ASSERT_EQUAL ((size_t) n, received.size ());
+
+	for (guint i = 0; i < n; ++i) {
+		CPPUNIT_ASSERT_EQUAL (i, received[i]);
+	}
+}
+
+}
+
+AbstractUITest::AbstractUITest ()
+{
+}
+
+/** Requests sent while the ring buffer is full must still be handled, in
+ * the order they were sent, and the sender must go back to using the ring
+ * buffer once they have been.
+ */
+void
+AbstractUITest::testOverflowOrder ()
+{
+	OrderTestUI ui;
+	Sender s (ui, 3, 100, true);
+
+	Glib::Threads::Thread* t = Glib::Threads::Thread::create (sigc::bind (sigc::ptr_fun (send_requests), &s));
+
+	for (guint b = 0; b < s.batches; ++b) {
+		while ((guint) g_atomic_int_get (&s.sent) <= b) {
+			Glib::Threads::Thread::yield ();
+		}
+
+		ui.handle ();
+		g_atomic_int_inc (&s.handled);
+	}
+
+	g_atomic_int_set (&s.done, 1);
+	t->join ();
+
+	check_order (ui.received, s.batches * s.per_batch);
+}
+
+/** As above, with the UI handling requests while they are being sent */
+void
+AbstractUITest::testConcurrentOverflowOrder ()
+{
+	OrderTestUI ui;
+	Sender s (ui, 1, 20000, false);
+	guint const n = s.batches * s.per_batch;
+
+	gint64 const deadline = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+
+	Glib::Threads::Thread* t = Glib::Threads::Thread::create (sigc::bind (sigc::ptr_fun (send_requests), &s));
+
+	while (ui.received.size () < n && g_get_monotonic_time () < deadline) {
+		ui.handle ();
+		Glib::Threads::Thread::yield ();
+	}
+
+	g_atomic_int_set (&s.done, 1);
+	t->join ();
+
+	check_order (ui.received, n);
+}
@@ -0,0 +1,15 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class AbstractUITest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (AbstractUITest);
+	CPPUNIT_TEST (testOverflowOrder);
+	CPPUNIT_TEST (testConcurrentOverflowOrder);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	AbstractUITest ();
+	void testOverflowOrder ();
+	void testConcurrentOverflowOrder ();
+};
@@ -0,0 +1,300 @@
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include <glibmm/threads.h>
+#include <sigc++/bind.h>
+
+#include "arena_test.h"
+#include "pbd/arena.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (ArenaTest);
+
+using namespace std;
+using namespace PBD;
+
+namespace {
+
+/* arenas live as long as the program, and each test needs one in which
+ * no other thread has a heap yet.
+ */
+Arena size_class_arena ("size class test");
+Arena same_thread_arena ("same thread test");
+Arena remote_arena ("remote release test");
+Arena adoption_arena ("adoption test");
+Arena exhaustion_arena ("exhaustion test");
+
+Arena::Stats
+stats_for (Arena const & a, size_t size)
+{
+	vector<Arena::Stats> s;
+	a.stats (s);
+
+	for (vector<Arena::Stats>::const_iterator i = s.begin(); i != s.end(); ++i) {
+		if (i->size == size) {
+			return *i;
+		}
+	}
+
+	CPPUNIT_FAIL ("no such size class");
+	return s.front ();
+}
+
+guint
+total_in_use (Arena const & a)
+{
+	vector<Arena::Stats> s;
+	a.stats (s);
+
+	guint n = 0;
+	for (vector<Arena::Stats>::const_iterator i = s.begin(); i != s.end(); ++i) {
+		n += i->in_use;
+	}
+	return n;
+}
+
+void
+release_all (vector<void*>* blocks)
+{
+	for (vector<void*>::const_iterator i = blocks->begin(); i != blocks->end(); ++i) {
+		Arena::release (*i);
+	}
+}
+
+void
+fill_heap (vector<void*>* blocks)
+{
+	adoption_arena.reserve (256, 8);
+
+	for (int i = 0; i < 8; ++i) {
+		blocks->push_back (adoption_arena.alloc (256));
+	}
+}
+
+void
+reuse_heap (vector<void*>* blocks, vector<void*>* reused, bool* adopted)
+{
+	/* a thread which never used the arena, so this has to find a heap */
+	adoption_arena.reserve (256, 8);
+	*adopted = stats_for (adoption_arena, 256).reserved == 8;
+
+	/* blocks of an adopted heap are released locally */
+	for (size_t i = 4; i < blocks->size (); ++i) {
+		Arena::release ((*blocks)[i]);
+	}
+
+	for (int i = 0; i < 8; ++i) {
+		reused->push_back (adoption_arena.alloc (256));
+	}
+
+	release_all (reused);
+}
+
+bool
+same_blocks (vector<void*> a, vector<void*> b)
+{
+	sort (a.begin(), a.end());
+	sort (b.begin(), b.end());
+	return a == b;
+}
+
+}
+
+ArenaTest::ArenaTest ()
+{
+}
+
+void
+ArenaTest::testSizeClasses ()
+{
+	Arena& a (size_class_arena);
+
+	size_t const sizes[]   = { 1,  16, 17, 32, 33, 100, 1000, 1024, 1025, 2048 };
+	size_t const classes[] = { 16, 16, 32, 32, 64, 128, 1024, 1024, 2048, 2048 };
+
+	for (size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); ++i) {
+		void* p = a.alloc (sizes[i]);
+		memset (p, 0xa5, sizes[i]);
+		CPPUNIT_ASSERT_EQUAL ((guint) 1, stats_for (a, classes[i]).in_use);
+		CPPUNIT_ASSERT_EQUAL ((guint) 1, total_in_use (a));
+		Arena::release (p);
+		CPPUNIT_ASSERT_EQUAL ((guint) 0, total_in_use (a));
+	}
+
+	/* bigger blocks bypass the size classes */
+	void* p = a.alloc (Arena::max_size + 1);
+	memset (p, 0xa5, Arena::max_size + 1);
+	CPPUNIT_ASSERT_EQUAL ((guint) 0, total_in_use (a));
+	Arena::release (p);
+
+	Arena::release (0);
+}
+
+void
+ArenaTest::testSameThread ()
+{
+	Arena& a (same_thread_arena);
+
+	CPPUNIT_ASSERT (!a.has_heap ());
+	a.reserve (64, 4);
+	CPPUNIT_ASSERT (a.has_heap ());
+	CPPUNIT_ASSERT_EQUAL ((guint) 4, stats_for (a, 64).reserved);
+
+	/* reserving less than is there already does nothing */
+	a.reserve (64, 2);
+	CPPUNIT_ASSERT_EQUAL ((guint) 4, stats_for (a, 64).reserved);
+
+	vector<void*> blocks;
+	for (int i = 0; i < 4; ++i) {
+		blocks.push_back (a.alloc (50));
+		memset (blocks.back (), i, 50);
+	}
+
+	for (int i = 0; i < 4; ++i) {
+		for (int b = 0; b < 50; ++b) {
+			CPPUNIT_ASSERT_EQUAL (i, (int) ((char*) blocks[i])[b]);
+		}
+	}
+
+	Arena::Stats s = stats_for (a, 64);
+	CPPUNIT_ASSERT_EQUAL ((guint) 4, s.in_use);
+	CPPUNIT_ASSERT_EQUAL ((guint) 4, s.high_water);
+	CPPUNIT_ASSERT_EQUAL ((guint) 0, s.exhausted);
+
+	release_all (&blocks);
+	CPPUNIT_ASSERT_EQUAL ((guint) 0, stats_for (a, 64).in_use);
+
+	/* released blocks are handed out again */
+	vector<void*> again;
+	for (int i = 0; i < 4; ++i) {
+		again.push_back (a.alloc (64));
+	}
+	CPPUNIT_ASSERT (same_blocks (blocks, again));
+
+	s = stats_for (a, 64);
+	CPPUNIT_ASSERT_EQUAL ((guint) 4, s.reserved);
+	CPPUNIT_ASSERT_EQUAL ((guint) 0, s.exhausted);
+
+	release_all (&again);
+}
+
+void
+ArenaTest::testRemoteRelease ()
+{
+	Arena& a (remote_arena);
+
+	a.reserve (128, 8);
+
+	vector<void*> blocks;
+	for (int i = 0; i < 8; ++i) {
+		blocks.push_back (a.alloc (128));
+	}
+
+	Glib::Threads::Thread* t = Glib::Threads::Thread::create (sigc::bind (sigc::ptr_fun (release_all), &blocks));
+	t->join ();
+
+	CPPUNIT_ASSERT_EQUAL ((guint) 0, stats_for (a, 128).in_use);
+
+	/* the local free list is empty, so the owner has to take back what
+	 * the other thread released instead of growing the heap
+	 */
+	vector<void*> reclaimed;
+	for (int i = 0; i < 8; ++i) {
+		reclaimed.push_back (a.alloc (128));
+	}
+	CPPUNIT_ASSERT (same_blocks (blocks, reclaimed));
+
+	Arena::Stats s = stats_for (a, 128);
+	CPPUNIT_ASSERT_EQUAL ((guint) 8, s.in_use);
+	CPPUNIT_ASSERT_EQUAL ((guint) 8, s.reserved);
+	CPPUNIT_ASSERT_EQUAL ((guint) 0, s.exhausted);
+
+	release_all (&reclaimed);
+}
+
+void
+ArenaTest::testAdoption ()
+{
+	Arena& a (adoption_arena);
+
+	vector<void*> blocks;
+	Glib::Threads::Thread* t = Glib::Threads::Thread::create (sigc::bind (sigc::ptr_fun (fill_heap), &blocks));
+	t->join ();
+
+	CPPUNIT_ASSERT_EQUAL ((size_t) 8, blocks.size ());
+	CPPUNIT_ASSERT_EQUAL ((guint) 8, stats_for (a, 256).in_use);
+
+	/* the owner has exited; release some blocks into its heap anyway.
+	 * Releasing does not give this thread a heap.
+	 */
+	for (size_t i = 0; i < 4; ++i) {
+		Arena::release (blocks[i]);
+	}
+	CPPUNIT_ASSERT (!a.has_heap ());
+	CPPUNIT_ASSERT_EQUAL ((guint) 4, stats_for (a, 256).in_use);
+
+	/* the next thread adopts the orphaned heap rather than creating
+	 * another one, and gets all of its blocks back.
+	 */
+	vector<void*> reused;
+	bool adopted = false;
+	t = Glib::Threads::Thread::create (sigc::bind (sigc::ptr_fun (reuse_heap), &blocks, &reused, &adopted));
+	t->join ();
+
+	CPPUNIT_ASSERT (adopted);
+	CPPUNIT_ASSERT (same_blocks (blocks, reused));
+
+	Arena::Stats s = stats_for (a, 256);
+	CPPUNIT_ASSERT_EQUAL ((guint) 0, s.in_use);
+	CPPUNIT_ASSERT_EQUAL ((guint) 8, s.reserved);
+	CPPUNIT_ASSERT_EQUAL ((guint) 0, s.exhausted);
+}
+
+void
+ArenaTest::testExhaustion ()
+{
+	Arena& a (exhaustion_arena);
+
+	a.reserve (32, 4);
+
+	vector<void*> blocks;
+	for (int i = 0; i < 4; ++i) {
+		blocks.push_back (a.alloc (32));
+	}
+	CPPUNIT_ASSERT_EQUAL ((guint) 0, stats_for (a, 32).exhausted);
+
+	/* running out grows the heap by half of what it had, but at least 16 */
+	blocks.push_back (a.alloc (32));
+
+	Arena::Stats s = stats_for (a, 32);
+	CPPUNIT_ASSERT_EQUAL ((guint) 1, s.exhausted);
+	CPPUNIT_ASSERT_EQUAL ((guint) 20, s.reserved);
+	CPPUNIT_ASSERT_EQUAL ((guint) 5, s.high_water);
+
+	while (blocks.size () < 20) {
+		blocks.push_back (a.alloc (32));
+	}
+	CPPUNIT_ASSERT_EQUAL ((guint) 1, stats_for (a, 32).exhausted);
+
+	blocks.push_back (a.alloc (32));
+
+	s = stats_for (a, 32);
+	CPPUNIT_ASSERT_EQUAL ((guint) 2, s.exhausted);
+	CPPUNIT_ASSERT_EQUAL ((guint) 36, s.reserved);
+	CPPUNIT_ASSERT_EQUAL ((guint) 21, s.in_use);
+
+	release_all (&blocks);
+
+	s = stats_for (a, 32);
+	CPPUNIT_ASSERT_EQUAL ((guint) 0, s.in_use);
+	CPPUNIT_ASSERT_EQUAL ((guint) 21, s.high_water);
+
+	/* a size class which was never reserved grows on first use */
+	void* p = a.alloc (512);
+	s = stats_for (a, 512);
+	CPPUNIT_ASSERT_EQUAL ((guint) 1, s.exhausted);
+	CPPUNIT_ASSERT_EQUAL ((guint) 16, s.reserved);
+	Arena::release (p);
+
+	CPPUNIT_ASSERT (Arena::report ().find ("'exhaustion test' 32 bytes") != string::npos);
+}
@@ -0,0 +1,21 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class ArenaTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (ArenaTest);
+	CPPUNIT_TEST (testSizeClasses);
+	CPPUNIT_TEST (testSameThread);
+	CPPUNIT_TEST (testRemoteRelease);
+	CPPUNIT_TEST (testAdoption);
+	CPPUNIT_TEST (testExhaustion);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	ArenaTest ();
+	void testSizeClasses ();
+	void testSameThread ();
+	void testRemoteRelease ();
+	void testAdoption ();
+	void testExhaustion ();
+};
@@ -89,3 +89,81 @@ SignalsTest::testScopedConnectionList ()
 
 	CPPUNIT_ASSERT_EQUAL (1, N);
 }
+
+class Disconnector
+{
+public:
+	Disconnector (Emitter* e) {
+		for (int i = 0; i < 3; ++i) {
+			e->Fred.connect_same_thread (c[i], boost::bind (&Disconnector::receiver, this));
+		}
+	}
+
+	/* the first slot to be called disconnects all of them */
+	void receiver () {
+		++N;
+		for (int i = 0; i < 3; ++i) {
+			c[i].disconnect ();
+		}
+	}
+
+	PBD::ScopedConnection c[3];
+};
+
+void
+SignalsTest::testDisconnectInEmission ()
+{
+	Emitter* e = new Emitter;
+	Disconnector d (e);
+
+	N = 0;
+	e->emit ();
+	CPPUNIT_ASSERT_EQUAL (1, N);
+
+	e->emit ();
+	CPPUNIT_ASSERT_EQUAL (1, N);
+	CPPUNIT_ASSERT (e->Fred.empty ());
+
+	delete e;
+}
+
+class Connector
+{
+public:
+	Connector (Emitter* e) : _e (e), _connected (false) {
+		e->Fred.connect_same_thread (c, boost::bind (&Connector::receiver, this));
+	}
+
+	/* connect another slot, which is not called by this emission */
+	void receiver () {
+		++N;
+		if (!_connected) {
+			_e->Fred.connect_same_thread (d, boost::bind (&::receiver));
+			_connected = true;
+		}
+	}
+
+	PBD::ScopedConnection c;
+	PBD::ScopedConnection d;
+
+private:
+	Emitter* _e;
+	bool _connected;
+};
+
+void
+SignalsTest::testConnectInEmission ()
+{
+	Emitter* e = new Emitter;
+	Connector c (e);
+
+	N = 0;
+	e->emit ();
+	CPPUNIT_ASSERT_EQUAL (1, N);
+
+	N = 0;
+	e->emit ();
+	CPPUNIT_ASSERT_EQUAL (2, N);
+
+	delete e;
+}
@@ -0,0 +1,90 @@
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include "sizeclasspool_test.h"
+#include "pbd/sizeclasspool.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (SizeClassPoolTest);
+
+using namespace std;
+
+SizeClassPoolTest::SizeClassPoolTest ()
+{
+}
+
+void
+SizeClassPoolTest::testBasic ()
+{
+	::srand (0);
+	PBD::SizeClassPool *m = new PBD::SizeClassPool ("TestPool", 512 * 1024);
+
+	for (int l = 0; l < 2 * 1024 * 1024; ++l) {
+		void *x[32];
+		size_t s[32];
+		int cnt = ::rand() % 32;
+		for (int i = 0; i < cnt; ++i) {
+			/* mostly small, like an interpreter */
+			s[i] = 1 + ::rand() % ((i % 4) ? 256 : 1024);
+			x[i] = m->malloc (s[i]);
+		}
+		for (int i = 0; i < cnt; ++i) {
+			if (x[i]) {
+				memset (x[i], 0xa5, s[i]);
+			}
+		}
+		for (int i = 0; i < cnt; ++i) {
+			m->free (x[i], s[i]);
+		}
+	}
+	delete (m);
+}
+
+void
+SizeClassPoolTest::testRealloc ()
+{
+	::srand (0);
+	PBD::SizeClassPool *m = new PBD::SizeClassPool ("TestPool", 256 * 1024);
+
+	std::vector<pair<unsigned char*, size_t> > blocks;
+
+	for (int l = 0; l < 256 * 1024; ++l) {
+		if (blocks.size () < 64 && (blocks.empty () || ::rand() % 3)) {
+			size_t s = 1 + ::rand() % 512;
+			unsigned char* x = (unsigned char*) m->malloc (s);
+			if (x) {
+				memset (x, s & 0xff, s);
+				blocks.push_back (make_pair (x, s));
+			}
+			continue;
+		}
+
+		size_t i = ::rand() % blocks.size ();
+		unsigned char* x = blocks[i].first;
+		size_t s = blocks[i].second;
+
+		/* content must survive moves between the size-classes and
+		 * the fallback pool
+		 */
+		for (size_t b = 0; b < s; ++b) {
+			CPPUNIT_ASSERT (x[b] == (s & 0xff));
+		}
+
+		if (::rand() % 2) {
+			size_t ns = 1 + ::rand() % 512;
+			unsigned char* y = (unsigned char*) m->realloc (x, s, ns);
+			if (y) {
+				memset (y, ns & 0xff, ns);
+				blocks[i] = make_pair (y, ns);
+			}
+		} else {
+			m->free (x, s);
+			blocks[i] = blocks.back ();
+			blocks.pop_back ();
+		}
+	}
+
+	for (size_t i = 0; i < blocks.size (); ++i) {
+		m->free (blocks[i].first, blocks[i].second);
+	}
+	delete (m);
+}
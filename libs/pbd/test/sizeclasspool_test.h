@@ -0,0 +1,17 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class SizeClassPoolTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (SizeClassPoolTest);
+	CPPUNIT_TEST (testBasic);
+	CPPUNIT_TEST (testRealloc);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	SizeClassPoolTest ();
+	void testBasic ();
+	void testRealloc ();
+
+private:
+};
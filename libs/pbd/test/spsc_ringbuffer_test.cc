@@ -0,0 +1,209 @@
+#include <algorithm>
+
+#include <glib.h>
+#include <glibmm/threads.h>
+#include <sigc++/bind.h>
+
+#include "spsc_ringbuffer_test.h"
+#include "pbd/spsc_ringbuffer.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (SPSCRingBufferTest);
+
+using namespace std;
+using namespace PBD;
+
+SPSCRingBufferTest::SPSCRingBufferTest ()
+{
+}
+
+void
+SPSCRingBufferTest::testBasic ()
+{
+	SPSCRingBuffer<int> rb (100);
+	SPSCRingBuffer<int>::rw_vector vec;
+	int data[128];
+
+	for (int i = 0; i < 128; ++i) {
+		data[i] = i;
+	}
+
+	/* rounded up, and all of it can be used */
+	CPPUNIT_ASSERT_EQUAL ((size_t) 128, rb.bufsize ());
+	CPPUNIT_ASSERT_EQUAL ((size_t) 128, rb.write_space ());
+	CPPUNIT_ASSERT_EQUAL ((size_t) 128, rb.write (data, 128));
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, rb.write_space ());
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, rb.write_one (0));
+
+	int out[128];
+	CPPUNIT_ASSERT_EQUAL ((size_t) 100, rb.read (out, 100));
+	CPPUNIT_ASSERT_EQUAL (99, out[99]);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 50, rb.write (data, 50));
+
+	/* 28 at the end, 50 from the start of the buffer */
+	rb.get_read_vector (&vec);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 28, vec.len[0]);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 50, vec.len[1]);
+	CPPUNIT_ASSERT_EQUAL (100, vec.buf[0][0]);
+	CPPUNIT_ASSERT_EQUAL (0, vec.buf[1][0]);
+
+	/* reserve more than there is */
+	CPPUNIT_ASSERT_EQUAL ((size_t) 50, rb.reserve_write (&vec, 100));
+	CPPUNIT_ASSERT_EQUAL ((size_t) 50, vec.len[0]);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, vec.len[1]);
+
+	for (size_t i = 0; i < vec.len[0]; ++i) {
+		vec.buf[0][i] = 1000 + i;
+	}
+
+	/* nothing is visible before the commit */
+	CPPUNIT_ASSERT_EQUAL ((size_t) 78, rb.read_space ());
+	rb.commit_write (vec.len[0]);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 128, rb.read_space ());
+
+	CPPUNIT_ASSERT_EQUAL ((size_t) 30, rb.reserve_read (&vec, 30));
+	CPPUNIT_ASSERT_EQUAL ((size_t) 28, vec.len[0]);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 2, vec.len[1]);
+	CPPUNIT_ASSERT_EQUAL (127, vec.buf[0][27]);
+	CPPUNIT_ASSERT_EQUAL (1, vec.buf[1][1]);
+	rb.commit_read (30);
+
+	CPPUNIT_ASSERT_EQUAL ((size_t) 98, rb.read (out, 128));
+	CPPUNIT_ASSERT_EQUAL (2, out[0]);
+	CPPUNIT_ASSERT_EQUAL (1000, out[48]);
+	CPPUNIT_ASSERT_EQUAL (1049, out[97]);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, rb.read_space ());
+
+	/* increment_read_ptr() past the consumer's cached write index */
+	CPPUNIT_ASSERT_EQUAL ((size_t) 10, rb.write (data, 10));
+	rb.increment_read_ptr (5);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 5, rb.read (out, 128));
+	CPPUNIT_ASSERT_EQUAL (5, out[0]);
+}
+
+namespace {
+
+class WrappingRingBuffer : public SPSCRingBuffer<int>
+{
+public:
+	WrappingRingBuffer (size_t sz, guint idx) : SPSCRingBuffer<int> (sz) {
+		g_atomic_int_set (&writer.idx, idx);
+		g_atomic_int_set (&reader.idx, idx);
+		writer.cached = reader.cached = idx;
+	}
+};
+
+}
+
+/* the indices are free running and overflow after 2^32 elements */
+void
+SPSCRingBufferTest::testIndexWrap ()
+{
+	WrappingRingBuffer rb (16, 0xfffffff8);
+	int data[16];
+	int out[16];
+
+	for (int i = 0; i < 16; ++i) {
+		data[i] = i;
+	}
+
+	for (int n = 0; n < 4; ++n) {
+		CPPUNIT_ASSERT_EQUAL ((size_t) 16, rb.write_space ());
+		CPPUNIT_ASSERT_EQUAL ((size_t) 13, rb.write (data, 13));
+		CPPUNIT_ASSERT_EQUAL ((size_t) 13, rb.read_space ());
+		CPPUNIT_ASSERT_EQUAL ((size_t) 3, rb.write_space ());
+		CPPUNIT_ASSERT_EQUAL ((size_t) 13, rb.read (out, 16));
+		CPPUNIT_ASSERT_EQUAL (12, out[12]);
+	}
+}
+
+namespace {
+
+static const guint n_items = 1 << 20;
+
+void
+produce (SPSCRingBuffer<guint>* rb)
+{
+	guint chunk[64];
+	guint n = 0;
+
+	while (n < n_items) {
+		const guint cnt = std::min (n_items - n, 1 + n % 64);
+		for (guint i = 0; i < cnt; ++i) {
+			chunk[i] = n + i;
+		}
+		size_t w = 0;
+		while (w < cnt) {
+			size_t const c = rb->write (chunk + w, cnt - w);
+			if (c == 0) {
+				Glib::Threads::Thread::yield ();
+			}
+			w += c;
+		}
+		n += cnt;
+	}
+}
+
+/* fill the buffer in place */
+void
+produce_spans (SPSCRingBuffer<guint>* rb)
+{
+	SPSCRingBuffer<guint>::rw_vector vec;
+	guint n = 0;
+
+	while (n < n_items) {
+		if (rb->reserve_write (&vec, std::min (n_items - n, (guint) 256)) == 0) {
+			Glib::Threads::Thread::yield ();
+			continue;
+		}
+		for (int p = 0; p < 2; ++p) {
+			for (size_t i = 0; i < vec.len[p]; ++i) {
+				vec.buf[p][i] = n++;
+			}
+		}
+		rb->commit_write (vec.len[0] + vec.len[1]);
+	}
+}
+
+bool
+consume (SPSCRingBuffer<guint>* rb)
+{
+	guint chunk[64];
+	guint n = 0;
+	bool ok = true;
+
+	while (n < n_items) {
+		size_t const c = rb->read (chunk, 64);
+		if (c == 0) {
+			Glib::Threads::Thread::yield ();
+		}
+		for (size_t i = 0; i < c; ++i, ++n) {
+			ok = ok && chunk[i] == n;
+		}
+	}
+	return ok;
+}
+
+void
+run (SPSCRingBuffer<guint>* rb, void (*producer)(SPSCRingBuffer<guint>*))
+{
+	Glib::Threads::Thread* t = Glib::Threads::Thread::create (sigc::bind (sigc::ptr_fun (producer), rb));
+	bool const ok = consume (rb);
+	t->join ();
+	CPPUNIT_ASSERT (ok);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, rb->read_space ());
+}
+
+}
+
+/** Check that data arrives intact and in order while producer and consumer
+ * run concurrently, writing by copying and in place.
+ */
+void
+SPSCRingBufferTest::testContention ()
+{
+	SPSCRingBuffer<guint> rb (1024);
+
+	run (&rb, &produce);
+	rb.reset ();
+	run (&rb, &produce_spans);
+}
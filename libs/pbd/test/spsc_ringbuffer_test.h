@@ -0,0 +1,17 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class SPSCRingBufferTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (SPSCRingBufferTest);
+	CPPUNIT_TEST (testBasic);
+	CPPUNIT_TEST (testIndexWrap);
+	CPPUNIT_TEST (testContention);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	SPSCRingBufferTest ();
+	void testBasic ();
+	void testIndexWrap ();
+	void testContention ();
+};
@@ -22,6 +22,14 @@
 #include <sstream>
 #include <limits>
 
+#ifdef PLATFORM_WINDOWS
+#include "pbd/windows_timer_utils.h"
+#elif defined __APPLE__
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
 #ifdef COMPILER_MSVC
 #undef min
 #undef max
@@ -68,4 +76,80 @@ timing_summary (const std::vector<uint64_t>& values)
 	return oss.str();
 }
 
+int64_t
+get_nanoseconds ()
+{
+#ifdef PLATFORM_WINDOWS
+	return PBD::get_microseconds () * 1000;
+#elif defined __APPLE__
+	static mach_timebase_info_data_t timebase = { 0, 0 };
+	if (timebase.denom == 0) {
+		mach_timebase_info (&timebase);
+	}
+	return mach_absolute_time () * timebase.numer / timebase.denom;
+#else
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+void
+TimingHistogram::reset ()
+{
+	m_count = 0;
+	m_min = std::numeric_limits<uint64_t>::max();
+	m_max = 0;
+	m_total = 0;
+	for (int i = 0; i < n_bins; ++i) {
+		m_bins[i] = 0;
+	}
+}
+
+void
+TimingHistogram::add (uint64_t value)
+{
+	int b = 0;
+	while (b < n_bins - 1 && (value >> b)) {
+		++b;
+	}
+
+	++m_bins[b];
+	++m_count;
+	m_total += value;
+	m_min = std::min (m_min, value);
+	m_max = std::max (m_max, value);
+}
+
+uint64_t
+TimingHistogram::percentile (double fraction) const
+{
+	const double limit = fraction * m_count;
+	uint64_t cnt = 0;
+
+	for (int i = 0; i < n_bins - 1; ++i) {
+		cnt += m_bins[i];
+		if (cnt > 0 && cnt >= limit) {
+			return bin_start (i + 1);
+		}
+	}
+	return m_max;
+}
+
+std::string
+TimingHistogram::summary () const
+{
+	std::ostringstream oss;
+
+	if (m_count > 0) {
+		oss << "Count: " << m_count
+		    << " Min: " << minimum ()
+		    << " Max: " << m_max
+		    << " Avg: " << average ()
+		    << " 99%: < " << percentile (.99)
+		    << std::endl;
+	}
+	return oss.str();
+}
+
 } // namespace PBD
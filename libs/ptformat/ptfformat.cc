@@ -20,6 +20,7 @@
 #include <string.h>
 #include <assert.h>
 
+#include <glib.h>
 #include <glib/gstdio.h>
 
 #include "ptfformat.h"
@@ -48,7 +49,7 @@ hexdump(uint8_t *data, int len)
 	}
 }
 
-PTFFormat::PTFFormat() : version(0), product(NULL) {
+PTFFormat::PTFFormat() : version(0), product(NULL), decodetime(0), parsetime(0), ptfunxored(NULL), len(0) {
 }
 
 PTFFormat::~PTFFormat() {
@@ -73,41 +74,41 @@ PTFFormat::foundin(std::string haystack, std::string needle) {
 */
 int
 PTFFormat::load(std::string path, int64_t targetsr) {
-	FILE *fp;
+	GMappedFile *mf;
+	const unsigned char *ct;
 	unsigned char xxor[256];
-	unsigned char ct;
 	uint64_t i;
 	uint8_t xor_type;
 	uint8_t xor_value;
 	uint8_t xor_delta;
 	uint16_t xor_len;
+	int64_t start;
 	int err;
 
-	if (! (fp = g_fopen(path.c_str(), "rb"))) {
+	start = g_get_monotonic_time();
+
+	/* Map the file rather than reading it, the decrypted copy is
+	 * written in a single pass over it */
+	if (! (mf = g_mapped_file_new(path.c_str(), FALSE, NULL))) {
 		return -1;
 	}
 
-	fseek(fp, 0, SEEK_END);
-	len = ftell(fp);
-	if (len < 0x14) {
-		fclose(fp);
+	len = g_mapped_file_get_length(mf);
+	ct = (const unsigned char *) g_mapped_file_get_contents(mf);
+	if (len < 0x14 || !ct) {
+		g_mapped_file_unref(mf);
 		return -1;
 	}
 
 	if (! (ptfunxored = (unsigned char*) malloc(len * sizeof(unsigned char)))) {
 		/* Silently fail -- out of memory*/
-		fclose(fp);
+		g_mapped_file_unref(mf);
 		ptfunxored = 0;
 		return -1;
 	}
 
 	/* The first 20 bytes are always unencrypted */
-	fseek(fp, 0x00, SEEK_SET);
-	i = fread(ptfunxored, 1, 0x14, fp);
-	if (i < 0x14) {
-		fclose(fp);
-		return -1;
-	}
+	memcpy(ptfunxored, ct, 0x14);
 
 	xor_type = ptfunxored[0x12];
 	xor_value = ptfunxored[0x13];
@@ -124,7 +125,7 @@ PTFFormat::load(std::string path, int64_t targetsr) {
 		xor_len = 128;
 		break;
 	default:
-		fclose(fp);
+		g_mapped_file_unref(mf);
 		return -1;
 	}
 
@@ -134,14 +135,31 @@ PTFFormat::load(std::string path, int64_t targetsr) {
 
 	/* hexdump(xxor, xor_len); */
 
-	/* Read file and decrypt rest of file */
-	i = 0x14;
-	fseek(fp, i, SEEK_SET);
-	while (fread(&ct, 1, 1, fp) != 0) {
-		uint8_t xor_index = (xor_type == 0x01) ? i & 0xff : (i >> 12) & 0x7f;
-		ptfunxored[i++] = ct ^ xxor[xor_index];
+	/* Decrypt rest of file, and note where each block starts */
+	for (i = 0; i < 0x13; i++) {
+		if (ptfunxored[i] == 0x5a) {
+			blocks[ptfunxored[i+1]].push_back(i);
+		}
 	}
-	fclose(fp);
+	if (xor_type == 0x01) {
+		for (i = 0x14; i < len; i++) {
+			ptfunxored[i] = ct[i] ^ xxor[i & 0xff];
+			if (ptfunxored[i-1] == 0x5a) {
+				blocks[ptfunxored[i]].push_back(i-1);
+			}
+		}
+	} else {
+		for (i = 0x14; i < len; i++) {
+			ptfunxored[i] = ct[i] ^ xxor[(i >> 12) & 0x7f];
+			if (ptfunxored[i-1] == 0x5a) {
+				blocks[ptfunxored[i]].push_back(i-1);
+			}
+		}
+	}
+	g_mapped_file_unref(mf);
+
+	decodetime = g_get_monotonic_time() - start;
+	start = g_get_monotonic_time();
 
 	if (!parse_version())
 		return -1;
@@ -154,9 +172,55 @@ PTFFormat::load(std::string path, int64_t targetsr) {
 	if (err)
 		return -1;
 
+	parsetime = g_get_monotonic_time() - start;
+
 	return 0;
 }
 
+/* Return the offset of the first block of the given type at or after
+ * from, or len if there is none */
+uint64_t
+PTFFormat::findblock(uint64_t from, uint8_t type) const {
+	const std::vector<uint64_t>& b = blocks[type];
+	std::vector<uint64_t>::const_iterator i = std::lower_bound(b.begin(), b.end(), from);
+	return (i == b.end()) ? len : *i;
+}
+
+bool
+PTFFormat::wavexists(const wav_t& w) const {
+	return (wavnames.find(w.filename) != wavnames.end() ||
+		wavindices.find(w.index) != wavindices.end());
+}
+
+void
+PTFFormat::indexwavs(void) {
+	wavnames.clear();
+	wavindices.clear();
+	for (std::vector<wav_t>::const_iterator w = actualwavs.begin(); w != actualwavs.end(); ++w) {
+		wavnames.insert(w->filename);
+		wavindices.insert(w->index);
+	}
+}
+
+void
+PTFFormat::indexregions(void) {
+	regionindex.clear();
+	for (size_t i = 0; i < regions.size(); i++) {
+		/* the first region with an index is the one found */
+		regionindex.insert(std::make_pair(regions[i].index, i));
+	}
+}
+
+bool
+PTFFormat::findregion(region_t& r) const {
+	std::map<uint16_t, size_t>::const_iterator i = regionindex.find(r.index);
+	if (i == regionindex.end()) {
+		return false;
+	}
+	r = regions[i->second];
+	return true;
+}
+
 bool
 PTFFormat::parse_version() {
 	uint32_t seg_len,str_len;
@@ -322,14 +386,10 @@ PTFFormat::parse7header(void) {
 	uint64_t k;
 
 	// Find session sample rate
-	k = 0x100;
-	while (k < len) {
-		if (		(ptfunxored[k  ] == 0x5a) &&
-				(ptfunxored[k+1] == 0x00) &&
-				(ptfunxored[k+2] == 0x05)) {
+	for (k = findblock(0x100, 0x00); k < len; k = findblock(k+1, 0x00)) {
+		if (ptfunxored[k+2] == 0x05) {
 			break;
 		}
-		k++;
 	}
 
 	sessionrate = 0;
@@ -343,14 +403,7 @@ PTFFormat::parse8header(void) {
 	uint64_t k;
 
 	// Find session sample rate
-	k = 0;
-	while (k < len) {
-		if (		(ptfunxored[k  ] == 0x5a) &&
-				(ptfunxored[k+1] == 0x05)) {
-			break;
-		}
-		k++;
-	}
+	k = findblock(0, 0x05);
 
 	sessionrate = 0;
 	sessionrate |= ptfunxored[k+11];
@@ -363,14 +416,7 @@ PTFFormat::parse9header(void) {
 	uint64_t k;
 
 	// Find session sample rate
-	k = 0x100;
-	while (k < len) {
-		if (		(ptfunxored[k  ] == 0x5a) &&
-				(ptfunxored[k+1] == 0x06)) {
-			break;
-		}
-		k++;
-	}
+	k = findblock(0x100, 0x06);
 
 	sessionrate = 0;
 	sessionrate |= ptfunxored[k+11];
@@ -383,14 +429,7 @@ PTFFormat::parse10header(void) {
 	uint64_t k;
 
 	// Find session sample rate
-	k = 0x100;
-	while (k < len) {
-		if (		(ptfunxored[k  ] == 0x5a) &&
-				(ptfunxored[k+1] == 0x09)) {
-			break;
-		}
-		k++;
-	}
+	k = findblock(0x100, 0x09);
 
 	sessionrate = 0;
 	sessionrate |= ptfunxored[k+11];
@@ -892,232 +931,206 @@ PTFFormat::parserest89(void) {
 	}
 	uint16_t rindex = 0;
 	uint32_t findex = 0;
-	for (i = k; i < len-70; i++) {
-		if (		(ptfunxored[i  ] == 0x5a) &&
-				(ptfunxored[i+1] == 0x0a)) {
-				break;
-		}
-		if (		(ptfunxored[i  ] == 0x5a) &&
-				(ptfunxored[i+1] == 0x0c)) {
+	uint64_t end = std::min(findblock(k, 0x0a), len-70);
+	indexwavs();
+	const std::vector<uint64_t>& rb = blocks[0x0c];
+	for (std::vector<uint64_t>::const_iterator b = std::lower_bound(rb.begin(), rb.end(), k);
+			b != rb.end() && *b < end; ++b) {
+		i = *b;
 
-			uint8_t lengthofname = ptfunxored[i+9];
+		uint8_t lengthofname = ptfunxored[i+9];
 
-			char name[256] = {0};
-			for (j = 0; j < lengthofname; j++) {
-				name[j] = ptfunxored[i+13+j];
-			}
-			name[j] = '\0';
-			j += i+13;
-			//uint8_t disabled = ptfunxored[j];
+		char name[256] = {0};
+		for (j = 0; j < lengthofname; j++) {
+			name[j] = ptfunxored[i+13+j];
+		}
+		name[j] = '\0';
+		j += i+13;
+		//uint8_t disabled = ptfunxored[j];
+
+		offsetbytes = (ptfunxored[j+1] & 0xf0) >> 4;
+		lengthbytes = (ptfunxored[j+2] & 0xf0) >> 4;
+		startbytes = (ptfunxored[j+3] & 0xf0) >> 4;
+		somethingbytes = (ptfunxored[j+3] & 0xf);
+		skipbytes = ptfunxored[j+4];
+		findex = ptfunxored[j+5
+				+startbytes
+				+lengthbytes
+				+offsetbytes
+				+somethingbytes
+				+skipbytes
+				+40];
+		/*rindex = ptfunxored[j+5
+				+startbytes
+				+lengthbytes
+				+offsetbytes
+				+somethingbytes
+				+skipbytes
+				+24];
+		*/
+		uint32_t sampleoffset = 0;
+		switch (offsetbytes) {
+		case 4:
+			sampleoffset |= (uint32_t)(ptfunxored[j+8] << 24);
+		case 3:
+			sampleoffset |= (uint32_t)(ptfunxored[j+7] << 16);
+		case 2:
+			sampleoffset |= (uint32_t)(ptfunxored[j+6] << 8);
+		case 1:
+			sampleoffset |= (uint32_t)(ptfunxored[j+5]);
+		default:
+			break;
+		}
+		j+=offsetbytes;
+		uint32_t length = 0;
+		switch (lengthbytes) {
+		case 4:
+			length |= (uint32_t)(ptfunxored[j+8] << 24);
+		case 3:
+			length |= (uint32_t)(ptfunxored[j+7] << 16);
+		case 2:
+			length |= (uint32_t)(ptfunxored[j+6] << 8);
+		case 1:
+			length |= (uint32_t)(ptfunxored[j+5]);
+		default:
+			break;
+		}
+		j+=lengthbytes;
+		uint32_t start = 0;
+		switch (startbytes) {
+		case 4:
+			start |= (uint32_t)(ptfunxored[j+8] << 24);
+		case 3:
+			start |= (uint32_t)(ptfunxored[j+7] << 16);
+		case 2:
+			start |= (uint32_t)(ptfunxored[j+6] << 8);
+		case 1:
+			start |= (uint32_t)(ptfunxored[j+5]);
+		default:
+			break;
+		}
+		j+=startbytes;
+		/*
+		uint32_t something = 0;
+		switch (somethingbytes) {
+		case 4:
+			something |= (uint32_t)(ptfunxored[j+8] << 24);
+		case 3:
+			something |= (uint32_t)(ptfunxored[j+7] << 16);
+		case 2:
+			something |= (uint32_t)(ptfunxored[j+6] << 8);
+		case 1:
+			something |= (uint32_t)(ptfunxored[j+5]);
+		default:
+			break;
+		}
+		j+=somethingbytes;
+		*/
+		std::string filename = string(name) + extension;
+		wav_t f = {
+			filename,
+			0,
+			(int64_t)(start*ratefactor),
+			(int64_t)(length*ratefactor),
+		};
 
-			offsetbytes = (ptfunxored[j+1] & 0xf0) >> 4;
-			lengthbytes = (ptfunxored[j+2] & 0xf0) >> 4;
-			startbytes = (ptfunxored[j+3] & 0xf0) >> 4;
-			somethingbytes = (ptfunxored[j+3] & 0xf);
-			skipbytes = ptfunxored[j+4];
-			findex = ptfunxored[j+5
-					+startbytes
-					+lengthbytes
-					+offsetbytes
-					+somethingbytes
-					+skipbytes
-					+40];
-			/*rindex = ptfunxored[j+5
-					+startbytes
-					+lengthbytes
-					+offsetbytes
-					+somethingbytes
-					+skipbytes
-					+24];
-			*/
-			uint32_t sampleoffset = 0;
-			switch (offsetbytes) {
-			case 4:
-				sampleoffset |= (uint32_t)(ptfunxored[j+8] << 24);
-			case 3:
-				sampleoffset |= (uint32_t)(ptfunxored[j+7] << 16);
-			case 2:
-				sampleoffset |= (uint32_t)(ptfunxored[j+6] << 8);
-			case 1:
-				sampleoffset |= (uint32_t)(ptfunxored[j+5]);
-			default:
-				break;
-			}
-			j+=offsetbytes;
-			uint32_t length = 0;
-			switch (lengthbytes) {
-			case 4:
-				length |= (uint32_t)(ptfunxored[j+8] << 24);
-			case 3:
-				length |= (uint32_t)(ptfunxored[j+7] << 16);
-			case 2:
-				length |= (uint32_t)(ptfunxored[j+6] << 8);
-			case 1:
-				length |= (uint32_t)(ptfunxored[j+5]);
-			default:
-				break;
-			}
-			j+=lengthbytes;
-			uint32_t start = 0;
-			switch (startbytes) {
-			case 4:
-				start |= (uint32_t)(ptfunxored[j+8] << 24);
-			case 3:
-				start |= (uint32_t)(ptfunxored[j+7] << 16);
-			case 2:
-				start |= (uint32_t)(ptfunxored[j+6] << 8);
-			case 1:
-				start |= (uint32_t)(ptfunxored[j+5]);
-			default:
-				break;
-			}
-			j+=startbytes;
-			/*
-			uint32_t something = 0;
-			switch (somethingbytes) {
-			case 4:
-				something |= (uint32_t)(ptfunxored[j+8] << 24);
-			case 3:
-				something |= (uint32_t)(ptfunxored[j+7] << 16);
-			case 2:
-				something |= (uint32_t)(ptfunxored[j+6] << 8);
-			case 1:
-				something |= (uint32_t)(ptfunxored[j+5]);
-			default:
-				break;
-			}
-			j+=somethingbytes;
-			*/
-			std::string filename = string(name) + extension;
-			wav_t f = {
-				filename,
-				0,
+		f.index = findex;
+		//printf("something=%d\n", something);
+
+		// Add file to list only if it is an actual wav
+		if (wavexists(f)) {
+			audiofiles.push_back(f);
+			// Also add plain wav as region
+			std::vector<midi_ev_t> m;
+			region_t r = {
+				name,
+				rindex,
 				(int64_t)(start*ratefactor),
+				(int64_t)(sampleoffset*ratefactor),
 				(int64_t)(length*ratefactor),
+				f,
+				m
 			};
-
-			f.index = findex;
-			//printf("something=%d\n", something);
-
-			vector<wav_t>::iterator begin = actualwavs.begin();
-			vector<wav_t>::iterator finish = actualwavs.end();
-			vector<wav_t>::iterator found;
-			// Add file to list only if it is an actual wav
-			if ((found = std::find(begin, finish, f)) != finish) {
-				audiofiles.push_back(f);
-				// Also add plain wav as region
-				std::vector<midi_ev_t> m;
-				region_t r = {
-					name,
-					rindex,
-					(int64_t)(start*ratefactor),
-					(int64_t)(sampleoffset*ratefactor),
-					(int64_t)(length*ratefactor),
-					f,
-					m
-				};
-				regions.push_back(r);
-			// Region only
-			} else {
-				if (foundin(filename, string(".grp"))) {
-					continue;
-				}
-				std::vector<midi_ev_t> m;
-				region_t r = {
-					name,
-					rindex,
-					(int64_t)(start*ratefactor),
-					(int64_t)(sampleoffset*ratefactor),
-					(int64_t)(length*ratefactor),
-					f,
-					m
-				};
-				regions.push_back(r);
+			regions.push_back(r);
+		// Region only
+		} else {
+			if (foundin(filename, string(".grp"))) {
+				continue;
 			}
-			rindex++;
+			std::vector<midi_ev_t> m;
+			region_t r = {
+				name,
+				rindex,
+				(int64_t)(start*ratefactor),
+				(int64_t)(sampleoffset*ratefactor),
+				(int64_t)(length*ratefactor),
+				f,
+				m
+			};
+			regions.push_back(r);
 		}
+		rindex++;
 	}
 
-	while (k < len) {
-		if (		(ptfunxored[k  ] == 0x5a) &&
-				(ptfunxored[k+1] == 0x03)) {
-				break;
-		}
-		k++;
-	}
-	while (k < len) {
-		if (		(ptfunxored[k  ] == 0x5a) &&
-				(ptfunxored[k+1] == 0x02)) {
-				break;
-		}
-		k++;
-	}
+	k = findblock(k, 0x03);
+	k = findblock(k, 0x02);
 	k++;
 
 	//  Tracks
 	uint32_t offset;
 	uint32_t tracknumber = 0;
 	uint32_t regionspertrack = 0;
-	for (;k < len; k++) {
-		if (	(ptfunxored[k  ] == 0x5a) &&
-			(ptfunxored[k+1] == 0x04)) {
-			break;
+	indexregions();
+	end = findblock(k, 0x04);
+	const std::vector<uint64_t>& tb = blocks[0x02];
+	for (std::vector<uint64_t>::const_iterator b = std::lower_bound(tb.begin(), tb.end(), k);
+			b != tb.end() && *b < end; ++b) {
+		k = *b;
+
+		uint8_t lengthofname = 0;
+		lengthofname = ptfunxored[k+9];
+		if (lengthofname == 0x5a) {
+			continue;
 		}
-		if (	(ptfunxored[k  ] == 0x5a) &&
-			(ptfunxored[k+1] == 0x02)) {
+		track_t tr;
 
-			uint8_t lengthofname = 0;
-			lengthofname = ptfunxored[k+9];
-			if (lengthofname == 0x5a) {
-				continue;
-			}
-			track_t tr;
+		regionspertrack = (uint8_t)(ptfunxored[k+13+lengthofname]);
 
-			regionspertrack = (uint8_t)(ptfunxored[k+13+lengthofname]);
+		//printf("regions/track=%d\n", regionspertrack);
+		char name[256] = {0};
+		for (j = 0; j < lengthofname; j++) {
+			name[j] = ptfunxored[j+k+13];
+		}
+		name[j] = '\0';
+		tr.name = string(name);
+		tr.index = tracknumber++;
 
-			//printf("regions/track=%d\n", regionspertrack);
-			char name[256] = {0};
-			for (j = 0; j < lengthofname; j++) {
-				name[j] = ptfunxored[j+k+13];
+		for (j = k; regionspertrack > 0 && j < len; j++) {
+			l = findblock(j, 0x07);
+			if (l == len) {
+				break;
 			}
-			name[j] = '\0';
-			tr.name = string(name);
-			tr.index = tracknumber++;
-
-			for (j = k; regionspertrack > 0 && j < len; j++) {
-				for (l = j; l < len; l++) {
-					if (	(ptfunxored[l  ] == 0x5a) &&
-						(ptfunxored[l+1] == 0x07)) {
-						j = l;
-						break;
-					}
-				}
+			j = l;
 
 
-				if (regionspertrack == 0) {
-				//	tr.reg.index = (uint8_t)ptfunxored[j+13+lengthofname+5];
-					break;
-				} else {
+			if (regionspertrack == 0) {
+			//	tr.reg.index = (uint8_t)ptfunxored[j+13+lengthofname+5];
+				break;
+			} else {
 
-					tr.reg.index = (uint8_t)(ptfunxored[l+11]);
-					vector<region_t>::iterator begin = regions.begin();
-					vector<region_t>::iterator finish = regions.end();
-					vector<region_t>::iterator found;
-					if ((found = std::find(begin, finish, tr.reg)) != finish) {
-						tr.reg = (*found);
-					}
-					i = l+16;
-					offset = 0;
-					offset |= (uint32_t)(ptfunxored[i+3] << 24);
-					offset |= (uint32_t)(ptfunxored[i+2] << 16);
-					offset |= (uint32_t)(ptfunxored[i+1] << 8);
-					offset |= (uint32_t)(ptfunxored[i]);
-					tr.reg.startpos = (int64_t)(offset*ratefactor);
-					if (tr.reg.length > 0) {
-						tracks.push_back(tr);
-					}
-					regionspertrack--;
+				tr.reg.index = (uint8_t)(ptfunxored[l+11]);
+				findregion(tr.reg);
+				i = l+16;
+				offset = 0;
+				offset |= (uint32_t)(ptfunxored[i+3] << 24);
+				offset |= (uint32_t)(ptfunxored[i+2] << 16);
+				offset |= (uint32_t)(ptfunxored[i+1] << 8);
+				offset |= (uint32_t)(ptfunxored[i]);
+				tr.reg.startpos = (int64_t)(offset*ratefactor);
+				if (tr.reg.length > 0) {
+					tracks.push_back(tr);
 				}
+				regionspertrack--;
 			}
 		}
 	}
@@ -1143,250 +1156,223 @@ PTFFormat::parserest10(void) {
 		}
 		k++;
 	}
-	for (i = k; i < len-70; i++) {
-		if (		(ptfunxored[i  ] == 0x5a) &&
-				(ptfunxored[i+1] == 0x02)) {
-				k = i;
-				break;
-		}
+	if ((i = findblock(k, 0x02)) < len-70) {
+		k = i;
 	}
 	k++;
-	for (i = k; i < len-70; i++) {
-		if (		(ptfunxored[i  ] == 0x5a) &&
-				(ptfunxored[i+1] == 0x02)) {
-				k = i;
-				break;
-		}
+	if ((i = findblock(k, 0x02)) < len-70) {
+		k = i;
 	}
 	k++;
 	uint16_t rindex = 0;
 	uint32_t findex = 0;
-	for (i = k; i < len-70; i++) {
-		if (		(ptfunxored[i  ] == 0x5a) &&
-				(ptfunxored[i+1] == 0x08)) {
-				break;
+	uint64_t end = std::min(findblock(k, 0x08), len-70);
+	indexwavs();
+	const std::vector<uint64_t>& rb = blocks[0x01];
+	for (std::vector<uint64_t>::const_iterator b = std::lower_bound(rb.begin(), rb.end(), k);
+			b != rb.end() && *b < end; ++b) {
+		i = *b;
+
+		uint8_t lengthofname = ptfunxored[i+9];
+		if (ptfunxored[i+13] == 0x5a) {
+			continue;
 		}
-		if (		(ptfunxored[i  ] == 0x5a) &&
-				(ptfunxored[i+1] == 0x01)) {
-
-			uint8_t lengthofname = ptfunxored[i+9];
-			if (ptfunxored[i+13] == 0x5a) {
-				continue;
-			}
-			char name[256] = {0};
-			for (j = 0; j < lengthofname; j++) {
-				name[j] = ptfunxored[i+13+j];
-			}
-			name[j] = '\0';
-			j += i+13;
-			//uint8_t disabled = ptfunxored[j];
-			//printf("%s\n", name);
+		char name[256] = {0};
+		for (j = 0; j < lengthofname; j++) {
+			name[j] = ptfunxored[i+13+j];
+		}
+		name[j] = '\0';
+		j += i+13;
+		//uint8_t disabled = ptfunxored[j];
+		//printf("%s\n", name);
+
+		offsetbytes = (ptfunxored[j+1] & 0xf0) >> 4;
+		lengthbytes = (ptfunxored[j+2] & 0xf0) >> 4;
+		startbytes = (ptfunxored[j+3] & 0xf0) >> 4;
+		somethingbytes = (ptfunxored[j+3] & 0xf);
+		skipbytes = ptfunxored[j+4];
+		findex = ptfunxored[j+5
+				+startbytes
+				+lengthbytes
+				+offsetbytes
+				+somethingbytes
+				+skipbytes
+				+37];
+		/*rindex = ptfunxored[j+5
+				+startbytes
+				+lengthbytes
+				+offsetbytes
+				+somethingbytes
+				+skipbytes
+				+24];
+		*/
+		uint32_t sampleoffset = 0;
+		switch (offsetbytes) {
+		case 4:
+			sampleoffset |= (uint32_t)(ptfunxored[j+8] << 24);
+		case 3:
+			sampleoffset |= (uint32_t)(ptfunxored[j+7] << 16);
+		case 2:
+			sampleoffset |= (uint32_t)(ptfunxored[j+6] << 8);
+		case 1:
+			sampleoffset |= (uint32_t)(ptfunxored[j+5]);
+		default:
+			break;
+		}
+		j+=offsetbytes;
+		uint32_t length = 0;
+		switch (lengthbytes) {
+		case 4:
+			length |= (uint32_t)(ptfunxored[j+8] << 24);
+		case 3:
+			length |= (uint32_t)(ptfunxored[j+7] << 16);
+		case 2:
+			length |= (uint32_t)(ptfunxored[j+6] << 8);
+		case 1:
+			length |= (uint32_t)(ptfunxored[j+5]);
+		default:
+			break;
+		}
+		j+=lengthbytes;
+		uint32_t start = 0;
+		switch (startbytes) {
+		case 4:
+			start |= (uint32_t)(ptfunxored[j+8] << 24);
+		case 3:
+			start |= (uint32_t)(ptfunxored[j+7] << 16);
+		case 2:
+			start |= (uint32_t)(ptfunxored[j+6] << 8);
+		case 1:
+			start |= (uint32_t)(ptfunxored[j+5]);
+		default:
+			break;
+		}
+		j+=startbytes;
+		/*
+		uint32_t something = 0;
+		switch (somethingbytes) {
+		case 4:
+			something |= (uint32_t)(ptfunxored[j+8] << 24);
+		case 3:
+			something |= (uint32_t)(ptfunxored[j+7] << 16);
+		case 2:
+			something |= (uint32_t)(ptfunxored[j+6] << 8);
+		case 1:
+			something |= (uint32_t)(ptfunxored[j+5]);
+		default:
+			break;
+		}
+		j+=somethingbytes;
+		*/
+		std::string filename = string(name) + extension;
+		wav_t f = {
+			filename,
+			0,
+			(int64_t)(start*ratefactor),
+			(int64_t)(length*ratefactor),
+		};
 
-			offsetbytes = (ptfunxored[j+1] & 0xf0) >> 4;
-			lengthbytes = (ptfunxored[j+2] & 0xf0) >> 4;
-			startbytes = (ptfunxored[j+3] & 0xf0) >> 4;
-			somethingbytes = (ptfunxored[j+3] & 0xf);
-			skipbytes = ptfunxored[j+4];
-			findex = ptfunxored[j+5
-					+startbytes
-					+lengthbytes
-					+offsetbytes
-					+somethingbytes
-					+skipbytes
-					+37];
-			/*rindex = ptfunxored[j+5
-					+startbytes
-					+lengthbytes
-					+offsetbytes
-					+somethingbytes
-					+skipbytes
-					+24];
-			*/
-			uint32_t sampleoffset = 0;
-			switch (offsetbytes) {
-			case 4:
-				sampleoffset |= (uint32_t)(ptfunxored[j+8] << 24);
-			case 3:
-				sampleoffset |= (uint32_t)(ptfunxored[j+7] << 16);
-			case 2:
-				sampleoffset |= (uint32_t)(ptfunxored[j+6] << 8);
-			case 1:
-				sampleoffset |= (uint32_t)(ptfunxored[j+5]);
-			default:
-				break;
-			}
-			j+=offsetbytes;
-			uint32_t length = 0;
-			switch (lengthbytes) {
-			case 4:
-				length |= (uint32_t)(ptfunxored[j+8] << 24);
-			case 3:
-				length |= (uint32_t)(ptfunxored[j+7] << 16);
-			case 2:
-				length |= (uint32_t)(ptfunxored[j+6] << 8);
-			case 1:
-				length |= (uint32_t)(ptfunxored[j+5]);
-			default:
-				break;
-			}
-			j+=lengthbytes;
-			uint32_t start = 0;
-			switch (startbytes) {
-			case 4:
-				start |= (uint32_t)(ptfunxored[j+8] << 24);
-			case 3:
-				start |= (uint32_t)(ptfunxored[j+7] << 16);
-			case 2:
-				start |= (uint32_t)(ptfunxored[j+6] << 8);
-			case 1:
-				start |= (uint32_t)(ptfunxored[j+5]);
-			default:
-				break;
-			}
-			j+=startbytes;
-			/*
-			uint32_t something = 0;
-			switch (somethingbytes) {
-			case 4:
-				something |= (uint32_t)(ptfunxored[j+8] << 24);
-			case 3:
-				something |= (uint32_t)(ptfunxored[j+7] << 16);
-			case 2:
-				something |= (uint32_t)(ptfunxored[j+6] << 8);
-			case 1:
-				something |= (uint32_t)(ptfunxored[j+5]);
-			default:
-				break;
-			}
-			j+=somethingbytes;
-			*/
-			std::string filename = string(name) + extension;
-			wav_t f = {
-				filename,
-				0,
+		if (strlen(name) == 0) {
+			continue;
+		}
+		if (length == 0) {
+			continue;
+		}
+		f.index = findex;
+		//printf("something=%d\n", something);
+
+		// Add file to list only if it is an actual wav
+		if (wavexists(f)) {
+			audiofiles.push_back(f);
+			// Also add plain wav as region
+			std::vector<midi_ev_t> m;
+			region_t r = {
+				name,
+				rindex,
 				(int64_t)(start*ratefactor),
+				(int64_t)(sampleoffset*ratefactor),
 				(int64_t)(length*ratefactor),
+				f,
+				m
 			};
-
-			if (strlen(name) == 0) {
-				continue;
-			}
-			if (length == 0) {
+			regions.push_back(r);
+		// Region only
+		} else {
+			if (foundin(filename, string(".grp"))) {
 				continue;
 			}
-			f.index = findex;
-			//printf("something=%d\n", something);
-
-			vector<wav_t>::iterator begin = actualwavs.begin();
-			vector<wav_t>::iterator finish = actualwavs.end();
-			vector<wav_t>::iterator found;
-			// Add file to list only if it is an actual wav
-			if ((found = std::find(begin, finish, f)) != finish) {
-				audiofiles.push_back(f);
-				// Also add plain wav as region
-				std::vector<midi_ev_t> m;
-				region_t r = {
-					name,
-					rindex,
-					(int64_t)(start*ratefactor),
-					(int64_t)(sampleoffset*ratefactor),
-					(int64_t)(length*ratefactor),
-					f,
-					m
-				};
-				regions.push_back(r);
-			// Region only
-			} else {
-				if (foundin(filename, string(".grp"))) {
-					continue;
-				}
-				std::vector<midi_ev_t> m;
-				region_t r = {
-					name,
-					rindex,
-					(int64_t)(start*ratefactor),
-					(int64_t)(sampleoffset*ratefactor),
-					(int64_t)(length*ratefactor),
-					f,
-					m
-				};
-				regions.push_back(r);
-			}
-			rindex++;
-			//printf("%s\n", name);
+			std::vector<midi_ev_t> m;
+			region_t r = {
+				name,
+				rindex,
+				(int64_t)(start*ratefactor),
+				(int64_t)(sampleoffset*ratefactor),
+				(int64_t)(length*ratefactor),
+				f,
+				m
+			};
+			regions.push_back(r);
 		}
+		rindex++;
+		//printf("%s\n", name);
 	}
 	//  Tracks
 	uint32_t offset;
 	uint32_t tracknumber = 0;
 	uint32_t regionspertrack = 0;
-	for (;k < len; k++) {
-		if (	(ptfunxored[k  ] == 0x5a) &&
-			(ptfunxored[k+1] == 0x08)) {
-			break;
-		}
-	}
+	k = findblock(k, 0x08);
 	k++;
-	for (;k < len; k++) {
-		if (	(ptfunxored[k  ] == 0x5a) &&
-			(ptfunxored[k+1] == 0x04)) {
-			break;
+	indexregions();
+	end = findblock(k, 0x04);
+	const std::vector<uint64_t>& tb = blocks[0x02];
+	for (std::vector<uint64_t>::const_iterator b = std::lower_bound(tb.begin(), tb.end(), k);
+			b != tb.end() && *b < end; ++b) {
+		k = *b;
+
+		uint8_t lengthofname = 0;
+		lengthofname = ptfunxored[k+9];
+		if (lengthofname == 0x5a) {
+			continue;
 		}
-		if (	(ptfunxored[k  ] == 0x5a) &&
-			(ptfunxored[k+1] == 0x02)) {
+		track_t tr;
 
-			uint8_t lengthofname = 0;
-			lengthofname = ptfunxored[k+9];
-			if (lengthofname == 0x5a) {
-				continue;
-			}
-			track_t tr;
+		regionspertrack = (uint8_t)(ptfunxored[k+13+lengthofname]);
 
-			regionspertrack = (uint8_t)(ptfunxored[k+13+lengthofname]);
+		//printf("regions/track=%d\n", regionspertrack);
+		char name[256] = {0};
+		for (j = 0; j < lengthofname; j++) {
+			name[j] = ptfunxored[j+k+13];
+		}
+		name[j] = '\0';
+		tr.name = string(name);
+		tr.index = tracknumber++;
 
-			//printf("regions/track=%d\n", regionspertrack);
-			char name[256] = {0};
-			for (j = 0; j < lengthofname; j++) {
-				name[j] = ptfunxored[j+k+13];
+		for (j = k; regionspertrack > 0 && j < len; j++) {
+			l = findblock(j, 0x08);
+			if (l == len) {
+				break;
 			}
-			name[j] = '\0';
-			tr.name = string(name);
-			tr.index = tracknumber++;
-
-			for (j = k; regionspertrack > 0 && j < len; j++) {
-				for (l = j; l < len; l++) {
-					if (	(ptfunxored[l  ] == 0x5a) &&
-						(ptfunxored[l+1] == 0x08)) {
-						j = l+1;
-						break;
-					}
-				}
+			j = l+1;
 
 
-				if (regionspertrack == 0) {
-				//	tr.reg.index = (uint8_t)ptfunxored[j+13+lengthofname+5];
-					break;
-				} else {
+			if (regionspertrack == 0) {
+			//	tr.reg.index = (uint8_t)ptfunxored[j+13+lengthofname+5];
+				break;
+			} else {
 
-					tr.reg.index = (uint8_t)(ptfunxored[l+11]);
-					vector<region_t>::iterator begin = regions.begin();
-					vector<region_t>::iterator finish = regions.end();
-					vector<region_t>::iterator found;
-					if ((found = std::find(begin, finish, tr.reg)) != finish) {
-						tr.reg = (*found);
-					}
-					i = l+16;
-					offset = 0;
-					offset |= (uint32_t)(ptfunxored[i+3] << 24);
-					offset |= (uint32_t)(ptfunxored[i+2] << 16);
-					offset |= (uint32_t)(ptfunxored[i+1] << 8);
-					offset |= (uint32_t)(ptfunxored[i]);
-					tr.reg.startpos = (int64_t)(offset*ratefactor);
-					if (tr.reg.length > 0) {
-						tracks.push_back(tr);
-					}
-					regionspertrack--;
+				tr.reg.index = (uint8_t)(ptfunxored[l+11]);
+				findregion(tr.reg);
+				i = l+16;
+				offset = 0;
+				offset |= (uint32_t)(ptfunxored[i+3] << 24);
+				offset |= (uint32_t)(ptfunxored[i+2] << 16);
+				offset |= (uint32_t)(ptfunxored[i+1] << 8);
+				offset |= (uint32_t)(ptfunxored[i]);
+				tr.reg.startpos = (int64_t)(offset*ratefactor);
+				if (tr.reg.length > 0) {
+					tracks.push_back(tr);
 				}
+				regionspertrack--;
 			}
 		}
 	}
@@ -19,6 +19,8 @@
 #include <cstring>
 #include <algorithm>
 #include <vector>
+#include <map>
+#include <set>
 #include <stdint.h>
 #include "ptformat/visibility.h"
 
@@ -121,6 +123,10 @@ public:
 	uint8_t *product;
 
 
+	/* time taken to decrypt and index, and to parse the file, in microseconds */
+	int64_t decodetime;
+	int64_t parsetime;
+
 	unsigned char c0;
 	unsigned char c1;
 	unsigned char *ptfunxored;
@@ -128,6 +134,11 @@ public:
 
 private:
 	bool foundin(std::string haystack, std::string needle);
+	uint64_t findblock(uint64_t from, uint8_t type) const;
+	void indexwavs(void);
+	bool wavexists(const wav_t& w) const;
+	void indexregions(void);
+	bool findregion(region_t& r) const;
 	int parse(void);
 	bool parse_version();
 	uint8_t gen_xor_delta(uint8_t xor_value, uint8_t mul, bool negative);
@@ -146,6 +157,11 @@ private:
 	void resort(std::vector<wav_t>& ws);
 	std::vector<wav_t> actualwavs;
 	float ratefactor;
+	/* offsets of all 0x5a block markers, by the type (byte) following them */
+	std::vector<uint64_t> blocks[256];
+	std::set<std::string> wavnames;
+	std::set<uint16_t> wavindices;
+	std::map<uint16_t, size_t> regionindex;
 	std::string extension;
 	unsigned char key10a;
 	unsigned char key10b;
@@ -10,8 +10,14 @@
 
 #include "maths/MathUtilities.h"
 
+#ifdef HAVE_FFTW3
+#include <fftw3.h>
+#include <pthread.h>
+#include <map>
+#else
 #include "kiss_fft.h"
 #include "kiss_fftr.h"
+#endif
 
 #include <cmath>
 
@@ -19,6 +25,124 @@
 
 #include <stdexcept>
 
+#ifdef HAVE_FFTW3
+
+// Plans are made once for each size and kind of transform and shared
+// by all FFT and FFTReal objects of that size; they are never
+// destroyed. Making a plan is not thread-safe, but executing one on
+// other arrays is, as long as they are aligned like those it was made
+// with, which fftw_malloc() takes care of. Our own planning is
+// serialised by planLock; FFTW is only used where its planner can be
+// made thread-safe (FFTW >= 3.3.5, not windows), because other users of
+// FFTW in the process, such as rubberband, do not take that lock.
+
+namespace {
+
+struct Plans {
+    fftw_plan forward;
+    fftw_plan inverse;
+};
+
+pthread_mutex_t planLock = PTHREAD_MUTEX_INITIALIZER;
+std::map<int, Plans> complexPlans;
+std::map<int, Plans> realPlans;
+
+Plans
+getPlans(int n, bool real)
+{
+    pthread_mutex_lock(&planLock);
+
+    static bool threadSafe = false;
+    if (!threadSafe) {
+        fftw_make_planner_thread_safe();
+        threadSafe = true;
+    }
+
+    std::map<int, Plans> &cache = (real ? realPlans : complexPlans);
+    std::map<int, Plans>::iterator i = cache.find(n);
+
+    if (i == cache.end()) {
+        Plans p;
+        if (real) {
+            double *r = (double *)fftw_malloc(n * sizeof(double));
+            fftw_complex *c = (fftw_complex *)fftw_malloc((n/2 + 1) * sizeof(fftw_complex));
+            p.forward = fftw_plan_dft_r2c_1d(n, r, c, FFTW_MEASURE);
+            p.inverse = fftw_plan_dft_c2r_1d(n, c, r, FFTW_MEASURE);
+            fftw_free(r);
+            fftw_free(c);
+        } else {
+            fftw_complex *a = (fftw_complex *)fftw_malloc(n * sizeof(fftw_complex));
+            fftw_complex *b = (fftw_complex *)fftw_malloc(n * sizeof(fftw_complex));
+            p.forward = fftw_plan_dft_1d(n, a, b, FFTW_FORWARD, FFTW_MEASURE);
+            p.inverse = fftw_plan_dft_1d(n, a, b, FFTW_BACKWARD, FFTW_MEASURE);
+            fftw_free(a);
+            fftw_free(b);
+        }
+        i = cache.insert(std::make_pair(n, p)).first;
+    }
+
+    Plans p = i->second;
+    pthread_mutex_unlock(&planLock);
+    return p;
+}
+
+}
+
+class FFT::D
+{
+public:
+    D(int n) : m_n(n), m_plans(getPlans(n, false)) {
+        m_in = (fftw_complex *)fftw_malloc(m_n * sizeof(fftw_complex));
+        m_out = (fftw_complex *)fftw_malloc(m_n * sizeof(fftw_complex));
+    }
+
+    ~D() {
+        fftw_free(m_in);
+        fftw_free(m_out);
+    }
+
+    void process(bool inverse,
+                 const double *ri,
+                 const double *ii,
+                 double *ro,
+                 double *io) {
+
+        for (int i = 0; i < m_n; ++i) {
+            m_in[i][0] = ri[i];
+            m_in[i][1] = (ii ? ii[i] : 0.0);
+        }
+
+        if (!inverse) {
+
+            fftw_execute_dft(m_plans.forward, m_in, m_out);
+
+            for (int i = 0; i < m_n; ++i) {
+                ro[i] = m_out[i][0];
+                io[i] = m_out[i][1];
+            }
+
+        } else {
+
+            fftw_execute_dft(m_plans.inverse, m_in, m_out);
+
+            double scale = 1.0 / m_n;
+
+            for (int i = 0; i < m_n; ++i) {
+                ro[i] = m_out[i][0] * scale;
+                io[i] = m_out[i][1] * scale;
+            }
+        }
+    }
+
+private:
+    int m_n;
+    Plans m_plans;
+    fftw_complex *m_in;
+    fftw_complex *m_out;
+};
+
+#else // !HAVE_FFTW3
+
 class FFT::D
 {
 public:
@@ -77,6 +201,8 @@ private:
     kiss_fft_cpx *m_kout;
 };        
 
+#endif // !HAVE_FFTW3
+
 FFT::FFT(int n) :
     m_d(new D(n))
 {
@@ -97,6 +223,88 @@ FFT::process(bool inverse,
                  p_lpRealOut, p_lpImagOut);
 }
     
+#ifdef HAVE_FFTW3
+
+class FFTReal::D
+{
+public:
+    D(int n) : m_n(n) {
+        if (n % 2) {
+            throw std::invalid_argument
+                ("nsamples must be even in FFTReal constructor");
+        }
+        m_plans = getPlans(m_n, true);
+        m_r = (double *)fftw_malloc(m_n * sizeof(double));
+        m_c = (fftw_complex *)fftw_malloc((m_n/2 + 1) * sizeof(fftw_complex));
+    }
+
+    ~D() {
+        fftw_free(m_r);
+        fftw_free(m_c);
+    }
+
+    void forward(const double *ri, double *ro, double *io) {
+
+        transform(ri);
+
+        for (int i = 0; i <= m_n/2; ++i) {
+            ro[i] = m_c[i][0];
+            io[i] = m_c[i][1];
+        }
+
+        for (int i = 0; i + 1 < m_n/2; ++i) {
+            ro[m_n - i - 1] =  ro[i + 1];
+            io[m_n - i - 1] = -io[i + 1];
+        }
+    }
+
+    void forwardMagnitude(const double *ri, double *mo) {
+
+        transform(ri);
+
+        for (int i = 0; i <= m_n/2; ++i) {
+            mo[i] = sqrt(m_c[i][0] * m_c[i][0] + m_c[i][1] * m_c[i][1]);
+        }
+
+        for (int i = 0; i + 1 < m_n/2; ++i) {
+            mo[m_n - i - 1] = mo[i + 1];
+        }
+    }
+
+    void inverse(const double *ri, const double *ii, double *ro) {
+
+        for (int i = 0; i < m_n/2 + 1; ++i) {
+            m_c[i][0] = ri[i];
+            m_c[i][1] = ii[i];
+        }
+
+        fftw_execute_dft_c2r(m_plans.inverse, m_c, m_r);
+
+        double scale = 1.0 / m_n;
+
+        for (int i = 0; i < m_n; ++i) {
+            ro[i] = m_r[i] * scale;
+        }
+    }
+
+private:
+    void transform(const double *ri) {
+        // the input has to be copied, as the caller's array may not
+        // be aligned the way the plan expects
+        for (int i = 0; i < m_n; ++i) {
+            m_r[i] = ri[i];
+        }
+        fftw_execute_dft_r2c(m_plans.forward, m_r, m_c);
+    }
+
+    int m_n;
+    Plans m_plans;
+    double *m_r;
+    fftw_complex *m_c;
+};
+
+#else // !HAVE_FFTW3
+
 class FFTReal::D
 {
 public:
@@ -133,15 +341,15 @@ public:
 
     void forwardMagnitude(const double *ri, double *mo) {
 
-        double *io = new double[m_n];
-
-        forward(ri, mo, io);
+        kiss_fftr(m_planf, ri, m_c);
 
-        for (int i = 0; i < m_n; ++i) {
-            mo[i] = sqrt(mo[i] * mo[i] + io[i] * io[i]);
+        for (int i = 0; i <= m_n/2; ++i) {
+            mo[i] = sqrt(m_c[i].r * m_c[i].r + m_c[i].i * m_c[i].i);
         }
 
-        delete[] io;
+        for (int i = 0; i + 1 < m_n/2; ++i) {
+            mo[m_n - i - 1] = mo[i + 1];
+        }
     }
 
     void inverse(const double *ri, const double *ii, double *ro) {
@@ -170,6 +378,8 @@ private:
     kiss_fft_cpx *m_c;
 };
 
+#endif // !HAVE_FFTW3
+
 FFTReal::FFTReal(int n) :
     m_d(new D(n)) 
 {
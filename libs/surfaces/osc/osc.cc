@@ -34,6 +34,7 @@
 #include <pbd/failed_constructor.h>
 
 #include "ardour/amp.h"
+#include "ardour/audioengine.h"
 #include "ardour/session.h"
 #include "ardour/route.h"
 #include "ardour/audio_track.h"
@@ -41,6 +42,7 @@
 #include "ardour/monitor_control.h"
 #include "ardour/dB.h"
 #include "ardour/filesystem_paths.h"
+#include "ardour/meter.h"
 #include "ardour/panner.h"
 #include "ardour/plugin.h"
 #include "ardour/plugin_insert.h"
@@ -544,6 +546,7 @@ OSC::register_callbacks()
 		REGISTER_CALLBACK (serv, "/monitor/mute", "i", monitor_set_mute);
 		REGISTER_CALLBACK (serv, "/monitor/dim", "i", monitor_set_dim);
 		REGISTER_CALLBACK (serv, "/monitor/mono", "i", monitor_set_mono);
+		REGISTER_CALLBACK (serv, "/dsp_profiling", "i", set_dsp_profiling);
 
 		// Controls for the Selected strip
 		REGISTER_CALLBACK (serv, "/select/recenable", "i", sel_recenable);
@@ -610,6 +613,7 @@ OSC::register_callbacks()
 		REGISTER_CALLBACK(serv, "/strip/plugin/list", "i", route_plugin_list);
 		REGISTER_CALLBACK(serv, "/strip/plugin/descriptor", "ii", route_plugin_descriptor);
 		REGISTER_CALLBACK(serv, "/strip/plugin/reset", "ii", route_plugin_reset);
+		REGISTER_CALLBACK(serv, "/strip/dsp_profile", "i", route_dsp_profile);
 
 		/* still not-really-standardized query interface */
 		//REGISTER_CALLBACK (serv, "/ardour/*/#current_value", "", current_value);
@@ -1846,6 +1850,23 @@ OSC::monitor_set_mono (uint32_t state)
 	return 0;
 }
 
+int
+OSC::set_dsp_profiling (uint32_t yn)
+{
+	if (!session) return -1;
+
+	if (yn && !session->engine().profiling()) {
+		/* start from scratch */
+		session->engine().reset_cycle_timing ();
+		boost::shared_ptr<RouteList> rl = session->get_routes ();
+		for (RouteList::iterator i = rl->begin(); i != rl->end(); ++i) {
+			(*i)->reset_dsp_timing ();
+		}
+	}
+	session->engine().set_profiling (yn);
+	return 0;
+}
+
 int
 OSC::route_get_sends(lo_message msg) {
 	if (!session) {
@@ -3012,6 +3033,51 @@ OSC::route_plugin_reset (int ssid, int piid, lo_message msg) {
 	return 0;
 }
 
+void
+OSC::add_timing (lo_message reply, PBD::TimingHistogram const & t)
+{
+	lo_message_add_int64 (reply, t.count ());
+	lo_message_add_int64 (reply, t.minimum ());
+	lo_message_add_int64 (reply, t.average ());
+	lo_message_add_int64 (reply, t.maximum ());
+	lo_message_add_int64 (reply, t.percentile (0.99));
+}
+
+/* reply: ssid, then count, min, avg, max and 99th percentile (in nsec) of the
+ * time taken to process the route, followed by the name and the same figures
+ * for each of its processors. See also /dsp_profiling
+ */
+int
+OSC::route_dsp_profile (int ssid, lo_message msg) {
+	if (!session) {
+		return -1;
+	}
+
+	boost::shared_ptr<Route> r = boost::dynamic_pointer_cast<Route>(get_strip (ssid, get_address (msg)));
+
+	if (!r) {
+		PBD::error << "OSC: Invalid Remote Control ID '" << ssid << "'" << endmsg;
+		return -1;
+	}
+
+	lo_message reply = lo_message_new ();
+	lo_message_add_int32 (reply, ssid);
+	add_timing (reply, r->process_timing ());
+
+	for (uint32_t n = 0; ; ++n) {
+		boost::shared_ptr<Processor> p = r->nth_processor (n);
+		if (!p) {
+			break;
+		}
+		lo_message_add_string (reply, p->name().c_str());
+		add_timing (reply, p->dsp_timing ());
+	}
+
+	lo_send_message (get_address (msg), "/strip/dsp_profile", reply);
+	lo_message_free (reply);
+	return 0;
+}
+
 int
 OSC::route_plugin_parameter (int ssid, int piid, int par, float val, lo_message msg)
 {
@@ -3515,12 +3581,15 @@ OSC::periodic (void)
 		}
 	}
 
+	/* one copy of all meters for all observers */
+	_meters.update (session->meter_snapshot ());
+
 	for (GlobalObservers::iterator x = global_observers.begin(); x != global_observers.end(); x++) {
 
 		OSCGlobalObserver* go;
 
 		if ((go = dynamic_cast<OSCGlobalObserver*>(*x)) != 0) {
-			go->tick();
+			go->tick (_meters);
 		}
 	}
 	for (RouteObservers::iterator x = route_observers.begin(); x != route_observers.end(); x++) {
@@ -3528,14 +3597,14 @@ OSC::periodic (void)
 		OSCRouteObserver* ro;
 
 		if ((ro = dynamic_cast<OSCRouteObserver*>(*x)) != 0) {
-			ro->tick();
+			ro->tick (_meters);
 		}
 	}
 	for (uint32_t it = 0; it < _surface.size(); it++) {
 		OSCSurface* sur = &_surface[it];
 		OSCSelectObserver* so;
 		if ((so = dynamic_cast<OSCSelectObserver*>(sur->sel_obs)) != 0) {
-			so->tick();
+			so->tick (_meters);
 		}
 	}
 	for (CueObservers::iterator x = cue_observers.begin(); x != cue_observers.end(); x++) {
@@ -3543,12 +3612,21 @@ OSC::periodic (void)
 		OSCCueObserver* co;
 
 		if ((co = dynamic_cast<OSCCueObserver*>(*x)) != 0) {
-			co->tick();
+			co->tick (_meters);
 		}
 	}
 	return true;
 }
 
+float
+OSC::meter_level (MeterSnapshot::Reader const & meters, boost::shared_ptr<PeakMeter> meter)
+{
+	if (meter->snapshot_slot () != MeterSnapshot::no_slot) {
+		return meters.level (meter->snapshot_slot (), 0, MeterMCP);
+	}
+	return meter->meter_level (0, MeterMCP);
+}
+
 int
 OSC::route_send_fail (string path, uint32_t ssid, float val, lo_address addr)
 {
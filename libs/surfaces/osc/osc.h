@@ -35,8 +35,10 @@
 
 #define ABSTRACT_UI_EXPORTS
 #include "pbd/abstract_ui.h"
+#include "pbd/timing.h"
 
 #include "ardour/types.h"
+#include "ardour/meter_snapshot.h"
 #include "ardour/send.h"
 #include "control_protocol/control_protocol.h"
 
@@ -51,6 +53,7 @@ class OSCCueObserver;
 namespace ARDOUR {
 class Session;
 class Route;
+class PeakMeter;
 }
 
 /* this is mostly a placeholder because I suspect that at some
@@ -98,6 +101,11 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	typedef std::vector<boost::shared_ptr<ARDOUR::Stripable> > Sorted;
 	Sorted get_sorted_stripables(std::bitset<32> types, bool cue);
 
+	/** @return our copy of the session's meters, updated in periodic() */
+	ARDOUR::MeterSnapshot::Reader const & meters () const { return _meters; }
+	/** @return the highest level of all channels of @param meter, in dB */
+	static float meter_level (ARDOUR::MeterSnapshot::Reader const &, boost::shared_ptr<ARDOUR::PeakMeter> meter);
+
 // keep a surface's global setup by remote server url
 	struct OSCSurface {
 	public:
@@ -354,6 +362,7 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	PATH_CALLBACK1(monitor_set_mute,i,);
 	PATH_CALLBACK1(monitor_set_dim,i,);
 	PATH_CALLBACK1(monitor_set_mono,i,);
+	PATH_CALLBACK1(set_dsp_profiling,i,);
 
 #define PATH_CALLBACK1_MSG(name,arg1type) \
 	static int _ ## name (const char *path, const char *types, lo_arg **argv, int argc, void *data, void *user_data) { \
@@ -498,6 +507,7 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	PATH_CALLBACK1_MSG(route_plugin_list,i);
 	PATH_CALLBACK2_MSG(route_plugin_descriptor,i,i);
 	PATH_CALLBACK2_MSG(route_plugin_reset,i,i);
+	PATH_CALLBACK1_MSG(route_dsp_profile,i);
 
 	int route_rename (int rid, char *s, lo_message msg);
 	int route_mute (int rid, int yn, lo_message msg);
@@ -529,6 +539,8 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	int route_plugin_list(int ssid, lo_message msg);
 	int route_plugin_descriptor(int ssid, int piid, lo_message msg);
 	int route_plugin_reset(int ssid, int piid, lo_message msg);
+	int route_dsp_profile(int ssid, lo_message msg);
+	void add_timing (lo_message reply, PBD::TimingHistogram const & t);
 
 	//banking functions
 	int set_bank (uint32_t bank_start, lo_message msg);
@@ -552,6 +564,7 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	int monitor_set_mute (uint32_t state);
 	int monitor_set_dim (uint32_t state);
 	int monitor_set_mono (uint32_t state);
+	int set_dsp_profiling (uint32_t yn);
 	int sel_recenable (uint32_t state, lo_message msg);
 	int sel_recsafe (uint32_t state, lo_message msg);
 	int sel_mute (uint32_t state, lo_message msg);
@@ -600,6 +613,7 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	int cancel_all_solos ();
 	bool periodic (void);
 	sigc::connection periodic_connection;
+	ARDOUR::MeterSnapshot::Reader _meters;
 	PBD::ScopedConnectionList session_connections;
 	PBD::ScopedConnectionList cueobserver_connections;
 
@@ -56,7 +56,7 @@ OSCCueObserver::OSCCueObserver (boost::shared_ptr<Stripable> s, std::vector<boos
 	std::cout << "observer past send init\n";
 
 	tick_enable = true;
-	tick ();
+	tick (OSC::instance()->meters ());
 }
 
 OSCCueObserver::~OSCCueObserver ()
@@ -74,14 +74,14 @@ OSCCueObserver::~OSCCueObserver ()
 }
 
 void
-OSCCueObserver::tick ()
+OSCCueObserver::tick (MeterSnapshot::Reader const & meters)
 {
 	if (!tick_enable) {
 		return;
 	}
 	float now_meter;
 	if (_strip->peak_meter()) {
-		now_meter = _strip->peak_meter()->meter_level(0, MeterMCP);
+		now_meter = OSC::meter_level (meters, _strip->peak_meter());
 	} else {
 		now_meter = -193;
 	}
@@ -28,6 +28,7 @@
 #include "pbd/controllable.h"
 #include "pbd/stateful.h"
 #include "ardour/types.h"
+#include "ardour/meter_snapshot.h"
 
 class OSCCueObserver
 {
@@ -38,7 +39,7 @@ class OSCCueObserver
 
 	boost::shared_ptr<ARDOUR::Stripable> strip () const { return _strip; }
 	lo_address address() const { return addr; };
-	void tick (void);
+	void tick (ARDOUR::MeterSnapshot::Reader const &);
 	typedef std::vector<boost::shared_ptr<ARDOUR::Stripable> > Sorted;
 	Sorted sends;
 
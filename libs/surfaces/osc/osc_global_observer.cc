@@ -128,7 +128,7 @@ OSCGlobalObserver::~OSCGlobalObserver ()
 }
 
 void
-OSCGlobalObserver::tick ()
+OSCGlobalObserver::tick (MeterSnapshot::Reader const & meters)
 {
 	framepos_t now_frame = session->transport_frame();
 	if (now_frame != _last_frame) {
@@ -205,7 +205,7 @@ OSCGlobalObserver::tick ()
 	}
 	if (feedback[7] || feedback[8] || feedback[9]) { // meters enabled
 		// the only meter here is master
-		float now_meter = session->master_out()->peak_meter()->meter_level(0, MeterMCP);
+		float now_meter = OSC::meter_level (meters, session->master_out()->peak_meter());
 		if (now_meter < -94) now_meter = -193;
 		if (_last_meter != now_meter) {
 			if (feedback[7] || feedback[8]) {
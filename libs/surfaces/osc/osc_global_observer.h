@@ -28,6 +28,7 @@
 #include "pbd/controllable.h"
 #include "pbd/stateful.h"
 #include "ardour/types.h"
+#include "ardour/meter_snapshot.h"
 
 class OSCGlobalObserver
 {
@@ -37,7 +38,7 @@ class OSCGlobalObserver
 	~OSCGlobalObserver ();
 
 	lo_address address() const { return addr; };
-	void tick (void);
+	void tick (ARDOUR::MeterSnapshot::Reader const &);
 
   private:
 
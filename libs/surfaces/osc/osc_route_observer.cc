@@ -94,7 +94,7 @@ OSCRouteObserver::OSCRouteObserver (boost::shared_ptr<Stripable> s, lo_address a
 			send_change_message ("/strip/pan_stereo_position", _strip->pan_azimuth_control());
 		}
 	}
-	tick();
+	tick (OSC::instance()->meters ());
 }
 
 OSCRouteObserver::~OSCRouteObserver ()
@@ -140,13 +140,13 @@ OSCRouteObserver::~OSCRouteObserver ()
 }
 
 void
-OSCRouteObserver::tick ()
+OSCRouteObserver::tick (MeterSnapshot::Reader const & meters)
 {
 	if (feedback[7] || feedback[8] || feedback[9]) { // meters enabled
 		// the only meter here is master
 		float now_meter;
 		if (_strip->peak_meter()) {
-			now_meter = _strip->peak_meter()->meter_level(0, MeterMCP);
+			now_meter = OSC::meter_level (meters, _strip->peak_meter());
 		} else {
 			now_meter = -193;
 		}
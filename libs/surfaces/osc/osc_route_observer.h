@@ -29,6 +29,7 @@
 #include "pbd/controllable.h"
 #include "pbd/stateful.h"
 #include "ardour/types.h"
+#include "ardour/meter_snapshot.h"
 
 class OSCRouteObserver
 {
@@ -39,7 +40,7 @@ class OSCRouteObserver
 
 	boost::shared_ptr<ARDOUR::Stripable> strip () const { return _strip; }
 	lo_address address() const { return addr; };
-	void tick (void);
+	void tick (ARDOUR::MeterSnapshot::Reader const &);
 	void send_select_status (const PBD::PropertyChange&);
 
   private:
@@ -174,7 +174,7 @@ OSCSelectObserver::OSCSelectObserver (boost::shared_ptr<Stripable> s, lo_address
 
 	}
 
-	tick();
+	tick (OSC::instance()->meters ());
 }
 
 OSCSelectObserver::~OSCSelectObserver ()
@@ -303,12 +303,12 @@ OSCSelectObserver::send_restart(int x)
 }
 
 void
-OSCSelectObserver::tick ()
+OSCSelectObserver::tick (MeterSnapshot::Reader const & meters)
 {
 	if (feedback[7] || feedback[8] || feedback[9]) { // meters enabled
 		float now_meter;
 		if (_strip->peak_meter()) {
-			now_meter = _strip->peak_meter()->meter_level(0, MeterMCP);
+			now_meter = OSC::meter_level (meters, _strip->peak_meter());
 		} else {
 			now_meter = -193;
 		}
@@ -29,6 +29,7 @@
 #include "pbd/controllable.h"
 #include "pbd/stateful.h"
 #include "ardour/types.h"
+#include "ardour/meter_snapshot.h"
 #include "ardour/processor.h"
 
 class OSCSelectObserver
@@ -40,7 +41,7 @@ class OSCSelectObserver
 
 	boost::shared_ptr<ARDOUR::Stripable> strip () const { return _strip; }
 	lo_address address() const { return addr; };
-	void tick (void);
+	void tick (ARDOUR::MeterSnapshot::Reader const &);
 
   private:
 	boost::shared_ptr<ARDOUR::Stripable> _strip;
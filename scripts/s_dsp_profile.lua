@@ -0,0 +1,39 @@
+ardour { ["type"] = "Snippet", name = "DSP Profile" }
+
+function factory () return function ()
+	-- run this once to start collecting DSP timing statistics,
+	-- and again to print them (times in usec) and stop.
+	local engine = Session:engine ()
+
+	if not engine:profiling () then
+		engine:reset_cycle_timing ()
+		for r in Session:get_routes():iter() do
+			r:reset_dsp_timing ()
+		end
+		engine:set_profiling (true)
+		print ("DSP profiling started")
+		return
+	end
+
+	engine:set_profiling (false)
+
+	function stats (name, t)
+		if t:count () == 0 then return end
+		print (string.format ("%-32s n: %8d min: %8.1f avg: %8.1f max: %8.1f p99: %8.1f",
+		       name, t:count (), t:minimum () / 1000, t:average () / 1000,
+		       t:maximum () / 1000, t:percentile (0.99) / 1000))
+	end
+
+	stats ("Process cycle", engine:cycle_timing ())
+
+	for r in Session:get_routes():iter() do
+		stats (r:name (), r:process_timing ())
+		local i = 0
+		while true do
+			local proc = r:nth_processor (i)
+			if proc:isnil () then break end
+			stats ("  " .. proc:display_name (), proc:dsp_timing ())
+			i = i + 1
+		end
+	end
+end end
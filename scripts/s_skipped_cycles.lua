@@ -0,0 +1,23 @@
+ardour { ["type"] = "Snippet", name = "Skipped Plugin Cycles" }
+
+function factory () return function ()
+	-- show how often the plugins of each route were not run, because
+	-- their input had been silent for longer than their tail
+	for r in Session:get_routes():iter() do
+		local processed = r:processed_cycles ()
+		local skipped = r:skipped_cycles ()
+		if processed + skipped > 0 then
+			print (string.format ("%-24s %6.2f%% of %d cycles skipped",
+			       r:name(), 100 * skipped / (processed + skipped), processed + skipped))
+		end
+		local i = 0
+		while true do
+			local proc = r:nth_plugin (i)
+			if proc:isnil () then break end
+			local pi = proc:to_insert ()
+			print ("  ", proc:name (), "tail:", pi:tail ())
+			i = i + 1
+		end
+		r:reset_cycle_stats ()
+	end
+end end